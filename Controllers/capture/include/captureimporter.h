@@ -0,0 +1,56 @@
+#ifndef CAPTUREIMPORTER_H
+#define CAPTUREIMPORTER_H
+
+#include <QString>
+
+// Forward declarations
+struct ExportProgress;
+
+/**
+ * @brief The CaptureImporter class turns the telemetry datagrams of a packet capture into a session log
+ *
+ * The capture is mapped by a PcapReader. The UDP payloads for one port are decoded by the same
+ * UdpParserWorker::parsePayload() the live UDP source uses and stamped with their capture times.
+ * Batches of packets are parsed on the global thread pool, each batch is sorted by capture time and
+ * the batches are merged pairwise, also in parallel, so datagrams that were captured out of order
+ * end up in timestamp order. The frames are written as an ordinary .tlog with its index, which the
+ * replay source then plays with pacing, fast-forward, seeking and export like a recorded session.
+ */
+class CaptureImporter
+{
+public:
+    struct Result
+    {
+        quint16 port = 0;    // The imported port, the busiest one if none was chosen
+        qint64 packets = 0;
+        qint64 datagrams = 0; // UDP datagrams to the port
+        qint64 frames = 0;
+        qint64 rejected = 0;  // Datagrams the parser could not decode
+    };
+
+    /**
+     * @brief Where the imported log of a capture is cached, in the cache directory of the application
+     * @param port 0 for the busiest port
+     */
+    static QString logPath(const QString &capturePath, quint16 port);
+
+    /**
+     * @brief Import a capture unless a log newer than the capture is cached, see logPath()
+     * @param progress Optional, counts the packets decoded and cancels the import
+     * @return The log to open, empty if the capture cannot be imported
+     */
+    static QString cachedImport(const QString &capturePath, quint16 port, QString *error = nullptr, ExportProgress *progress = nullptr);
+
+    /**
+     * @brief Decode the datagrams sent to one port of a capture into a session log
+     * @param port Destination port of the telemetry, 0 picks the port with the most datagrams
+     * @param logPath The .tlog to write, replaced only once it is complete
+     * @param progress Optional, every packet counts twice, once for its headers and once for its payload
+     * @return False if the capture cannot be read, holds no telemetry, the log cannot be written or
+     * the import was cancelled
+     */
+    static bool import(const QString &capturePath, quint16 port, const QString &logPath, Result &result, QString *error = nullptr,
+                       ExportProgress *progress = nullptr);
+};
+
+#endif // CAPTUREIMPORTER_H
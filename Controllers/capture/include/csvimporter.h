@@ -0,0 +1,76 @@
+#ifndef CSVIMPORTER_H
+#define CSVIMPORTER_H
+
+#include <QList>
+#include <QString>
+
+// Forward declarations
+struct ExportProgress;
+
+/**
+ * @brief The CsvImporter class converts legacy CSV logs in the 15-field MCU format into session logs
+ *
+ * The file is memory-mapped and cut into line-aligned chunks of a few MiB. The lines of every chunk
+ * are counted first, in parallel, so each line knows its number in the file. A window of chunks, one
+ * per worker of the global thread pool, is then parsed at a time by SerialParserWorker::parseLine(),
+ * the parser of the live serial source, and the frames are streamed into a SessionLogWriter in file
+ * order. Memory therefore stays bounded however large the file is.
+ *
+ * The logs carry no timestamps, so lines are taken to be a fixed interval apart and the session to
+ * end when the file was last modified. A malformed line keeps its time slot and leaves a gap.
+ */
+class CsvImporter
+{
+public:
+    static constexpr qint64 DefaultIntervalUs = 10000; // One line every 10 ms
+
+    struct Chunk
+    {
+        qint64 firstLine = 0;    // 1-based number in the file
+        qint64 lines = 0;
+        qint64 frames = 0;
+        qint64 rejected = 0;
+        qint64 firstBadLine = 0; // 0 if no line was rejected
+        QString firstError;
+    };
+
+    struct Result
+    {
+        qint64 bytes = 0;
+        qint64 lines = 0;
+        qint64 frames = 0;
+        qint64 rejected = 0;
+        QList<Chunk> chunks;
+    };
+
+    /**
+     * @brief Where the imported log of a CSV file is cached, in the cache directory of the application
+     */
+    static QString logPath(const QString &csvPath);
+
+    /**
+     * @brief Import a CSV file unless a log newer than the file is cached, see logPath()
+     *
+     * The figures of an import are saved in a .result file next to the log and read back with it.
+     * @param result Optional, the figures of the import, also when the cached log is used
+     * @param progress Optional, counts the bytes parsed and cancels the import
+     * @return The log to open, empty if the file cannot be imported
+     */
+    static QString cachedImport(const QString &csvPath, QString *error = nullptr, Result *result = nullptr, ExportProgress *progress = nullptr);
+
+    /**
+     * @brief Parse a CSV file into a session log
+     *
+     * A first line that does not start with a number is taken for a column header and skipped. Blank
+     * lines are skipped too. Other malformed lines are counted per chunk with the first error of the chunk.
+     * @param intervalUs Time between two lines
+     * @param logPath The .tlog to write, replaced only once it is complete
+     * @param progress Optional, counts the bytes parsed and is checked between two windows of chunks
+     * @return False if the file cannot be read, holds no valid line, the log cannot be written or the
+     * import was cancelled
+     */
+    static bool import(const QString &csvPath, const QString &logPath, qint64 intervalUs, Result &result, QString *error = nullptr,
+                       ExportProgress *progress = nullptr);
+};
+
+#endif // CSVIMPORTER_H
@@ -0,0 +1,35 @@
+#ifndef IMPORTCACHE_H
+#define IMPORTCACHE_H
+
+#include <QString>
+
+/**
+ * @brief The ImportCache class locates the session logs that importers keep in the cache directory
+ *
+ * A log is named after its source file and a hash of the source's absolute path, so sources of the
+ * same name in different directories do not share a log. A log is reused until the source is
+ * modified after it.
+ */
+class ImportCache
+{
+public:
+    /**
+     * @brief Where the log of a source file is cached
+     * @param directory Subdirectory of the cache directory of the application, e.g. "captures"
+     * @param suffix Ends the name of the log before ".tlog", tells apart logs imported from one source
+     * with different settings
+     */
+    static QString logPath(const QString &sourcePath, const QString &directory, const QString &suffix);
+
+    /**
+     * @brief True if the log exists and is not older than its source
+     */
+    static bool isFresh(const QString &sourcePath, const QString &logPath);
+
+    /**
+     * @brief Create the directory of a log before it is written
+     */
+    static bool makeDirectory(const QString &logPath, QString *error = nullptr);
+};
+
+#endif // IMPORTCACHE_H
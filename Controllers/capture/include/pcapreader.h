@@ -0,0 +1,83 @@
+#ifndef PCAPREADER_H
+#define PCAPREADER_H
+
+#include <QByteArrayView>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+/**
+ * @brief The PcapReader class reads packet captures, e.g. from tcpdump or Wireshark, through a memory mapping
+ *
+ * Both the classic pcap format, with microsecond or nanosecond timestamps in either byte order, and
+ * pcapng, with per-interface timestamp resolutions and several sections, are understood. Opening
+ * walks the record headers once and lists every packet with its capture time. Packets are not
+ * copied: udpDatagram() decodes the link, IP and UDP headers in place and is safe to call from many
+ * threads at once.
+ *
+ * Ethernet with VLAN tags, Linux cooked captures (SLL and SLL2), BSD loopback and raw IP links carrying
+ * IPv4 or IPv6 are decoded. Fragmented datagrams cannot be reassembled and are skipped.
+ */
+class PcapReader
+{
+public:
+    struct Packet
+    {
+        qint64 timeUs = 0;  // Capture time, microseconds since the Unix epoch
+        qint64 offset = 0;  // Start of the captured bytes in the file
+        quint32 length = 0; // Captured bytes, may be less than were on the wire
+        quint16 linkType = 0;
+    };
+
+    struct Datagram
+    {
+        quint16 sourcePort = 0;
+        quint16 destinationPort = 0;
+        qint64 offset = 0; // Start of the UDP payload in the file
+        quint32 length = 0;
+    };
+
+    PcapReader();
+    ~PcapReader();
+
+    PcapReader(const PcapReader &) = delete;
+    PcapReader &operator=(const PcapReader &) = delete;
+
+    /**
+     * @brief True if the file starts like a pcap or pcapng capture
+     */
+    static bool isCapture(const QString &path);
+
+    /**
+     * @brief Map a capture and list its packets
+     *
+     * A record cut short at the end of the file, as left by an interrupted capture, is ignored.
+     * @param error Set to a description if the file cannot be read
+     * @return False if the file is not a capture
+     */
+    bool open(const QString &path, QString *error = nullptr);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    const QList<Packet> &packets() const { return m_packets; }
+    qint64 skippedPackets() const { return m_skippedPackets; } // Packets without a timestamp or interface.
+
+    /**
+     * @brief Locate the UDP payload of a packet
+     * @return False if the packet is not a complete, unfragmented UDP datagram over IPv4 or IPv6
+     */
+    bool udpDatagram(const Packet &packet, Datagram &datagram) const;
+
+    QByteArrayView payload(const Datagram &datagram) const;
+
+private:
+    bool readPcap(qint64 size, QString *error);
+    bool readPcapng(qint64 size, QString *error);
+
+    QFile m_file;
+    uchar *m_data;
+    QList<Packet> m_packets;
+    qint64 m_skippedPackets;
+};
+
+#endif // PCAPREADER_H
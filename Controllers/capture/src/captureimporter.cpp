@@ -0,0 +1,215 @@
+#include "../include/captureimporter.h"
+#include "../include/importcache.h"
+#include "../include/pcapreader.h"
+#include "../../export/include/exportprogress.h"
+#include "../../recording/include/sessionlogwriter.h"
+#include "../../telemetry/include/parallelfor.h"
+#include "../../udp/include/udpparserworker.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+// Packets per parallel batch, large enough that claiming a batch costs nothing against parsing it
+constexpr qsizetype BatchPackets = 16384;
+
+bool earlier(const TelemetryFrame &left, const TelemetryFrame &right)
+{
+    return left.timestampUs < right.timestampUs;
+}
+}
+
+QString CaptureImporter::logPath(const QString &capturePath, quint16 port)
+{
+    return ImportCache::logPath(capturePath, QStringLiteral("captures"),
+                                QStringLiteral("udp%1").arg(port == 0 ? QStringLiteral("any") : QString::number(port)));
+}
+
+QString CaptureImporter::cachedImport(const QString &capturePath, quint16 port, QString *error, ExportProgress *progress)
+{
+    const QString path = logPath(capturePath, port);
+    if (ImportCache::isFresh(capturePath, path))
+    {
+        qDebug() << "CaptureImporter: Using the earlier import" << path;
+        return path;
+    }
+    if (!ImportCache::makeDirectory(path, error))
+    {
+        return QString();
+    }
+
+    Result result;
+    return import(capturePath, port, path, result, error, progress) ? path : QString();
+}
+
+bool CaptureImporter::import(const QString &capturePath, quint16 port, const QString &logPath, Result &result, QString *error,
+                             ExportProgress *progress)
+{
+    auto cancelled = [progress]()
+    {
+        return progress && progress->isCancelled();
+    };
+    auto advance = [progress](qint64 packets)
+    {
+        if (progress)
+        {
+            progress->advance(packets);
+        }
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    result = Result();
+
+    PcapReader reader;
+    if (!reader.open(capturePath, error))
+    {
+        return false;
+    }
+    const QList<PcapReader::Packet> &packets = reader.packets();
+    result.packets = packets.size();
+    if (progress)
+    {
+        progress->total.store(2 * result.packets);
+    }
+
+    // Link, IP and UDP headers of every packet, decoded in place
+    const qsizetype batchCount = (packets.size() + BatchPackets - 1) / BatchPackets;
+    QList<PcapReader::Datagram> datagrams(packets.size());
+    QList<bool> isDatagram(packets.size(), false);
+    parallelFor(batchCount, [&](qsizetype batch)
+    {
+        if (cancelled())
+        {
+            return;
+        }
+        const qsizetype end = qMin(packets.size(), (batch + 1) * BatchPackets);
+        for (qsizetype i = batch * BatchPackets; i < end; ++i)
+        {
+            isDatagram[i] = reader.udpDatagram(packets.at(i), datagrams[i]);
+        }
+        advance(end - batch * BatchPackets);
+    });
+
+    if (port == 0)
+    {
+        QHash<quint16, qint64> counts;
+        for (qsizetype i = 0; i < packets.size(); ++i)
+        {
+            if (isDatagram.at(i))
+            {
+                ++counts[datagrams.at(i).destinationPort];
+            }
+        }
+        qint64 busiest = 0;
+        for (auto it = counts.cbegin(); it != counts.cend(); ++it)
+        {
+            if (it.value() > busiest)
+            {
+                busiest = it.value();
+                port = it.key();
+            }
+        }
+    }
+    result.port = port;
+
+    // Every batch parses its payloads and sorts its frames by capture time, which they nearly always are already
+    QList<QList<TelemetryFrame>> runs(batchCount);
+    std::atomic<qint64> datagramCount(0);
+    std::atomic<qint64> rejected(0);
+    parallelFor(batchCount, [&](qsizetype batch)
+    {
+        if (cancelled())
+        {
+            return;
+        }
+        QList<TelemetryFrame> &frames = runs[batch];
+        qint64 batchDatagrams = 0;
+        qint64 batchRejected = 0;
+        const qsizetype end = qMin(packets.size(), (batch + 1) * BatchPackets);
+        for (qsizetype i = batch * BatchPackets; i < end; ++i)
+        {
+            if (!isDatagram.at(i) || datagrams.at(i).destinationPort != port)
+            {
+                continue;
+            }
+
+            ++batchDatagrams;
+            TelemetryFrame frame;
+            if (!UdpParserWorker::parsePayload(reader.payload(datagrams.at(i)), frame))
+            {
+                ++batchRejected;
+                continue;
+            }
+            frame.timestampUs = packets.at(i).timeUs;
+            frames.append(frame);
+        }
+
+        if (!std::is_sorted(frames.cbegin(), frames.cend(), earlier))
+        {
+            std::stable_sort(frames.begin(), frames.end(), earlier);
+        }
+        datagramCount.fetch_add(batchDatagrams, std::memory_order_relaxed);
+        rejected.fetch_add(batchRejected, std::memory_order_relaxed);
+        advance(end - batch * BatchPackets);
+    });
+    if (cancelled())
+    {
+        if (error)
+        {
+            *error = QStringLiteral("Import cancelled");
+        }
+        return false;
+    }
+
+    // Pairwise merges halve the runs in every round, ties keep their capture order
+    while (runs.size() > 1)
+    {
+        QList<QList<TelemetryFrame>> merged((runs.size() + 1) / 2);
+        parallelFor(merged.size(), [&](qsizetype i)
+        {
+            if (2 * i + 1 == runs.size())
+            {
+                merged[i] = std::move(runs[2 * i]);
+                return;
+            }
+            const QList<TelemetryFrame> &left = runs.at(2 * i);
+            const QList<TelemetryFrame> &right = runs.at(2 * i + 1);
+            merged[i].resize(left.size() + right.size());
+            std::merge(left.cbegin(), left.cend(), right.cbegin(), right.cend(), merged[i].begin(), earlier);
+        });
+        runs = std::move(merged);
+    }
+
+    result.datagrams = datagramCount.load();
+    result.rejected = rejected.load();
+    result.frames = runs.isEmpty() ? 0 : runs.first().size();
+    if (result.frames == 0)
+    {
+        if (error)
+        {
+            *error = port == 0 ? QStringLiteral("No UDP datagrams in %1").arg(capturePath)
+                               : QStringLiteral("No telemetry datagrams on UDP port %1 in %2").arg(port).arg(capturePath);
+        }
+        return false;
+    }
+
+    // Capture times are kept as they are, on a clock that reads the wall clock time in microseconds
+    SessionLogWriter writer;
+    if (!writer.open(logPath, runs.first().first().timestampUs / 1000, SessionLog::Transport::Udp, error))
+    {
+        return false;
+    }
+    writer.append(runs.first()); // A failed write is reported by commit()
+    if (!writer.commit(error))
+    {
+        return false;
+    }
+
+    qDebug() << "CaptureImporter: Imported" << result.frames << "frames from" << result.datagrams << "datagrams on port" << port
+             << "of" << result.packets << "packets," << result.rejected << "rejected, in" << timer.elapsed() << "ms";
+    return true;
+}
@@ -0,0 +1,295 @@
+#include "../include/csvimporter.h"
+#include "../include/importcache.h"
+#include "../../export/include/exportprogress.h"
+#include "../../recording/include/sessionlogwriter.h"
+#include "../../serial/include/serialparserworker.h"
+#include "../../telemetry/include/parallelfor.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+// Bytes per chunk, tens of thousands of 15-field lines; a window of chunks holds its frames in memory at once
+constexpr qint64 ChunkBytes = qint64(4) << 20;
+
+const char *lineEnd(const char *from, const char *end)
+{
+    const void *newline = std::memchr(from, '\n', size_t(end - from));
+    return newline ? static_cast<const char *>(newline) : end;
+}
+
+// The figures of an import, saved next to its log so a cached log still reports its rejected lines
+constexpr quint32 ResultMagic = 0x54435652; // "TCVR"
+constexpr quint16 ResultVersion = 1;
+
+QString resultPath(const QString &logPath)
+{
+    const QFileInfo info(logPath);
+    return QDir(info.path()).filePath(info.completeBaseName() + QStringLiteral(".result"));
+}
+
+bool saveResult(const QString &path, const CsvImporter::Result &result)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << ResultMagic << ResultVersion << result.bytes << result.lines << result.frames << result.rejected << qint64(result.chunks.size());
+    for (const CsvImporter::Chunk &chunk : result.chunks)
+    {
+        stream << chunk.firstLine << chunk.lines << chunk.frames << chunk.rejected << chunk.firstBadLine << chunk.firstError;
+    }
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+bool loadResult(const QString &path, CsvImporter::Result &result)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint64 chunkCount = 0;
+    stream >> magic >> version;
+    if (magic != ResultMagic || version != ResultVersion)
+    {
+        return false;
+    }
+    stream >> result.bytes >> result.lines >> result.frames >> result.rejected >> chunkCount;
+    // Every chunk takes at least 44 bytes, a count beyond the file is corrupt
+    if (stream.status() != QDataStream::Ok || chunkCount < 0 || chunkCount > file.size() / 44)
+    {
+        return false;
+    }
+
+    result.chunks.resize(qsizetype(chunkCount));
+    for (CsvImporter::Chunk &chunk : result.chunks)
+    {
+        stream >> chunk.firstLine >> chunk.lines >> chunk.frames >> chunk.rejected >> chunk.firstBadLine >> chunk.firstError;
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+bool isHeader(QByteArrayView line)
+{
+    const QByteArrayView trimmed = line.trimmed();
+    return !trimmed.isEmpty() && ((trimmed.front() >= 'A' && trimmed.front() <= 'Z') || (trimmed.front() >= 'a' && trimmed.front() <= 'z'));
+}
+}
+
+QString CsvImporter::logPath(const QString &csvPath)
+{
+    return ImportCache::logPath(csvPath, QStringLiteral("imports"), QStringLiteral("csv"));
+}
+
+QString CsvImporter::cachedImport(const QString &csvPath, QString *error, Result *result, ExportProgress *progress)
+{
+    // A cached log without its saved figures is imported again when the caller wants them
+    const QString path = logPath(csvPath);
+    if (ImportCache::isFresh(csvPath, path) && (!result || loadResult(resultPath(path), *result)))
+    {
+        qDebug() << "CsvImporter: Using the earlier import" << path;
+        return path;
+    }
+    if (!ImportCache::makeDirectory(path, error))
+    {
+        return QString();
+    }
+
+    Result figures;
+    if (!import(csvPath, path, DefaultIntervalUs, figures, error, progress))
+    {
+        return QString();
+    }
+    if (!saveResult(resultPath(path), figures))
+    {
+        qDebug() << "CsvImporter: Cannot write" << resultPath(path);
+    }
+    if (result)
+    {
+        *result = figures;
+    }
+    return path;
+}
+
+bool CsvImporter::import(const QString &csvPath, const QString &logPath, qint64 intervalUs, Result &result, QString *error,
+                         ExportProgress *progress)
+{
+    auto fail = [error](const QString &message)
+    {
+        if (error)
+        {
+            *error = message;
+        }
+        return false;
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    result = Result();
+
+    QFile file(csvPath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return fail(file.errorString());
+    }
+    result.bytes = file.size();
+    if (result.bytes == 0)
+    {
+        return fail(QStringLiteral("%1 is empty").arg(csvPath));
+    }
+    const uchar *mapped = file.map(0, result.bytes);
+    if (!mapped)
+    {
+        return fail(file.errorString());
+    }
+    const char *data = reinterpret_cast<const char *>(mapped);
+    const char *dataEnd = data + result.bytes;
+    if (progress)
+    {
+        progress->total.store(result.bytes);
+    }
+
+    // Chunks end after the first newline past every ChunkBytes, a line longer than a chunk leaves one empty
+    const qsizetype chunkCount = qsizetype((result.bytes + ChunkBytes - 1) / ChunkBytes);
+    QList<const char *> bounds(chunkCount + 1);
+    bounds[0] = data;
+    for (qsizetype i = 1; i < chunkCount; ++i)
+    {
+        const char *from = qMax(bounds.at(i - 1), data + i * ChunkBytes);
+        const char *end = lineEnd(from, dataEnd);
+        bounds[i] = end == dataEnd ? dataEnd : end + 1;
+    }
+    bounds[chunkCount] = dataEnd;
+
+    // Line numbers first, so the chunks can be parsed and timed independently
+    result.chunks.resize(chunkCount);
+    parallelFor(chunkCount, [&](qsizetype i)
+    {
+        const char *begin = bounds.at(i);
+        const char *end = bounds.at(i + 1);
+        qint64 lines = std::count(begin, end, '\n');
+        if (end > begin && end[-1] != '\n')
+        {
+            ++lines; // The last line of the file without a newline
+        }
+        result.chunks[i].lines = lines;
+    });
+    qint64 line = 1;
+    for (Chunk &chunk : result.chunks)
+    {
+        chunk.firstLine = line;
+        line += chunk.lines;
+    }
+    result.lines = line - 1;
+
+    // The session ends when the file was last written
+    const qint64 endUs = QFileInfo(csvPath).lastModified().toMSecsSinceEpoch() * 1000;
+    const qint64 startUs = endUs - result.lines * intervalUs;
+
+    SessionLogWriter writer;
+    if (!writer.open(logPath, startUs / 1000, SessionLog::Transport::Serial, error))
+    {
+        return false;
+    }
+
+    // A window of chunks, one per worker, is parsed at a time and handed to the writer in file order
+    const qsizetype window = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    QList<QList<TelemetryFrame>> frames(window);
+    for (qsizetype first = 0; first < chunkCount; first += window)
+    {
+        if (progress && progress->isCancelled())
+        {
+            return fail(QStringLiteral("Import cancelled"));
+        }
+
+        const qsizetype count = qMin(window, chunkCount - first);
+        parallelFor(count, [&](qsizetype i)
+        {
+            Chunk &chunk = result.chunks[first + i];
+            QList<TelemetryFrame> &chunkFrames = frames[i];
+            chunkFrames.clear();
+
+            const char *end = bounds.at(first + i + 1);
+            qint64 lineNumber = chunk.firstLine;
+            for (const char *from = bounds.at(first + i); from < end; ++lineNumber)
+            {
+                const char *to = lineEnd(from, end);
+                const QByteArrayView text(from, to - from);
+                from = to + 1;
+
+                if (text.trimmed().isEmpty() || (lineNumber == 1 && isHeader(text)))
+                {
+                    continue;
+                }
+
+                TelemetryFrame frame;
+                QString lineError;
+                if (!SerialParserWorker::parseLine(text, frame, &lineError))
+                {
+                    if (chunk.rejected++ == 0)
+                    {
+                        chunk.firstBadLine = lineNumber;
+                        chunk.firstError = lineError;
+                    }
+                    continue;
+                }
+                frame.timestampUs = startUs + (lineNumber - 1) * intervalUs;
+                chunkFrames.append(frame);
+            }
+            chunk.frames = chunkFrames.size();
+            if (progress)
+            {
+                progress->advance(end - bounds.at(first + i));
+            }
+        });
+
+        for (qsizetype i = 0; i < count; ++i)
+        {
+            writer.append(frames.at(i)); // A failed write is reported by commit()
+        }
+    }
+
+    for (qsizetype i = 0; i < chunkCount; ++i)
+    {
+        const Chunk &chunk = result.chunks.at(i);
+        result.frames += chunk.frames;
+        result.rejected += chunk.rejected;
+        if (chunk.rejected > 0)
+        {
+            qDebug() << "CsvImporter: Chunk" << i << "lines" << chunk.firstLine << "to" << chunk.firstLine + chunk.lines - 1 << ":"
+                     << chunk.rejected << "rejected, first at line" << chunk.firstBadLine << ":" << chunk.firstError;
+        }
+    }
+
+    if (result.frames == 0)
+    {
+        return fail(QStringLiteral("No valid lines in %1").arg(csvPath));
+    }
+    if (!writer.commit(error))
+    {
+        return false;
+    }
+
+    qDebug() << "CsvImporter: Imported" << result.frames << "frames from" << result.lines << "lines," << result.rejected << "rejected,"
+             << result.bytes / 1000000 << "MB in" << timer.elapsed() << "ms";
+    return true;
+}
@@ -0,0 +1,34 @@
+#include "../include/importcache.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QStandardPaths>
+
+QString ImportCache::logPath(const QString &sourcePath, const QString &directory, const QString &suffix)
+{
+    const QFileInfo info(sourcePath);
+    const QString key = QString::number(quint64(qHash(info.absoluteFilePath(), 0)), 16);
+    const QString name = QStringLiteral("%1-%2-%3.tlog").arg(info.completeBaseName(), key, suffix);
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1Char('/') + directory).filePath(name);
+}
+
+bool ImportCache::isFresh(const QString &sourcePath, const QString &logPath)
+{
+    const QFileInfo log(logPath);
+    return log.exists() && log.lastModified() >= QFileInfo(sourcePath).lastModified();
+}
+
+bool ImportCache::makeDirectory(const QString &logPath, QString *error)
+{
+    const QString directory = QFileInfo(logPath).absolutePath();
+    if (!QDir().mkpath(directory))
+    {
+        if (error)
+        {
+            *error = QStringLiteral("Cannot create directory %1").arg(directory);
+        }
+        return false;
+    }
+    return true;
+}
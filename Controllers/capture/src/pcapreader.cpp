@@ -0,0 +1,483 @@
+#include "../include/pcapreader.h"
+#include <QDebug>
+#include <QtEndian>
+
+namespace
+{
+// Magic numbers of classic pcap as read little-endian, byte-swapped files read the other way round
+constexpr quint32 PcapMicroMagic = 0xA1B2C3D4;
+constexpr quint32 PcapNanoMagic = 0xA1B23C4D;
+constexpr int PcapHeaderSize = 24;
+constexpr int PcapRecordHeaderSize = 16;
+
+// pcapng block types, the section header reads the same in both byte orders
+constexpr quint32 SectionHeaderBlock = 0x0A0D0D0A;
+constexpr quint32 InterfaceBlock = 1;
+constexpr quint32 ObsoletePacketBlock = 2;
+constexpr quint32 SimplePacketBlock = 3;
+constexpr quint32 EnhancedPacketBlock = 6;
+constexpr quint32 ByteOrderMagic = 0x1A2B3C4D;
+
+// Interface options that change how timestamps are read
+constexpr quint16 EndOfOptions = 0;
+constexpr quint16 TimestampResolutionOption = 9;
+constexpr quint16 TimestampOffsetOption = 14;
+
+// Link types, see https://www.tcpdump.org/linktypes.html
+constexpr quint16 LinkNull = 0;
+constexpr quint16 LinkEthernet = 1;
+constexpr quint16 LinkRawOpenBsd = 12;
+constexpr quint16 LinkRawBsd = 14;
+constexpr quint16 LinkRaw = 101;
+constexpr quint16 LinkLoop = 108;
+constexpr quint16 LinkLinuxSll = 113;
+constexpr quint16 LinkIpv4 = 228;
+constexpr quint16 LinkIpv6 = 229;
+constexpr quint16 LinkLinuxSll2 = 276;
+
+constexpr quint16 EtherTypeIpv4 = 0x0800;
+constexpr quint16 EtherTypeIpv6 = 0x86DD;
+constexpr quint8 ProtocolUdp = 17;
+
+/**
+ * @brief Reads the integers of a capture in the byte order of the machine that wrote it
+ */
+struct ByteOrder
+{
+    bool big = false;
+
+    quint16 u16(const uchar *source) const { return big ? qFromBigEndian<quint16>(source) : qFromLittleEndian<quint16>(source); }
+    quint32 u32(const uchar *source) const { return big ? qFromBigEndian<quint32>(source) : qFromLittleEndian<quint32>(source); }
+    qint64 i64(const uchar *source) const { return big ? qFromBigEndian<qint64>(source) : qFromLittleEndian<qint64>(source); }
+};
+
+/**
+ * @brief Timestamp units of a pcapng interface, microseconds unless its options say otherwise
+ */
+struct Interface
+{
+    quint16 linkType = 0;
+    bool binary = false; // Units are 2^-exponent seconds instead of 10^-exponent
+    int exponent = 6;
+    qint64 offsetSeconds = 0;
+
+    qint64 toMicroseconds(quint64 units) const
+    {
+        qint64 us;
+        if (!binary)
+        {
+            quint64 scale = 1;
+            for (int i = 6; i < exponent; ++i)
+            {
+                scale *= 10;
+            }
+            for (int i = exponent; i < 6; ++i)
+            {
+                scale *= 10;
+            }
+            us = qint64(exponent >= 6 ? units / scale : units * scale);
+        }
+        else
+        {
+            // The fraction is cut to 40 bits first so the multiplication cannot overflow
+            const quint64 seconds = units >> exponent;
+            quint64 fraction = units & ((quint64(1) << exponent) - 1);
+            int bits = exponent;
+            if (bits > 40)
+            {
+                fraction >>= bits - 40;
+                bits = 40;
+            }
+            us = qint64(seconds * 1000000 + ((fraction * 1000000) >> bits));
+        }
+        return us + offsetSeconds * 1000000;
+    }
+};
+
+quint16 be16(const uchar *source)
+{
+    return qFromBigEndian<quint16>(source);
+}
+}
+
+PcapReader::PcapReader()
+    : m_data(nullptr),
+    m_skippedPackets(0)
+{
+}
+
+PcapReader::~PcapReader()
+{
+    close();
+}
+
+bool PcapReader::isCapture(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    const QByteArray head = file.read(4);
+    if (head.size() != 4)
+    {
+        return false;
+    }
+    const quint32 little = qFromLittleEndian<quint32>(head.constData());
+    const quint32 big = qFromBigEndian<quint32>(head.constData());
+    return little == SectionHeaderBlock || little == PcapMicroMagic || little == PcapNanoMagic || big == PcapMicroMagic || big == PcapNanoMagic;
+}
+
+bool PcapReader::open(const QString &path, QString *error)
+{
+    close();
+
+    auto fail = [this, error](const QString &message)
+    {
+        if (error)
+        {
+            *error = message;
+        }
+        close();
+        return false;
+    };
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        return fail(m_file.errorString());
+    }
+
+    const qint64 size = m_file.size();
+    m_data = size >= 12 ? m_file.map(0, size) : nullptr;
+    if (!m_data)
+    {
+        return fail(QStringLiteral("Cannot map %1").arg(path));
+    }
+
+    const quint32 magic = qFromLittleEndian<quint32>(m_data);
+    const bool read = magic == SectionHeaderBlock ? readPcapng(size, error) : readPcap(size, error);
+    if (!read)
+    {
+        return fail(error ? *error : QString());
+    }
+
+    if (m_skippedPackets > 0)
+    {
+        qDebug() << "PcapReader: Skipped" << m_skippedPackets << "packets without a timestamp in" << path;
+    }
+    return true;
+}
+
+void PcapReader::close()
+{
+    if (m_data)
+    {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+    m_file.close();
+    m_packets.clear();
+    m_skippedPackets = 0;
+}
+
+bool PcapReader::readPcap(qint64 size, QString *error)
+{
+    ByteOrder order;
+    const quint32 magic = qFromLittleEndian<quint32>(m_data);
+    order.big = magic != PcapMicroMagic && magic != PcapNanoMagic;
+    const bool nanoseconds = order.u32(m_data) == PcapNanoMagic;
+    if (size < PcapHeaderSize || (order.u32(m_data) != PcapMicroMagic && !nanoseconds))
+    {
+        if (error)
+        {
+            *error = QStringLiteral("Not a pcap or pcapng capture");
+        }
+        return false;
+    }
+
+    // The upper bits of the link type field carry the FCS length, not the link type
+    const quint16 linkType = quint16(order.u32(m_data + 20) & 0xFFFF);
+
+    // Records are only about 16 bytes of header apart, a sequential walk is far cheaper than decoding them
+    m_packets.reserve(size / 128);
+    qint64 offset = PcapHeaderSize;
+    while (offset + PcapRecordHeaderSize <= size)
+    {
+        const uchar *record = m_data + offset;
+        const quint32 length = order.u32(record + 8);
+        if (length > size - offset - PcapRecordHeaderSize)
+        {
+            qDebug() << "PcapReader: Ignoring a truncated record at offset" << offset;
+            break;
+        }
+
+        Packet packet;
+        const qint64 fraction = order.u32(record + 4);
+        packet.timeUs = qint64(order.u32(record)) * 1000000 + (nanoseconds ? fraction / 1000 : fraction);
+        packet.offset = offset + PcapRecordHeaderSize;
+        packet.length = length;
+        packet.linkType = linkType;
+        m_packets.append(packet);
+        offset += PcapRecordHeaderSize + length;
+    }
+    return true;
+}
+
+bool PcapReader::readPcapng(qint64 size, QString *error)
+{
+    ByteOrder order;
+    QList<Interface> interfaces;
+    bool sectionSeen = false;
+
+    m_packets.reserve(size / 128);
+    qint64 offset = 0;
+    while (offset + 12 <= size)
+    {
+        const uchar *block = m_data + offset;
+        const quint32 type = order.u32(block);
+        if (type == SectionHeaderBlock)
+        {
+            // Every section states its own byte order and numbers its interfaces from 0
+            if (offset + 16 > size)
+            {
+                break;
+            }
+            const quint32 byteOrder = qFromLittleEndian<quint32>(block + 8);
+            if (byteOrder != ByteOrderMagic && qFromBigEndian<quint32>(block + 8) != ByteOrderMagic)
+            {
+                break;
+            }
+            order.big = byteOrder != ByteOrderMagic;
+            interfaces.clear();
+            sectionSeen = true;
+        }
+        else if (!sectionSeen)
+        {
+            break;
+        }
+
+        const quint32 blockLength = order.u32(block + 4);
+        if (blockLength < 12 || blockLength % 4 != 0 || blockLength > size - offset)
+        {
+            qDebug() << "PcapReader: Ignoring a truncated block at offset" << offset;
+            break;
+        }
+        const uchar *body = block + 8;
+        const qint64 bodyLength = qint64(blockLength) - 12;
+
+        if (type == InterfaceBlock && bodyLength >= 8)
+        {
+            Interface interface;
+            interface.linkType = order.u16(body);
+            for (qint64 position = 8; position + 4 <= bodyLength;)
+            {
+                const quint16 code = order.u16(body + position);
+                const quint16 length = order.u16(body + position + 2);
+                if (code == EndOfOptions || position + 4 + length > bodyLength)
+                {
+                    break;
+                }
+                const uchar *value = body + position + 4;
+                if (code == TimestampResolutionOption && length >= 1)
+                {
+                    const int exponent = value[0] & 0x7F;
+                    interface.binary = (value[0] & 0x80) != 0;
+                    if ((interface.binary && exponent < 64) || (!interface.binary && exponent <= 19))
+                    {
+                        interface.exponent = exponent;
+                    }
+                    else
+                    {
+                        interface.binary = false;
+                    }
+                }
+                else if (code == TimestampOffsetOption && length >= 8)
+                {
+                    interface.offsetSeconds = order.i64(value);
+                }
+                position += 4 + ((length + 3) & ~3);
+            }
+            interfaces.append(interface);
+        }
+        else if ((type == EnhancedPacketBlock || type == ObsoletePacketBlock) && bodyLength >= 20)
+        {
+            // The obsolete block has a 16-bit interface id followed by a drop counter
+            const quint32 id = type == EnhancedPacketBlock ? order.u32(body) : order.u16(body);
+            const quint32 length = order.u32(body + 12);
+            if (id >= quint32(interfaces.size()) || length > bodyLength - 20)
+            {
+                ++m_skippedPackets;
+            }
+            else
+            {
+                const Interface &interface = interfaces.at(id);
+                Packet packet;
+                packet.timeUs = interface.toMicroseconds((quint64(order.u32(body + 4)) << 32) | order.u32(body + 8));
+                packet.offset = offset + 8 + 20;
+                packet.length = length;
+                packet.linkType = interface.linkType;
+                m_packets.append(packet);
+            }
+        }
+        else if (type == SimplePacketBlock)
+        {
+            ++m_skippedPackets;
+        }
+
+        offset += blockLength;
+    }
+
+    if (!sectionSeen)
+    {
+        if (error)
+        {
+            *error = QStringLiteral("Not a pcap or pcapng capture");
+        }
+        return false;
+    }
+    return true;
+}
+
+bool PcapReader::udpDatagram(const Packet &packet, Datagram &datagram) const
+{
+    const uchar *data = m_data + packet.offset;
+    const qint64 length = packet.length;
+
+    // Find the IP header and its version behind the link layer
+    qint64 position = 0;
+    int version = 0;
+    switch (packet.linkType)
+    {
+    case LinkEthernet:
+    {
+        if (length < 14)
+        {
+            return false;
+        }
+        quint16 etherType = be16(data + 12);
+        position = 14;
+        while ((etherType == 0x8100 || etherType == 0x88A8 || etherType == 0x9100) && position + 4 <= length)
+        {
+            etherType = be16(data + position + 2);
+            position += 4;
+        }
+        version = etherType == EtherTypeIpv4 ? 4 : etherType == EtherTypeIpv6 ? 6 : 0;
+        break;
+    }
+    case LinkNull:
+    case LinkLoop:
+    {
+        if (length < 4)
+        {
+            return false;
+        }
+        // Null links store the address family in the byte order of the capturing host
+        quint32 family = packet.linkType == LinkLoop ? qFromBigEndian<quint32>(data) : qFromLittleEndian<quint32>(data);
+        if (family > 0xFFFF)
+        {
+            family = qFromBigEndian<quint32>(data);
+        }
+        version = family == 2 ? 4 : (family == 24 || family == 28 || family == 30) ? 6 : 0;
+        position = 4;
+        break;
+    }
+    case LinkLinuxSll:
+        if (length < 16)
+        {
+            return false;
+        }
+        version = be16(data + 14) == EtherTypeIpv4 ? 4 : be16(data + 14) == EtherTypeIpv6 ? 6 : 0;
+        position = 16;
+        break;
+    case LinkLinuxSll2:
+        if (length < 20)
+        {
+            return false;
+        }
+        version = be16(data) == EtherTypeIpv4 ? 4 : be16(data) == EtherTypeIpv6 ? 6 : 0;
+        position = 20;
+        break;
+    case LinkRaw:
+    case LinkRawOpenBsd:
+    case LinkRawBsd:
+    case LinkIpv4:
+    case LinkIpv6:
+        version = length > 0 ? data[0] >> 4 : 0;
+        break;
+    default:
+        return false;
+    }
+
+    // The IP header bounds the datagram, anything behind it is link padding or a frame check sequence
+    qint64 end = length;
+    if (version == 4)
+    {
+        if (position + 20 > length || (data[position] >> 4) != 4)
+        {
+            return false;
+        }
+        const qint64 headerLength = qint64(data[position] & 0x0F) * 4;
+        const qint64 totalLength = be16(data + position + 2);
+        const quint16 fragment = be16(data + position + 6);
+        if (headerLength < 20 || data[position + 9] != ProtocolUdp || (fragment & 0x3FFF) != 0)
+        {
+            return false;
+        }
+        end = qMin(length, position + totalLength);
+        position += headerLength;
+    }
+    else if (version == 6)
+    {
+        if (position + 40 > length || (data[position] >> 4) != 6)
+        {
+            return false;
+        }
+        quint8 next = data[position + 6];
+        end = qMin(length, position + 40 + be16(data + position + 4));
+        position += 40;
+
+        // Hop-by-hop, routing, destination and authentication headers are stepped over, fragments are not reassembled
+        while (next == 0 || next == 43 || next == 60 || next == 51)
+        {
+            if (position + 8 > end)
+            {
+                return false;
+            }
+            const qint64 extension = next == 51 ? (qint64(data[position + 1]) + 2) * 4 : (qint64(data[position + 1]) + 1) * 8;
+            next = data[position];
+            position += extension;
+        }
+        if (next != ProtocolUdp)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    if (position + 8 > end)
+    {
+        return false;
+    }
+    const qint64 udpLength = be16(data + position + 4);
+    if (udpLength < 8 || position + udpLength > end)
+    {
+        // Cut short by the snapshot length
+        return false;
+    }
+
+    datagram.sourcePort = be16(data + position);
+    datagram.destinationPort = be16(data + position + 2);
+    datagram.offset = packet.offset + position + 8;
+    datagram.length = quint32(udpLength - 8);
+    return true;
+}
+
+QByteArrayView PcapReader::payload(const Datagram &datagram) const
+{
+    return QByteArrayView(m_data + datagram.offset, datagram.length);
+}
@@ -0,0 +1,86 @@
+#ifndef BARGAUGE_H
+#define BARGAUGE_H
+
+#include <QQuickItem>
+#include <QColor>
+
+/**
+ * @brief The BarGauge class shows a level as a vertical stack of segments that fill from the bottom
+ *
+ * Every segment is a rectangle node created once; a new value only recolors the segments, nothing is
+ * rasterized. Lit segments share one color interpolated between emptyColor and fullColor.
+ *
+ * Usage from QML:
+ * @code
+ * BarGauge {
+ *     width: 40; height: 100
+ *     value: batteryLevel
+ *     segments: 10
+ * }
+ * @endcode
+ */
+class BarGauge : public QQuickItem
+{
+    Q_OBJECT
+
+    Q_PROPERTY(qreal value READ value WRITE setValue NOTIFY valueChanged)
+    Q_PROPERTY(qreal maximumValue READ maximumValue WRITE setMaximumValue NOTIFY appearanceChanged)
+    Q_PROPERTY(int segments READ segments WRITE setSegments NOTIFY appearanceChanged)
+    Q_PROPERTY(qreal spacing READ spacing WRITE setSpacing NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor inactiveColor READ inactiveColor WRITE setInactiveColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor emptyColor READ emptyColor WRITE setEmptyColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor fullColor READ fullColor WRITE setFullColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor color READ color NOTIFY valueChanged)
+
+public:
+    explicit BarGauge(QQuickItem *parent = nullptr);
+
+    qreal value() const { return m_value; }
+    void setValue(qreal value);
+
+    qreal maximumValue() const { return m_maximumValue; }
+    void setMaximumValue(qreal value);
+
+    int segments() const { return m_segments; }
+    void setSegments(int segments);
+
+    qreal spacing() const { return m_spacing; } // Gap below every segment.
+    void setSpacing(qreal spacing);
+
+    QColor inactiveColor() const { return m_inactiveColor; }
+    void setInactiveColor(const QColor &color);
+
+    QColor emptyColor() const { return m_emptyColor; }
+    void setEmptyColor(const QColor &color);
+
+    QColor fullColor() const { return m_fullColor; }
+    void setFullColor(const QColor &color);
+
+    /**
+     * @brief Color of the lit segments for the current value
+     */
+    QColor color() const;
+
+signals:
+    void valueChanged();
+    void appearanceChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+
+private:
+    void changeAppearance();
+    int litSegments() const;
+
+    qreal m_value;
+    qreal m_maximumValue;
+    int m_segments;
+    qreal m_spacing;
+    QColor m_inactiveColor;
+    QColor m_emptyColor;
+    QColor m_fullColor;
+    bool m_layoutDirty; // Segment count or geometry changed, the rectangles are laid out again
+};
+
+#endif // BARGAUGE_H
@@ -0,0 +1,216 @@
+#ifndef DIALGAUGE_H
+#define DIALGAUGE_H
+
+#include <QQuickItem>
+#include <QPointer>
+#include <QColor>
+#include <QFont>
+#include <QImage>
+#include <QVariantList>
+
+/**
+ * @brief The DialGauge class draws a round gauge with ticks, labels and an optional needle
+ *
+ * The static parts of the dial are painted once into a cached texture: the labels, every tick in the
+ * inactive color and every tick in its value color. Changing the value only rotates the needle, which
+ * is a matrix change, and moves the border between the lit and the unlit tick sectors, which rewrites a
+ * few dozen vertices and only happens when the value crosses a tick. The dial is repainted only when
+ * its size or configuration changes.
+ *
+ * Angles are in degrees, 0 points right and positive angles turn clockwise, like the Canvas 2D API.
+ * Ticks between originValue and value are lit, so a centered gauge lights up in both directions.
+ *
+ * Usage from QML:
+ * @code
+ * DialGauge {
+ *     width: 270; height: 270
+ *     value: speed
+ *     maximumValue: 240
+ *     startAngle: -210; sweepAngle: 240
+ *     radius: 126
+ *     tickStep: 2; majorTickStep: 10; labelStep: 60
+ *     colorStops: [ { value: 60, color: "#4CAF50" }, { value: 240, color: "#F44336" } ]
+ * }
+ * @endcode
+ */
+class DialGauge : public QQuickItem
+{
+    Q_OBJECT
+
+    Q_PROPERTY(qreal value READ value WRITE setValue NOTIFY valueChanged)
+    Q_PROPERTY(qreal minimumValue READ minimumValue WRITE setMinimumValue NOTIFY dialChanged)
+    Q_PROPERTY(qreal maximumValue READ maximumValue WRITE setMaximumValue NOTIFY dialChanged)
+    Q_PROPERTY(qreal originValue READ originValue WRITE setOriginValue NOTIFY dialChanged)
+    Q_PROPERTY(qreal startAngle READ startAngle WRITE setStartAngle NOTIFY dialChanged)
+    Q_PROPERTY(qreal sweepAngle READ sweepAngle WRITE setSweepAngle NOTIFY dialChanged)
+    Q_PROPERTY(QPointF pivot READ pivot WRITE setPivot NOTIFY dialChanged)
+    Q_PROPERTY(qreal radius READ radius WRITE setRadius NOTIFY dialChanged)
+
+    Q_PROPERTY(qreal tickStep READ tickStep WRITE setTickStep NOTIFY dialChanged)
+    Q_PROPERTY(qreal majorTickStep READ majorTickStep WRITE setMajorTickStep NOTIFY dialChanged)
+    Q_PROPERTY(qreal tickLength READ tickLength WRITE setTickLength NOTIFY dialChanged)
+    Q_PROPERTY(qreal majorTickLength READ majorTickLength WRITE setMajorTickLength NOTIFY dialChanged)
+    Q_PROPERTY(qreal tickWidth READ tickWidth WRITE setTickWidth NOTIFY dialChanged)
+    Q_PROPERTY(qreal majorTickWidth READ majorTickWidth WRITE setMajorTickWidth NOTIFY dialChanged)
+
+    Q_PROPERTY(qreal labelStep READ labelStep WRITE setLabelStep NOTIFY dialChanged)
+    Q_PROPERTY(qreal labelInset READ labelInset WRITE setLabelInset NOTIFY dialChanged)
+    Q_PROPERTY(qreal labelOffset READ labelOffset WRITE setLabelOffset NOTIFY dialChanged)
+    Q_PROPERTY(QFont font READ font WRITE setFont NOTIFY dialChanged)
+
+    Q_PROPERTY(QVariantList colorStops READ colorStops WRITE setColorStops NOTIFY dialChanged)
+    Q_PROPERTY(QColor inactiveColor READ inactiveColor WRITE setInactiveColor NOTIFY dialChanged)
+    Q_PROPERTY(QColor color READ color NOTIFY colorChanged)
+
+    Q_PROPERTY(qreal needleLength READ needleLength WRITE setNeedleLength NOTIFY dialChanged)
+    Q_PROPERTY(qreal needleWidth READ needleWidth WRITE setNeedleWidth NOTIFY dialChanged)
+    Q_PROPERTY(qreal hubRadius READ hubRadius WRITE setHubRadius NOTIFY dialChanged)
+
+public:
+    explicit DialGauge(QQuickItem *parent = nullptr);
+
+    qreal value() const { return m_value; }
+    void setValue(qreal value);
+
+    qreal minimumValue() const { return m_minimumValue; }
+    void setMinimumValue(qreal value);
+    qreal maximumValue() const { return m_maximumValue; }
+    void setMaximumValue(qreal value);
+    qreal originValue() const { return m_originValue; }
+    void setOriginValue(qreal value);
+    qreal startAngle() const { return m_startAngle; }
+    void setStartAngle(qreal angle);
+    qreal sweepAngle() const { return m_sweepAngle; }
+    void setSweepAngle(qreal angle);
+    QPointF pivot() const { return m_pivot; } // Center of the dial relative to the item size, (0.5, 0.5) by default.
+    void setPivot(const QPointF &pivot);
+    qreal radius() const { return m_radius; }
+    void setRadius(qreal radius);
+
+    qreal tickStep() const { return m_tickStep; }
+    void setTickStep(qreal step);
+    qreal majorTickStep() const { return m_majorTickStep; }
+    void setMajorTickStep(qreal step);
+    qreal tickLength() const { return m_tickLength; }
+    void setTickLength(qreal length);
+    qreal majorTickLength() const { return m_majorTickLength; }
+    void setMajorTickLength(qreal length);
+    qreal tickWidth() const { return m_tickWidth; }
+    void setTickWidth(qreal width);
+    qreal majorTickWidth() const { return m_majorTickWidth; }
+    void setMajorTickWidth(qreal width);
+
+    qreal labelStep() const { return m_labelStep; } // 0 disables the labels.
+    void setLabelStep(qreal step);
+    qreal labelInset() const { return m_labelInset; } // Distance of the label centers inside the radius.
+    void setLabelInset(qreal inset);
+    qreal labelOffset() const { return m_labelOffset; } // Extra downward shift of the labels.
+    void setLabelOffset(qreal offset);
+    QFont font() const { return m_font; }
+    void setFont(const QFont &font);
+
+    /**
+     * @brief Color bands as a list of { value, color }, sorted by value
+     *
+     * A value takes the color of the first stop at or above it, values above the last stop take the last color.
+     */
+    QVariantList colorStops() const { return m_colorStopsConfig; }
+    void setColorStops(const QVariantList &stops);
+    QColor inactiveColor() const { return m_inactiveColor; }
+    void setInactiveColor(const QColor &color);
+
+    /**
+     * @brief Color of the current value, for text that should match the needle
+     */
+    QColor color() const { return colorAt(m_value); }
+
+    qreal needleLength() const { return m_needleLength; } // 0 hides the needle.
+    void setNeedleLength(qreal length);
+    qreal needleWidth() const { return m_needleWidth; }
+    void setNeedleWidth(qreal width);
+    qreal hubRadius() const { return m_hubRadius; }
+    void setHubRadius(qreal radius);
+
+signals:
+    void valueChanged();
+    void dialChanged();
+    void colorChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    void itemChange(ItemChange change, const ItemChangeData &value) override;
+
+private:
+    struct ColorStop
+    {
+        qreal value = 0.0;
+        QColor color;
+    };
+
+    // Lit ticks as an index range, first > last when nothing is lit
+    struct LitRange
+    {
+        int first = 0;
+        int last = -1;
+
+        bool operator==(const LitRange &other) const { return first == other.first && last == other.last; }
+    };
+
+    void invalidateDial(); // The cached texture no longer matches the configuration
+    void refreshValueState();
+
+    QColor colorAt(qreal value) const;
+    int colorIndex(qreal value) const;
+    int tickCount() const;
+    qreal tickValue(int index) const;
+    qreal angleAt(qreal value) const;
+    qreal tickAngle(qreal index) const; // Fractional tick indices give the borders between ticks
+    QPointF center() const;
+    LitRange litRange() const;
+
+    QImage renderDial(qreal devicePixelRatio) const;
+
+    QSGNode *updateHardwareNode(QSGNode *oldNode);
+    QSGNode *updateSoftwareNode(QSGNode *oldNode);
+
+    qreal m_value;
+    qreal m_minimumValue;
+    qreal m_maximumValue;
+    qreal m_originValue;
+    qreal m_startAngle;
+    qreal m_sweepAngle;
+    QPointF m_pivot;
+    qreal m_radius;
+
+    qreal m_tickStep;
+    qreal m_majorTickStep;
+    qreal m_tickLength;
+    qreal m_majorTickLength;
+    qreal m_tickWidth;
+    qreal m_majorTickWidth;
+
+    qreal m_labelStep;
+    qreal m_labelInset;
+    qreal m_labelOffset;
+    QFont m_font;
+
+    QVariantList m_colorStopsConfig;
+    QList<ColorStop> m_colorStops;
+    QColor m_inactiveColor;
+
+    qreal m_needleLength;
+    qreal m_needleWidth;
+    qreal m_hubRadius;
+
+    QPointer<QQuickWindow> m_window;
+    QImage m_dial;        // Labels, inactive ticks and lit ticks stacked vertically, one item height each
+    qreal m_dialRatio;    // Device pixel ratio m_dial was rendered for
+    bool m_dialDirty;     // Repaint m_dial and recreate the texture
+    LitRange m_litRange;
+    bool m_sectorsDirty;  // The lit range moved, rewrite the tick sectors
+    int m_colorIndex;
+    bool m_needleDirty;   // Needle color or shape changed
+};
+
+#endif // DIALGAUGE_H
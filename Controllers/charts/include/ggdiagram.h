@@ -0,0 +1,136 @@
+#ifndef GGDIAGRAM_H
+#define GGDIAGRAM_H
+
+#include <QQuickItem>
+#include <QPointer>
+#include <QColor>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QList>
+#include <QPointF>
+#include "../../communication_manager/include/communicationmanager.h"
+
+/**
+ * @brief The GGDiagram class plots lateral against longitudinal acceleration
+ *
+ * Every sample of the active source's history is binned into a 2D density histogram that is drawn as
+ * a heatmap texture, so a whole stint stays visible. On top of it a fading trail shows the most recent
+ * motion; it lives in a fixed-capacity ring buffer. Both have a fixed size, so the cost per frame does
+ * not grow with the length of the session.
+ *
+ * Lateral acceleration runs left to right, longitudinal acceleration bottom to top.
+ *
+ * Usage from QML:
+ * @code
+ * GGDiagram {
+ *     source: communicationManager
+ *     maxLateralG: 3.5
+ *     maxLongitudinalG: 2.0
+ * }
+ * @endcode
+ */
+class GGDiagram : public QQuickItem
+{
+    Q_OBJECT
+
+    Q_PROPERTY(CommunicationManager *source READ source WRITE setSource NOTIFY sourceChanged)
+    Q_PROPERTY(qreal maxLateralG READ maxLateralG WRITE setMaxLateralG NOTIFY rangeChanged)
+    Q_PROPERTY(qreal maxLongitudinalG READ maxLongitudinalG WRITE setMaxLongitudinalG NOTIFY rangeChanged)
+    Q_PROPERTY(qreal margin READ margin WRITE setMargin NOTIFY rangeChanged)
+    Q_PROPERTY(int trailLength READ trailLength WRITE setTrailLength NOTIFY trailChanged)
+    Q_PROPERTY(int trailInterval READ trailInterval WRITE setTrailInterval NOTIFY trailChanged)
+    Q_PROPERTY(QColor trailColor READ trailColor WRITE setTrailColor NOTIFY trailChanged)
+    Q_PROPERTY(int bins READ bins WRITE setBins NOTIFY binsChanged)
+    Q_PROPERTY(bool running READ running WRITE setRunning NOTIFY runningChanged)
+
+public:
+    explicit GGDiagram(QQuickItem *parent = nullptr);
+
+    CommunicationManager *source() const { return m_source; }
+    void setSource(CommunicationManager *source);
+
+    qreal maxLateralG() const { return m_maxLateralG; }
+    void setMaxLateralG(qreal g);
+
+    qreal maxLongitudinalG() const { return m_maxLongitudinalG; }
+    void setMaxLongitudinalG(qreal g);
+
+    qreal margin() const { return m_margin; } // Space between the plotted range and the item edge.
+    void setMargin(qreal margin);
+
+    int trailLength() const { return m_trailLength; } // Points kept in the trail ring.
+    void setTrailLength(int points);
+
+    int trailInterval() const { return m_trailInterval; } // Minimum ms between two trail points.
+    void setTrailInterval(int ms);
+
+    QColor trailColor() const { return m_trailColor; }
+    void setTrailColor(const QColor &color);
+
+    int bins() const { return m_bins; } // Heatmap resolution per axis.
+    void setBins(int bins);
+
+    bool running() const { return m_running; }
+    void setRunning(bool running);
+
+    /**
+     * @brief Forget the trail and the density histogram
+     */
+    Q_INVOKABLE void clear();
+
+signals:
+    void sourceChanged();
+    void rangeChanged();
+    void trailChanged();
+    void binsChanged();
+    void runningChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    void itemChange(ItemChange change, const ItemChangeData &value) override;
+
+private slots:
+    void advance(); // Runs on the GUI thread once per frame, pulls new samples from the history.
+
+private:
+    void accumulate(qint64 timeUs, double lateralG, double longitudinalG);
+    void resetTrail();
+    void resetHistogram();
+    QPointF mapToPlot(double lateralG, double longitudinalG) const;
+    QRectF plotRect() const;
+    void renderHeatmap();
+
+    QPointer<CommunicationManager> m_source;
+    qreal m_maxLateralG;
+    qreal m_maxLongitudinalG;
+    qreal m_margin;
+    int m_trailLength;
+    int m_trailInterval;
+    QColor m_trailColor;
+    int m_bins;
+    bool m_running;
+
+    QPointer<QQuickWindow> m_window;
+
+    quint64 m_nextIndex;    // First history sample not consumed yet
+    quint64 m_historyStart; // history.start() when m_nextIndex was set, a change means the source changed
+    bool m_primed;
+
+    // Trail ring in G, mapped to pixels when the geometry is written so a resize keeps it
+    QList<QPointF> m_trail;
+    int m_trailHead;  // Slot of the next point
+    int m_trailCount;
+    qint64 m_lastTrailUs;
+    bool m_trailDirty;
+
+    QList<quint32> m_histogram; // m_bins * m_bins, row 0 is the top (strongest acceleration)
+    quint32 m_histogramMax;
+    bool m_histogramDirty;
+    QElapsedTimer m_heatmapClock; // Limits how often the heatmap texture is rebuilt
+    QImage m_heatmap;
+    bool m_heatmapDirty;          // m_heatmap changed, upload it
+    bool m_layoutDirty;           // Size or range changed, the heatmap rect and the trail are laid out again
+};
+
+#endif // GGDIAGRAM_H
@@ -0,0 +1,127 @@
+#ifndef GPSTRACK_H
+#define GPSTRACK_H
+
+#include <QObject>
+#include <QPointer>
+#include <QGeoCoordinate>
+#include <QList>
+#include <QVariantList>
+#include "../../communication_manager/include/communicationmanager.h"
+
+/**
+ * @brief The GpsTrack class turns the GPS fixes of the telemetry history into a simplified polyline
+ *
+ * Fixes are simplified while they stream in (an opening-window variant of Douglas-Peucker): the newest
+ * fix is always the provisional last vertex, and the vertex before it only becomes final once a
+ * straight segment no longer covers the fixes in between within the tolerance. So every new fix
+ * either appends a vertex or moves the last one, which a MapPolyline applies in place without copying
+ * the path. When the track exceeds maxVertices the tolerance is doubled and the final part is
+ * simplified again, which keeps memory bounded over any session length.
+ *
+ * A fix of exactly (0, 0) is taken as "no fix yet" and skipped.
+ *
+ * Usage from QML:
+ * @code
+ * GpsTrack {
+ *     source: communicationManager
+ *     onVertexAppended: (coordinate) => pathLine.addCoordinate(coordinate)
+ *     onLastVertexMoved: (coordinate) => pathLine.replaceCoordinate(pathLine.pathLength() - 1, coordinate)
+ *     onPathReset: pathLine.path = path()
+ * }
+ * @endcode
+ */
+class GpsTrack : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(CommunicationManager *source READ source WRITE setSource NOTIFY sourceChanged)
+    Q_PROPERTY(double tolerance READ tolerance WRITE setTolerance NOTIFY toleranceChanged)
+    Q_PROPERTY(double minDistance READ minDistance WRITE setMinDistance NOTIFY minDistanceChanged)
+    Q_PROPERTY(int maxVertices READ maxVertices WRITE setMaxVertices NOTIFY maxVerticesChanged)
+    Q_PROPERTY(int vertexCount READ vertexCount NOTIFY vertexCountChanged)
+    Q_PROPERTY(double effectiveTolerance READ effectiveTolerance NOTIFY vertexCountChanged)
+
+public:
+    explicit GpsTrack(QObject *parent = nullptr);
+
+    CommunicationManager *source() const { return m_source; }
+    void setSource(CommunicationManager *source);
+
+    double tolerance() const { return m_tolerance; } // Maximum deviation of the drawn line from the fixes, meters.
+    void setTolerance(double meters);
+
+    double minDistance() const { return m_minDistance; } // Fixes closer than this to the previous one are dropped, meters.
+    void setMinDistance(double meters);
+
+    int maxVertices() const { return m_maxVertices; }
+    void setMaxVertices(int vertices);
+
+    int vertexCount() const;
+
+    /**
+     * @brief Tolerance in use, larger than tolerance() once the track had to be thinned out
+     */
+    double effectiveTolerance() const { return m_effectiveTolerance; }
+
+    /**
+     * @brief The whole polyline as a list of coordinates, for a full reassignment after pathReset()
+     */
+    Q_INVOKABLE QVariantList path() const;
+
+    Q_INVOKABLE void clear();
+
+signals:
+    void sourceChanged();
+    void toleranceChanged();
+    void minDistanceChanged();
+    void maxVerticesChanged();
+    void vertexCountChanged();
+
+    void vertexAppended(const QGeoCoordinate &coordinate);
+    void lastVertexMoved(const QGeoCoordinate &coordinate);
+    void pathReset(); // The path changed in more than its last vertex, e.g. after clear() or thinning.
+
+private slots:
+    void pull(); // Consume the fixes appended to the history since the previous call.
+
+private:
+    struct TrackPoint
+    {
+        double latitude = 0.0;
+        double longitude = 0.0;
+        double x = 0.0; // Meters east of the projection origin
+        double y = 0.0; // Meters north of the projection origin
+    };
+
+    void addFix(double latitude, double longitude);
+    TrackPoint project(double latitude, double longitude) const;
+    bool windowFits(const TrackPoint &end) const;
+    void thin();
+    void reset();
+
+    static double segmentDistance(const TrackPoint &p, const TrackPoint &a, const TrackPoint &b);
+    static QGeoCoordinate coordinate(const TrackPoint &point);
+
+    QPointer<CommunicationManager> m_source;
+    double m_tolerance;
+    double m_minDistance;
+    int m_maxVertices;
+    double m_effectiveTolerance;
+
+    quint64 m_nextIndex;    // First history sample not consumed yet
+    quint64 m_historyStart; // history.start() when m_nextIndex was set, a change means the source changed
+    bool m_primed;
+
+    bool m_hasOrigin;
+    double m_originLatitude;
+    double m_originLongitude;
+    double m_metersPerDegreeLongitude;
+
+    QList<TrackPoint> m_vertices; // Final vertices, the last one anchors the window
+    QList<TrackPoint> m_window;   // Fixes after the anchor, the last one is the provisional vertex
+    bool m_hasLastFix;
+    double m_lastLatitude;
+    double m_lastLongitude;
+};
+
+#endif // GPSTRACK_H
@@ -0,0 +1,114 @@
+#ifndef STRIPCHART_H
+#define STRIPCHART_H
+
+#include <QQuickItem>
+#include <QPointer>
+#include <QColor>
+#include <QVariantList>
+#include "../../communication_manager/include/communicationmanager.h"
+#include "../../telemetry/include/telemetrydecimator.h"
+
+/**
+ * @brief The StripChart class plots telemetry channels over a scrolling time window
+ *
+ * Each series is decimated from the C++ history to the pixel width of the item, so the amount of
+ * geometry does not depend on the input rate. Final points are written once into a ring of line
+ * segments that lives in the vertex buffer; scrolling and scaling only change a transform. Only the
+ * few provisional points of the newest buckets are rewritten per frame.
+ *
+ * With the software scene graph backend the series are painted with QPainter instead.
+ *
+ * Usage from QML:
+ * @code
+ * StripChart {
+ *     source: communicationManager
+ *     windowSeconds: 30
+ *     series: [ { channel: "speed", color: "#4CAF50", minimum: 0, maximum: 240 } ]
+ * }
+ * @endcode
+ */
+class StripChart : public QQuickItem
+{
+    Q_OBJECT
+
+    Q_PROPERTY(CommunicationManager *source READ source WRITE setSource NOTIFY sourceChanged)
+    Q_PROPERTY(QVariantList series READ series WRITE setSeries NOTIFY seriesChanged)
+    Q_PROPERTY(qreal windowSeconds READ windowSeconds WRITE setWindowSeconds NOTIFY windowSecondsChanged)
+    Q_PROPERTY(DecimationMode mode READ mode WRITE setMode NOTIFY modeChanged)
+    Q_PROPERTY(bool running READ running WRITE setRunning NOTIFY runningChanged)
+
+public:
+    enum DecimationMode { MinMax, Lttb };
+    Q_ENUM(DecimationMode)
+
+    explicit StripChart(QQuickItem *parent = nullptr);
+
+    CommunicationManager *source() const { return m_source; }
+    void setSource(CommunicationManager *source);
+
+    QVariantList series() const { return m_seriesConfig; }
+    void setSeries(const QVariantList &series);
+
+    qreal windowSeconds() const { return m_windowSeconds; }
+    void setWindowSeconds(qreal seconds);
+
+    DecimationMode mode() const { return m_mode; }
+    void setMode(DecimationMode mode);
+
+    bool running() const { return m_running; }
+    void setRunning(bool running);
+
+signals:
+    void sourceChanged();
+    void seriesChanged();
+    void windowSecondsChanged();
+    void modeChanged();
+    void runningChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    void itemChange(ItemChange change, const ItemChangeData &value) override;
+
+private slots:
+    void advance(); // Runs on the GUI thread once per frame, pulls new samples from the history.
+
+private:
+    struct Series
+    {
+        TelemetryDecimator decimator;
+        QColor color;
+        double minimum = 0.0;
+        double maximum = 1.0;
+
+        quint64 generation = 0;
+        bool hasCommitted = false;
+        TelemetryPoint lastCommitted;
+        QList<TelemetryPoint> pendingCommits; // Final points not yet written to the vertex ring
+        QList<TelemetryPoint> tail;           // Provisional points, rewritten every frame
+        bool resetRing = true;
+
+        explicit Series(TelemetryChannel channel) : decimator(channel) {}
+    };
+
+    void configureDecimators();
+    void restartSeries(); // Forget everything derived from the decimators, e.g. after the time origin moved.
+
+    QSGNode *updateHardwareNode(QSGNode *oldNode);
+    QSGNode *updateSoftwareNode(QSGNode *oldNode);
+
+    QPointer<CommunicationManager> m_source;
+    QVariantList m_seriesConfig;
+    QList<Series> m_series;
+    qreal m_windowSeconds;
+    DecimationMode m_mode;
+    bool m_running;
+
+    QPointer<QQuickWindow> m_window;
+    qint64 m_originUs; // Vertex x coordinates are seconds since this time
+    qint64 m_nowUs;
+    bool m_hasData;
+    bool m_nodesDirty; // Series or ring capacity changed, the node tree is rebuilt
+};
+
+#endif // STRIPCHART_H
@@ -0,0 +1,168 @@
+#include "../include/bargauge.h"
+#include <QQuickWindow>
+#include <QSGRectangleNode>
+#include <QtMath>
+
+BarGauge::BarGauge(QQuickItem *parent)
+    : QQuickItem(parent),
+    m_value(0.0),
+    m_maximumValue(100.0),
+    m_segments(10),
+    m_spacing(2.0),
+    m_inactiveColor(Qt::black),
+    m_emptyColor(255, 0, 0),
+    m_fullColor(0, 255, 0),
+    m_layoutDirty(true)
+{
+    setFlag(ItemHasContents, true);
+}
+
+void BarGauge::setValue(qreal value)
+{
+    if (m_value == value)
+    {
+        return;
+    }
+
+    m_value = value;
+    emit valueChanged();
+    update();
+}
+
+void BarGauge::setMaximumValue(qreal value)
+{
+    if (m_maximumValue != value)
+    {
+        m_maximumValue = value;
+        changeAppearance();
+    }
+}
+
+void BarGauge::setSegments(int segments)
+{
+    segments = qMax(1, segments);
+    if (m_segments != segments)
+    {
+        m_segments = segments;
+        m_layoutDirty = true;
+        changeAppearance();
+    }
+}
+
+void BarGauge::setSpacing(qreal spacing)
+{
+    if (m_spacing != spacing)
+    {
+        m_spacing = spacing;
+        m_layoutDirty = true;
+        changeAppearance();
+    }
+}
+
+void BarGauge::setInactiveColor(const QColor &color)
+{
+    if (m_inactiveColor != color)
+    {
+        m_inactiveColor = color;
+        changeAppearance();
+    }
+}
+
+void BarGauge::setEmptyColor(const QColor &color)
+{
+    if (m_emptyColor != color)
+    {
+        m_emptyColor = color;
+        changeAppearance();
+    }
+}
+
+void BarGauge::setFullColor(const QColor &color)
+{
+    if (m_fullColor != color)
+    {
+        m_fullColor = color;
+        changeAppearance();
+    }
+}
+
+void BarGauge::changeAppearance()
+{
+    emit appearanceChanged();
+    emit valueChanged(); // color depends on the range and the end colors too
+    update();
+}
+
+QColor BarGauge::color() const
+{
+    const qreal t = m_maximumValue > 0.0 ? qBound<qreal>(0.0, m_value / m_maximumValue, 1.0) : 0.0;
+    auto mix = [t](int empty, int full) { return int(empty + (full - empty) * t); };
+    return QColor(mix(m_emptyColor.red(), m_fullColor.red()),
+                  mix(m_emptyColor.green(), m_fullColor.green()),
+                  mix(m_emptyColor.blue(), m_fullColor.blue()),
+                  mix(m_emptyColor.alpha(), m_fullColor.alpha()));
+}
+
+int BarGauge::litSegments() const
+{
+    if (m_maximumValue <= 0.0)
+    {
+        return 0;
+    }
+
+    // A segment goes dark as soon as any part of it is missing
+    const qreal missing = (m_maximumValue - m_value) / m_maximumValue * m_segments;
+    return qBound(0, m_segments - qCeil(missing), m_segments);
+}
+
+void BarGauge::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+
+    if (newGeometry.size() != oldGeometry.size())
+    {
+        m_layoutDirty = true;
+        update();
+    }
+}
+
+QSGNode *BarGauge::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+
+    QSGNode *root = oldNode;
+    if (root && root->childCount() != m_segments)
+    {
+        delete root;
+        root = nullptr;
+    }
+
+    if (!root)
+    {
+        root = new QSGNode;
+        for (int i = 0; i < m_segments; ++i)
+        {
+            root->appendChildNode(window()->createRectangleNode());
+        }
+        m_layoutDirty = true;
+    }
+
+    const qreal segmentHeight = height() / m_segments;
+    const int dark = m_segments - litSegments();
+    const QColor lit = color();
+
+    // Segments are laid out top to bottom, the top ones go dark first
+    int i = 0;
+    for (QSGNode *child = root->firstChild(); child; child = child->nextSibling(), ++i)
+    {
+        auto *segment = static_cast<QSGRectangleNode *>(child);
+        if (m_layoutDirty)
+        {
+            segment->setRect(QRectF(0.0, i * segmentHeight, width(), qMax<qreal>(0.0, segmentHeight - m_spacing)));
+        }
+        segment->setColor(i < dark ? m_inactiveColor : lit);
+    }
+
+    m_layoutDirty = false;
+    return root;
+}
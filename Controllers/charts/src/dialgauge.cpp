@@ -0,0 +1,863 @@
+#include "../include/dialgauge.h"
+#include <QDebug>
+#include <QPainter>
+#include <QPainterPath>
+#include <QQuickWindow>
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QSGImageNode>
+#include <QSGRenderNode>
+#include <QSGRendererInterface>
+#include <QSGTextureMaterial>
+#include <QSGTransformNode>
+#include <QtMath>
+
+namespace
+{
+// Rows of the cached dial image
+constexpr int LabelRow = 0;
+constexpr int InactiveRow = 1;
+constexpr int ActiveRow = 2;
+constexpr int RowCount = 3;
+
+// Arc segments of a tick sector are at most this many degrees, the chord error stays below a tenth of a pixel
+constexpr qreal SegmentDegrees = 4.0;
+
+constexpr int HubSegments = 24;
+constexpr qreal ShadowOffset = 2.0;
+
+// Tolerance for deciding whether a tick lies on a major or label step
+constexpr qreal StepEpsilon = 1.0e-3;
+
+bool assign(qreal &member, qreal value)
+{
+    if (member == value)
+    {
+        return false;
+    }
+    member = value;
+    return true;
+}
+
+bool isMultiple(qreal value, qreal step)
+{
+    if (step <= 0.0)
+    {
+        return false;
+    }
+    const qreal ratio = value / step;
+    return qAbs(ratio - qRound64(ratio)) < StepEpsilon;
+}
+
+QPointF polar(qreal radius, qreal degrees)
+{
+    const qreal radians = qDegreesToRadians(degrees);
+    return QPointF(radius * qCos(radians), radius * qSin(radians));
+}
+
+// One arc of the tick ring and the dial row it takes its pixels from
+struct Sector
+{
+    qreal fromAngle = 0.0;
+    qreal toAngle = 0.0;
+    int row = InactiveRow;
+};
+
+class DialGaugeNode : public QSGNode
+{
+public:
+    ~DialGaugeNode() override { delete texture; }
+
+    QSGTexture *texture = nullptr;      // Shared by the label and tick nodes, owned here
+    QSGImageNode *labels = nullptr;
+    QSGGeometryNode *ticks = nullptr;   // Textured annulus sectors cut from the inactive and active rows
+    QSGTransformNode *shadow = nullptr;
+    QSGTransformNode *needle = nullptr;
+    QSGGeometryNode *shadowShape = nullptr;
+    QSGGeometryNode *needleShape = nullptr;
+};
+
+QSGGeometryNode *createNeedleShape(const QColor &color)
+{
+    auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+    geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+
+    auto *material = new QSGFlatColorMaterial;
+    material->setColor(color);
+
+    auto *node = new QSGGeometryNode;
+    node->setGeometry(geometry);
+    node->setMaterial(material);
+    node->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial);
+    return node;
+}
+
+// Needle along the positive x axis plus the round hub, rotated into place by the parent transform
+void buildNeedle(QSGGeometryNode *node, qreal length, qreal width, qreal hubRadius)
+{
+    QSGGeometry *geometry = node->geometry();
+    if (length <= 0.0)
+    {
+        geometry->allocate(0);
+        node->markDirty(QSGNode::DirtyGeometry);
+        return;
+    }
+
+    geometry->allocate(6 + 3 * HubSegments);
+    QSGGeometry::Point2D *v = geometry->vertexDataAsPoint2D();
+
+    const float half = float(width / 2.0);
+    const float tip = float(length);
+    v[0].set(0.0f, -half);
+    v[1].set(tip, -half);
+    v[2].set(tip, half);
+    v[3].set(0.0f, -half);
+    v[4].set(tip, half);
+    v[5].set(0.0f, half);
+
+    int i = 6;
+    for (int segment = 0; segment < HubSegments; ++segment)
+    {
+        const QPointF a = polar(hubRadius, 360.0 * segment / HubSegments);
+        const QPointF b = polar(hubRadius, 360.0 * (segment + 1) / HubSegments);
+        v[i++].set(0.0f, 0.0f);
+        v[i++].set(float(a.x()), float(a.y()));
+        v[i++].set(float(b.x()), float(b.y()));
+    }
+
+    geometry->markVertexDataDirty();
+    node->markDirty(QSGNode::DirtyGeometry);
+}
+
+void setShapeColor(QSGGeometryNode *node, const QColor &color)
+{
+    auto *material = static_cast<QSGFlatColorMaterial *>(node->material());
+    if (material->color() != color)
+    {
+        material->setColor(color);
+        node->markDirty(QSGNode::DirtyMaterial);
+    }
+}
+
+// The software backend cannot draw custom geometry, it blits the same cached rows through pie clips
+class SoftwareDialNode : public QSGRenderNode
+{
+public:
+    explicit SoftwareDialNode(QQuickWindow *window)
+        : m_window(window)
+    {
+    }
+
+    void render(const RenderState *state) override
+    {
+        QSGRendererInterface *rif = m_window->rendererInterface();
+        auto *painter = static_cast<QPainter *>(rif->getResource(m_window, QSGRendererInterface::PainterResource));
+        if (!painter || dial.isNull())
+        {
+            return;
+        }
+
+        const QRegion *clipRegion = state->clipRegion();
+        if (clipRegion && !clipRegion->isEmpty())
+        {
+            painter->setClipRegion(*clipRegion, Qt::ReplaceClip);
+        }
+        painter->setTransform(matrix()->toTransform());
+        painter->setOpacity(inheritedOpacity());
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setRenderHint(QPainter::SmoothPixmapTransform);
+
+        const qreal rowHeight = dial.height() / RowCount;
+        const QRectF target(QPointF(0.0, 0.0), bounds.size());
+        painter->drawImage(target, dial, QRectF(0.0, LabelRow * rowHeight, dial.width(), rowHeight));
+
+        const QRectF ring(center.x() - outerRadius, center.y() - outerRadius, 2.0 * outerRadius, 2.0 * outerRadius);
+        for (const Sector &sector : std::as_const(sectors))
+        {
+            // QPainterPath angles turn counter-clockwise on screen, the gauge angles clockwise
+            QPainterPath pie;
+            pie.moveTo(center);
+            pie.arcTo(ring, -sector.fromAngle, -(sector.toAngle - sector.fromAngle));
+            pie.closeSubpath();
+
+            painter->save();
+            painter->setClipPath(pie, Qt::IntersectClip);
+            painter->drawImage(target, dial, QRectF(0.0, sector.row * rowHeight, dial.width(), rowHeight));
+            painter->restore();
+        }
+
+        if (needleLength > 0.0)
+        {
+            const QRectF shape(0.0, -needleWidth / 2.0, needleLength, needleWidth);
+            painter->setPen(Qt::NoPen);
+
+            painter->save();
+            painter->translate(center + QPointF(ShadowOffset, ShadowOffset));
+            painter->rotate(needleAngle);
+            painter->setBrush(QColor(0, 0, 0, 77));
+            painter->drawRect(shape);
+            painter->drawEllipse(QPointF(0.0, 0.0), hubRadius, hubRadius);
+            painter->restore();
+
+            painter->save();
+            painter->translate(center);
+            painter->rotate(needleAngle);
+            painter->setBrush(needleColor);
+            painter->drawRect(shape);
+            painter->drawEllipse(QPointF(0.0, 0.0), hubRadius, hubRadius);
+            painter->restore();
+        }
+    }
+
+    StateFlags changedStates() const override { return {}; }
+    RenderingFlags flags() const override { return BoundedRectRendering; }
+    QRectF rect() const override { return bounds; }
+
+    QImage dial;
+    QList<Sector> sectors;
+    QRectF bounds;
+    QPointF center;
+    qreal outerRadius = 0.0;
+    qreal needleAngle = 0.0;
+    qreal needleLength = 0.0;
+    qreal needleWidth = 0.0;
+    qreal hubRadius = 0.0;
+    QColor needleColor;
+
+private:
+    QQuickWindow *m_window;
+};
+}
+
+DialGauge::DialGauge(QQuickItem *parent)
+    : QQuickItem(parent),
+    m_value(0.0),
+    m_minimumValue(0.0),
+    m_maximumValue(100.0),
+    m_originValue(0.0),
+    m_startAngle(-210.0),
+    m_sweepAngle(240.0),
+    m_pivot(0.5, 0.5),
+    m_radius(100.0),
+    m_tickStep(2.0),
+    m_majorTickStep(10.0),
+    m_tickLength(9.0),
+    m_majorTickLength(18.0),
+    m_tickWidth(2.0),
+    m_majorTickWidth(4.0),
+    m_labelStep(0.0),
+    m_labelInset(31.5),
+    m_labelOffset(0.0),
+    m_inactiveColor(0x80, 0x80, 0x80),
+    m_needleLength(0.0),
+    m_needleWidth(4.0),
+    m_hubRadius(7.2),
+    m_dialRatio(0.0),
+    m_dialDirty(true),
+    m_sectorsDirty(true),
+    m_colorIndex(-1),
+    m_needleDirty(true)
+{
+    setFlag(ItemHasContents, true);
+    m_font.setBold(true);
+    m_font.setPixelSize(13);
+}
+
+void DialGauge::setValue(qreal value)
+{
+    if (!assign(m_value, value))
+    {
+        return;
+    }
+
+    refreshValueState();
+    emit valueChanged();
+    update();
+}
+
+void DialGauge::setMinimumValue(qreal value)
+{
+    if (assign(m_minimumValue, value))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::setMaximumValue(qreal value)
+{
+    if (assign(m_maximumValue, value))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::setOriginValue(qreal value)
+{
+    if (assign(m_originValue, value))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::setStartAngle(qreal angle)
+{
+    if (assign(m_startAngle, angle))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::setSweepAngle(qreal angle)
+{
+    if (assign(m_sweepAngle, angle))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::setPivot(const QPointF &pivot)
+{
+    if (m_pivot != pivot)
+    {
+        m_pivot = pivot;
+        invalidateDial();
+    }
+}
+
+void DialGauge::setRadius(qreal radius)
+{
+    if (assign(m_radius, radius))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::setTickStep(qreal step)
+{
+    if (assign(m_tickStep, step))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::setMajorTickStep(qreal step)
+{
+    if (assign(m_majorTickStep, step))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::setTickLength(qreal length)
+{
+    if (assign(m_tickLength, length))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::setMajorTickLength(qreal length)
+{
+    if (assign(m_majorTickLength, length))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::setTickWidth(qreal width)
+{
+    if (assign(m_tickWidth, width))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::setMajorTickWidth(qreal width)
+{
+    if (assign(m_majorTickWidth, width))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::setLabelStep(qreal step)
+{
+    if (assign(m_labelStep, step))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::setLabelInset(qreal inset)
+{
+    if (assign(m_labelInset, inset))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::setLabelOffset(qreal offset)
+{
+    if (assign(m_labelOffset, offset))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::setFont(const QFont &font)
+{
+    if (m_font != font)
+    {
+        m_font = font;
+        invalidateDial();
+    }
+}
+
+void DialGauge::setColorStops(const QVariantList &stops)
+{
+    m_colorStopsConfig = stops;
+    m_colorStops.clear();
+
+    for (const QVariant &entry : stops)
+    {
+        const QVariantMap map = entry.toMap();
+        ColorStop stop;
+        stop.value = map.value(QStringLiteral("value")).toDouble();
+        stop.color = map.value(QStringLiteral("color")).value<QColor>();
+        if (!stop.color.isValid())
+        {
+            qDebug() << "DialGauge: Invalid color stop" << map;
+            continue;
+        }
+        m_colorStops.append(stop);
+    }
+
+    m_colorIndex = -1; // Same index may mean a different color now
+    invalidateDial();
+}
+
+void DialGauge::setInactiveColor(const QColor &color)
+{
+    if (m_inactiveColor != color)
+    {
+        m_inactiveColor = color;
+        invalidateDial();
+    }
+}
+
+void DialGauge::setNeedleLength(qreal length)
+{
+    if (assign(m_needleLength, length))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::setNeedleWidth(qreal width)
+{
+    if (assign(m_needleWidth, width))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::setHubRadius(qreal radius)
+{
+    if (assign(m_hubRadius, radius))
+    {
+        invalidateDial();
+    }
+}
+
+void DialGauge::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+
+    if (newGeometry.size() != oldGeometry.size())
+    {
+        m_dialDirty = true;
+        m_sectorsDirty = true;
+        m_needleDirty = true;
+        update();
+    }
+}
+
+void DialGauge::itemChange(ItemChange change, const ItemChangeData &value)
+{
+    QQuickItem::itemChange(change, value);
+
+    if (change == ItemDevicePixelRatioHasChanged)
+    {
+        // The texture is rendered at device resolution
+        m_dialDirty = true;
+        update();
+    }
+}
+
+void DialGauge::invalidateDial()
+{
+    m_dialDirty = true;
+    m_sectorsDirty = true;
+    m_needleDirty = true;
+    refreshValueState();
+    emit dialChanged();
+    update();
+}
+
+void DialGauge::refreshValueState()
+{
+    const LitRange range = litRange();
+    if (!(range == m_litRange))
+    {
+        m_litRange = range;
+        m_sectorsDirty = true;
+    }
+
+    const int index = colorIndex(m_value);
+    if (index != m_colorIndex)
+    {
+        m_colorIndex = index;
+        m_needleDirty = true;
+        emit colorChanged();
+    }
+}
+
+int DialGauge::colorIndex(qreal value) const
+{
+    for (int i = 0; i < m_colorStops.size(); ++i)
+    {
+        if (value <= m_colorStops.at(i).value)
+        {
+            return i;
+        }
+    }
+    return int(m_colorStops.size()) - 1;
+}
+
+QColor DialGauge::colorAt(qreal value) const
+{
+    const int index = colorIndex(value);
+    return index < 0 ? QColor(Qt::white) : m_colorStops.at(index).color;
+}
+
+int DialGauge::tickCount() const
+{
+    if (m_tickStep <= 0.0 || m_maximumValue <= m_minimumValue)
+    {
+        return 0;
+    }
+    return int(qFloor((m_maximumValue - m_minimumValue) / m_tickStep + StepEpsilon)) + 1;
+}
+
+qreal DialGauge::tickValue(int index) const
+{
+    return m_minimumValue + index * m_tickStep;
+}
+
+qreal DialGauge::angleAt(qreal value) const
+{
+    const qreal span = m_maximumValue - m_minimumValue;
+    if (span <= 0.0)
+    {
+        return m_startAngle;
+    }
+    const qreal clamped = qBound(m_minimumValue, value, m_maximumValue);
+    return m_startAngle + (clamped - m_minimumValue) / span * m_sweepAngle;
+}
+
+qreal DialGauge::tickAngle(qreal index) const
+{
+    const qreal span = m_maximumValue - m_minimumValue;
+    if (span <= 0.0)
+    {
+        return m_startAngle;
+    }
+    return m_startAngle + index * m_tickStep / span * m_sweepAngle;
+}
+
+QPointF DialGauge::center() const
+{
+    return QPointF(width() * m_pivot.x(), height() * m_pivot.y());
+}
+
+DialGauge::LitRange DialGauge::litRange() const
+{
+    LitRange range;
+    const int count = tickCount();
+    if (count == 0)
+    {
+        return range;
+    }
+
+    const qreal low = qMin(m_originValue, m_value);
+    const qreal high = qMax(m_originValue, m_value);
+    range.first = qMax(0, int(qCeil((low - m_minimumValue) / m_tickStep - StepEpsilon)));
+    range.last = qMin(count - 1, int(qFloor((high - m_minimumValue) / m_tickStep + StepEpsilon)));
+    if (range.first > range.last)
+    {
+        range = LitRange();
+    }
+    return range;
+}
+
+QImage DialGauge::renderDial(qreal devicePixelRatio) const
+{
+    const int pixelWidth = qMax(1, qCeil(width() * devicePixelRatio));
+    const int rowHeight = qMax(1, qCeil(height() * devicePixelRatio));
+
+    QImage image(pixelWidth, rowHeight * RowCount, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+
+    const QPointF origin = center();
+    const int count = tickCount();
+
+    for (int row = 0; row < RowCount; ++row)
+    {
+        painter.save();
+        painter.translate(0.0, row * rowHeight);
+        painter.scale(devicePixelRatio, devicePixelRatio);
+        painter.translate(origin);
+
+        if (row == LabelRow)
+        {
+            painter.setFont(m_font);
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            const qreal value = tickValue(i);
+            const qreal angle = tickAngle(i);
+
+            if (row == LabelRow)
+            {
+                if (isMultiple(value, m_labelStep))
+                {
+                    const qreal labelValue = qRound64(value / StepEpsilon) * StepEpsilon;
+                    const QPointF position = polar(m_radius - m_labelInset, angle) + QPointF(0.0, m_labelOffset);
+                    painter.setPen(colorAt(value));
+                    painter.drawText(QRectF(position.x() - 50.0, position.y() - 50.0, 100.0, 100.0), Qt::AlignCenter,
+                                     QString::number(labelValue));
+                }
+                continue;
+            }
+
+            const bool major = isMultiple(value, m_majorTickStep);
+            QPen pen(row == ActiveRow ? colorAt(value) : m_inactiveColor, major ? m_majorTickWidth : m_tickWidth);
+            pen.setCapStyle(Qt::FlatCap);
+            painter.setPen(pen);
+            painter.drawLine(polar(m_radius, angle), polar(m_radius - (major ? m_majorTickLength : m_tickLength), angle));
+        }
+
+        painter.restore();
+    }
+
+    painter.end();
+    return image;
+}
+
+QSGNode *DialGauge::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+
+    if (width() <= 0.0 || height() <= 0.0)
+    {
+        delete oldNode;
+        return nullptr;
+    }
+
+    const qreal ratio = window() ? window()->effectiveDevicePixelRatio() : 1.0;
+    if (m_dialDirty || m_dial.isNull() || ratio != m_dialRatio)
+    {
+        m_dial = renderDial(ratio);
+        m_dialRatio = ratio;
+    }
+
+    const bool software = window() && window()->rendererInterface()->graphicsApi() == QSGRendererInterface::Software;
+    QSGNode *node = software ? updateSoftwareNode(oldNode) : updateHardwareNode(oldNode);
+
+    m_dialDirty = false;
+    m_sectorsDirty = false;
+    m_needleDirty = false;
+    return node;
+}
+
+QSGNode *DialGauge::updateHardwareNode(QSGNode *oldNode)
+{
+    auto *root = static_cast<DialGaugeNode *>(oldNode);
+    bool fresh = false;
+    if (!root)
+    {
+        root = new DialGaugeNode;
+
+        root->labels = window()->createImageNode();
+        root->labels->setOwnsTexture(false);
+        root->labels->setFiltering(QSGTexture::Linear);
+        root->appendChildNode(root->labels);
+
+        auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 0);
+        geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        auto *material = new QSGTextureMaterial;
+        material->setFiltering(QSGTexture::Linear);
+        root->ticks = new QSGGeometryNode;
+        root->ticks->setGeometry(geometry);
+        root->ticks->setMaterial(material);
+        root->ticks->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial);
+        root->appendChildNode(root->ticks);
+
+        root->shadow = new QSGTransformNode;
+        root->shadowShape = createNeedleShape(QColor(0, 0, 0, 77));
+        root->shadow->appendChildNode(root->shadowShape);
+        root->appendChildNode(root->shadow);
+
+        root->needle = new QSGTransformNode;
+        root->needleShape = createNeedleShape(color());
+        root->needle->appendChildNode(root->needleShape);
+        root->appendChildNode(root->needle);
+
+        fresh = true;
+    }
+
+    const qreal rowHeight = m_dial.height() / RowCount;
+    const qreal textureWidth = m_dial.width();
+    const qreal textureHeight = m_dial.height();
+
+    if (fresh || m_dialDirty || !root->texture)
+    {
+        delete root->texture;
+        root->texture = window()->createTextureFromImage(m_dial, QQuickWindow::TextureHasAlphaChannel);
+
+        root->labels->setTexture(root->texture);
+        root->labels->setRect(QRectF(0.0, 0.0, width(), height()));
+        root->labels->setSourceRect(QRectF(0.0, LabelRow * rowHeight, textureWidth, rowHeight));
+
+        static_cast<QSGTextureMaterial *>(root->ticks->material())->setTexture(root->texture);
+        root->ticks->markDirty(QSGNode::DirtyMaterial);
+    }
+
+    if (fresh || m_sectorsDirty)
+    {
+        // Lit ticks come from the active row, the rest from the inactive row, split half way between ticks
+        QList<Sector> sectors;
+        const int count = tickCount();
+        if (count > 0)
+        {
+            if (m_litRange.first > m_litRange.last)
+            {
+                sectors.append({tickAngle(-0.5), tickAngle(count - 0.5), InactiveRow});
+            }
+            else
+            {
+                if (m_litRange.first > 0)
+                {
+                    sectors.append({tickAngle(-0.5), tickAngle(m_litRange.first - 0.5), InactiveRow});
+                }
+                sectors.append({tickAngle(m_litRange.first - 0.5), tickAngle(m_litRange.last + 0.5), ActiveRow});
+                if (m_litRange.last < count - 1)
+                {
+                    sectors.append({tickAngle(m_litRange.last + 0.5), tickAngle(count - 0.5), InactiveRow});
+                }
+            }
+        }
+
+        int vertexCount = 0;
+        for (const Sector &sector : std::as_const(sectors))
+        {
+            vertexCount += 6 * qMax(1, qCeil(qAbs(sector.toAngle - sector.fromAngle) / SegmentDegrees));
+        }
+
+        QSGGeometry *geometry = root->ticks->geometry();
+        geometry->allocate(vertexCount);
+        QSGGeometry::TexturedPoint2D *v = geometry->vertexDataAsTexturedPoint2D();
+
+        const QPointF origin = center();
+        const qreal outer = m_radius + 2.0;
+        const qreal inner = qMax<qreal>(0.0, m_radius - qMax(m_tickLength, m_majorTickLength) - 2.0);
+        int i = 0;
+        for (const Sector &sector : std::as_const(sectors))
+        {
+            const qreal rowTop = sector.row * rowHeight;
+            auto vertex = [&](qreal radius, qreal angle) {
+                const QPointF p = origin + polar(radius, angle);
+                v[i++].set(float(p.x()), float(p.y()),
+                           float(p.x() * m_dialRatio / textureWidth),
+                           float((rowTop + p.y() * m_dialRatio) / textureHeight));
+            };
+
+            const int segments = qMax(1, qCeil(qAbs(sector.toAngle - sector.fromAngle) / SegmentDegrees));
+            for (int s = 0; s < segments; ++s)
+            {
+                const qreal a = sector.fromAngle + (sector.toAngle - sector.fromAngle) * s / segments;
+                const qreal b = sector.fromAngle + (sector.toAngle - sector.fromAngle) * (s + 1) / segments;
+                vertex(inner, a);
+                vertex(outer, a);
+                vertex(outer, b);
+                vertex(inner, a);
+                vertex(outer, b);
+                vertex(inner, b);
+            }
+        }
+
+        geometry->markVertexDataDirty();
+        root->ticks->markDirty(QSGNode::DirtyGeometry);
+    }
+
+    if (fresh || m_needleDirty)
+    {
+        buildNeedle(root->shadowShape, m_needleLength, m_needleWidth, m_hubRadius);
+        buildNeedle(root->needleShape, m_needleLength, m_needleWidth, m_hubRadius);
+        setShapeColor(root->needleShape, color());
+    }
+
+    // The per-value work: two matrices
+    const QPointF origin = center();
+    const qreal angle = angleAt(m_value);
+
+    QMatrix4x4 needleMatrix;
+    needleMatrix.translate(float(origin.x()), float(origin.y()));
+    needleMatrix.rotate(float(angle), 0.0f, 0.0f, 1.0f);
+    root->needle->setMatrix(needleMatrix);
+
+    QMatrix4x4 shadowMatrix;
+    shadowMatrix.translate(float(origin.x() + ShadowOffset), float(origin.y() + ShadowOffset));
+    shadowMatrix.rotate(float(angle), 0.0f, 0.0f, 1.0f);
+    root->shadow->setMatrix(shadowMatrix);
+
+    return root;
+}
+
+QSGNode *DialGauge::updateSoftwareNode(QSGNode *oldNode)
+{
+    auto *node = static_cast<SoftwareDialNode *>(oldNode);
+    if (!node)
+    {
+        node = new SoftwareDialNode(window());
+    }
+
+    node->dial = m_dial;
+    node->bounds = QRectF(0.0, 0.0, width(), height());
+    node->center = center();
+    node->outerRadius = m_radius + 2.0;
+
+    node->sectors.clear();
+    const int count = tickCount();
+    if (count > 0)
+    {
+        node->sectors.append({tickAngle(-0.5), tickAngle(count - 0.5), InactiveRow});
+        if (m_litRange.first <= m_litRange.last)
+        {
+            node->sectors.append({tickAngle(m_litRange.first - 0.5), tickAngle(m_litRange.last + 0.5), ActiveRow});
+        }
+    }
+
+    node->needleAngle = angleAt(m_value);
+    node->needleLength = m_needleLength;
+    node->needleWidth = m_needleWidth;
+    node->hubRadius = m_hubRadius;
+    node->needleColor = color();
+    node->markDirty(QSGNode::DirtyMaterial);
+    return node;
+}
@@ -0,0 +1,566 @@
+#include "../include/ggdiagram.h"
+#include <QPainter>
+#include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QSGImageNode>
+#include <QSGRenderNode>
+#include <QSGRendererInterface>
+#include <QSGVertexColorMaterial>
+#include <QtMath>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+// Samples copied out of the history per validation step
+constexpr int ChunkSize = 1024;
+
+// The heatmap texture is rebuilt at most this often, the histogram itself is updated every frame
+constexpr qint64 HeatmapRefreshMs = 100;
+
+// Premultiplied heat palette from sparse (transparent blue) to dense (opaque red)
+const std::array<QRgb, 256> &heatPalette()
+{
+    static const std::array<QRgb, 256> palette = [] {
+        struct Stop
+        {
+            qreal at;
+            int r, g, b, a;
+        };
+        const Stop stops[] = {
+            {0.0, 0, 64, 255, 70},
+            {0.35, 0, 220, 255, 130},
+            {0.65, 255, 235, 0, 180},
+            {1.0, 255, 40, 0, 220},
+        };
+
+        std::array<QRgb, 256> table{};
+        for (int i = 0; i < 256; ++i)
+        {
+            const qreal t = i / 255.0;
+            int s = 0;
+            while (s < 2 && t > stops[s + 1].at)
+            {
+                ++s;
+            }
+            const Stop &from = stops[s];
+            const Stop &to = stops[s + 1];
+            const qreal f = (t - from.at) / (to.at - from.at);
+            auto mix = [f](int a, int b) { return qRound(a + (b - a) * f); };
+            table[i] = qPremultiply(qRgba(mix(from.r, to.r), mix(from.g, to.g), mix(from.b, to.b), mix(from.a, to.a)));
+        }
+        return table;
+    }();
+    return palette;
+}
+
+// The software backend cannot draw custom geometry, it paints the trail segment by segment
+class SoftwareTrailNode : public QSGRenderNode
+{
+public:
+    explicit SoftwareTrailNode(QQuickWindow *window)
+        : m_window(window)
+    {
+    }
+
+    void render(const RenderState *state) override
+    {
+        QSGRendererInterface *rif = m_window->rendererInterface();
+        auto *painter = static_cast<QPainter *>(rif->getResource(m_window, QSGRendererInterface::PainterResource));
+        if (!painter || points.size() < 2)
+        {
+            return;
+        }
+
+        const QRegion *clipRegion = state->clipRegion();
+        if (clipRegion && !clipRegion->isEmpty())
+        {
+            painter->setClipRegion(*clipRegion, Qt::ReplaceClip);
+        }
+        painter->setTransform(matrix()->toTransform());
+        painter->setOpacity(inheritedOpacity());
+        painter->setRenderHint(QPainter::Antialiasing);
+
+        QColor segmentColor = color;
+        for (qsizetype i = 1; i < points.size(); ++i)
+        {
+            segmentColor.setAlphaF(color.alphaF() * i / (points.size() - 1));
+            painter->setPen(QPen(segmentColor, 2.0));
+            painter->drawLine(points.at(i - 1), points.at(i));
+        }
+    }
+
+    StateFlags changedStates() const override { return {}; }
+    RenderingFlags flags() const override { return BoundedRectRendering; }
+    QRectF rect() const override { return bounds; }
+
+    QList<QPointF> points; // Oldest first
+    QColor color;
+    QRectF bounds;
+
+private:
+    QQuickWindow *m_window;
+};
+
+class GGDiagramNode : public QSGNode
+{
+public:
+    ~GGDiagramNode() override { delete texture; }
+
+    QSGTexture *texture = nullptr; // Heatmap, owned here
+    QSGImageNode *heatmap = nullptr;
+    QSGGeometryNode *trail = nullptr;
+    SoftwareTrailNode *softwareTrail = nullptr;
+};
+}
+
+GGDiagram::GGDiagram(QQuickItem *parent)
+    : QQuickItem(parent),
+    m_maxLateralG(3.5),
+    m_maxLongitudinalG(2.0),
+    m_margin(20.0),
+    m_trailLength(250),
+    m_trailInterval(20),
+    m_trailColor(Qt::white),
+    m_bins(64),
+    m_running(true),
+    m_nextIndex(0),
+    m_historyStart(0),
+    m_primed(false),
+    m_trailHead(0),
+    m_trailCount(0),
+    m_lastTrailUs(std::numeric_limits<qint64>::min()),
+    m_trailDirty(true),
+    m_histogramMax(0),
+    m_histogramDirty(false),
+    m_heatmapDirty(false),
+    m_layoutDirty(true)
+{
+    setFlag(ItemHasContents, true);
+    m_trail.resize(m_trailLength);
+    m_histogram.resize(m_bins * m_bins);
+}
+
+void GGDiagram::setSource(CommunicationManager *source)
+{
+    if (m_source == source)
+    {
+        return;
+    }
+
+    m_source = source;
+    m_primed = false;
+    clear();
+    emit sourceChanged();
+}
+
+void GGDiagram::setMaxLateralG(qreal g)
+{
+    g = qMax<qreal>(g, 0.01);
+    if (m_maxLateralG == g)
+    {
+        return;
+    }
+
+    // The bins cover the plotted range, so they lose their meaning
+    m_maxLateralG = g;
+    resetHistogram();
+    m_layoutDirty = true;
+    emit rangeChanged();
+    update();
+}
+
+void GGDiagram::setMaxLongitudinalG(qreal g)
+{
+    g = qMax<qreal>(g, 0.01);
+    if (m_maxLongitudinalG == g)
+    {
+        return;
+    }
+
+    m_maxLongitudinalG = g;
+    resetHistogram();
+    m_layoutDirty = true;
+    emit rangeChanged();
+    update();
+}
+
+void GGDiagram::setMargin(qreal margin)
+{
+    if (m_margin == margin)
+    {
+        return;
+    }
+
+    m_margin = margin;
+    m_layoutDirty = true;
+    emit rangeChanged();
+    update();
+}
+
+void GGDiagram::setTrailLength(int points)
+{
+    points = qMax(2, points);
+    if (m_trailLength == points)
+    {
+        return;
+    }
+
+    m_trailLength = points;
+    m_trail.resize(m_trailLength);
+    resetTrail();
+    emit trailChanged();
+    update();
+}
+
+void GGDiagram::setTrailInterval(int ms)
+{
+    ms = qMax(0, ms);
+    if (m_trailInterval == ms)
+    {
+        return;
+    }
+
+    m_trailInterval = ms;
+    emit trailChanged();
+}
+
+void GGDiagram::setTrailColor(const QColor &color)
+{
+    if (m_trailColor == color)
+    {
+        return;
+    }
+
+    m_trailColor = color;
+    m_trailDirty = true;
+    emit trailChanged();
+    update();
+}
+
+void GGDiagram::setBins(int bins)
+{
+    bins = qBound(4, bins, 1024);
+    if (m_bins == bins)
+    {
+        return;
+    }
+
+    m_bins = bins;
+    m_histogram.resize(m_bins * m_bins);
+    resetHistogram();
+    emit binsChanged();
+    update();
+}
+
+void GGDiagram::setRunning(bool running)
+{
+    if (m_running == running)
+    {
+        return;
+    }
+
+    m_running = running;
+    emit runningChanged();
+}
+
+void GGDiagram::clear()
+{
+    resetTrail();
+    resetHistogram();
+    update();
+}
+
+void GGDiagram::resetTrail()
+{
+    m_trailHead = 0;
+    m_trailCount = 0;
+    m_lastTrailUs = std::numeric_limits<qint64>::min();
+    m_trailDirty = true;
+}
+
+void GGDiagram::resetHistogram()
+{
+    m_histogram.fill(0);
+    m_histogramMax = 0;
+    renderHeatmap(); // Show the empty map right away, also while not running
+}
+
+void GGDiagram::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+
+    if (newGeometry.size() != oldGeometry.size())
+    {
+        m_layoutDirty = true;
+        update();
+    }
+}
+
+void GGDiagram::itemChange(ItemChange change, const ItemChangeData &value)
+{
+    QQuickItem::itemChange(change, value);
+
+    if (change != ItemSceneChange)
+    {
+        return;
+    }
+
+    if (m_window)
+    {
+        disconnect(m_window, &QQuickWindow::afterAnimating, this, &GGDiagram::advance);
+    }
+
+    m_window = value.window;
+
+    if (m_window)
+    {
+        // Same frame clock as the telemetry delivery in CommunicationManager
+        connect(m_window, &QQuickWindow::afterAnimating, this, &GGDiagram::advance);
+    }
+}
+
+void GGDiagram::advance()
+{
+    if (!m_running || !m_source)
+    {
+        return;
+    }
+
+    const TelemetryHistory &history = m_source->history();
+    const quint64 historyStart = history.start();
+    TelemetryHistory::View available = history.all();
+
+    if (!m_primed || historyStart != m_historyStart)
+    {
+        // New source: its samples start a new diagram
+        if (m_primed)
+        {
+            clear();
+        }
+        m_nextIndex = available.begin;
+        m_historyStart = historyStart;
+        m_primed = true;
+    }
+
+    std::array<qint64, ChunkSize> times;
+    std::array<double, ChunkSize> lateral;
+    std::array<double, ChunkSize> longitudinal;
+
+    while (m_nextIndex < available.end)
+    {
+        // Samples the ring overwrote before we got to them are lost, carry on with what is left
+        m_nextIndex = qMax(m_nextIndex, available.begin);
+
+        TelemetryHistory::View chunk;
+        chunk.begin = m_nextIndex;
+        chunk.end = qMin<quint64>(available.end, m_nextIndex + ChunkSize);
+
+        const TelemetryRingSpan<qint64> chunkTimes = history.times(chunk);
+        const TelemetryRingSpan<double> chunkLateral = history.values(TelemetryChannel::LateralG, chunk);
+        const TelemetryRingSpan<double> chunkLongitudinal = history.values(TelemetryChannel::LongitudinalG, chunk);
+        const qsizetype count = chunkTimes.size();
+        for (qsizetype i = 0; i < count; ++i)
+        {
+            times[i] = chunkTimes.at(i);
+            lateral[i] = chunkLateral.at(i);
+            longitudinal[i] = chunkLongitudinal.at(i);
+        }
+
+        if (!history.isValid(chunk))
+        {
+            available = history.all();
+            continue;
+        }
+
+        for (qsizetype i = 0; i < count; ++i)
+        {
+            accumulate(times[i], lateral[i], longitudinal[i]);
+        }
+        m_nextIndex = chunk.end;
+    }
+
+    if (m_histogramDirty && (!m_heatmapClock.isValid() || m_heatmapClock.elapsed() >= HeatmapRefreshMs))
+    {
+        renderHeatmap();
+        m_heatmapClock.start();
+    }
+
+    if (m_trailDirty || m_heatmapDirty)
+    {
+        update();
+    }
+}
+
+void GGDiagram::accumulate(qint64 timeUs, double lateralG, double longitudinalG)
+{
+    if (!qIsFinite(lateralG) || !qIsFinite(longitudinalG))
+    {
+        return;
+    }
+
+    // Outliers pile up in the border bins instead of disappearing
+    const double u = (lateralG / m_maxLateralG + 1.0) / 2.0;
+    const double v = (longitudinalG / m_maxLongitudinalG + 1.0) / 2.0;
+    const int column = qBound(0, int(u * m_bins), m_bins - 1);
+    const int row = m_bins - 1 - qBound(0, int(v * m_bins), m_bins - 1);
+
+    quint32 &bin = m_histogram[row * m_bins + column];
+    if (bin < std::numeric_limits<quint32>::max())
+    {
+        ++bin;
+        m_histogramMax = qMax(m_histogramMax, bin);
+        m_histogramDirty = true;
+    }
+
+    if (m_trailCount == 0 || timeUs - m_lastTrailUs >= qint64(m_trailInterval) * 1000)
+    {
+        m_trail[m_trailHead] = QPointF(lateralG, longitudinalG);
+        m_trailHead = (m_trailHead + 1) % m_trailLength;
+        m_trailCount = qMin(m_trailCount + 1, m_trailLength);
+        m_lastTrailUs = timeUs;
+        m_trailDirty = true;
+    }
+}
+
+void GGDiagram::renderHeatmap()
+{
+    if (m_heatmap.width() != m_bins)
+    {
+        m_heatmap = QImage(m_bins, m_bins, QImage::Format_ARGB32_Premultiplied);
+    }
+
+    // Logarithmic scale, a long stint at one spot must not wash out the rest
+    const std::array<QRgb, 256> &palette = heatPalette();
+    const double scale = m_histogramMax > 0 ? 255.0 / std::log1p(double(m_histogramMax)) : 0.0;
+    for (int row = 0; row < m_bins; ++row)
+    {
+        auto *line = reinterpret_cast<QRgb *>(m_heatmap.scanLine(row));
+        const quint32 *counts = m_histogram.constData() + row * m_bins;
+        for (int column = 0; column < m_bins; ++column)
+        {
+            line[column] = counts[column] == 0 ? 0 : palette[qBound(0, int(std::log1p(double(counts[column])) * scale), 255)];
+        }
+    }
+
+    m_histogramDirty = false;
+    m_heatmapDirty = true;
+}
+
+QRectF GGDiagram::plotRect() const
+{
+    return QRectF(m_margin, m_margin, qMax<qreal>(0.0, width() - 2.0 * m_margin), qMax<qreal>(0.0, height() - 2.0 * m_margin));
+}
+
+QPointF GGDiagram::mapToPlot(double lateralG, double longitudinalG) const
+{
+    // Clamped to the item like the marker in the diagram
+    const QRectF plot = plotRect();
+    const qreal x = plot.center().x() + lateralG / m_maxLateralG * plot.width() / 2.0;
+    const qreal y = plot.center().y() - longitudinalG / m_maxLongitudinalG * plot.height() / 2.0;
+    return QPointF(qBound<qreal>(0.0, x, width()), qBound<qreal>(0.0, y, height()));
+}
+
+QSGNode *GGDiagram::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+
+    const bool software = window() && window()->rendererInterface()->graphicsApi() == QSGRendererInterface::Software;
+
+    auto *root = static_cast<GGDiagramNode *>(oldNode);
+    if (!root)
+    {
+        root = new GGDiagramNode;
+
+        if (software)
+        {
+            root->softwareTrail = new SoftwareTrailNode(window());
+            root->appendChildNode(root->softwareTrail);
+        }
+        else
+        {
+            auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+            geometry->setDrawingMode(QSGGeometry::DrawLineStrip);
+            geometry->setVertexDataPattern(QSGGeometry::DynamicPattern);
+            geometry->setLineWidth(2.0f);
+
+            root->trail = new QSGGeometryNode;
+            root->trail->setGeometry(geometry);
+            root->trail->setMaterial(new QSGVertexColorMaterial);
+            root->trail->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial);
+            root->appendChildNode(root->trail);
+        }
+
+        m_heatmapDirty = !m_heatmap.isNull();
+        m_layoutDirty = true;
+    }
+
+    if (m_heatmapDirty)
+    {
+        if (!root->heatmap)
+        {
+            // Below the trail
+            root->heatmap = window()->createImageNode();
+            root->heatmap->setOwnsTexture(false);
+            root->heatmap->setFiltering(QSGTexture::Linear);
+            root->prependChildNode(root->heatmap);
+        }
+
+        // Tiny texture, replacing it is cheaper than keeping it in sync
+        QSGTexture *texture = window()->createTextureFromImage(m_heatmap, QQuickWindow::TextureHasAlphaChannel);
+        root->heatmap->setTexture(texture);
+        delete root->texture;
+        root->texture = texture;
+        m_heatmapDirty = false;
+    }
+
+    if (root->heatmap && m_layoutDirty)
+    {
+        root->heatmap->setRect(plotRect());
+    }
+
+    if (m_trailDirty || m_layoutDirty)
+    {
+        const int first = (m_trailHead - m_trailCount + m_trailLength) % m_trailLength;
+
+        if (root->softwareTrail)
+        {
+            root->softwareTrail->points.clear();
+            root->softwareTrail->points.reserve(m_trailCount);
+            for (int i = 0; i < m_trailCount; ++i)
+            {
+                const QPointF &g = m_trail.at((first + i) % m_trailLength);
+                root->softwareTrail->points.append(mapToPlot(g.x(), g.y()));
+            }
+            root->softwareTrail->color = m_trailColor;
+            root->softwareTrail->bounds = QRectF(0.0, 0.0, width(), height());
+            root->softwareTrail->markDirty(QSGNode::DirtyMaterial);
+        }
+        else
+        {
+            QSGGeometry *geometry = root->trail->geometry();
+            geometry->allocate(m_trailCount);
+            QSGGeometry::ColoredPoint2D *vertices = geometry->vertexDataAsColoredPoint2D();
+
+            // Oldest first, fading in towards the newest point; the material expects premultiplied colors
+            for (int i = 0; i < m_trailCount; ++i)
+            {
+                const QPointF &g = m_trail.at((first + i) % m_trailLength);
+                const QPointF p = mapToPlot(g.x(), g.y());
+                const qreal alpha = m_trailColor.alphaF() * (i + 1) / m_trailCount;
+                vertices[i].set(float(p.x()), float(p.y()),
+                                uchar(m_trailColor.red() * alpha), uchar(m_trailColor.green() * alpha),
+                                uchar(m_trailColor.blue() * alpha), uchar(255 * alpha));
+            }
+
+            geometry->markVertexDataDirty();
+            root->trail->markDirty(QSGNode::DirtyGeometry);
+        }
+
+        m_trailDirty = false;
+    }
+
+    m_layoutDirty = false;
+    return root;
+}
@@ -0,0 +1,370 @@
+#include "../include/gpstrack.h"
+#include <QBitArray>
+#include <QDebug>
+#include <QtMath>
+#include <array>
+#include <cmath>
+
+namespace
+{
+constexpr double EarthRadiusMeters = 6371000.0;
+
+// Samples copied out of the history per validation step
+constexpr int ChunkSize = 1024;
+
+// Fixes checked against the candidate segment per new fix, bounds the cost of a long straight
+constexpr int MaxWindow = 256;
+}
+
+GpsTrack::GpsTrack(QObject *parent)
+    : QObject(parent),
+    m_tolerance(1.0),
+    m_minDistance(0.5),
+    m_maxVertices(5000),
+    m_effectiveTolerance(m_tolerance),
+    m_nextIndex(0),
+    m_historyStart(0),
+    m_primed(false),
+    m_hasOrigin(false),
+    m_originLatitude(0.0),
+    m_originLongitude(0.0),
+    m_metersPerDegreeLongitude(0.0),
+    m_hasLastFix(false),
+    m_lastLatitude(0.0),
+    m_lastLongitude(0.0)
+{
+}
+
+void GpsTrack::setSource(CommunicationManager *source)
+{
+    if (m_source == source)
+    {
+        return;
+    }
+
+    if (m_source)
+    {
+        disconnect(m_source, &CommunicationManager::telemetryChanged, this, &GpsTrack::pull);
+    }
+
+    m_source = source;
+    m_primed = false;
+    reset();
+
+    if (m_source)
+    {
+        // Fixes are read from the history, the notification only says when to look
+        connect(m_source, &CommunicationManager::telemetryChanged, this, &GpsTrack::pull);
+        pull();
+    }
+    emit sourceChanged();
+}
+
+void GpsTrack::setTolerance(double meters)
+{
+    meters = qMax(0.0, meters);
+    if (m_tolerance == meters)
+    {
+        return;
+    }
+
+    m_tolerance = meters;
+    m_effectiveTolerance = meters;
+    emit toleranceChanged();
+}
+
+void GpsTrack::setMinDistance(double meters)
+{
+    meters = qMax(0.0, meters);
+    if (m_minDistance == meters)
+    {
+        return;
+    }
+
+    m_minDistance = meters;
+    emit minDistanceChanged();
+}
+
+void GpsTrack::setMaxVertices(int vertices)
+{
+    vertices = qMax(16, vertices);
+    if (m_maxVertices == vertices)
+    {
+        return;
+    }
+
+    m_maxVertices = vertices;
+    emit maxVerticesChanged();
+
+    if (m_vertices.size() > m_maxVertices)
+    {
+        thin();
+        emit pathReset();
+        emit vertexCountChanged();
+    }
+}
+
+int GpsTrack::vertexCount() const
+{
+    return int(m_vertices.size()) + (m_window.isEmpty() ? 0 : 1);
+}
+
+QVariantList GpsTrack::path() const
+{
+    QVariantList result;
+    result.reserve(vertexCount());
+    for (const TrackPoint &vertex : m_vertices)
+    {
+        result.append(QVariant::fromValue(coordinate(vertex)));
+    }
+    if (!m_window.isEmpty())
+    {
+        result.append(QVariant::fromValue(coordinate(m_window.constLast())));
+    }
+    return result;
+}
+
+void GpsTrack::clear()
+{
+    // Only the drawn track is dropped, fixes already in the history are not replayed
+    reset();
+}
+
+void GpsTrack::reset()
+{
+    m_vertices.clear();
+    m_window.clear();
+    m_hasOrigin = false;
+    m_hasLastFix = false;
+    m_effectiveTolerance = m_tolerance;
+    emit pathReset();
+    emit vertexCountChanged();
+}
+
+void GpsTrack::pull()
+{
+    if (!m_source)
+    {
+        return;
+    }
+
+    const TelemetryHistory &history = m_source->history();
+    const quint64 historyStart = history.start();
+    TelemetryHistory::View available = history.all();
+
+    if (!m_primed || historyStart != m_historyStart)
+    {
+        // New source: its fixes start a new track
+        if (m_primed)
+        {
+            reset();
+        }
+        m_nextIndex = available.begin;
+        m_historyStart = historyStart;
+        m_primed = true;
+    }
+
+    std::array<double, ChunkSize> latitudes;
+    std::array<double, ChunkSize> longitudes;
+
+    while (m_nextIndex < available.end)
+    {
+        // Samples the ring overwrote before we got to them are lost, carry on with what is left
+        m_nextIndex = qMax(m_nextIndex, available.begin);
+
+        TelemetryHistory::View chunk;
+        chunk.begin = m_nextIndex;
+        chunk.end = qMin<quint64>(available.end, m_nextIndex + ChunkSize);
+
+        const TelemetryRingSpan<double> chunkLatitudes = history.values(TelemetryChannel::GpsLatitude, chunk);
+        const TelemetryRingSpan<double> chunkLongitudes = history.values(TelemetryChannel::GpsLongitude, chunk);
+        const qsizetype count = chunkLatitudes.size();
+        for (qsizetype i = 0; i < count; ++i)
+        {
+            latitudes[i] = chunkLatitudes.at(i);
+            longitudes[i] = chunkLongitudes.at(i);
+        }
+
+        if (!history.isValid(chunk))
+        {
+            available = history.all();
+            continue;
+        }
+
+        for (qsizetype i = 0; i < count; ++i)
+        {
+            addFix(latitudes[i], longitudes[i]);
+        }
+        m_nextIndex = chunk.end;
+    }
+}
+
+void GpsTrack::addFix(double latitude, double longitude)
+{
+    // Every telemetry frame carries the last fix, most samples repeat it
+    if (m_hasLastFix && latitude == m_lastLatitude && longitude == m_lastLongitude)
+    {
+        return;
+    }
+    m_hasLastFix = true;
+    m_lastLatitude = latitude;
+    m_lastLongitude = longitude;
+
+    if (!qIsFinite(latitude) || !qIsFinite(longitude) || qAbs(latitude) > 90.0 || qAbs(longitude) > 180.0
+        || (latitude == 0.0 && longitude == 0.0))
+    {
+        return;
+    }
+
+    if (!m_hasOrigin)
+    {
+        // Local equirectangular projection, exact enough over the extent of a track
+        m_originLatitude = latitude;
+        m_originLongitude = longitude;
+        m_metersPerDegreeLongitude = EarthRadiusMeters * M_PI / 180.0 * qCos(qDegreesToRadians(latitude));
+        m_hasOrigin = true;
+    }
+
+    const TrackPoint point = project(latitude, longitude);
+
+    if (m_vertices.isEmpty())
+    {
+        m_vertices.append(point);
+        emit vertexAppended(coordinate(point));
+        emit vertexCountChanged();
+        return;
+    }
+
+    const TrackPoint &previous = m_window.isEmpty() ? m_vertices.constLast() : m_window.constLast();
+    if (std::hypot(point.x - previous.x, point.y - previous.y) < m_minDistance)
+    {
+        return;
+    }
+
+    if (m_window.isEmpty())
+    {
+        m_window.append(point);
+        emit vertexAppended(coordinate(point));
+        emit vertexCountChanged();
+        return;
+    }
+
+    if (m_window.size() < MaxWindow && windowFits(point))
+    {
+        // One straight segment from the anchor still covers everything, just move its end
+        m_window.append(point);
+        emit lastVertexMoved(coordinate(point));
+        return;
+    }
+
+    // The provisional vertex becomes final and anchors a new window
+    m_vertices.append(m_window.constLast());
+    m_window.clear();
+    m_window.append(point);
+    emit vertexAppended(coordinate(point));
+
+    if (m_vertices.size() > m_maxVertices)
+    {
+        thin();
+        emit pathReset();
+    }
+    emit vertexCountChanged();
+}
+
+GpsTrack::TrackPoint GpsTrack::project(double latitude, double longitude) const
+{
+    TrackPoint point;
+    point.latitude = latitude;
+    point.longitude = longitude;
+    point.x = (longitude - m_originLongitude) * m_metersPerDegreeLongitude;
+    point.y = (latitude - m_originLatitude) * EarthRadiusMeters * M_PI / 180.0;
+    return point;
+}
+
+bool GpsTrack::windowFits(const TrackPoint &end) const
+{
+    const TrackPoint &anchor = m_vertices.constLast();
+    for (const TrackPoint &point : m_window)
+    {
+        if (segmentDistance(point, anchor, end) > m_effectiveTolerance)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void GpsTrack::thin()
+{
+    // Douglas-Peucker over the final vertices with a doubled tolerance until half the budget is free,
+    // so thinning runs rarely and its cost amortizes to O(1) per fix. The last vertex anchors the window and stays.
+    while (m_vertices.size() > m_maxVertices / 2)
+    {
+        m_effectiveTolerance = qMax(2.0 * m_effectiveTolerance, 0.1);
+
+        const qsizetype count = m_vertices.size();
+        QBitArray keep(count, false);
+        keep.setBit(0);
+        keep.setBit(count - 1);
+
+        struct Range
+        {
+            qsizetype first;
+            qsizetype last;
+        };
+        QList<Range> ranges;
+        ranges.append({0, count - 1});
+        while (!ranges.isEmpty())
+        {
+            const Range range = ranges.takeLast();
+            double farthest = -1.0;
+            qsizetype index = -1;
+            for (qsizetype i = range.first + 1; i < range.last; ++i)
+            {
+                const double distance = segmentDistance(m_vertices.at(i), m_vertices.at(range.first), m_vertices.at(range.last));
+                if (distance > farthest)
+                {
+                    farthest = distance;
+                    index = i;
+                }
+            }
+
+            if (index >= 0 && farthest > m_effectiveTolerance)
+            {
+                keep.setBit(index);
+                ranges.append({range.first, index});
+                ranges.append({index, range.last});
+            }
+        }
+
+        qsizetype kept = 0;
+        for (qsizetype i = 0; i < count; ++i)
+        {
+            if (keep.testBit(i))
+            {
+                m_vertices[kept++] = m_vertices.at(i);
+            }
+        }
+        m_vertices.resize(kept);
+    }
+
+    qDebug() << "GpsTrack: Thinned the track to" << m_vertices.size() << "vertices, tolerance" << m_effectiveTolerance << "m";
+}
+
+double GpsTrack::segmentDistance(const TrackPoint &p, const TrackPoint &a, const TrackPoint &b)
+{
+    const double dx = b.x - a.x;
+    const double dy = b.y - a.y;
+    const double lengthSquared = dx * dx + dy * dy;
+    double t = 0.0;
+    if (lengthSquared > 0.0)
+    {
+        t = qBound(0.0, ((p.x - a.x) * dx + (p.y - a.y) * dy) / lengthSquared, 1.0);
+    }
+    return std::hypot(p.x - (a.x + t * dx), p.y - (a.y + t * dy));
+}
+
+QGeoCoordinate GpsTrack::coordinate(const TrackPoint &point)
+{
+    return QGeoCoordinate(point.latitude, point.longitude);
+}
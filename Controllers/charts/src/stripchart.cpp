@@ -0,0 +1,495 @@
+#include "../include/stripchart.h"
+#include <QDebug>
+#include <QPainter>
+#include <QQuickWindow>
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QSGRenderNode>
+#include <QSGRendererInterface>
+#include <QSGTransformNode>
+#include <QtMath>
+#include <algorithm>
+
+namespace
+{
+// Far left of any plot, used for ring segments that hold no data yet
+constexpr float UnusedX = -1.0e7f;
+
+// Vertex x is stored as float seconds since the origin, move the origin before precision suffers
+constexpr qint64 RebaseAfterUs = qint64(3600) * 1000000;
+
+struct SeriesNodes
+{
+    QSGTransformNode *transform = nullptr;
+    QSGGeometryNode *ring = nullptr; // DrawLines, one segment per final point, overwritten oldest first
+    QSGGeometryNode *tail = nullptr; // DrawLineStrip through the provisional points
+    int capacity = 0;                // Segments in the ring
+    int nextSlot = 0;
+    bool hasLast = false;
+    QSGGeometry::Point2D last;
+};
+
+class StripChartNode : public QSGNode
+{
+public:
+    QList<SeriesNodes> series;
+};
+
+QSGGeometryNode *createLineNode(QSGGeometry::DrawingMode mode, int vertexCount, const QColor &color)
+{
+    auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), vertexCount);
+    geometry->setDrawingMode(mode);
+    geometry->setVertexDataPattern(QSGGeometry::DynamicPattern);
+    geometry->setLineWidth(1.5f);
+
+    auto *material = new QSGFlatColorMaterial;
+    material->setColor(color);
+
+    auto *node = new QSGGeometryNode;
+    node->setGeometry(geometry);
+    node->setMaterial(material);
+    node->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial);
+    return node;
+}
+
+void clearRing(SeriesNodes &nodes)
+{
+    QSGGeometry *geometry = nodes.ring->geometry();
+    QSGGeometry::Point2D *vertices = geometry->vertexDataAsPoint2D();
+    for (int i = 0; i < geometry->vertexCount(); ++i)
+    {
+        vertices[i].set(UnusedX, 0.0f);
+    }
+
+    nodes.nextSlot = 0;
+    nodes.hasLast = false;
+    geometry->markVertexDataDirty();
+    nodes.ring->markDirty(QSGNode::DirtyGeometry);
+}
+
+// The software backend cannot draw custom geometry, it gets the decimated series as polylines
+class SoftwareChartNode : public QSGRenderNode
+{
+public:
+    struct Line
+    {
+        QPolygonF points;
+        QColor color;
+    };
+
+    explicit SoftwareChartNode(QQuickWindow *window)
+        : m_window(window)
+    {
+    }
+
+    void render(const RenderState *state) override
+    {
+        QSGRendererInterface *rif = m_window->rendererInterface();
+        auto *painter = static_cast<QPainter *>(rif->getResource(m_window, QSGRendererInterface::PainterResource));
+        if (!painter)
+        {
+            return;
+        }
+
+        const QRegion *clipRegion = state->clipRegion();
+        if (clipRegion && !clipRegion->isEmpty())
+        {
+            painter->setClipRegion(*clipRegion, Qt::ReplaceClip);
+        }
+        painter->setTransform(matrix()->toTransform());
+        painter->setOpacity(inheritedOpacity());
+        painter->setRenderHint(QPainter::Antialiasing);
+
+        for (const Line &line : std::as_const(lines))
+        {
+            painter->setPen(QPen(line.color, 1.5));
+            painter->drawPolyline(line.points);
+        }
+    }
+
+    StateFlags changedStates() const override { return {}; }
+    RenderingFlags flags() const override { return BoundedRectRendering; }
+    QRectF rect() const override { return bounds; }
+
+    QList<Line> lines;
+    QRectF bounds;
+
+private:
+    QQuickWindow *m_window;
+};
+}
+
+StripChart::StripChart(QQuickItem *parent)
+    : QQuickItem(parent),
+    m_windowSeconds(10.0),
+    m_mode(MinMax),
+    m_running(true),
+    m_originUs(0),
+    m_nowUs(0),
+    m_hasData(false),
+    m_nodesDirty(true)
+{
+    setFlag(ItemHasContents, true);
+    setClip(true);
+}
+
+void StripChart::setSource(CommunicationManager *source)
+{
+    if (m_source == source)
+    {
+        return;
+    }
+
+    m_source = source;
+    for (Series &series : m_series)
+    {
+        series.decimator.reset();
+    }
+    emit sourceChanged();
+}
+
+void StripChart::setSeries(const QVariantList &series)
+{
+    m_seriesConfig = series;
+    m_series.clear();
+
+    for (const QVariant &entry : series)
+    {
+        const QVariantMap map = entry.toMap();
+        const QString name = map.value(QStringLiteral("channel")).toString();
+        const TelemetryChannelInfo *channel = findTelemetryChannel(name);
+        if (!channel)
+        {
+            qDebug() << "StripChart: Unknown telemetry channel" << name;
+            continue;
+        }
+
+        Series item(channel->channel);
+        item.color = map.value(QStringLiteral("color")).value<QColor>();
+        if (!item.color.isValid())
+        {
+            item.color = Qt::white;
+        }
+        item.minimum = map.value(QStringLiteral("minimum"), 0.0).toDouble();
+        item.maximum = map.value(QStringLiteral("maximum"), 1.0).toDouble();
+        if (item.maximum <= item.minimum)
+        {
+            item.maximum = item.minimum + 1.0;
+        }
+        m_series.append(item);
+    }
+
+    configureDecimators();
+    m_nodesDirty = true;
+    emit seriesChanged();
+    update();
+}
+
+void StripChart::setWindowSeconds(qreal seconds)
+{
+    seconds = qMax<qreal>(seconds, 0.1);
+    if (qFuzzyCompare(m_windowSeconds, seconds))
+    {
+        return;
+    }
+
+    m_windowSeconds = seconds;
+    configureDecimators();
+    emit windowSecondsChanged();
+    update();
+}
+
+void StripChart::setMode(DecimationMode mode)
+{
+    if (m_mode == mode)
+    {
+        return;
+    }
+
+    m_mode = mode;
+    configureDecimators();
+    emit modeChanged();
+    update();
+}
+
+void StripChart::setRunning(bool running)
+{
+    if (m_running == running)
+    {
+        return;
+    }
+
+    m_running = running;
+    emit runningChanged();
+    update();
+}
+
+void StripChart::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+
+    if (newGeometry.size() != oldGeometry.size())
+    {
+        // The ring is sized from the width, so a resize rebuilds it
+        configureDecimators();
+        m_nodesDirty = true;
+        update();
+    }
+}
+
+void StripChart::itemChange(ItemChange change, const ItemChangeData &value)
+{
+    QQuickItem::itemChange(change, value);
+
+    if (change != ItemSceneChange)
+    {
+        return;
+    }
+
+    if (m_window)
+    {
+        disconnect(m_window, &QQuickWindow::afterAnimating, this, &StripChart::advance);
+    }
+
+    m_window = value.window;
+
+    if (m_window)
+    {
+        // Same frame clock as the telemetry delivery in CommunicationManager
+        connect(m_window, &QQuickWindow::afterAnimating, this, &StripChart::advance);
+    }
+}
+
+void StripChart::configureDecimators()
+{
+    const int pixels = qMax(1, qCeil(width()));
+    const qint64 windowUs = qint64(m_windowSeconds * 1000000.0);
+    const TelemetryDecimator::Mode mode = m_mode == Lttb ? TelemetryDecimator::Mode::Lttb : TelemetryDecimator::Mode::MinMax;
+
+    for (Series &series : m_series)
+    {
+        series.decimator.setMode(mode);
+        series.decimator.setWindow(windowUs);
+        series.decimator.setWidth(pixels);
+    }
+}
+
+void StripChart::restartSeries()
+{
+    for (Series &series : m_series)
+    {
+        series.hasCommitted = false;
+        series.pendingCommits.clear();
+        series.tail.clear();
+        series.resetRing = true;
+    }
+}
+
+void StripChart::advance()
+{
+    if (!m_running || !m_source || m_series.isEmpty())
+    {
+        return;
+    }
+
+    const TelemetryHistory &history = m_source->history();
+    m_nowUs = telemetryTimestampUs();
+
+    if (m_originUs == 0 || m_nowUs - m_originUs > RebaseAfterUs)
+    {
+        m_originUs = m_nowUs;
+        restartSeries();
+    }
+
+    bool hasData = false;
+    for (Series &series : m_series)
+    {
+        series.decimator.update(history, m_nowUs);
+
+        if (series.decimator.generation() != series.generation)
+        {
+            series.generation = series.decimator.generation();
+            series.hasCommitted = false;
+            series.pendingCommits.clear();
+            series.resetRing = true;
+        }
+
+        // Final points newer than the last committed one go to the vertex ring exactly once
+        const QList<TelemetryPoint> &points = series.decimator.points();
+        const auto stableEnd = points.cbegin() + series.decimator.stableCount();
+        auto next = points.cbegin();
+        if (series.hasCommitted)
+        {
+            next = std::upper_bound(points.cbegin(), stableEnd, series.lastCommitted.timeUs,
+                                    [](qint64 timeUs, const TelemetryPoint &point) { return timeUs < point.timeUs; });
+        }
+        for (; next != stableEnd; ++next)
+        {
+            series.pendingCommits.append(*next);
+            series.lastCommitted = *next;
+            series.hasCommitted = true;
+        }
+
+        // Don't let commits pile up while nothing is rendered, the ring only keeps the newest anyway
+        const qsizetype maxPending = 4 * qMax(1, qCeil(width())) + 64;
+        if (series.pendingCommits.size() > maxPending)
+        {
+            series.pendingCommits.remove(0, series.pendingCommits.size() - maxPending);
+        }
+
+        series.tail.clear();
+        if (series.hasCommitted)
+        {
+            series.tail.append(series.lastCommitted);
+        }
+        for (auto it = stableEnd; it != points.cend(); ++it)
+        {
+            series.tail.append(*it);
+        }
+
+        hasData |= !points.isEmpty();
+    }
+
+    // Keep scrolling while anything is visible, and draw once more when the last point left
+    if (hasData || m_hasData)
+    {
+        update();
+    }
+    m_hasData = hasData;
+}
+
+QSGNode *StripChart::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+
+    const bool software = window() && window()->rendererInterface()->graphicsApi() == QSGRendererInterface::Software;
+    return software ? updateSoftwareNode(oldNode) : updateHardwareNode(oldNode);
+}
+
+QSGNode *StripChart::updateHardwareNode(QSGNode *oldNode)
+{
+    auto *root = static_cast<StripChartNode *>(oldNode);
+    if (root && (m_nodesDirty || root->series.size() != m_series.size()))
+    {
+        delete root;
+        root = nullptr;
+    }
+
+    if (!root)
+    {
+        // Room for every point the decimators can produce, min/max emits up to two per pixel
+        const int capacity = 2 * qMax(1, qCeil(width())) + 16;
+
+        root = new StripChartNode;
+        for (const Series &series : std::as_const(m_series))
+        {
+            SeriesNodes nodes;
+            nodes.capacity = capacity;
+            nodes.transform = new QSGTransformNode;
+            nodes.ring = createLineNode(QSGGeometry::DrawLines, 2 * capacity, series.color);
+            nodes.tail = createLineNode(QSGGeometry::DrawLineStrip, 0, series.color);
+            nodes.transform->appendChildNode(nodes.ring);
+            nodes.transform->appendChildNode(nodes.tail);
+            root->appendChildNode(nodes.transform);
+            root->series.append(nodes);
+        }
+
+        // The new ring is empty, commit everything again on the next frame
+        restartSeries();
+        m_nodesDirty = false;
+    }
+
+    const double windowSeconds = m_windowSeconds;
+    const double left = double(m_nowUs - m_originUs) / 1000000.0 - windowSeconds;
+
+    for (int i = 0; i < m_series.size(); ++i)
+    {
+        Series &series = m_series[i];
+        SeriesNodes &nodes = root->series[i];
+
+        if (series.resetRing)
+        {
+            clearRing(nodes);
+            series.resetRing = false;
+        }
+
+        // Only the slots of new segments are written, older segments stay where they are
+        if (!series.pendingCommits.isEmpty())
+        {
+            QSGGeometry *geometry = nodes.ring->geometry();
+            QSGGeometry::Point2D *vertices = geometry->vertexDataAsPoint2D();
+            for (const TelemetryPoint &point : std::as_const(series.pendingCommits))
+            {
+                QSGGeometry::Point2D vertex;
+                vertex.set(float(double(point.timeUs - m_originUs) / 1000000.0), float(point.value));
+                if (nodes.hasLast)
+                {
+                    vertices[2 * nodes.nextSlot] = nodes.last;
+                    vertices[2 * nodes.nextSlot + 1] = vertex;
+                    nodes.nextSlot = (nodes.nextSlot + 1) % nodes.capacity;
+                }
+                nodes.last = vertex;
+                nodes.hasLast = true;
+            }
+            series.pendingCommits.clear();
+            geometry->markVertexDataDirty();
+            nodes.ring->markDirty(QSGNode::DirtyGeometry);
+        }
+
+        QSGGeometry *tailGeometry = nodes.tail->geometry();
+        tailGeometry->allocate(int(series.tail.size()));
+        QSGGeometry::Point2D *tailVertices = tailGeometry->vertexDataAsPoint2D();
+        for (int j = 0; j < series.tail.size(); ++j)
+        {
+            const TelemetryPoint &point = series.tail.at(j);
+            tailVertices[j].set(float(double(point.timeUs - m_originUs) / 1000000.0), float(point.value));
+        }
+        nodes.tail->markDirty(QSGNode::DirtyGeometry);
+
+        // Map (seconds, value) to pixels, scrolling and scaling never touch the vertices
+        QMatrix4x4 matrix;
+        matrix.translate(0.0f, float(height()));
+        matrix.scale(float(width() / windowSeconds), float(-height() / (series.maximum - series.minimum)));
+        matrix.translate(float(-left), float(-series.minimum));
+        nodes.transform->setMatrix(matrix);
+    }
+
+    return root;
+}
+
+QSGNode *StripChart::updateSoftwareNode(QSGNode *oldNode)
+{
+    auto *node = static_cast<SoftwareChartNode *>(oldNode);
+    if (!node)
+    {
+        node = new SoftwareChartNode(window());
+    }
+
+    node->bounds = boundingRect();
+    node->lines.clear();
+
+    const double windowUs = m_windowSeconds * 1000000.0;
+    const double leftUs = double(m_nowUs) - windowUs;
+
+    for (Series &series : m_series)
+    {
+        SoftwareChartNode::Line line;
+        line.color = series.color;
+
+        const double xScale = width() / windowUs;
+        const double yScale = height() / (series.maximum - series.minimum);
+        const QList<TelemetryPoint> &points = series.decimator.points();
+        line.points.reserve(points.size());
+        for (const TelemetryPoint &point : points)
+        {
+            line.points.append(QPointF((double(point.timeUs) - leftUs) * xScale, height() - (point.value - series.minimum) * yScale));
+        }
+        node->lines.append(line);
+
+        // Nothing is kept between frames here, the vertex ring is not used
+        series.pendingCommits.clear();
+    }
+
+    node->markDirty(QSGNode::DirtyMaterial);
+    return node;
+}
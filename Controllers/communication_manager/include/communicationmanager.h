@@ -4,166 +4,252 @@
 #include <QObject>
 #include <QVariant>
 #include <QDebug>
+#include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <atomic>
+#include "../../telemetry/include/telemetryframe.h"
+#include "../../telemetry/include/telemetrystore.h"
+#include "../../telemetry/include/telemetrychangefilter.h"
+#include "../../telemetry/include/telemetryhistory.h"
+#include "../../telemetry/include/telemetrysourcestats.h"
+#include "updategovernor.h"
+#include "../../recording/include/sessionrecorder.h"
+#include "../../recording/include/blackboxrecorder.h"
+#include "../../replay/include/replayclient.h"
 
 // Forward declarations
 class UdpClient;
 class SerialManager;
 class MqttClient;
+class QQuickWindow;
+class TelemetryFeed;
 
 
 class CommunicationManager : public QObject
 {
     Q_OBJECT
 
-    // Expose all properties that were previously in UdpClient and SerialManager
-    Q_PROPERTY(float speed READ speed NOTIFY speedChanged)
-    Q_PROPERTY(int rpm READ rpm NOTIFY rpmChanged)
-    Q_PROPERTY(int accPedal READ accPedal NOTIFY accPedalChanged)
-    Q_PROPERTY(int brakePedal READ brakePedal NOTIFY brakePedalChanged)
-    Q_PROPERTY(double encoderAngle READ encoderAngle NOTIFY encoderAngleChanged)
-    Q_PROPERTY(float temperature READ temperature NOTIFY temperatureChanged)
-    Q_PROPERTY(int batteryLevel READ batteryLevel NOTIFY batteryLevelChanged)
-    Q_PROPERTY(double gpsLongitude READ gpsLongitude NOTIFY gpsLongitudeChanged)
-    Q_PROPERTY(double gpsLatitude READ gpsLatitude NOTIFY gpsLatitudeChanged)
-    Q_PROPERTY(int speedFL READ speedFL NOTIFY speedFLChanged)
-    Q_PROPERTY(int speedFR READ speedFR NOTIFY speedFRChanged)
-    Q_PROPERTY(int speedBL READ speedBL NOTIFY speedBLChanged)
-    Q_PROPERTY(int speedBR READ speedBR NOTIFY speedBRChanged)
-    Q_PROPERTY(double lateralG READ lateralG NOTIFY lateralGChanged)
-    Q_PROPERTY(double longitudinalG READ longitudinalG NOTIFY longitudinalGChanged)
+    // Expose all properties that were previously in UdpClient and SerialManager.
+    // They all share one notify signal, emitted at most once per rendered frame.
+    Q_PROPERTY(float speed READ speed NOTIFY telemetryChanged)
+    Q_PROPERTY(int rpm READ rpm NOTIFY telemetryChanged)
+    Q_PROPERTY(int accPedal READ accPedal NOTIFY telemetryChanged)
+    Q_PROPERTY(int brakePedal READ brakePedal NOTIFY telemetryChanged)
+    Q_PROPERTY(double encoderAngle READ encoderAngle NOTIFY telemetryChanged)
+    Q_PROPERTY(float temperature READ temperature NOTIFY telemetryChanged)
+    Q_PROPERTY(int batteryLevel READ batteryLevel NOTIFY telemetryChanged)
+    Q_PROPERTY(double gpsLongitude READ gpsLongitude NOTIFY telemetryChanged)
+    Q_PROPERTY(double gpsLatitude READ gpsLatitude NOTIFY telemetryChanged)
+    Q_PROPERTY(int speedFL READ speedFL NOTIFY telemetryChanged)
+    Q_PROPERTY(int speedFR READ speedFR NOTIFY telemetryChanged)
+    Q_PROPERTY(int speedBL READ speedBL NOTIFY telemetryChanged)
+    Q_PROPERTY(int speedBR READ speedBR NOTIFY telemetryChanged)
+    Q_PROPERTY(double lateralG READ lateralG NOTIFY telemetryChanged)
+    Q_PROPERTY(double longitudinalG READ longitudinalG NOTIFY telemetryChanged)
     Q_PROPERTY(bool isSerialSource READ isSerialSource WRITE setIsSerialSource NOTIFY isSerialSourceChanged)
+    Q_PROPERTY(SessionRecorder *recorder READ recorder CONSTANT)
+    Q_PROPERTY(BlackBoxRecorder *blackBox READ blackBox CONSTANT)
+    Q_PROPERTY(ReplayClient *replay READ replay CONSTANT)
+    Q_PROPERTY(bool live READ isLive NOTIFY rewindChanged)
+    Q_PROPERTY(double rewindSeconds READ rewindSeconds NOTIFY rewindChanged)
 
 public:
     explicit CommunicationManager(QObject *parent = nullptr);
     ~CommunicationManager();
 
     // Property getters
-    float speed() const { return m_speed; }
-    int rpm() const { return m_rpm; }
-    int accPedal() const { return m_accPedal; }
-    int brakePedal() const { return m_brakePedal; }
-    double encoderAngle() const { return m_encoderAngle; }
-    float temperature() const { return m_temperature; }
-    int batteryLevel() const { return m_batteryLevel; }
-    double gpsLongitude() const { return m_gpsLongitude; }
-    double gpsLatitude() const { return m_gpsLatitude; }
-    int speedFL() const { return m_speedFL; }
-    int speedFR() const { return m_speedFR; }
-    int speedBL() const { return m_speedBL; }
-    int speedBR() const { return m_speedBR; }
-    double lateralG() const { return m_lateralG; }
-    double longitudinalG() const { return m_longitudinalG; }
+    float speed() const { return m_frame.speed; }
+    int rpm() const { return m_frame.rpm; }
+    int accPedal() const { return m_frame.accPedal; }
+    int brakePedal() const { return m_frame.brakePedal; }
+    double encoderAngle() const { return m_frame.encoderAngle; }
+    float temperature() const { return m_frame.temperature; }
+    int batteryLevel() const { return m_frame.batteryLevel; }
+    double gpsLongitude() const { return m_frame.gpsLongitude; }
+    double gpsLatitude() const { return m_frame.gpsLatitude; }
+    int speedFL() const { return m_frame.speedFL; }
+    int speedFR() const { return m_frame.speedFR; }
+    int speedBL() const { return m_frame.speedBL; }
+    int speedBR() const { return m_frame.speedBR; }
+    double lateralG() const { return m_frame.lateralG; }
+    double longitudinalG() const { return m_frame.longitudinalG; }
 
     Q_INVOKABLE bool startSerial(const QString &portName, qint32 baudRate);
     Q_INVOKABLE bool startUdp(quint16 port);
     Q_INVOKABLE bool startMqtt(const QString &brokerAddress, quint16 port, bool useTls, const QString &clientId, const QString &username, const QString &password, const QString &topic);
+
+    /**
+     * @brief Play a recorded session, a packet capture or a CSV log through the live pipeline instead of a transport
+     * @param path The .tlog, .pcap, .pcapng or .csv file
+     * @param speed Factor on the recorded timing, 0 replays as fast as possible
+     * @param capturePort UDP port of the telemetry in a capture, 0 for the busiest port
+     */
+    Q_INVOKABLE bool startReplay(const QString &path, double speed = 1.0, quint16 capturePort = 0);
     Q_INVOKABLE bool stop();
 
+    /**
+     * @brief Configure when changes of a channel are passed on to QML
+     *
+     * Raw values are unaffected, only the notifications of the telemetry properties are filtered.
+     * @param channel The property name of the channel, e.g. "speed"
+     * @param deadband Changes up to this size are ignored, 0 passes every change
+     * @param hysteresis Extra margin needed when the value reverses its direction
+     * @param minIntervalMs Minimum time between two updates of the channel
+     * @return True if the channel exists
+     */
+    Q_INVOKABLE bool setChannelNotifyPolicy(const QString &channel, double deadband, double hysteresis, int minIntervalMs);
+
+    /**
+     * @brief Time per rendered frame for TelemetryFeed updates before lower priorities are deferred
+     * @param budgetMs Milliseconds, 0 defers everything below high priority once one update ran
+     */
+    Q_INVOKABLE void setUpdateBudget(double budgetMs);
+
+    /**
+     * @brief Show the telemetry of a moment in the history instead of the latest frame
+     *
+     * Only what the UI shows changes. Ingest, the history, recording and the black box keep running
+     * live. The moment is found with a binary search over the history, nothing is copied but the one
+     * sample. It stays where it is until the next rewind() or goLive().
+     * @param secondsAgo Time before the newest sample in the history
+     * @return False if the history is empty
+     */
+    Q_INVOKABLE bool rewind(double secondsAgo);
+
+    /**
+     * @brief Show the latest frame again after rewind()
+     */
+    Q_INVOKABLE void goLive();
+
+    /**
+     * @brief How far back rewind() can go, the time covered by the history
+     */
+    Q_INVOKABLE double historySeconds() const;
+
+    bool isLive() const { return m_live.load(std::memory_order_relaxed); }
+    double rewindSeconds() const { return m_rewindSeconds; }
+
+    // Called by TelemetryFeed when its source is set or cleared
+    void addFeed(TelemetryFeed *feed);
+    void removeFeed(TelemetryFeed *feed);
+
     bool isSerialSource() const { return m_isSerialSource; }
     void setIsSerialSource(bool isSerialSource);
 
+    /**
+     * @brief Drive telemetry delivery from the frame clock of a Quick window
+     *
+     * The latest frame is applied once per rendered frame, right before the scene graph is
+     * synchronized. Without a window a 60 Hz timer is used instead.
+     * @param window The window that renders the dashboard
+     */
+    void attachWindow(QQuickWindow *window);
+
+    /**
+     * @brief The store of the active source
+     *
+     * Consistent snapshots of the latest frame can be taken from any thread, e.g. by a recorder or
+     * analytics worker, without going through queued signals.
+     * @return The store of the running source, or nullptr if no source is running
+     */
+    const TelemetryStore *telemetryStore() const { return m_activeStore.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Timestamped history of every channel of the active source, at full input rate
+     *
+     * Readers on any thread query views and spans without locking, see TelemetryHistory.
+     */
+    const TelemetryHistory &history() const { return m_history; }
+
+    /**
+     * @brief Pipeline counters of the active source, all zero if no source is running
+     */
+    TelemetrySourceStats sourceStats();
+
+    quint64 framesDelivered() const { return m_framesDelivered; } // New frames applied on the frame clock.
+
+    /**
+     * @brief Records every raw frame of the active source to disk while recording is started
+     */
+    SessionRecorder *recorder() const { return m_recorder; }
+
+    /**
+     * @brief Keeps the last minutes of raw frames of the active source and saves them when triggered
+     */
+    BlackBoxRecorder *blackBox() const { return m_blackBox; }
+
+    /**
+     * @brief Playback controls of the replay source: pause, step, seek and speed
+     */
+    ReplayClient *replay() const { return m_replayClient; }
+
 signals:
-    void speedChanged(float newSpeed);
-    void rpmChanged(int newRpm);
-    void accPedalChanged(int newAccPedal);
-    void brakePedalChanged(int newBrakePedal);
-    void encoderAngleChanged(double newAngle);
-    void temperatureChanged(float newTemperature);
-    void batteryLevelChanged(int newBatteryLevel);
-    void gpsLongitudeChanged(double newLongitude);
-    void gpsLatitudeChanged(double newLatitude);
-    void speedFLChanged(int newSpeedFL);
-    void speedFRChanged(int newSpeedFR);
-    void speedBLChanged(int newSpeedBL);
-    void speedBRChanged(int newSpeedBR);
-    void lateralGChanged(double newLateralG);
-    void longitudinalGChanged(double newLongitudinalG);
+    void telemetryChanged();
     void isSerialSourceChanged(bool isSerialSource);
+    void rewindChanged();
     void errorOccurred(const QString &error);
 
 private slots:
-    void handleUdpSpeedChanged(float newSpeed);
-    void handleUdpRpmChanged(int newRpm);
-    void handleUdpAccPedalChanged(int newAccPedal);
-    void handleUdpBrakePedalChanged(int newBrakePedal);
-    void handleUdpEncoderAngleChanged(double newAngle);
-    void handleUdpTemperatureChanged(float newTemperature);
-    void handleUdpBatteryLevelChanged(int newBatteryLevel);
-    void handleUdpGpsLongitudeChanged(double newLongitude);
-    void handleUdpGpsLatitudeChanged(double newGpsLatitude);
-    void handleUdpSpeedFLChanged(int newSpeedFL);
-    void handleUdpSpeedFRChanged(int newSpeedFR);
-    void handleUdpSpeedBLChanged(int newSpeedBL);
-    void handleUdpSpeedBRChanged(int newSpeedBR);
-    void handleUdpLateralGChanged(double newLateralG);
-    void handleUdpLongitudinalGChanged(double newLongitudinalG);
-    void handleUdpError(const QString &error);
+    void handleFrame(const TelemetryFrame &frame);  // Runs in the parser thread of the active source only, feeds the history and the recorders.
 
-    void handleSerialSpeedChanged(float newSpeed);
-    void handleSerialRpmChanged(int newRpm);
-    void handleSerialAccPedalChanged(int newAccPedal);
-    void handleSerialBrakePedalChanged(int newBrakePedal);
-    void handleSerialEncoderAngleChanged(double newAngle);
-    void handleSerialTemperatureChanged(float newTemperature);
-    void handleSerialBatteryLevelChanged(int newBatteryLevel);
-    void handleSerialGpsLongitudeChanged(double newLongitude);
-    void handleSerialGpsLatitudeChanged(double newGpsLatitude);
-    void handleSerialSpeedFLChanged(int newSpeedFL);
-    void handleSerialSpeedFRChanged(int newSpeedFR);
-    void handleSerialSpeedBLChanged(int newSpeedBL);
-    void handleSerialSpeedBRChanged(int newSpeedBR);
-    void handleSerialLateralGChanged(double newLateralG);
-    void handleSerialLongitudinalGChanged(double newLongitudinalG);
+    void handleUdpError(const QString &error);
     void handleSerialError(const QString &error);
-
-
-    void handleMqttSpeedChanged(float newSpeed);
-    void handleMqttRpmChanged(int newRpm);
-    void handleMqttAccPedalChanged(int newAccPedal);
-    void handleMqttBrakePedalChanged(int newBrakePedal);
-    void handleMqttEncoderAngleChanged(double newAngle);
-    void handleMqttTemperatureChanged(float newTemperature);
-    void handleMqttBatteryLevelChanged(int newBatteryLevel);
-    void handleMqttGpsLongitudeChanged(double newLongitude);
-    void handleMqttGpsLatitudeChanged(double newGpsLatitude);
-    void handleMqttSpeedFLChanged(int newSpeedFL);
-    void handleMqttSpeedFRChanged(int newSpeedFR);
-    void handleMqttSpeedBLChanged(int newSpeedBL);
-    void handleMqttSpeedBRChanged(int newSpeedBR);
-    void handleMqttLateralGChanged(double newLateralG);
-    void handleMqttLongitudinalGChanged(double newLongitudinalG);
     void handleMqttError(const QString &error);
+    void handleReplayError(const QString &error);
+
+    void requestFrame();  // Asks the frame clock for one more frame, runs on the GUI thread.
+    void deliverFrame();  // Applies the latest frame from the active store, runs once per rendered frame.
 
 private:
+    enum class SourceType { None, Serial, Udp, Mqtt, Replay };
+
+    template <typename Client>
+    void routeSource(SourceType source, Client *client);
+    void unrouteSource();
 
 
     UdpClient *m_udpClient;
     SerialManager *m_serialManager;
     MqttClient *m_mqttClient;
+    ReplayClient *m_replayClient;
+    SessionRecorder *m_recorder;
+    BlackBoxRecorder *m_blackBox;
 
 
-    enum class SourceType { None, Serial, Udp, Mqtt };
     SourceType m_currentSource;
+    std::atomic<const TelemetryStore *> m_activeStore;
+    QMetaObject::Connection m_frameConnection;  // Frame stream of the active source, the others stay disconnected
+
+    // Frame clock hand-over, the parser threads only wake the GUI thread once per delivered frame
+    std::atomic<bool> m_frameRequested;
+    quint64 m_deliveredVersion;
+    quint64 m_framesDelivered;
+
+    // Live rewind, the parser threads only check m_live to skip waking the frame clock
+    std::atomic<bool> m_live;
+    qint64 m_rewindTimeUs;
+    double m_rewindSeconds;
+    bool m_rewindPending; // The snapshot at m_rewindTimeUs is due for delivery
+
+    // Deadband, hysteresis and rate limit per channel, between the raw frame and the published one
+    TelemetryChangeFilter m_changeFilter;
+    QElapsedTimer m_clock;
+    TelemetryFrame m_rawFrame;
+
+    // Per-widget delivery of the published frame, each TelemetryFeed at its own rate
+    UpdateGovernor m_governor;
+    QTimer m_governorTimer; // Wakes the frame clock when a rate-limited feed becomes due
+
+    // Raw frames of the active source, memory is allocated once
+    TelemetryHistory m_history;
+    QPointer<QQuickWindow> m_window;
+    QTimer m_frameTimer;
 
     // Internal storage for properties
-    float m_speed;
-    int m_rpm;
-    int m_accPedal;
-    int m_brakePedal;
-    double m_encoderAngle;
-    float m_temperature;
-    int m_batteryLevel;
-    double m_gpsLongitude;
-    double m_gpsLatitude;
-    int m_speedFL;
-    int m_speedFR;
-    int m_speedBL;
-    int m_speedBR;
-    double m_lateralG;
-    double m_longitudinalG;
+    TelemetryFrame m_frame;
     bool m_isSerialSource;
 
 };
 
 #endif // COMMUNICATIONMANAGER_H
-
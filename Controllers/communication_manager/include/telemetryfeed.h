@@ -0,0 +1,104 @@
+#ifndef TELEMETRYFEED_H
+#define TELEMETRYFEED_H
+
+#include <QObject>
+#include <QPointer>
+#include "../../telemetry/include/telemetryframe.h"
+
+// Forward declarations
+class CommunicationManager;
+
+/**
+ * @brief The TelemetryFeed class hands the published telemetry to one widget at its own rate
+ *
+ * The feed holds a copy of the published frame that only changes when the UpdateGovernor of its
+ * source delivers, at most maxRate times per second and coalescing every change in between. An
+ * expensive widget binds to a slow feed, a cheap one to a feed without a rate limit.
+ *
+ * Usage from QML:
+ * @code
+ * TelemetryFeed {
+ *     id: gpsFeed
+ *     source: communicationManager
+ *     maxRate: 5
+ *     priority: TelemetryFeed.Low
+ *     onUpdated: map.center = QtPositioning.coordinate(gpsFeed.gpsLatitude, gpsFeed.gpsLongitude)
+ * }
+ * @endcode
+ */
+class TelemetryFeed : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(CommunicationManager *source READ source WRITE setSource NOTIFY sourceChanged)
+    Q_PROPERTY(double maxRate READ maxRate WRITE setMaxRate NOTIFY maxRateChanged)
+    Q_PROPERTY(Priority priority READ priority WRITE setPriority NOTIFY priorityChanged)
+
+    // The same channels as CommunicationManager, all changing together on updated()
+    Q_PROPERTY(float speed READ speed NOTIFY updated)
+    Q_PROPERTY(int rpm READ rpm NOTIFY updated)
+    Q_PROPERTY(int accPedal READ accPedal NOTIFY updated)
+    Q_PROPERTY(int brakePedal READ brakePedal NOTIFY updated)
+    Q_PROPERTY(double encoderAngle READ encoderAngle NOTIFY updated)
+    Q_PROPERTY(float temperature READ temperature NOTIFY updated)
+    Q_PROPERTY(int batteryLevel READ batteryLevel NOTIFY updated)
+    Q_PROPERTY(double gpsLongitude READ gpsLongitude NOTIFY updated)
+    Q_PROPERTY(double gpsLatitude READ gpsLatitude NOTIFY updated)
+    Q_PROPERTY(int speedFL READ speedFL NOTIFY updated)
+    Q_PROPERTY(int speedFR READ speedFR NOTIFY updated)
+    Q_PROPERTY(int speedBL READ speedBL NOTIFY updated)
+    Q_PROPERTY(int speedBR READ speedBR NOTIFY updated)
+    Q_PROPERTY(double lateralG READ lateralG NOTIFY updated)
+    Q_PROPERTY(double longitudinalG READ longitudinalG NOTIFY updated)
+
+public:
+    enum Priority { Low, Normal, High };
+    Q_ENUM(Priority)
+
+    explicit TelemetryFeed(QObject *parent = nullptr);
+    ~TelemetryFeed();
+
+    CommunicationManager *source() const { return m_source; }
+    void setSource(CommunicationManager *source);
+
+    double maxRate() const { return m_maxRate; } // Updates per second at most, 0 updates with every rendered frame.
+    void setMaxRate(double rate);
+
+    Priority priority() const { return m_priority; } // High is never deferred when the frame budget is spent.
+    void setPriority(Priority priority);
+
+    float speed() const { return m_frame.speed; }
+    int rpm() const { return m_frame.rpm; }
+    int accPedal() const { return m_frame.accPedal; }
+    int brakePedal() const { return m_frame.brakePedal; }
+    double encoderAngle() const { return m_frame.encoderAngle; }
+    float temperature() const { return m_frame.temperature; }
+    int batteryLevel() const { return m_frame.batteryLevel; }
+    double gpsLongitude() const { return m_frame.gpsLongitude; }
+    double gpsLatitude() const { return m_frame.gpsLatitude; }
+    int speedFL() const { return m_frame.speedFL; }
+    int speedFR() const { return m_frame.speedFR; }
+    int speedBL() const { return m_frame.speedBL; }
+    int speedBR() const { return m_frame.speedBR; }
+    double lateralG() const { return m_frame.lateralG; }
+    double longitudinalG() const { return m_frame.longitudinalG; }
+
+    /**
+     * @brief Take over a published frame and notify, called by the UpdateGovernor
+     */
+    void deliver(const TelemetryFrame &frame);
+
+signals:
+    void sourceChanged();
+    void maxRateChanged();
+    void priorityChanged();
+    void updated();
+
+private:
+    QPointer<CommunicationManager> m_source;
+    double m_maxRate;
+    Priority m_priority;
+    TelemetryFrame m_frame;
+};
+
+#endif // TELEMETRYFEED_H
@@ -0,0 +1,53 @@
+#ifndef UPDATEGOVERNOR_H
+#define UPDATEGOVERNOR_H
+
+#include <QList>
+#include <QtGlobal>
+#include "../../telemetry/include/telemetryframe.h"
+
+// Forward declarations
+class TelemetryFeed;
+
+/**
+ * @brief The UpdateGovernor class schedules the updates of the registered TelemetryFeeds
+ *
+ * Runs on the GUI thread, once per delivered frame. Every feed gets the published frame at most at
+ * its own maximum rate, changes in between are coalesced into the next update. Updates run QML
+ * bindings synchronously, so their time is measured: once the frame budget is spent, feeds below
+ * high priority wait for the next frame, the longest waiting first.
+ */
+class UpdateGovernor
+{
+public:
+    UpdateGovernor();
+
+    void addFeed(TelemetryFeed *feed);
+    void removeFeed(TelemetryFeed *feed);
+
+    /**
+     * @brief Publish a frame to the feeds that are due
+     * @param frame The published frame
+     * @param changed Whether the frame changed since the previous call
+     * @param nowMs Monotonic time in milliseconds
+     * @return Time in milliseconds at which the next waiting feed becomes due, -1 if none waits
+     */
+    qint64 deliver(const TelemetryFrame &frame, bool changed, qint64 nowMs);
+
+    void setFrameBudgetMs(double budgetMs) { m_frameBudgetMs = qMax(0.0, budgetMs); }
+    double frameBudgetMs() const { return m_frameBudgetMs; }
+
+private:
+    struct Entry
+    {
+        TelemetryFeed *feed = nullptr;
+        quint64 deliveredVersion = 0;
+        qint64 lastDeliveryMs = -1;
+    };
+
+    QList<Entry> m_entries;
+    QList<qsizetype> m_due; // Scratch list of due entries, reused every frame
+    quint64 m_version;
+    double m_frameBudgetMs;
+};
+
+#endif // UPDATEGOVERNOR_H
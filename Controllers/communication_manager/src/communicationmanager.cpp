@@ -2,83 +2,48 @@
 #include "../../serial/include/serialmanager.h"
 #include "../../udp/include/udpclient.h"
 #include "../../mqtt/include/mqttclient.h"
+#include "../../replay/include/replayclient.h"
+#include "../../telemetry/include/telemetrychannels.h"
 #include <QDebug>
+#include <QQuickWindow>
 
 CommunicationManager::CommunicationManager(QObject *parent)
     : QObject(parent),
     m_udpClient(new UdpClient(this)),
     m_serialManager(new SerialManager(this)),
     m_mqttClient(new MqttClient(this)),
+    m_replayClient(new ReplayClient(this)),
+    m_recorder(new SessionRecorder(this)),
+    m_blackBox(new BlackBoxRecorder(BlackBoxRecorder::DefaultCapacity, this)),
     m_currentSource(SourceType::None),
-    m_speed(0.0f),
-    m_rpm(0),
-    m_accPedal(0),
-    m_brakePedal(0),
-    m_encoderAngle(0.0),
-    m_temperature(0.0f),
-    m_batteryLevel(0),
-    m_gpsLongitude(0.0),
-    m_gpsLatitude(0.0),
-    m_speedFL(0),
-    m_speedFR(0),
-    m_speedBL(0),
-    m_speedBR(0),
-    m_lateralG(0.0),
-    m_longitudinalG(0.0),
+    m_activeStore(nullptr),
+    m_frameRequested(false),
+    m_deliveredVersion(0),
+    m_framesDelivered(0),
+    m_live(true),
+    m_rewindTimeUs(0),
+    m_rewindSeconds(0.0),
+    m_rewindPending(false),
     m_isSerialSource(false)
 {
-    // Connect signals from UdpClient to CommunicationManager's slots
-    connect(m_udpClient, &UdpClient::speedChanged, this, &CommunicationManager::handleUdpSpeedChanged);
-    connect(m_udpClient, &UdpClient::rpmChanged, this, &CommunicationManager::handleUdpRpmChanged);
-    connect(m_udpClient, &UdpClient::accPedalChanged, this, &CommunicationManager::handleUdpAccPedalChanged);
-    connect(m_udpClient, &UdpClient::brakePedalChanged, this, &CommunicationManager::handleUdpBrakePedalChanged);
-    connect(m_udpClient, &UdpClient::encoderAngleChanged, this, &CommunicationManager::handleUdpEncoderAngleChanged);
-    connect(m_udpClient, &UdpClient::temperatureChanged, this, &CommunicationManager::handleUdpTemperatureChanged);
-    connect(m_udpClient, &UdpClient::batteryLevelChanged, this, &CommunicationManager::handleUdpBatteryLevelChanged);
-    connect(m_udpClient, &UdpClient::gpsLongitudeChanged, this, &CommunicationManager::handleUdpGpsLongitudeChanged);
-    connect(m_udpClient, &UdpClient::gpsLatitudeChanged, this, &CommunicationManager::handleUdpGpsLatitudeChanged);
-    connect(m_udpClient, &UdpClient::speedFLChanged, this, &CommunicationManager::handleUdpSpeedFLChanged);
-    connect(m_udpClient, &UdpClient::speedFRChanged, this, &CommunicationManager::handleUdpSpeedFRChanged);
-    connect(m_udpClient, &UdpClient::speedBLChanged, this, &CommunicationManager::handleUdpSpeedBLChanged);
-    connect(m_udpClient, &UdpClient::speedBRChanged, this, &CommunicationManager::handleUdpSpeedBRChanged);
-    connect(m_udpClient, &UdpClient::lateralGChanged, this, &CommunicationManager::handleUdpLateralGChanged);
-    connect(m_udpClient, &UdpClient::longitudinalGChanged, this, &CommunicationManager::handleUdpLongitudinalGChanged);
+    // Only error reporting is connected for every client, the frame stream of the active
+    // source is routed on start and dropped on stop.
     connect(m_udpClient, &UdpClient::errorOccurred, this, &CommunicationManager::handleUdpError);
-
-    // Connect signals from SerialManager to CommunicationManager's slots
-    connect(m_serialManager, &SerialManager::speedChanged, this, &CommunicationManager::handleSerialSpeedChanged);
-    connect(m_serialManager, &SerialManager::rpmChanged, this, &CommunicationManager::handleSerialRpmChanged);
-    connect(m_serialManager, &SerialManager::accPedalChanged, this, &CommunicationManager::handleSerialAccPedalChanged);
-    connect(m_serialManager, &SerialManager::brakePedalChanged, this, &CommunicationManager::handleSerialBrakePedalChanged);
-    connect(m_serialManager, &SerialManager::encoderAngleChanged, this, &CommunicationManager::handleSerialEncoderAngleChanged);
-    connect(m_serialManager, &SerialManager::temperatureChanged, this, &CommunicationManager::handleSerialTemperatureChanged);
-    connect(m_serialManager, &SerialManager::batteryLevelChanged, this, &CommunicationManager::handleSerialBatteryLevelChanged);
-    connect(m_serialManager, &SerialManager::gpsLongitudeChanged, this, &CommunicationManager::handleSerialGpsLongitudeChanged);
-    connect(m_serialManager, &SerialManager::gpsLatitudeChanged, this, &CommunicationManager::handleSerialGpsLatitudeChanged);
-    connect(m_serialManager, &SerialManager::speedFLChanged, this, &CommunicationManager::handleSerialSpeedFLChanged);
-    connect(m_serialManager, &SerialManager::speedFRChanged, this, &CommunicationManager::handleSerialSpeedFRChanged);
-    connect(m_serialManager, &SerialManager::speedBLChanged, this, &CommunicationManager::handleSerialSpeedBLChanged);
-    connect(m_serialManager, &SerialManager::speedBRChanged, this, &CommunicationManager::handleSerialSpeedBRChanged);
-    connect(m_serialManager, &SerialManager::lateralGChanged, this, &CommunicationManager::handleSerialLateralGChanged);
-    connect(m_serialManager, &SerialManager::longitudinalGChanged, this, &CommunicationManager::handleSerialLongitudinalGChanged);
     connect(m_serialManager, &SerialManager::errorOccurred, this, &CommunicationManager::handleSerialError);
-
-    connect(m_mqttClient, &MqttClient::speedChanged, this, &CommunicationManager::handleMqttSpeedChanged);
-    connect(m_mqttClient, &MqttClient::rpmChanged, this, &CommunicationManager::handleMqttRpmChanged);
-    connect(m_mqttClient, &MqttClient::accPedalChanged, this, &CommunicationManager::handleMqttAccPedalChanged);
-    connect(m_mqttClient, &MqttClient::brakePedalChanged, this, &CommunicationManager::handleMqttBrakePedalChanged);
-    connect(m_mqttClient, &MqttClient::encoderAngleChanged, this, &CommunicationManager::handleMqttEncoderAngleChanged);
-    connect(m_mqttClient, &MqttClient::temperatureChanged, this, &CommunicationManager::handleMqttTemperatureChanged);
-    connect(m_mqttClient, &MqttClient::batteryLevelChanged, this, &CommunicationManager::handleMqttBatteryLevelChanged);
-    connect(m_mqttClient, &MqttClient::gpsLongitudeChanged, this, &CommunicationManager::handleMqttGpsLongitudeChanged);
-    connect(m_mqttClient, &MqttClient::gpsLatitudeChanged, this, &CommunicationManager::handleMqttGpsLatitudeChanged);
-    connect(m_mqttClient, &MqttClient::speedFLChanged, this, &CommunicationManager::handleMqttSpeedFLChanged);
-    connect(m_mqttClient, &MqttClient::speedFRChanged, this, &CommunicationManager::handleMqttSpeedFRChanged);
-    connect(m_mqttClient, &MqttClient::speedBLChanged, this, &CommunicationManager::handleMqttSpeedBLChanged);
-    connect(m_mqttClient, &MqttClient::speedBRChanged, this, &CommunicationManager::handleMqttSpeedBRChanged);
-    connect(m_mqttClient, &MqttClient::lateralGChanged, this, &CommunicationManager::handleMqttLateralGChanged);
-    connect(m_mqttClient, &MqttClient::longitudinalGChanged, this, &CommunicationManager::handleMqttLongitudinalGChanged);
     connect(m_mqttClient, &MqttClient::errorOccurred, this, &CommunicationManager::handleMqttError);
+    connect(m_replayClient, &ReplayClient::errorOccurred, this, &CommunicationManager::handleReplayError);
+    connect(m_recorder, &SessionRecorder::errorOccurred, this, &CommunicationManager::errorOccurred);
+    connect(m_blackBox, &BlackBoxRecorder::errorOccurred, this, &CommunicationManager::errorOccurred);
+
+    m_clock.start();
+
+    // Fallback frame clock, used until a window is attached
+    m_frameTimer.setSingleShot(true);
+    m_frameTimer.setInterval(16);
+    connect(&m_frameTimer, &QTimer::timeout, this, &CommunicationManager::deliverFrame);
+
+    m_governorTimer.setSingleShot(true);
+    connect(&m_governorTimer, &QTimer::timeout, this, &CommunicationManager::requestFrame);
 }
 
 CommunicationManager::~CommunicationManager()
@@ -89,15 +54,16 @@ CommunicationManager::~CommunicationManager()
 bool CommunicationManager::startSerial(const QString &portName, qint32 baudRate)
 {
     stop(); // Stop any active communication first
+    routeSource(SourceType::Serial, m_serialManager); // Route first so the very first frame is delivered
     bool success = m_serialManager->start(portName, baudRate);
     if (success)
     {
-        m_currentSource = SourceType::Serial;
         setIsSerialSource(true);
         qDebug() << "CommunicationManager: Serial started.";
     }
     else
     {
+        unrouteSource();
         qDebug() << "CommunicationManager: Failed to start Serial.";
     }
     return success;
@@ -106,15 +72,16 @@ bool CommunicationManager::startSerial(const QString &portName, qint32 baudRate)
 bool CommunicationManager::startUdp(quint16 port)
 {
     stop(); // Stop any active communication first
+    routeSource(SourceType::Udp, m_udpClient); // Route first so the very first frame is delivered
     bool success = m_udpClient->start(port);
     if (success)
     {
-        m_currentSource = SourceType::Udp;
         setIsSerialSource(false);
         qDebug() << "CommunicationManager: UDP started.";
     }
     else
     {
+        unrouteSource();
         qDebug() << "CommunicationManager: Failed to start UDP.";
     }
     return success;
@@ -123,20 +90,39 @@ bool CommunicationManager::startUdp(quint16 port)
 bool CommunicationManager::startMqtt(const QString &brokerAddress, quint16 port, bool useTls, const QString &clientId, const QString &username, const QString &password, const QString &topic)
 {
     stop(); // Stop any active communication first
+    routeSource(SourceType::Mqtt, m_mqttClient); // Route first so the very first frame is delivered
     bool success = m_mqttClient->start(brokerAddress, port, useTls, clientId, username, password, topic);
     if (success)
     {
-        m_currentSource = SourceType::Mqtt;
         setIsSerialSource(false);
         qDebug() << "CommunicationManager: MQTT started.";
     }
     else
     {
+        unrouteSource();
         qDebug() << "CommunicationManager: Failed to start MQTT.";
     }
     return success;
 }
 
+bool CommunicationManager::startReplay(const QString &path, double speed, quint16 capturePort)
+{
+    stop(); // Stop any active communication first
+    routeSource(SourceType::Replay, m_replayClient); // Route first so the very first frame is delivered
+    bool success = m_replayClient->start(path, speed, capturePort);
+    if (success)
+    {
+        setIsSerialSource(false);
+        qDebug() << "CommunicationManager: Replay started.";
+    }
+    else
+    {
+        unrouteSource();
+        qDebug() << "CommunicationManager: Failed to start Replay.";
+    }
+    return success;
+}
+
 bool CommunicationManager::stop()
 {
     bool success = false;
@@ -155,10 +141,62 @@ bool CommunicationManager::stop()
         success = m_mqttClient->stop();
         qDebug() << "CommunicationManager: MQTT stopped.";
     }
-    m_currentSource = SourceType::None;
+    else if (m_currentSource == SourceType::Replay)
+    {
+        success = m_replayClient->stop();
+        qDebug() << "CommunicationManager: Replay stopped.";
+    }
+    unrouteSource();
     return success;
 }
 
+template <typename Client>
+void CommunicationManager::routeSource(SourceType source, Client *client)
+{
+    // The frame signal is emitted on the parser threads and only wakes the frame clock,
+    // the data itself is read from the client's store.
+    m_frameConnection = connect(client, &Client::frameReceived, this, &CommunicationManager::handleFrame, Qt::DirectConnection);
+    m_deliveredVersion = client->telemetryStore().version();
+    m_changeFilter.reset();
+    m_history.clear();
+    m_blackBox->clear();
+    m_activeStore.store(&client->telemetryStore(), std::memory_order_release);
+    m_currentSource = source;
+
+    SessionLog::Transport transport = SessionLog::Transport::Unknown;
+    switch (source)
+    {
+    case SourceType::Serial:
+        transport = SessionLog::Transport::Serial;
+        break;
+    case SourceType::Udp:
+        transport = SessionLog::Transport::Udp;
+        break;
+    case SourceType::Mqtt:
+        transport = SessionLog::Transport::Mqtt;
+        break;
+    case SourceType::Replay:
+        transport = SessionLog::Transport::Replay;
+        break;
+    case SourceType::None:
+        break;
+    }
+    m_recorder->setTransport(transport);
+    m_blackBox->setTransport(transport);
+
+    // The history of the previous source is gone
+    goLive();
+}
+
+void CommunicationManager::unrouteSource()
+{
+    disconnect(m_frameConnection);
+    m_activeStore.store(nullptr, std::memory_order_release);
+    m_currentSource = SourceType::None;
+    m_recorder->setTransport(SessionLog::Transport::Unknown);
+    m_blackBox->setTransport(SessionLog::Transport::Unknown);
+}
+
 void CommunicationManager::setIsSerialSource(bool isSerialSource)
 {
     if (m_isSerialSource != isSerialSource)
@@ -183,543 +221,203 @@ void CommunicationManager::handleMqttError(const QString &error)
     emit errorOccurred(error);
 }
 
-void CommunicationManager::handleUdpSpeedChanged(float newSpeed)
-{
-    if (m_currentSource == SourceType::Udp)
-    {
-        if (m_speed != newSpeed)
-        {
-            m_speed = newSpeed;
-            emit speedChanged(m_speed);
-        }
-    }
-}
-
-void CommunicationManager::handleUdpRpmChanged(int newRpm)
-{
-    if (m_currentSource == SourceType::Udp)
-    {
-        if (m_rpm != newRpm)
-        {
-            m_rpm = newRpm;
-            emit rpmChanged(m_rpm);
-        }
-    }
-}
-
-void CommunicationManager::handleUdpAccPedalChanged(int newAccPedal)
-{
-    if (m_currentSource == SourceType::Udp)
-    {
-        if (m_accPedal != newAccPedal)
-        {
-            m_accPedal = newAccPedal;
-            emit accPedalChanged(m_accPedal);
-        }
-    }
-}
-
-void CommunicationManager::handleUdpBrakePedalChanged(int newBrakePedal)
-{
-    if (m_currentSource == SourceType::Udp)
-    {
-        if (m_brakePedal != newBrakePedal)
-        {
-            m_brakePedal = newBrakePedal;
-            emit brakePedalChanged(m_brakePedal);
-        }
-    }
-}
-
-void CommunicationManager::handleUdpEncoderAngleChanged(double newAngle)
-{
-    if (m_currentSource == SourceType::Udp)
-    {
-        if (m_encoderAngle != newAngle)
-        {
-            m_encoderAngle = newAngle;
-            emit encoderAngleChanged(m_encoderAngle);
-        }
-    }
-}
-
-void CommunicationManager::handleUdpTemperatureChanged(float newTemperature)
-{
-    if (m_currentSource == SourceType::Udp)
-    {
-        if (m_temperature != newTemperature)
-        {
-            m_temperature = newTemperature;
-            emit temperatureChanged(m_temperature);
-        }
-    }
-}
-
-void CommunicationManager::handleUdpBatteryLevelChanged(int newBatteryLevel)
-{
-    if (m_currentSource == SourceType::Udp)
-    {
-        if (m_batteryLevel != newBatteryLevel)
-        {
-            m_batteryLevel = newBatteryLevel;
-            emit batteryLevelChanged(m_batteryLevel);
-        }
-    }
-}
-
-void CommunicationManager::handleUdpGpsLongitudeChanged(double newLongitude)
-{
-    if (m_currentSource == SourceType::Udp)
-    {
-        if (m_gpsLongitude != newLongitude)
-        {
-            m_gpsLongitude = newLongitude;
-            emit gpsLongitudeChanged(m_gpsLongitude);
-        }
-    }
-}
-
-void CommunicationManager::handleUdpGpsLatitudeChanged(double newGpsLatitude)
-{
-    if (m_currentSource == SourceType::Udp)
-    {
-        if (m_gpsLatitude != newGpsLatitude)
-        {
-            m_gpsLatitude = newGpsLatitude;
-            emit gpsLatitudeChanged(m_gpsLatitude);
-        }
-    }
-}
-
-void CommunicationManager::handleUdpSpeedFLChanged(int newSpeedFL)
-{
-    if (m_currentSource == SourceType::Udp)
-    {
-        if (m_speedFL != newSpeedFL)
-        {
-            m_speedFL = newSpeedFL;
-            emit speedFLChanged(m_speedFL);
-        }
-    }
-}
-
-void CommunicationManager::handleUdpSpeedFRChanged(int newSpeedFR)
-{
-    if (m_currentSource == SourceType::Udp)
-    {
-        if (m_speedFR != newSpeedFR)
-        {
-            m_speedFR = newSpeedFR;
-            emit speedFRChanged(m_speedFR);
-        }
-    }
-}
-
-void CommunicationManager::handleUdpSpeedBLChanged(int newSpeedBL)
-{
-    if (m_currentSource == SourceType::Udp)
-    {
-        if (m_speedBL != newSpeedBL)
-        {
-            m_speedBL = newSpeedBL;
-            emit speedBLChanged(m_speedBL);
-        }
-    }
-}
-
-void CommunicationManager::handleUdpSpeedBRChanged(int newSpeedBR)
-{
-    if (m_currentSource == SourceType::Udp)
-    {
-        if (m_speedBR != newSpeedBR)
-        {
-            m_speedBR = newSpeedBR;
-            emit speedBRChanged(m_speedBR);
-        }
-    }
-}
-
-void CommunicationManager::handleUdpLateralGChanged(double newLateralG)
-{
-    if (m_currentSource == SourceType::Udp)
-    {
-        if (m_lateralG != newLateralG)
-        {
-            m_lateralG = newLateralG;
-            emit lateralGChanged(m_lateralG);
-        }
-    }
-}
-
-void CommunicationManager::handleUdpLongitudinalGChanged(double newLongitudinalG)
-{
-    if (m_currentSource == SourceType::Udp)
-    {
-        if (m_longitudinalG != newLongitudinalG)
-        {
-            m_longitudinalG = newLongitudinalG;
-            emit longitudinalGChanged(m_longitudinalG);
-        }
-    }
-}
-
-void CommunicationManager::handleSerialSpeedChanged(float newSpeed)
-{
-    if (m_currentSource == SourceType::Serial)
-    {
-        if (m_speed != newSpeed)
-        {
-            m_speed = newSpeed;
-            emit speedChanged(m_speed);
-        }
-    }
-}
-
-void CommunicationManager::handleSerialRpmChanged(int newRpm)
+void CommunicationManager::handleReplayError(const QString &error)
 {
-    if (m_currentSource == SourceType::Serial)
-    {
-        if (m_rpm != newRpm)
-        {
-            m_rpm = newRpm;
-            emit rpmChanged(m_rpm);
-        }
-    }
+    emit errorOccurred(error);
 }
 
-void CommunicationManager::handleSerialAccPedalChanged(int newAccPedal)
+void CommunicationManager::attachWindow(QQuickWindow *window)
 {
-    if (m_currentSource == SourceType::Serial)
+    if (m_window)
     {
-        if (m_accPedal != newAccPedal)
-        {
-            m_accPedal = newAccPedal;
-            emit accPedalChanged(m_accPedal);
-        }
+        disconnect(m_window, &QQuickWindow::afterAnimating, this, &CommunicationManager::deliverFrame);
     }
-}
 
-void CommunicationManager::handleSerialBrakePedalChanged(int newBrakePedal)
-{
-    if (m_currentSource == SourceType::Serial)
-    {
-        if (m_brakePedal != newBrakePedal)
-        {
-            m_brakePedal = newBrakePedal;
-            emit brakePedalChanged(m_brakePedal);
-        }
-    }
-}
+    m_window = window;
 
-void CommunicationManager::handleSerialEncoderAngleChanged(double newAngle)
-{
-    if (m_currentSource == SourceType::Serial)
+    if (m_window)
     {
-        if (m_encoderAngle != newAngle)
-        {
-            m_encoderAngle = newAngle;
-            emit encoderAngleChanged(m_encoderAngle);
-        }
+        // afterAnimating is emitted on the GUI thread at the start of every frame, before polish and sync
+        connect(m_window, &QQuickWindow::afterAnimating, this, &CommunicationManager::deliverFrame);
+        m_frameTimer.stop();
     }
 }
 
-void CommunicationManager::handleSerialTemperatureChanged(float newTemperature)
+void CommunicationManager::handleFrame(const TelemetryFrame &frame)
 {
-    if (m_currentSource == SourceType::Serial)
-    {
-        if (m_temperature != newTemperature)
-        {
-            m_temperature = newTemperature;
-            emit temperatureChanged(m_temperature);
-        }
-    }
-}
+    m_history.append(frame);
+    m_recorder->append(frame);
+    m_blackBox->append(frame);
 
-void CommunicationManager::handleSerialBatteryLevelChanged(int newBatteryLevel)
-{
-    if (m_currentSource == SourceType::Serial)
+    // Only the first frame after a delivery needs to wake the GUI thread, the store already holds the latest one.
+    // While rewound the UI shows a fixed moment, so new frames do not wake it at all.
+    if (m_live.load(std::memory_order_relaxed) && !m_frameRequested.exchange(true))
     {
-        if (m_batteryLevel != newBatteryLevel)
-        {
-            m_batteryLevel = newBatteryLevel;
-            emit batteryLevelChanged(m_batteryLevel);
-        }
+        QMetaObject::invokeMethod(this, &CommunicationManager::requestFrame, Qt::QueuedConnection);
     }
 }
 
-void CommunicationManager::handleSerialGpsLongitudeChanged(double newLongitude)
+void CommunicationManager::requestFrame()
 {
-    if (m_currentSource == SourceType::Serial)
+    if (m_window)
     {
-        if (m_gpsLongitude != newLongitude)
-        {
-            m_gpsLongitude = newLongitude;
-            emit gpsLongitudeChanged(m_gpsLongitude);
-        }
+        m_window->requestUpdate();
     }
-}
-
-void CommunicationManager::handleSerialGpsLatitudeChanged(double newGpsLatitude)
-{
-    if (m_currentSource == SourceType::Serial)
+    else if (!m_frameTimer.isActive())
     {
-        if (m_gpsLatitude != newGpsLatitude)
-        {
-            m_gpsLatitude = newGpsLatitude;
-            emit gpsLatitudeChanged(m_gpsLatitude);
-        }
+        m_frameTimer.start();
     }
 }
 
-void CommunicationManager::handleSerialSpeedFLChanged(int newSpeedFL)
+void CommunicationManager::deliverFrame()
 {
-    if (m_currentSource == SourceType::Serial)
-    {
-        if (m_speedFL != newSpeedFL)
-        {
-            m_speedFL = newSpeedFL;
-            emit speedFLChanged(m_speedFL);
-        }
-    }
-}
+    // Re-arm the wake-up before reading, a frame published after this point requests the next delivery
+    m_frameRequested.store(false);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
 
-void CommunicationManager::handleSerialSpeedFRChanged(int newSpeedFR)
-{
-    if (m_currentSource == SourceType::Serial)
+    bool newFrame = false;
+    if (m_live.load(std::memory_order_relaxed))
     {
-        if (m_speedFR != newSpeedFR)
-        {
-            m_speedFR = newSpeedFR;
-            emit speedFRChanged(m_speedFR);
-        }
+        const TelemetryStore *store = m_activeStore.load(std::memory_order_acquire);
+        newFrame = store && store->readIfNewer(m_deliveredVersion, m_rawFrame);
     }
-}
-
-void CommunicationManager::handleSerialSpeedBLChanged(int newSpeedBL)
-{
-    if (m_currentSource == SourceType::Serial)
+    else if (m_rewindPending)
     {
-        if (m_speedBL != newSpeedBL)
-        {
-            m_speedBL = newSpeedBL;
-            emit speedBLChanged(m_speedBL);
-        }
+        // The snapshot is delivered once, the history keeps filling behind it
+        newFrame = m_history.frameAt(m_rewindTimeUs, m_rawFrame);
+        m_rewindPending = false;
     }
-}
-
-void CommunicationManager::handleSerialSpeedBRChanged(int newSpeedBR)
-{
-    if (m_currentSource == SourceType::Serial)
+    bool changed = false;
+    m_framesDelivered += newFrame ? 1 : 0;
+    if (newFrame || m_changeFilter.hasPending())
     {
-        if (m_speedBR != newSpeedBR)
+        changed = m_changeFilter.apply(m_rawFrame, m_frame, m_clock.elapsed());
+        if (changed)
         {
-            m_speedBR = newSpeedBR;
-            emit speedBRChanged(m_speedBR);
+            emit telemetryChanged();
         }
-    }
-}
 
-void CommunicationManager::handleSerialLateralGChanged(double newLateralG)
-{
-    if (m_currentSource == SourceType::Serial)
-    {
-        if (m_lateralG != newLateralG)
+        // Changes held back by a minimum notify interval need another frame even if no new data arrives
+        if (m_changeFilter.hasPending())
         {
-            m_lateralG = newLateralG;
-            emit lateralGChanged(m_lateralG);
+            requestFrame();
         }
     }
-}
 
-void CommunicationManager::handleSerialLongitudinalGChanged(double newLongitudinalG)
-{
-    if (m_currentSource == SourceType::Serial)
+    // Feeds that are not due yet get the frame later, the timer brings the frame clock back for them
+    const qint64 nowMs = m_clock.elapsed();
+    const qint64 nextDueMs = m_governor.deliver(m_frame, changed, nowMs);
+    if (nextDueMs >= 0 && nextDueMs <= nowMs)
     {
-        if (m_longitudinalG != newLongitudinalG)
-        {
-            m_longitudinalG = newLongitudinalG;
-            emit longitudinalGChanged(m_longitudinalG);
-        }
+        requestFrame();
     }
-}
-
-void CommunicationManager::handleMqttSpeedChanged(float newSpeed)
-{
-    if (m_currentSource == SourceType::Mqtt)
+    else if (nextDueMs > nowMs)
     {
-        if (m_speed != newSpeed)
-        {
-            m_speed = newSpeed;
-            emit speedChanged(m_speed);
-        }
+        m_governorTimer.start(int(nextDueMs - nowMs));
     }
 }
 
-void CommunicationManager::handleMqttRpmChanged(int newRpm)
+bool CommunicationManager::rewind(double secondsAgo)
 {
-    if (m_currentSource == SourceType::Mqtt)
+    // Relative to the newest sample rather than the clock, so a source that went quiet can be rewound too
+    const TelemetryHistory::View newest = m_history.latest(1);
+    if (newest.isEmpty())
     {
-        if (m_rpm != newRpm)
-        {
-            m_rpm = newRpm;
-            emit rpmChanged(m_rpm);
-        }
+        qDebug() << "CommunicationManager: Nothing to rewind, the history is empty";
+        return false;
     }
-}
 
-void CommunicationManager::handleMqttAccPedalChanged(int newAccPedal)
-{
-    if (m_currentSource == SourceType::Mqtt)
+    m_rewindSeconds = qMax(0.0, secondsAgo);
+    m_rewindTimeUs = m_history.times(newest).at(0) - qint64(m_rewindSeconds * 1e6);
+    m_rewindPending = true;
+    if (m_live.exchange(false))
     {
-        if (m_accPedal != newAccPedal)
-        {
-            m_accPedal = newAccPedal;
-            emit accPedalChanged(m_accPedal);
-        }
+        m_changeFilter.reset();
     }
-}
 
-void CommunicationManager::handleMqttBrakePedalChanged(int newBrakePedal)
-{
-    if (m_currentSource == SourceType::Mqtt)
-    {
-        if (m_brakePedal != newBrakePedal)
-        {
-            m_brakePedal = newBrakePedal;
-            emit brakePedalChanged(m_brakePedal);
-        }
-    }
+    emit rewindChanged();
+    requestFrame();
+    return true;
 }
 
-void CommunicationManager::handleMqttEncoderAngleChanged(double newAngle)
+void CommunicationManager::goLive()
 {
-    if (m_currentSource == SourceType::Mqtt)
+    if (m_live.load(std::memory_order_relaxed))
     {
-        if (m_encoderAngle != newAngle)
-        {
-            m_encoderAngle = newAngle;
-            emit encoderAngleChanged(m_encoderAngle);
-        }
+        return;
     }
-}
 
-void CommunicationManager::handleMqttTemperatureChanged(float newTemperature)
-{
-    if (m_currentSource == SourceType::Mqtt)
-    {
-        if (m_temperature != newTemperature)
-        {
-            m_temperature = newTemperature;
-            emit temperatureChanged(m_temperature);
-        }
-    }
-}
+    // Not a version the store can have, so the latest frame is delivered even if none arrived while rewound
+    m_deliveredVersion = ~quint64(0);
+    m_changeFilter.reset();
+    m_rewindPending = false;
+    m_rewindSeconds = 0.0;
+    m_live.store(true, std::memory_order_relaxed);
 
-void CommunicationManager::handleMqttBatteryLevelChanged(int newBatteryLevel)
-{
-    if (m_currentSource == SourceType::Mqtt)
-    {
-        if (m_batteryLevel != newBatteryLevel)
-        {
-            m_batteryLevel = newBatteryLevel;
-            emit batteryLevelChanged(m_batteryLevel);
-        }
-    }
+    emit rewindChanged();
+    requestFrame();
 }
 
-void CommunicationManager::handleMqttGpsLongitudeChanged(double newLongitude)
+double CommunicationManager::historySeconds() const
 {
-    if (m_currentSource == SourceType::Mqtt)
+    const TelemetryHistory::View view = m_history.all();
+    if (view.size() < 2)
     {
-        if (m_gpsLongitude != newLongitude)
-        {
-            m_gpsLongitude = newLongitude;
-            emit gpsLongitudeChanged(m_gpsLongitude);
-        }
+        return 0.0;
     }
-}
 
-void CommunicationManager::handleMqttGpsLatitudeChanged(double newGpsLatitude)
-{
-    if (m_currentSource == SourceType::Mqtt)
-    {
-        if (m_gpsLatitude != newGpsLatitude)
-        {
-            m_gpsLatitude = newGpsLatitude;
-            emit gpsLatitudeChanged(m_gpsLatitude);
-        }
-    }
+    const TelemetryRingSpan<qint64> times = m_history.times(view);
+    const double seconds = (times.at(times.size() - 1) - times.at(0)) / 1e6;
+    return m_history.isValid(view) ? seconds : 0.0;
 }
 
-void CommunicationManager::handleMqttSpeedFLChanged(int newSpeedFL)
+TelemetrySourceStats CommunicationManager::sourceStats()
 {
-    if (m_currentSource == SourceType::Mqtt)
+    switch (m_currentSource)
     {
-        if (m_speedFL != newSpeedFL)
-        {
-            m_speedFL = newSpeedFL;
-            emit speedFLChanged(m_speedFL);
-        }
+    case SourceType::Serial:
+        return m_serialManager->stats();
+    case SourceType::Udp:
+        return m_udpClient->stats();
+    case SourceType::Mqtt:
+        return m_mqttClient->stats();
+    case SourceType::Replay:
+        return m_replayClient->stats();
+    case SourceType::None:
+        break;
     }
+    return TelemetrySourceStats();
 }
 
-void CommunicationManager::handleMqttSpeedFRChanged(int newSpeedFR)
+void CommunicationManager::addFeed(TelemetryFeed *feed)
 {
-    if (m_currentSource == SourceType::Mqtt)
-    {
-        if (m_speedFR != newSpeedFR)
-        {
-            m_speedFR = newSpeedFR;
-            emit speedFRChanged(m_speedFR);
-        }
-    }
+    m_governor.addFeed(feed);
+    requestFrame();
 }
 
-void CommunicationManager::handleMqttSpeedBLChanged(int newSpeedBL)
+void CommunicationManager::removeFeed(TelemetryFeed *feed)
 {
-    if (m_currentSource == SourceType::Mqtt)
-    {
-        if (m_speedBL != newSpeedBL)
-        {
-            m_speedBL = newSpeedBL;
-            emit speedBLChanged(m_speedBL);
-        }
-    }
+    m_governor.removeFeed(feed);
 }
 
-void CommunicationManager::handleMqttSpeedBRChanged(int newSpeedBR)
+void CommunicationManager::setUpdateBudget(double budgetMs)
 {
-    if (m_currentSource == SourceType::Mqtt)
-    {
-        if (m_speedBR != newSpeedBR)
-        {
-            m_speedBR = newSpeedBR;
-            emit speedBRChanged(m_speedBR);
-        }
-    }
+    m_governor.setFrameBudgetMs(budgetMs);
 }
 
-void CommunicationManager::handleMqttLateralGChanged(double newLateralG)
+bool CommunicationManager::setChannelNotifyPolicy(const QString &channel, double deadband, double hysteresis, int minIntervalMs)
 {
-    if (m_currentSource == SourceType::Mqtt)
+    const TelemetryChannelInfo *info = findTelemetryChannel(channel);
+    if (!info)
     {
-        if (m_lateralG != newLateralG)
-        {
-            m_lateralG = newLateralG;
-            emit lateralGChanged(m_lateralG);
-        }
+        qDebug() << "CommunicationManager: Unknown telemetry channel" << channel;
+        return false;
     }
-}
 
-void CommunicationManager::handleMqttLongitudinalGChanged(double newLongitudinalG)
-{
-    if (m_currentSource == SourceType::Mqtt)
-    {
-        if (m_longitudinalG != newLongitudinalG)
-        {
-            m_longitudinalG = newLongitudinalG;
-            emit longitudinalGChanged(m_longitudinalG);
-        }
-    }
+    TelemetryNotifyPolicy policy;
+    policy.deadband = qMax(0.0, deadband);
+    policy.hysteresis = qMax(0.0, hysteresis);
+    policy.minIntervalMs = qMax(0, minIntervalMs);
+    m_changeFilter.setPolicy(info->channel, policy);
+    return true;
 }
-
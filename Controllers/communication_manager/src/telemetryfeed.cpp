@@ -0,0 +1,68 @@
+#include "../include/telemetryfeed.h"
+#include "../include/communicationmanager.h"
+
+TelemetryFeed::TelemetryFeed(QObject *parent)
+    : QObject(parent),
+    m_maxRate(0.0),
+    m_priority(Normal)
+{
+}
+
+TelemetryFeed::~TelemetryFeed()
+{
+    if (m_source)
+    {
+        m_source->removeFeed(this);
+    }
+}
+
+void TelemetryFeed::setSource(CommunicationManager *source)
+{
+    if (m_source == source)
+    {
+        return;
+    }
+
+    if (m_source)
+    {
+        m_source->removeFeed(this);
+    }
+
+    m_source = source;
+
+    if (m_source)
+    {
+        // The current frame is delivered with the next rendered frame
+        m_source->addFeed(this);
+    }
+    emit sourceChanged();
+}
+
+void TelemetryFeed::setMaxRate(double rate)
+{
+    rate = qMax(0.0, rate);
+    if (m_maxRate == rate)
+    {
+        return;
+    }
+
+    m_maxRate = rate;
+    emit maxRateChanged();
+}
+
+void TelemetryFeed::setPriority(Priority priority)
+{
+    if (m_priority == priority)
+    {
+        return;
+    }
+
+    m_priority = priority;
+    emit priorityChanged();
+}
+
+void TelemetryFeed::deliver(const TelemetryFrame &frame)
+{
+    m_frame = frame;
+    emit updated();
+}
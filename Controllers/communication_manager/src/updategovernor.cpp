@@ -0,0 +1,120 @@
+#include "../include/updategovernor.h"
+#include "../include/telemetryfeed.h"
+#include <QElapsedTimer>
+#include <algorithm>
+
+namespace
+{
+// Time per frame for feed updates before lower priorities wait, leaves most of a 60 Hz frame to rendering
+constexpr double DefaultFrameBudgetMs = 4.0;
+}
+
+UpdateGovernor::UpdateGovernor()
+    : m_version(0),
+    m_frameBudgetMs(DefaultFrameBudgetMs)
+{
+}
+
+void UpdateGovernor::addFeed(TelemetryFeed *feed)
+{
+    for (const Entry &entry : m_entries)
+    {
+        if (entry.feed == feed)
+        {
+            return;
+        }
+    }
+
+    Entry entry;
+    entry.feed = feed;
+    m_entries.append(entry);
+}
+
+void UpdateGovernor::removeFeed(TelemetryFeed *feed)
+{
+    // Only cleared here, a feed may be destroyed by QML from within its own update
+    for (Entry &entry : m_entries)
+    {
+        if (entry.feed == feed)
+        {
+            entry.feed = nullptr;
+        }
+    }
+}
+
+qint64 UpdateGovernor::deliver(const TelemetryFrame &frame, bool changed, qint64 nowMs)
+{
+    m_entries.removeIf([](const Entry &entry) { return entry.feed == nullptr; });
+
+    if (changed)
+    {
+        ++m_version;
+    }
+
+    qint64 nextDueMs = -1;
+    m_due.clear();
+    for (qsizetype i = 0; i < m_entries.size(); ++i)
+    {
+        const Entry &entry = m_entries.at(i);
+        if (entry.deliveredVersion == m_version)
+        {
+            continue;
+        }
+
+        const double maxRate = entry.feed->maxRate();
+        const qint64 intervalMs = maxRate > 0.0 ? qRound64(1000.0 / maxRate) : 0;
+        const qint64 dueMs = entry.lastDeliveryMs < 0 ? nowMs : entry.lastDeliveryMs + intervalMs;
+        if (dueMs <= nowMs)
+        {
+            m_due.append(i);
+        }
+        else
+        {
+            nextDueMs = nextDueMs < 0 ? dueMs : qMin(nextDueMs, dueMs);
+        }
+    }
+
+    if (m_due.isEmpty())
+    {
+        return nextDueMs;
+    }
+
+    // Highest priority first, then the feed that waited longest
+    std::sort(m_due.begin(), m_due.end(), [this](qsizetype a, qsizetype b)
+    {
+        const Entry &first = m_entries.at(a);
+        const Entry &second = m_entries.at(b);
+        if (first.feed->priority() != second.feed->priority())
+        {
+            return first.feed->priority() > second.feed->priority();
+        }
+        return first.lastDeliveryMs < second.lastDeliveryMs;
+    });
+
+    QElapsedTimer spent;
+    spent.start();
+    const qint64 budgetNs = qint64(m_frameBudgetMs * 1000000.0);
+
+    for (const qsizetype index : m_due)
+    {
+        // Indices stay valid, feeds added by an update are appended and removed ones only cleared
+        TelemetryFeed *feed = m_entries.at(index).feed;
+        if (!feed)
+        {
+            continue;
+        }
+
+        if (feed->priority() != TelemetryFeed::High && spent.nsecsElapsed() > budgetNs)
+        {
+            // Over budget, the feed stays due and is served first in the next frame
+            nextDueMs = nowMs;
+            continue;
+        }
+
+        m_entries[index].deliveredVersion = m_version;
+        m_entries[index].lastDeliveryMs = nowMs;
+        feed->deliver(frame);
+    }
+
+    return nextDueMs;
+}
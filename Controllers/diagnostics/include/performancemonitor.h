@@ -0,0 +1,129 @@
+#ifndef PERFORMANCEMONITOR_H
+#define PERFORMANCEMONITOR_H
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <atomic>
+#include "../../telemetry/include/telemetrysourcestats.h"
+
+// Forward declarations
+class CommunicationManager;
+class QQuickWindow;
+
+/**
+ * @brief The PerformanceMonitor class measures the render loop and the telemetry pipeline for the overlay
+ *
+ * Frame, sync and render times are taken on the render thread from the window's frame signals, the GUI
+ * event-loop latency from how late a short precise timer fires, and the pipeline rates from the
+ * counters of the active source. Figures are published twice a second. While disabled nothing is
+ * connected and no timer runs, so the monitor costs nothing when the overlay is hidden.
+ */
+class PerformanceMonitor : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+
+    Q_PROPERTY(double fps READ fps NOTIFY updated)
+    Q_PROPERTY(double frameTimeMs READ frameTimeMs NOTIFY updated)
+    Q_PROPERTY(double frameTimeMaxMs READ frameTimeMaxMs NOTIFY updated)
+    Q_PROPERTY(double syncTimeMs READ syncTimeMs NOTIFY updated)
+    Q_PROPERTY(double renderTimeMs READ renderTimeMs NOTIFY updated)
+    Q_PROPERTY(double eventLoopLatencyMs READ eventLoopLatencyMs NOTIFY updated)
+    Q_PROPERTY(double receivedRate READ receivedRate NOTIFY updated)
+    Q_PROPERTY(double parsedRate READ parsedRate NOTIFY updated)
+    Q_PROPERTY(double deliveredRate READ deliveredRate NOTIFY updated)
+    Q_PROPERTY(qint64 queueDepth READ queueDepth NOTIFY updated)
+    Q_PROPERTY(qint64 dropped READ dropped NOTIFY updated)
+
+public:
+    explicit PerformanceMonitor(QObject *parent = nullptr);
+    ~PerformanceMonitor();
+
+    void attachWindow(QQuickWindow *window);
+    void setSource(CommunicationManager *source);
+
+    bool isEnabled() const { return m_enabled; }
+    void setEnabled(bool enabled);
+
+    double fps() const { return m_fps; }                 // Frames presented per second.
+    double frameTimeMs() const { return m_frameTimeMs; } // Mean time between presented frames.
+    double frameTimeMaxMs() const { return m_frameTimeMaxMs; }
+    double syncTimeMs() const { return m_syncTimeMs; }     // Mean scene-graph synchronization time, GUI thread blocked.
+    double renderTimeMs() const { return m_renderTimeMs; } // Mean render pass recording time on the render thread.
+    double eventLoopLatencyMs() const { return m_eventLoopLatencyMs; } // Worst delay of a GUI timer in the last period.
+    double receivedRate() const { return m_receivedRate; }   // Messages per second from the active source.
+    double parsedRate() const { return m_parsedRate; }       // Frames per second out of the parsers.
+    double deliveredRate() const { return m_deliveredRate; } // Frames per second applied to the UI.
+    qint64 queueDepth() const { return m_queueDepth; }
+    qint64 dropped() const { return m_dropped; }
+
+signals:
+    void enabledChanged();
+    void updated();
+
+private slots:
+    // Render thread
+    void beginSync();
+    void endSync();
+    void beginRender();
+    void endRender();
+    void frameSwapped();
+
+    // GUI thread
+    void probe();
+    void publish();
+
+private:
+    struct Accumulator
+    {
+        std::atomic<qint64> totalNs{0};
+        std::atomic<qint64> maxNs{0};
+        std::atomic<qint64> count{0};
+
+        void add(qint64 ns);
+    };
+
+    void connectWindow();
+    void disconnectWindow();
+
+    QPointer<QQuickWindow> m_window;
+    QPointer<CommunicationManager> m_source;
+    bool m_enabled;
+
+    QElapsedTimer m_clock; // Shared by both threads, reading it is thread-safe
+    QTimer m_probeTimer;
+    QTimer m_publishTimer;
+
+    // Render thread only
+    qint64 m_syncStartNs;
+    qint64 m_renderStartNs;
+    qint64 m_lastSwapNs;
+
+    Accumulator m_frames;
+    Accumulator m_sync;
+    Accumulator m_render;
+
+    // GUI thread only
+    qint64 m_expectedProbeNs;
+    qint64 m_maxProbeLatencyNs;
+    qint64 m_lastPublishNs;
+    TelemetrySourceStats m_lastStats;
+    quint64 m_lastDelivered;
+
+    double m_fps;
+    double m_frameTimeMs;
+    double m_frameTimeMaxMs;
+    double m_syncTimeMs;
+    double m_renderTimeMs;
+    double m_eventLoopLatencyMs;
+    double m_receivedRate;
+    double m_parsedRate;
+    double m_deliveredRate;
+    qint64 m_queueDepth;
+    qint64 m_dropped;
+};
+
+#endif // PERFORMANCEMONITOR_H
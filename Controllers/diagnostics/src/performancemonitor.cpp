@@ -0,0 +1,231 @@
+#include "../include/performancemonitor.h"
+#include "../../communication_manager/include/communicationmanager.h"
+#include <QQuickWindow>
+
+namespace
+{
+// Interval of the GUI latency probe, short enough to catch single long stalls
+constexpr int ProbeIntervalMs = 20;
+
+// Interval at which the figures are published to QML
+constexpr int PublishIntervalMs = 500;
+
+double perSecond(quint64 current, quint64 previous, qint64 elapsedNs)
+{
+    // A counter that went backwards belongs to a new source
+    if (elapsedNs <= 0 || current < previous)
+    {
+        return 0.0;
+    }
+    return double(current - previous) * 1e9 / double(elapsedNs);
+}
+}
+
+void PerformanceMonitor::Accumulator::add(qint64 ns)
+{
+    totalNs.fetch_add(ns, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+
+    qint64 previous = maxNs.load(std::memory_order_relaxed);
+    while (ns > previous && !maxNs.compare_exchange_weak(previous, ns, std::memory_order_relaxed))
+    {
+    }
+}
+
+PerformanceMonitor::PerformanceMonitor(QObject *parent)
+    : QObject(parent),
+    m_enabled(false),
+    m_syncStartNs(0),
+    m_renderStartNs(0),
+    m_lastSwapNs(-1),
+    m_expectedProbeNs(0),
+    m_maxProbeLatencyNs(0),
+    m_lastPublishNs(0),
+    m_lastDelivered(0),
+    m_fps(0.0),
+    m_frameTimeMs(0.0),
+    m_frameTimeMaxMs(0.0),
+    m_syncTimeMs(0.0),
+    m_renderTimeMs(0.0),
+    m_eventLoopLatencyMs(0.0),
+    m_receivedRate(0.0),
+    m_parsedRate(0.0),
+    m_deliveredRate(0.0),
+    m_queueDepth(0),
+    m_dropped(0)
+{
+    m_clock.start();
+
+    m_probeTimer.setTimerType(Qt::PreciseTimer);
+    m_probeTimer.setInterval(ProbeIntervalMs);
+    connect(&m_probeTimer, &QTimer::timeout, this, &PerformanceMonitor::probe);
+
+    m_publishTimer.setInterval(PublishIntervalMs);
+    connect(&m_publishTimer, &QTimer::timeout, this, &PerformanceMonitor::publish);
+}
+
+PerformanceMonitor::~PerformanceMonitor()
+{
+    disconnectWindow();
+}
+
+void PerformanceMonitor::attachWindow(QQuickWindow *window)
+{
+    disconnectWindow();
+    m_window = window;
+    if (m_enabled)
+    {
+        connectWindow();
+    }
+}
+
+void PerformanceMonitor::setSource(CommunicationManager *source)
+{
+    m_source = source;
+    m_lastStats = m_source ? m_source->sourceStats() : TelemetrySourceStats();
+    m_lastDelivered = m_source ? m_source->framesDelivered() : 0;
+}
+
+void PerformanceMonitor::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled)
+    {
+        return;
+    }
+
+    m_enabled = enabled;
+    if (m_enabled)
+    {
+        connectWindow();
+
+        // Start every figure from a clean period
+        m_frames.totalNs.store(0);
+        m_frames.maxNs.store(0);
+        m_frames.count.store(0);
+        m_sync.totalNs.store(0);
+        m_sync.count.store(0);
+        m_render.totalNs.store(0);
+        m_render.count.store(0);
+        m_maxProbeLatencyNs = 0;
+        m_lastPublishNs = m_clock.nsecsElapsed();
+        m_expectedProbeNs = m_lastPublishNs + qint64(ProbeIntervalMs) * 1000000;
+        setSource(m_source);
+
+        m_probeTimer.start();
+        m_publishTimer.start();
+    }
+    else
+    {
+        m_probeTimer.stop();
+        m_publishTimer.stop();
+        disconnectWindow();
+    }
+    emit enabledChanged();
+}
+
+void PerformanceMonitor::connectWindow()
+{
+    if (!m_window)
+    {
+        return;
+    }
+
+    m_lastSwapNs = -1;
+
+    // Emitted on the render thread, the slots only touch atomics and render-thread members
+    connect(m_window, &QQuickWindow::beforeSynchronizing, this, &PerformanceMonitor::beginSync, Qt::DirectConnection);
+    connect(m_window, &QQuickWindow::afterSynchronizing, this, &PerformanceMonitor::endSync, Qt::DirectConnection);
+    connect(m_window, &QQuickWindow::beforeRendering, this, &PerformanceMonitor::beginRender, Qt::DirectConnection);
+    connect(m_window, &QQuickWindow::afterRendering, this, &PerformanceMonitor::endRender, Qt::DirectConnection);
+    connect(m_window, &QQuickWindow::frameSwapped, this, &PerformanceMonitor::frameSwapped, Qt::DirectConnection);
+}
+
+void PerformanceMonitor::disconnectWindow()
+{
+    if (!m_window)
+    {
+        return;
+    }
+
+    disconnect(m_window, &QQuickWindow::beforeSynchronizing, this, &PerformanceMonitor::beginSync);
+    disconnect(m_window, &QQuickWindow::afterSynchronizing, this, &PerformanceMonitor::endSync);
+    disconnect(m_window, &QQuickWindow::beforeRendering, this, &PerformanceMonitor::beginRender);
+    disconnect(m_window, &QQuickWindow::afterRendering, this, &PerformanceMonitor::endRender);
+    disconnect(m_window, &QQuickWindow::frameSwapped, this, &PerformanceMonitor::frameSwapped);
+}
+
+void PerformanceMonitor::beginSync()
+{
+    m_syncStartNs = m_clock.nsecsElapsed();
+}
+
+void PerformanceMonitor::endSync()
+{
+    m_sync.add(m_clock.nsecsElapsed() - m_syncStartNs);
+}
+
+void PerformanceMonitor::beginRender()
+{
+    m_renderStartNs = m_clock.nsecsElapsed();
+}
+
+void PerformanceMonitor::endRender()
+{
+    m_render.add(m_clock.nsecsElapsed() - m_renderStartNs);
+}
+
+void PerformanceMonitor::frameSwapped()
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    if (m_lastSwapNs >= 0)
+    {
+        m_frames.add(now - m_lastSwapNs);
+    }
+    m_lastSwapNs = now;
+}
+
+void PerformanceMonitor::probe()
+{
+    // How much later than scheduled the timer fired is how long the event loop was busy
+    const qint64 now = m_clock.nsecsElapsed();
+    m_maxProbeLatencyNs = qMax(m_maxProbeLatencyNs, now - m_expectedProbeNs);
+    m_expectedProbeNs = now + qint64(ProbeIntervalMs) * 1000000;
+}
+
+void PerformanceMonitor::publish()
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    const qint64 elapsedNs = now - m_lastPublishNs;
+    m_lastPublishNs = now;
+
+    const qint64 frameCount = m_frames.count.exchange(0, std::memory_order_relaxed);
+    const qint64 frameTotalNs = m_frames.totalNs.exchange(0, std::memory_order_relaxed);
+    const qint64 frameMaxNs = m_frames.maxNs.exchange(0, std::memory_order_relaxed);
+    const qint64 syncCount = m_sync.count.exchange(0, std::memory_order_relaxed);
+    const qint64 syncTotalNs = m_sync.totalNs.exchange(0, std::memory_order_relaxed);
+    const qint64 renderCount = m_render.count.exchange(0, std::memory_order_relaxed);
+    const qint64 renderTotalNs = m_render.totalNs.exchange(0, std::memory_order_relaxed);
+
+    m_fps = elapsedNs > 0 ? double(frameCount) * 1e9 / double(elapsedNs) : 0.0;
+    m_frameTimeMs = frameCount > 0 ? double(frameTotalNs) / double(frameCount) / 1e6 : 0.0;
+    m_frameTimeMaxMs = double(frameMaxNs) / 1e6;
+    m_syncTimeMs = syncCount > 0 ? double(syncTotalNs) / double(syncCount) / 1e6 : 0.0;
+    m_renderTimeMs = renderCount > 0 ? double(renderTotalNs) / double(renderCount) / 1e6 : 0.0;
+    m_eventLoopLatencyMs = double(qMax<qint64>(0, m_maxProbeLatencyNs)) / 1e6;
+    m_maxProbeLatencyNs = 0;
+
+    if (m_source)
+    {
+        const TelemetrySourceStats stats = m_source->sourceStats();
+        const quint64 delivered = m_source->framesDelivered();
+        m_receivedRate = perSecond(stats.received, m_lastStats.received, elapsedNs);
+        m_parsedRate = perSecond(stats.parsed, m_lastStats.parsed, elapsedNs);
+        m_deliveredRate = perSecond(delivered, m_lastDelivered, elapsedNs);
+        m_queueDepth = stats.queued;
+        m_dropped = qint64(stats.dropped);
+        m_lastStats = stats;
+        m_lastDelivered = delivered;
+    }
+
+    emit updated();
+}
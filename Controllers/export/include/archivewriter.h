@@ -0,0 +1,31 @@
+#ifndef ARCHIVEWRITER_H
+#define ARCHIVEWRITER_H
+
+#include <QIODevice>
+#include <QString>
+#include "exportprogress.h"
+#include "../../recording/include/sessionreader.h"
+
+/**
+ * @brief The ArchiveWriter class compacts a recorded session into a Gorilla-compressed .tlz archive
+ *
+ * Every block of the log becomes one archive segment. A window of blocks is encoded at a time, one
+ * block per worker, and written in order, so memory stays bounded like in the other writers. The
+ * result loads into a TelemetryArchive, which keeps it compressed in memory.
+ */
+class ArchiveWriter
+{
+public:
+    explicit ArchiveWriter(const SessionReader &reader);
+
+    /**
+     * @brief Write the whole session to a device opened for writing
+     * @return False if writing failed or the export was cancelled, error tells which
+     */
+    bool write(QIODevice &device, ExportProgress &progress, QString *error = nullptr);
+
+private:
+    const SessionReader &m_reader;
+};
+
+#endif // ARCHIVEWRITER_H
@@ -0,0 +1,9 @@
+#ifndef EXPORTENDIAN_H
+#define EXPORTENDIAN_H
+
+#include <QtGlobal>
+
+// The writers copy the native values of a SessionReader into little-endian file formats without swapping
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "The exporters write native values as little-endian");
+
+#endif // EXPORTENDIAN_H
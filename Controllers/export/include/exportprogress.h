@@ -0,0 +1,23 @@
+#ifndef EXPORTPROGRESS_H
+#define EXPORTPROGRESS_H
+
+#include <QtGlobal>
+#include <atomic>
+
+/**
+ * @brief Shared between an export or import running in a background thread and the object that started it
+ *
+ * The writer or importer sets total to the number of values or packets it is going to process, adds
+ * to done as it goes, and stops after the current batch once cancelled is set.
+ */
+struct ExportProgress
+{
+    std::atomic<qint64> total{0};
+    std::atomic<qint64> done{0};
+    std::atomic<bool> cancelled{false};
+
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+    void advance(qint64 values) { done.fetch_add(values, std::memory_order_relaxed); }
+};
+
+#endif // EXPORTPROGRESS_H
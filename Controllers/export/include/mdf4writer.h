@@ -0,0 +1,39 @@
+#ifndef MDF4WRITER_H
+#define MDF4WRITER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include "exportprogress.h"
+#include "../../recording/include/sessionreader.h"
+
+/**
+ * @brief The Mdf4Writer class streams a recorded session into an ASAM MDF 4.1 file
+ *
+ * The file is sorted: every channel group gets its own data group whose records hold a master time
+ * channel in seconds since the start of the recording followed by the group's channels as doubles,
+ * each with its name and unit. All sizes follow from the block directories of the log, so the
+ * metadata is written up front and the data blocks are streamed behind it without seeking back.
+ *
+ * Records are encoded a window of log blocks at a time, one block per worker, which bounds the memory
+ * to the window however long the session is.
+ */
+class Mdf4Writer
+{
+public:
+    explicit Mdf4Writer(const SessionReader &reader);
+
+    /**
+     * @brief Write the whole session to a device opened for writing
+     * @return False if writing failed or the export was cancelled, error tells which
+     */
+    bool write(QIODevice &device, ExportProgress &progress, QString *error = nullptr);
+
+private:
+    QByteArray buildMetadata(const QList<qint64> &dataSizes) const;
+    bool writeGroup(QIODevice &device, int group, ExportProgress &progress, QString *error);
+
+    const SessionReader &m_reader;
+};
+
+#endif // MDF4WRITER_H
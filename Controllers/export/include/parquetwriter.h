@@ -0,0 +1,52 @@
+#ifndef PARQUETWRITER_H
+#define PARQUETWRITER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QList>
+#include <QString>
+#include "exportprogress.h"
+#include "../../recording/include/sessionreader.h"
+
+/**
+ * @brief The ParquetWriter class streams a recorded session into an Apache Parquet file
+ *
+ * The file holds a UTC timestamp column in microseconds, the sequence number and one double column
+ * per channel, all required and PLAIN encoded without compression. Units go into the key/value
+ * metadata. Rows are cut into row groups of consecutive log blocks; the columns of a row group are
+ * encoded in parallel, written one after the other, and only their offsets and bounds are kept for
+ * the footer, so memory stays at one row group however long the session is.
+ */
+class ParquetWriter
+{
+public:
+    explicit ParquetWriter(const SessionReader &reader);
+
+    /**
+     * @brief Write the whole session to a device opened for writing
+     * @return False if writing failed or the export was cancelled, error tells which
+     */
+    bool write(QIODevice &device, ExportProgress &progress, QString *error = nullptr);
+
+private:
+    struct ColumnChunk
+    {
+        qint64 offset = 0;     // First page header in the file
+        qint64 bytes = 0;      // Page header and values
+        QByteArray minimum;    // PLAIN encoded, empty if the column has no usable bounds
+        QByteArray maximum;
+    };
+
+    struct RowGroup
+    {
+        qint64 rows = 0;
+        QList<ColumnChunk> columns;
+    };
+
+    void encodeColumn(int column, qsizetype firstChunk, qsizetype lastChunk, qint64 rows, QByteArray &buffer, ColumnChunk &chunk) const;
+    QByteArray fileMetadata(const QList<RowGroup> &rowGroups) const;
+
+    const SessionReader &m_reader;
+};
+
+#endif // PARQUETWRITER_H
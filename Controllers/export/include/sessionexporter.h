@@ -0,0 +1,68 @@
+#ifndef SESSIONEXPORTER_H
+#define SESSIONEXPORTER_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include "exportprogress.h"
+
+// Forward declarations
+class QThread;
+
+/**
+ * @brief The SessionExporter class converts a recorded session to MDF4, Parquet or a compressed
+ * archive in the background
+ *
+ * The log is read through a SessionReader and streamed into the target file by Mdf4Writer,
+ * ParquetWriter or ArchiveWriter, which encode columns on the global thread pool. The target is
+ * written through a QSaveFile, so a failed or cancelled export never leaves a truncated file behind.
+ */
+class SessionExporter : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool running READ isRunning NOTIFY runningChanged)
+    Q_PROPERTY(QString outputPath READ outputPath NOTIFY runningChanged)
+    Q_PROPERTY(double progress READ progress NOTIFY progressChanged)
+
+public:
+    explicit SessionExporter(QObject *parent = nullptr);
+    ~SessionExporter();
+
+    /**
+     * @brief Start exporting a session log
+     * @param sessionPath The .tlog file
+     * @param format "mdf4", "parquet" or "tlz"
+     * @param outputPath Target file, empty for the session path with .mf4, .parquet or .tlz
+     * @return False if an export is already running or the format is unknown
+     */
+    Q_INVOKABLE bool start(const QString &sessionPath, const QString &format, const QString &outputPath = QString());
+
+    /**
+     * @brief Stop the running export after its current batch, the target file is discarded
+     */
+    Q_INVOKABLE void cancel();
+
+    bool isRunning() const { return m_thread != nullptr; }
+    QString outputPath() const { return m_outputPath; }
+    double progress() const;
+
+signals:
+    void runningChanged();
+    void progressChanged();
+    void finished(const QString &outputPath);
+    void errorOccurred(const QString &error);
+
+private:
+    enum class Format { Mdf4, Parquet, Archive };
+
+    bool run(const QString &sessionPath, Format format, const QString &outputPath, QString *error); // Runs in the export thread.
+    void handleFinished(bool succeeded, const QString &error);
+
+    QThread *m_thread;
+    QString m_outputPath;
+    QTimer m_progressTimer;
+    ExportProgress m_progress;
+};
+
+#endif // SESSIONEXPORTER_H
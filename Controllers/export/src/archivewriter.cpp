@@ -0,0 +1,64 @@
+#include "../include/archivewriter.h"
+#include "../../telemetry/include/parallelfor.h"
+#include "../../telemetry/include/telemetryarchive.h"
+#include <QThreadPool>
+
+ArchiveWriter::ArchiveWriter(const SessionReader &reader)
+    : m_reader(reader)
+{
+}
+
+bool ArchiveWriter::write(QIODevice &device, ExportProgress &progress, QString *error)
+{
+    progress.total.store(m_reader.frameCount());
+
+    if (!TelemetryArchive::writeHeader(device))
+    {
+        if (error)
+        {
+            *error = device.errorString();
+        }
+        return false;
+    }
+
+    const qsizetype chunkCount = m_reader.chunks().size();
+    const qsizetype window = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    QList<TelemetryArchive::Segment> segments(window);
+
+    for (qsizetype first = 0; first < chunkCount; first += window)
+    {
+        if (progress.isCancelled())
+        {
+            if (error)
+            {
+                *error = QStringLiteral("Export cancelled");
+            }
+            return false;
+        }
+
+        const qsizetype count = qMin(window, chunkCount - first);
+        parallelFor(count, [&](qsizetype i)
+        {
+            std::array<QSpan<const double>, TelemetryChannelCount> columns;
+            for (int channel = 0; channel < TelemetryChannelCount; ++channel)
+            {
+                columns[channel] = m_reader.values(first + i, static_cast<TelemetryChannel>(channel));
+            }
+            segments[i] = TelemetryArchive::encode(m_reader.timestamps(first + i), columns);
+        });
+
+        for (qsizetype i = 0; i < count; ++i)
+        {
+            if (!TelemetryArchive::writeSegment(device, segments.at(i)))
+            {
+                if (error)
+                {
+                    *error = device.errorString();
+                }
+                return false;
+            }
+            progress.advance(segments.at(i).count);
+        }
+    }
+    return true;
+}
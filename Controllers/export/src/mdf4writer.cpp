@@ -0,0 +1,329 @@
+#include "../include/mdf4writer.h"
+#include "../include/exportendian.h"
+#include "../../telemetry/include/parallelfor.h"
+#include <QDateTime>
+#include <QThreadPool>
+#include <QtEndian>
+#include <cstring>
+#include <iterator>
+
+namespace
+{
+// Identification of the writing tool, in the ID block and the file history
+constexpr char ProgramId[] = "ASURT   ";
+constexpr char ToolId[] = "ASURT Telemetry Dashboard";
+constexpr char ToolVendor[] = "ASURT";
+constexpr char ToolVersion[] = "0.1";
+
+// Every block starts with its four-character id, a reserved word, its length and its link count
+constexpr int BlockHeaderSize = 24;
+constexpr int IdBlockSize = 64;
+
+// Link positions used in the blocks below, as numbered by the specification
+enum HdLink { HdDataGroup, HdFileHistory, HdChannelHierarchy, HdAttachment, HdEvent, HdComment, HdLinkCount };
+enum FhLink { FhNext, FhComment, FhLinkCount };
+enum DgLink { DgNext, DgChannelGroup, DgData, DgComment, DgLinkCount };
+enum CgLink { CgNext, CgChannel, CgAcquisitionName, CgAcquisitionSource, CgSampleReduction, CgComment, CgLinkCount };
+enum CnLink { CnNext, CnComposition, CnName, CnSource, CnConversion, CnData, CnUnit, CnComment, CnLinkCount };
+
+// Channel types and the data type of every channel written here
+constexpr quint8 FixedLengthChannel = 0;
+constexpr quint8 MasterChannel = 2;
+constexpr quint8 TimeSync = 1;
+constexpr quint8 FloatLittleEndian = 4;
+
+constexpr TelemetryChannel vehicleChannels[] = {TelemetryChannel::Speed, TelemetryChannel::Rpm, TelemetryChannel::Temperature, TelemetryChannel::BatteryLevel};
+constexpr TelemetryChannel driverChannels[] = {TelemetryChannel::AccPedal, TelemetryChannel::BrakePedal, TelemetryChannel::EncoderAngle};
+constexpr TelemetryChannel wheelChannels[] = {TelemetryChannel::SpeedFL, TelemetryChannel::SpeedFR, TelemetryChannel::SpeedBL, TelemetryChannel::SpeedBR};
+constexpr TelemetryChannel dynamicsChannels[] = {TelemetryChannel::LateralG, TelemetryChannel::LongitudinalG};
+constexpr TelemetryChannel positionChannels[] = {TelemetryChannel::GpsLatitude, TelemetryChannel::GpsLongitude};
+
+struct ChannelGroup
+{
+    const char *name;
+    const TelemetryChannel *channels;
+    int count;
+
+    // One double for the master time plus one per channel
+    qint64 recordBytes() const { return qint64(count + 1) * sizeof(double); }
+};
+
+// Each group becomes a data group with its own master, so tools list them separately
+const ChannelGroup channelGroups[] = {
+    {"Vehicle", vehicleChannels, int(std::size(vehicleChannels))},
+    {"Driver", driverChannels, int(std::size(driverChannels))},
+    {"Wheels", wheelChannels, int(std::size(wheelChannels))},
+    {"Dynamics", dynamicsChannels, int(std::size(dynamicsChannels))},
+    {"Position", positionChannels, int(std::size(positionChannels))},
+};
+constexpr int ChannelGroupCount = int(std::size(channelGroups));
+
+template <typename T>
+void put(QByteArray &data, T value)
+{
+    char bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    data.append(bytes, sizeof(T));
+}
+
+void putZeros(QByteArray &data, int count)
+{
+    data.append(count, '\0');
+}
+
+/**
+ * @brief Lays out the metadata blocks of one file, links are filled in once their targets exist
+ */
+class BlockBuilder
+{
+public:
+    explicit BlockBuilder(qint64 base) : m_base(base) {}
+
+    // Appends a block with null links and returns its file offset, data is padded to 8 bytes
+    qint64 add(const char *id, int linkCount, QByteArray data)
+    {
+        putZeros(data, (8 - data.size() % 8) % 8);
+        const qint64 offset = end();
+        m_data.append(id, 4);
+        putZeros(m_data, 4);
+        put<quint64>(m_data, BlockHeaderSize + quint64(linkCount) * 8 + data.size());
+        put<quint64>(m_data, linkCount);
+        putZeros(m_data, linkCount * 8);
+        m_data.append(data);
+        return offset;
+    }
+
+    qint64 addText(const char *id, const QString &text)
+    {
+        QByteArray data = text.toUtf8();
+        data.append('\0');
+        return add(id, 0, data);
+    }
+
+    void link(qint64 block, int index, qint64 target)
+    {
+        qToLittleEndian<qint64>(target, m_data.data() + (block - m_base) + BlockHeaderSize + index * 8);
+    }
+
+    qint64 end() const { return m_base + m_data.size(); }
+    const QByteArray &data() const { return m_data; }
+
+private:
+    qint64 m_base;
+    QByteArray m_data;
+};
+
+QByteArray idBlock()
+{
+    QByteArray data;
+    data.append("MDF     4.10    ", 16);
+    data.append(ProgramId, 8);
+    putZeros(data, 4);
+    put<quint16>(data, 410);
+    putZeros(data, 30);
+    put<quint16>(data, 0); // Finalized
+    put<quint16>(data, 0);
+    return data;
+}
+
+QByteArray channelData(quint8 type, quint8 sync, quint32 byteOffset)
+{
+    QByteArray data;
+    put<quint8>(data, type);
+    put<quint8>(data, sync);
+    put<quint8>(data, FloatLittleEndian);
+    put<quint8>(data, 0);           // Bit offset
+    put<quint32>(data, byteOffset);
+    put<quint32>(data, 64);         // Bit count
+    put<quint32>(data, 0);          // Flags, no ranges or limits are given
+    put<quint32>(data, 0);          // Invalidation bit
+    put<quint8>(data, 0);           // Precision, only used with its flag set
+    put<quint8>(data, 0);
+    put<quint16>(data, 0);          // Attachments
+    putZeros(data, 6 * 8);          // Value range and limits
+    return data;
+}
+}
+
+Mdf4Writer::Mdf4Writer(const SessionReader &reader)
+    : m_reader(reader)
+{
+}
+
+QByteArray Mdf4Writer::buildMetadata(const QList<qint64> &dataSizes) const
+{
+    BlockBuilder blocks(IdBlockSize);
+
+    QByteArray header;
+    put<quint64>(header, quint64(m_reader.fileHeader().startedMsSinceEpoch) * 1000000);
+    put<qint16>(header, 0);      // UTC, no time zone or daylight saving offsets
+    put<qint16>(header, 0);
+    put<quint8>(header, 0);
+    put<quint8>(header, 0);      // Local PC clock
+    put<quint8>(header, 0);      // Start angle and distance are not valid
+    put<quint8>(header, 0);
+    put<double>(header, 0.0);
+    put<double>(header, 0.0);
+    const qint64 hd = blocks.add("##HD", HdLinkCount, header);
+
+    QByteArray history;
+    put<quint64>(history, quint64(QDateTime::currentMSecsSinceEpoch()) * 1000000);
+    put<qint16>(history, 0);
+    put<qint16>(history, 0);
+    put<quint8>(history, 0);
+    putZeros(history, 3);
+    const qint64 fh = blocks.add("##FH", FhLinkCount, history);
+    const qint64 fhComment = blocks.addText("##MD", QStringLiteral("<FHcomment><TX>Exported from session log %1</TX><tool_id>%2</tool_id><tool_vendor>%3</tool_vendor><tool_version>%4</tool_version></FHcomment>")
+                                                         .arg(m_reader.filePath().toHtmlEscaped(), QLatin1String(ToolId), QLatin1String(ToolVendor), QLatin1String(ToolVersion)));
+    blocks.link(hd, HdFileHistory, fh);
+    blocks.link(fh, FhComment, fhComment);
+
+    QList<qint64> dataGroups;
+    for (int g = 0; g < ChannelGroupCount; ++g)
+    {
+        const ChannelGroup &group = channelGroups[g];
+
+        QByteArray dataGroup;
+        put<quint8>(dataGroup, 0); // No record ids, every data group holds one channel group
+        putZeros(dataGroup, 7);
+        const qint64 dg = blocks.add("##DG", DgLinkCount, dataGroup);
+        blocks.link(dataGroups.isEmpty() ? hd : dataGroups.last(), dataGroups.isEmpty() ? int(HdDataGroup) : int(DgNext), dg);
+        dataGroups.append(dg);
+
+        QByteArray channelGroup;
+        put<quint64>(channelGroup, 0);
+        put<quint64>(channelGroup, quint64(m_reader.frameCount()));
+        put<quint16>(channelGroup, 0);
+        put<quint16>(channelGroup, 0);
+        putZeros(channelGroup, 4);
+        put<quint32>(channelGroup, quint32(group.recordBytes()));
+        put<quint32>(channelGroup, 0);
+        const qint64 cg = blocks.add("##CG", CgLinkCount, channelGroup);
+        blocks.link(dg, DgChannelGroup, cg);
+        blocks.link(cg, CgAcquisitionName, blocks.addText("##TX", QString::fromLatin1(group.name)));
+
+        const qint64 master = blocks.add("##CN", CnLinkCount, channelData(MasterChannel, TimeSync, 0));
+        blocks.link(master, CnName, blocks.addText("##TX", QStringLiteral("time")));
+        blocks.link(master, CnUnit, blocks.addText("##TX", QStringLiteral("s")));
+        blocks.link(cg, CgChannel, master);
+
+        qint64 previous = master;
+        for (int c = 0; c < group.count; ++c)
+        {
+            const TelemetryChannelInfo &info = telemetryChannel(group.channels[c]);
+            const qint64 cn = blocks.add("##CN", CnLinkCount, channelData(FixedLengthChannel, 0, quint32((c + 1) * sizeof(double))));
+            blocks.link(cn, CnName, blocks.addText("##TX", QString::fromLatin1(info.name)));
+            blocks.link(cn, CnUnit, blocks.addText("##TX", QString::fromUtf8(info.unit)));
+            blocks.link(previous, CnNext, cn);
+            previous = cn;
+        }
+    }
+
+    // Data blocks follow the metadata in group order
+    qint64 dataOffset = blocks.end();
+    for (int g = 0; g < ChannelGroupCount; ++g)
+    {
+        blocks.link(dataGroups.at(g), DgData, dataOffset);
+        dataOffset += BlockHeaderSize + dataSizes.at(g);
+    }
+
+    return idBlock() + blocks.data();
+}
+
+bool Mdf4Writer::write(QIODevice &device, ExportProgress &progress, QString *error)
+{
+    QList<qint64> dataSizes;
+    qint64 total = 0;
+    for (const ChannelGroup &group : channelGroups)
+    {
+        dataSizes.append(m_reader.frameCount() * group.recordBytes());
+        total += m_reader.frameCount() * (group.count + 1);
+    }
+    progress.total.store(total);
+
+    const QByteArray metadata = buildMetadata(dataSizes);
+    if (device.write(metadata) != metadata.size())
+    {
+        if (error)
+        {
+            *error = device.errorString();
+        }
+        return false;
+    }
+
+    for (int g = 0; g < ChannelGroupCount; ++g)
+    {
+        QByteArray header;
+        header.append("##DT", 4);
+        putZeros(header, 4);
+        put<quint64>(header, BlockHeaderSize + quint64(dataSizes.at(g)));
+        put<quint64>(header, 0);
+        if (device.write(header) != header.size() || !writeGroup(device, g, progress, error))
+        {
+            if (error && error->isEmpty())
+            {
+                *error = device.errorString();
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Mdf4Writer::writeGroup(QIODevice &device, int group, ExportProgress &progress, QString *error)
+{
+    const ChannelGroup &channels = channelGroups[group];
+    const qint64 startTimeUs = m_reader.fileHeader().startTimeUs;
+    const qsizetype chunkCount = m_reader.chunks().size();
+
+    // One buffer per worker, reused for every window
+    const qsizetype window = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    QList<QByteArray> buffers(window);
+
+    for (qsizetype first = 0; first < chunkCount; first += window)
+    {
+        if (progress.isCancelled())
+        {
+            if (error)
+            {
+                *error = QStringLiteral("Export cancelled");
+            }
+            return false;
+        }
+
+        const qsizetype count = qMin(window, chunkCount - first);
+        parallelFor(count, [&](qsizetype i)
+        {
+            const qsizetype chunk = first + i;
+            const QSpan<const qint64> times = m_reader.timestamps(chunk);
+            QSpan<const double> columns[TelemetryChannelCount];
+            for (int c = 0; c < channels.count; ++c)
+            {
+                columns[c] = m_reader.values(chunk, channels.channels[c]);
+            }
+
+            // Every channel is declared FloatLittleEndian, so a record is the doubles copied as they are
+            QByteArray &buffer = buffers[i];
+            buffer.resize(times.size() * channels.recordBytes());
+            double *record = reinterpret_cast<double *>(buffer.data());
+            for (qsizetype r = 0; r < times.size(); ++r)
+            {
+                *record++ = double(times[r] - startTimeUs) * 1e-6;
+                for (int c = 0; c < channels.count; ++c)
+                {
+                    *record++ = columns[c][r];
+                }
+            }
+        });
+
+        for (qsizetype i = 0; i < count; ++i)
+        {
+            if (device.write(buffers.at(i)) != buffers.at(i).size())
+            {
+                return false;
+            }
+            progress.advance(buffers.at(i).size() / qint64(sizeof(double)));
+        }
+    }
+    return true;
+}
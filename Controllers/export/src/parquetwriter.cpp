@@ -0,0 +1,392 @@
+#include "../include/parquetwriter.h"
+#include "../include/exportendian.h"
+#include "../../telemetry/include/parallelfor.h"
+#include <QDateTime>
+#include <QTimeZone>
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+constexpr char Magic[] = "PAR1";
+constexpr char CreatedBy[] = "ASURT Telemetry Dashboard version 0.1";
+
+// A row group collects log blocks until it holds at least this many rows
+constexpr qint64 RowGroupRows = 128 * 1024;
+
+// Exported columns, the channels follow in TelemetryChannel order
+enum ExportColumn { TimeColumn, SequenceColumn, FirstChannelColumn };
+constexpr int ColumnCount = FirstChannelColumn + TelemetryChannelCount;
+
+// Values from the Parquet format definition
+constexpr qint32 TypeInt64 = 2;
+constexpr qint32 TypeDouble = 5;
+constexpr qint32 Required = 0;
+constexpr qint32 ConvertedTimestampMicros = 10;
+constexpr qint32 EncodingPlain = 0;
+constexpr qint32 EncodingRle = 3;
+constexpr qint32 CodecUncompressed = 0;
+constexpr qint32 DataPage = 0;
+
+/**
+ * @brief Minimal writer for the Thrift compact protocol the Parquet metadata is serialized with
+ */
+class CompactWriter
+{
+public:
+    enum Type : quint8 { BoolTrue = 1, BoolFalse = 2, I32 = 5, I64 = 6, Binary = 8, List = 9, Struct = 12 };
+
+    CompactWriter() { m_lastField.append(0); }
+
+    void fieldBool(int id, bool value) { fieldHeader(id, value ? BoolTrue : BoolFalse); }
+    void fieldI32(int id, qint32 value) { fieldHeader(id, I32); varint(zigzag(value)); }
+    void fieldI64(int id, qint64 value) { fieldHeader(id, I64); varint(zigzag(value)); }
+    void fieldBinary(int id, const QByteArray &value) { fieldHeader(id, Binary); binary(value); }
+    void fieldStruct(int id) { fieldHeader(id, Struct); beginStruct(); }
+    void fieldList(int id, Type element, qsizetype size)
+    {
+        fieldHeader(id, List);
+        if (size < 15)
+        {
+            m_data.append(char((size << 4) | element));
+        }
+        else
+        {
+            m_data.append(char(0xF0 | element));
+            varint(quint64(size));
+        }
+    }
+
+    // List elements and nested structs
+    void i32(qint32 value) { varint(zigzag(value)); }
+    void binary(const QByteArray &value) { varint(quint64(value.size())); m_data.append(value); }
+    void beginStruct() { m_lastField.append(0); }
+    void endStruct() { m_data.append('\0'); m_lastField.removeLast(); }
+
+    const QByteArray &data() const { return m_data; }
+
+private:
+    static quint64 zigzag(qint64 value) { return (quint64(value) << 1) ^ quint64(value >> 63); }
+
+    void varint(quint64 value)
+    {
+        while (value >= 0x80)
+        {
+            m_data.append(char((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        m_data.append(char(value));
+    }
+
+    void fieldHeader(int id, quint8 type)
+    {
+        const int delta = id - m_lastField.last();
+        if (delta > 0 && delta <= 15)
+        {
+            m_data.append(char((delta << 4) | type));
+        }
+        else
+        {
+            m_data.append(char(type));
+            varint(zigzag(id));
+        }
+        m_lastField.last() = id;
+    }
+
+    QByteArray m_data;
+    QList<int> m_lastField;
+};
+
+QByteArray columnName(int column)
+{
+    switch (column)
+    {
+    case TimeColumn:
+        return QByteArrayLiteral("time");
+    case SequenceColumn:
+        return QByteArrayLiteral("sequence");
+    default:
+        return QByteArray(telemetryChannels()[column - FirstChannelColumn].name);
+    }
+}
+
+QByteArray pageHeader(qint64 rows)
+{
+    const qint32 bytes = qint32(rows * 8);
+    CompactWriter header;
+    header.fieldI32(1, DataPage);
+    header.fieldI32(2, bytes);
+    header.fieldI32(3, bytes);
+    header.fieldStruct(5);
+    header.fieldI32(1, qint32(rows));
+    header.fieldI32(2, EncodingPlain);
+    header.fieldI32(3, EncodingRle);   // Level encodings, no levels are written for required columns
+    header.fieldI32(4, EncodingRle);
+    header.endStruct();
+    header.endStruct();
+    return header.data();
+}
+
+template <typename T>
+QByteArray plain(T value)
+{
+    QByteArray bytes(sizeof(T), Qt::Uninitialized);
+    qToLittleEndian(value, bytes.data());
+    return bytes;
+}
+}
+
+ParquetWriter::ParquetWriter(const SessionReader &reader)
+    : m_reader(reader)
+{
+}
+
+void ParquetWriter::encodeColumn(int column, qsizetype firstChunk, qsizetype lastChunk, qint64 rows, QByteArray &buffer, ColumnChunk &chunk) const
+{
+    const QByteArray header = pageHeader(rows);
+    buffer.resize(header.size() + rows * 8);
+    std::memcpy(buffer.data(), header.constData(), header.size());
+    char *out = buffer.data() + header.size();
+
+    // PLAIN stores INT64 and DOUBLE as 8-byte little-endian words back to back, the values are copied as they are
+    if (column == TimeColumn || column == SequenceColumn)
+    {
+        const qint64 epochOffsetUs = m_reader.fileHeader().startedMsSinceEpoch * 1000 - m_reader.fileHeader().startTimeUs;
+        qint64 *values = reinterpret_cast<qint64 *>(out);
+        for (qsizetype c = firstChunk; c < lastChunk; ++c)
+        {
+            if (column == TimeColumn)
+            {
+                for (qint64 time : m_reader.timestamps(c))
+                {
+                    *values++ = time + epochOffsetUs;
+                }
+            }
+            else
+            {
+                for (quint64 sequence : m_reader.sequences(c))
+                {
+                    *values++ = qint64(sequence);
+                }
+            }
+        }
+
+        if (rows > 0)
+        {
+            const qint64 *first = reinterpret_cast<const qint64 *>(out);
+            const auto bounds = std::minmax_element(first, first + rows);
+            chunk.minimum = plain(*bounds.first);
+            chunk.maximum = plain(*bounds.second);
+        }
+    }
+    else
+    {
+        const TelemetryChannel channel = static_cast<TelemetryChannel>(column - FirstChannelColumn);
+        double minimum = std::numeric_limits<double>::infinity();
+        double maximum = -std::numeric_limits<double>::infinity();
+        bool ordered = true;
+        double *values = reinterpret_cast<double *>(out);
+        for (qsizetype c = firstChunk; c < lastChunk; ++c)
+        {
+            for (double value : m_reader.values(c, channel))
+            {
+                *values++ = value;
+                minimum = qMin(minimum, value);
+                maximum = qMax(maximum, value);
+                ordered = ordered && !std::isnan(value);
+            }
+        }
+
+        // Bounds are left out if a NaN makes them meaningless
+        if (rows > 0 && ordered)
+        {
+            chunk.minimum = plain(minimum);
+            chunk.maximum = plain(maximum);
+        }
+    }
+    chunk.bytes = buffer.size();
+}
+
+bool ParquetWriter::write(QIODevice &device, ExportProgress &progress, QString *error)
+{
+    progress.total.store(m_reader.frameCount() * ColumnCount);
+
+    qint64 offset = 0;
+    auto append = [&](const QByteArray &data)
+    {
+        if (device.write(data) != data.size())
+        {
+            if (error)
+            {
+                *error = device.errorString();
+            }
+            return false;
+        }
+        offset += data.size();
+        return true;
+    };
+
+    if (!append(QByteArray(Magic, 4)))
+    {
+        return false;
+    }
+
+    QList<RowGroup> rowGroups;
+    QList<QByteArray> buffers(ColumnCount);
+    const qsizetype chunkCount = m_reader.chunks().size();
+    for (qsizetype first = 0; first < chunkCount;)
+    {
+        if (progress.isCancelled())
+        {
+            if (error)
+            {
+                *error = QStringLiteral("Export cancelled");
+            }
+            return false;
+        }
+
+        RowGroup group;
+        qsizetype last = first;
+        while (last < chunkCount && group.rows < RowGroupRows)
+        {
+            group.rows += m_reader.chunks().at(last).header.recordCount;
+            ++last;
+        }
+        group.columns.resize(ColumnCount);
+
+        parallelFor(ColumnCount, [&](qsizetype column)
+        {
+            encodeColumn(int(column), first, last, group.rows, buffers[column], group.columns[column]);
+        });
+
+        for (int column = 0; column < ColumnCount; ++column)
+        {
+            group.columns[column].offset = offset;
+            if (!append(buffers.at(column)))
+            {
+                return false;
+            }
+        }
+
+        progress.advance(group.rows * ColumnCount);
+        rowGroups.append(group);
+        first = last;
+    }
+
+    const QByteArray footer = fileMetadata(rowGroups);
+    QByteArray trailer(4, Qt::Uninitialized);
+    qToLittleEndian<quint32>(quint32(footer.size()), trailer.data());
+    return append(footer) && append(trailer) && append(QByteArray(Magic, 4));
+}
+
+QByteArray ParquetWriter::fileMetadata(const QList<RowGroup> &rowGroups) const
+{
+    CompactWriter meta;
+    meta.fieldI32(1, 1);
+
+    meta.fieldList(2, CompactWriter::Struct, ColumnCount + 1);
+    meta.beginStruct();
+    meta.fieldBinary(4, QByteArrayLiteral("schema"));
+    meta.fieldI32(5, ColumnCount);
+    meta.endStruct();
+    for (int column = 0; column < ColumnCount; ++column)
+    {
+        meta.beginStruct();
+        meta.fieldI32(1, column >= FirstChannelColumn ? TypeDouble : TypeInt64);
+        meta.fieldI32(3, Required);
+        meta.fieldBinary(4, columnName(column));
+        if (column == TimeColumn)
+        {
+            meta.fieldI32(6, ConvertedTimestampMicros);
+            meta.fieldStruct(10);   // LogicalType
+            meta.fieldStruct(8);    // TIMESTAMP
+            meta.fieldBool(1, true);
+            meta.fieldStruct(2);    // Unit
+            meta.fieldStruct(2);    // MICROS
+            meta.endStruct();
+            meta.endStruct();
+            meta.endStruct();
+            meta.endStruct();
+        }
+        meta.endStruct();
+    }
+
+    qint64 rows = 0;
+    for (const RowGroup &group : rowGroups)
+    {
+        rows += group.rows;
+    }
+    meta.fieldI64(3, rows);
+
+    meta.fieldList(4, CompactWriter::Struct, rowGroups.size());
+    for (const RowGroup &group : rowGroups)
+    {
+        qint64 groupBytes = 0;
+        meta.beginStruct();
+        meta.fieldList(1, CompactWriter::Struct, ColumnCount);
+        for (int column = 0; column < ColumnCount; ++column)
+        {
+            const ColumnChunk &chunk = group.columns.at(column);
+            groupBytes += chunk.bytes;
+
+            meta.beginStruct();
+            meta.fieldI64(2, chunk.offset);
+            meta.fieldStruct(3);
+            meta.fieldI32(1, column >= FirstChannelColumn ? TypeDouble : TypeInt64);
+            meta.fieldList(2, CompactWriter::I32, 2); // The values, and the levels of the page headers
+            meta.i32(EncodingPlain);
+            meta.i32(EncodingRle);
+            meta.fieldList(3, CompactWriter::Binary, 1);
+            meta.binary(columnName(column));
+            meta.fieldI32(4, CodecUncompressed);
+            meta.fieldI64(5, group.rows);
+            meta.fieldI64(6, chunk.bytes);
+            meta.fieldI64(7, chunk.bytes);
+            meta.fieldI64(9, chunk.offset);
+            meta.fieldStruct(12);   // Statistics
+            meta.fieldI64(3, 0);
+            if (!chunk.minimum.isEmpty())
+            {
+                meta.fieldBinary(5, chunk.maximum);
+                meta.fieldBinary(6, chunk.minimum);
+            }
+            meta.endStruct();
+            meta.endStruct();
+            meta.endStruct();
+        }
+        meta.fieldI64(2, groupBytes);
+        meta.fieldI64(3, group.rows);
+        meta.endStruct();
+    }
+
+    // Units and the wall-clock start of the session, Parquet has no place for them in the schema
+    meta.fieldList(5, CompactWriter::Struct, TelemetryChannelCount + 1);
+    meta.beginStruct();
+    meta.fieldBinary(1, QByteArrayLiteral("session.start"));
+    meta.fieldBinary(2, QDateTime::fromMSecsSinceEpoch(m_reader.fileHeader().startedMsSinceEpoch, QTimeZone::UTC).toString(Qt::ISODateWithMs).toUtf8());
+    meta.endStruct();
+    for (const TelemetryChannelInfo &info : telemetryChannels())
+    {
+        meta.beginStruct();
+        meta.fieldBinary(1, QByteArrayLiteral("unit.") + info.name);
+        meta.fieldBinary(2, QByteArray(info.unit));
+        meta.endStruct();
+    }
+
+    meta.fieldBinary(6, QByteArray(CreatedBy));
+
+    // Type defined order for every column, readers ignore min_value and max_value without it
+    meta.fieldList(7, CompactWriter::Struct, ColumnCount);
+    for (int column = 0; column < ColumnCount; ++column)
+    {
+        meta.beginStruct();
+        meta.fieldStruct(1);
+        meta.endStruct();
+        meta.endStruct();
+    }
+    meta.endStruct();
+    return meta.data();
+}
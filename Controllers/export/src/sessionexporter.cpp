@@ -0,0 +1,175 @@
+#include "../include/sessionexporter.h"
+#include "../include/archivewriter.h"
+#include "../include/mdf4writer.h"
+#include "../include/parquetwriter.h"
+#include "../../recording/include/sessionreader.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThread>
+
+namespace
+{
+// Interval at which the progress is published to QML while an export runs
+constexpr int ProgressIntervalMs = 100;
+}
+
+SessionExporter::SessionExporter(QObject *parent)
+    : QObject(parent),
+    m_thread(nullptr)
+{
+    m_progressTimer.setInterval(ProgressIntervalMs);
+    connect(&m_progressTimer, &QTimer::timeout, this, &SessionExporter::progressChanged);
+}
+
+SessionExporter::~SessionExporter()
+{
+    if (m_thread)
+    {
+        m_progress.cancelled.store(true);
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+bool SessionExporter::start(const QString &sessionPath, const QString &format, const QString &outputPath)
+{
+    if (m_thread)
+    {
+        qDebug() << "SessionExporter: An export is already running";
+        return false;
+    }
+
+    Format target;
+    QString suffix;
+    if (format.compare(QStringLiteral("mdf4"), Qt::CaseInsensitive) == 0)
+    {
+        target = Format::Mdf4;
+        suffix = QStringLiteral(".mf4");
+    }
+    else if (format.compare(QStringLiteral("parquet"), Qt::CaseInsensitive) == 0)
+    {
+        target = Format::Parquet;
+        suffix = QStringLiteral(".parquet");
+    }
+    else if (format.compare(QStringLiteral("tlz"), Qt::CaseInsensitive) == 0)
+    {
+        target = Format::Archive;
+        suffix = QStringLiteral(".tlz");
+    }
+    else
+    {
+        qDebug() << "SessionExporter: Unknown format" << format;
+        emit errorOccurred(QStringLiteral("Unknown export format %1").arg(format));
+        return false;
+    }
+
+    if (outputPath.isEmpty())
+    {
+        const QFileInfo info(sessionPath);
+        m_outputPath = info.absolutePath() + QLatin1Char('/') + info.completeBaseName() + suffix;
+    }
+    else
+    {
+        m_outputPath = outputPath;
+    }
+
+    m_progress.total.store(0);
+    m_progress.done.store(0);
+    m_progress.cancelled.store(false);
+
+    const QString destination = m_outputPath;
+    m_thread = QThread::create([this, sessionPath, target, destination]()
+    {
+        QString error;
+        const bool succeeded = run(sessionPath, target, destination, &error);
+        QMetaObject::invokeMethod(this, [this, succeeded, error]() { handleFinished(succeeded, error); }, Qt::QueuedConnection);
+    });
+    m_thread->setObjectName(QStringLiteral("Session Exporter"));
+    m_thread->start();
+    m_progressTimer.start();
+
+    qDebug() << "SessionExporter: Exporting" << sessionPath << "to" << m_outputPath;
+    emit runningChanged();
+    emit progressChanged();
+    return true;
+}
+
+void SessionExporter::cancel()
+{
+    m_progress.cancelled.store(true);
+}
+
+double SessionExporter::progress() const
+{
+    const qint64 total = m_progress.total.load(std::memory_order_relaxed);
+    return total > 0 ? double(m_progress.done.load(std::memory_order_relaxed)) / double(total) : 0.0;
+}
+
+bool SessionExporter::run(const QString &sessionPath, Format format, const QString &outputPath, QString *error)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    SessionReader reader;
+    if (!reader.open(sessionPath, error))
+    {
+        return false;
+    }
+
+    QSaveFile file(outputPath);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        *error = file.errorString();
+        return false;
+    }
+
+    bool written = false;
+    switch (format)
+    {
+    case Format::Mdf4:
+        written = Mdf4Writer(reader).write(file, m_progress, error);
+        break;
+    case Format::Parquet:
+        written = ParquetWriter(reader).write(file, m_progress, error);
+        break;
+    case Format::Archive:
+        written = ArchiveWriter(reader).write(file, m_progress, error);
+        break;
+    }
+    if (!written)
+    {
+        file.cancelWriting();
+        return false;
+    }
+    if (!file.commit())
+    {
+        *error = file.errorString();
+        return false;
+    }
+
+    qDebug() << "SessionExporter: Exported" << reader.frameCount() << "frames in" << timer.elapsed() << "ms";
+    return true;
+}
+
+void SessionExporter::handleFinished(bool succeeded, const QString &error)
+{
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+    m_progressTimer.stop();
+
+    if (succeeded)
+    {
+        emit finished(m_outputPath);
+    }
+    else
+    {
+        qDebug() << "SessionExporter: Export to" << m_outputPath << "failed:" << error;
+        emit errorOccurred(QStringLiteral("Export to %1 failed: %2").arg(m_outputPath, error));
+    }
+
+    emit progressChanged();
+    emit runningChanged();
+}
@@ -0,0 +1,81 @@
+#ifndef TILESERVER_H
+#define TILESERVER_H
+
+#include <QObject>
+#include <QString>
+#include <QThread>
+
+// Forward declarations
+class TileServerWorker;
+
+/**
+ * @brief The TileServer class provides offline map tiles to the QtLocation OSM plugin
+ *
+ * Serves an MBTiles file or a {z}/{x}/{y} tile directory on a loopback HTTP port that the plugin
+ * uses as its custom tile host. Reading and caching happen in a worker thread; feeding the car
+ * position through updatePosition() reads the tiles ahead of it into the cache before the map asks.
+ *
+ * The plugin reads its parameters once, so start() must run before the QML that creates the map.
+ */
+class TileServer : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool running READ isRunning NOTIFY runningChanged)
+    Q_PROPERTY(QString url READ url NOTIFY runningChanged)
+    Q_PROPERTY(QString tilePath READ tilePath NOTIFY runningChanged)
+
+public:
+    explicit TileServer(QObject *parent = nullptr);
+    ~TileServer();
+
+    /**
+     * @brief Open a tile source and start serving it, returns once the server listens
+     * @param path MBTiles file or tile directory
+     */
+    Q_INVOKABLE bool start(const QString &path);
+    Q_INVOKABLE void stop();
+
+    /**
+     * @brief Feed the car position, queues a prefetch around and ahead of it
+     * @param latitude Degrees
+     * @param longitude Degrees
+     * @param zoom Zoom level the map shows
+     */
+    Q_INVOKABLE void updatePosition(double latitude, double longitude, int zoom);
+
+    Q_INVOKABLE void setCacheSize(qint64 bytes);
+
+    bool isRunning() const { return m_running; }
+    QString url() const { return m_url; }
+    QString tilePath() const { return m_tilePath; }
+
+signals:
+    void runningChanged();
+    void errorOccurred(const QString &error);
+
+    // Internal signals for worker communication
+    void prefetchRequested(int zoom, double x, double y, double directionX, double directionY);
+
+private:
+    QThread m_workerThread;
+    TileServerWorker *m_worker;
+
+    bool m_running;
+    QString m_url;
+    QString m_tilePath;
+
+    // The heading is taken from the movement since the anchor, in tiles at m_zoom
+    bool m_hasPosition;
+    int m_zoom;
+    double m_anchorX;
+    double m_anchorY;
+    double m_directionX;
+    double m_directionY;
+
+    // Tile the last prefetch was centered on, a prefetch is only queued when the car leaves it or turns
+    int m_prefetchColumn;
+    int m_prefetchRow;
+};
+
+#endif // TILESERVER_H
@@ -0,0 +1,78 @@
+#ifndef TILESERVERWORKER_H
+#define TILESERVERWORKER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QCache>
+#include <QHash>
+#include <QList>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include "tilestore.h"
+
+/**
+ * @brief The TileServerWorker class serves tiles of a TileStore over HTTP on the loopback interface.
+ *
+ * Runs in its own thread, so neither the GUI nor the map renderer ever waits on the disk. Tiles are
+ * kept in an LRU cache bounded in bytes, and tiles ahead of the car are read into it between requests.
+ */
+class TileServerWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TileServerWorker(QObject *parent = nullptr);
+    ~TileServerWorker();
+
+    /**
+     * @brief Open a tile source and start listening, call in the worker thread
+     * @param path MBTiles file or tile directory
+     * @param url Receives the base URL tiles are served under, "http://127.0.0.1:<port>/"
+     * @param error Receives a description if starting fails
+     */
+    bool open(const QString &path, QString *url, QString *error);
+
+public slots:
+    void initialize();
+    void close();
+
+    /**
+     * @brief Replace the pending prefetch with the tiles around and ahead of a position
+     * @param zoom Zoom level the map shows
+     * @param x Column of the tile under the car, fractional
+     * @param y Row of the tile under the car, fractional
+     * @param directionX Unit vector of the heading in tile coordinates, (0, 0) if unknown
+     * @param directionY See directionX
+     */
+    void prefetch(int zoom, double x, double y, double directionX, double directionY);
+
+    void setCacheSize(qint64 bytes);
+
+signals:
+    void errorOccurred(const QString &error);
+
+private slots:
+    void acceptConnections();
+    void readRequests();
+    void prefetchNext(); // Reads one queued tile, so requests are never queued behind a whole prefetch.
+
+private:
+    const QByteArray *cachedTile(int zoom, int x, int y);
+    void respond(QTcpSocket *socket, const QByteArray &target, bool keepAlive);
+
+    static quint64 tileKey(int zoom, int x, int y);
+
+    TileStore m_store;
+    QTcpServer *m_server;
+
+    QCache<quint64, QByteArray> m_cache; // Encoded tiles, cost in bytes; an empty entry records a missing tile
+    QHash<QTcpSocket *, QByteArray> m_requests; // Partial request per connection
+
+    QList<quint64> m_prefetchQueue;
+    QTimer *m_prefetchTimer;
+
+    qint64 m_served;
+    qint64 m_hits;
+};
+
+#endif // TILESERVERWORKER_H
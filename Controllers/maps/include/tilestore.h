@@ -0,0 +1,62 @@
+#ifndef TILESTORE_H
+#define TILESTORE_H
+
+#include <QByteArray>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief The TileStore class reads map tiles from an MBTiles file or a {z}/{x}/{y} directory tree
+ *
+ * Tiles are addressed in the XYZ scheme used by OpenStreetMap; the TMS row order of MBTiles is
+ * converted internally. Not thread-safe, open and use a store from a single thread.
+ */
+class TileStore
+{
+public:
+    TileStore();
+    ~TileStore();
+
+    TileStore(const TileStore &) = delete;
+    TileStore &operator=(const TileStore &) = delete;
+
+    /**
+     * @brief Open a tile source
+     * @param path An .mbtiles (SQLite) file or the root directory of a tile tree
+     * @param error Receives a description if opening fails
+     * @return True on success
+     */
+    bool open(const QString &path, QString *error);
+    void close();
+    bool isOpen() const { return m_kind != Kind::None; }
+
+    /**
+     * @brief Encoded image of one tile
+     * @return The tile data, empty if the source has no such tile
+     */
+    QByteArray tile(int zoom, int x, int y);
+
+    /**
+     * @brief Image format of the tiles, "png" unless the source says otherwise
+     */
+    QString format() const { return m_format; }
+
+private:
+    enum class Kind { None, MBTiles, Directory };
+
+    bool openMBTiles(const QString &path, QString *error);
+    bool openDirectory(const QString &path, QString *error);
+
+    Kind m_kind;
+    QString m_path;
+    QString m_format;
+
+    QString m_connectionName;
+    QSqlQuery m_tileQuery; // Prepared once, bound per tile
+
+    QStringList m_extensions; // Directory tiles are probed with these, the last hit first
+};
+
+#endif // TILESTORE_H
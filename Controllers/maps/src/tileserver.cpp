@@ -0,0 +1,147 @@
+#include "../include/tileserver.h"
+#include "../include/tileserverworker.h"
+#include <QDebug>
+#include <QtMath>
+#include <cmath>
+
+namespace
+{
+// Movement in tiles before the heading is taken again, below this GPS noise dominates
+constexpr double HeadingDistance = 0.25;
+}
+
+TileServer::TileServer(QObject *parent)
+    : QObject(parent),
+    m_running(false),
+    m_hasPosition(false),
+    m_zoom(-1),
+    m_anchorX(0.0),
+    m_anchorY(0.0),
+    m_directionX(0.0),
+    m_directionY(0.0),
+    m_prefetchColumn(-1),
+    m_prefetchRow(-1)
+{
+    // Create and configure the worker
+    m_worker = new TileServerWorker();
+    m_worker->moveToThread(&m_workerThread);
+
+    connect(this, &TileServer::prefetchRequested, m_worker, &TileServerWorker::prefetch, Qt::QueuedConnection);
+    connect(m_worker, &TileServerWorker::errorOccurred, this, &TileServer::errorOccurred, Qt::QueuedConnection);
+
+    // Connect thread start/stop signals
+    connect(&m_workerThread, &QThread::started, m_worker, &TileServerWorker::initialize);
+    connect(&m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
+
+    m_workerThread.setObjectName("Tile Server Thread");
+    m_workerThread.start(QThread::LowPriority);
+}
+
+TileServer::~TileServer()
+{
+    stop();
+
+    m_workerThread.quit();
+    m_workerThread.wait();
+}
+
+bool TileServer::start(const QString &path)
+{
+    stop();
+
+    // Blocking, so the URL is known before the map plugin reads it
+    bool started = false;
+    QString url;
+    QString error;
+    QMetaObject::invokeMethod(m_worker, [&]() { started = m_worker->open(path, &url, &error); }, Qt::BlockingQueuedConnection);
+
+    if (!started)
+    {
+        qDebug() << "TileServer:" << error;
+        emit errorOccurred(error);
+        return false;
+    }
+
+    m_running = true;
+    m_url = url;
+    m_tilePath = path;
+    emit runningChanged();
+    return true;
+}
+
+void TileServer::stop()
+{
+    if (!m_running)
+    {
+        return;
+    }
+
+    QMetaObject::invokeMethod(m_worker, &TileServerWorker::close, Qt::BlockingQueuedConnection);
+
+    m_running = false;
+    m_url.clear();
+    m_tilePath.clear();
+    m_hasPosition = false;
+    emit runningChanged();
+}
+
+void TileServer::setCacheSize(qint64 bytes)
+{
+    QMetaObject::invokeMethod(m_worker, [this, bytes]() { m_worker->setCacheSize(bytes); }, Qt::QueuedConnection);
+}
+
+void TileServer::updatePosition(double latitude, double longitude, int zoom)
+{
+    if (!m_running || zoom < 0 || zoom > 24 || !qIsFinite(latitude) || !qIsFinite(longitude)
+        || qAbs(latitude) > 85.0511 || qAbs(longitude) > 180.0)
+    {
+        return;
+    }
+
+    // Web Mercator tile coordinates, the scheme the OSM plugin requests tiles in
+    const double tiles = double(1 << zoom);
+    const double latitudeRadians = qDegreesToRadians(latitude);
+    const double x = (longitude + 180.0) / 360.0 * tiles;
+    const double y = (1.0 - std::asinh(std::tan(latitudeRadians)) / M_PI) / 2.0 * tiles;
+
+    bool turned = false;
+    if (!m_hasPosition || zoom != m_zoom)
+    {
+        m_hasPosition = true;
+        m_zoom = zoom;
+        m_anchorX = x;
+        m_anchorY = y;
+        m_directionX = 0.0;
+        m_directionY = 0.0;
+        m_prefetchColumn = -1;
+    }
+    else
+    {
+        const double dx = x - m_anchorX;
+        const double dy = y - m_anchorY;
+        const double distance = std::hypot(dx, dy);
+        if (distance >= HeadingDistance)
+        {
+            // Re-aim the corridor only when the heading moved by more than about 30 degrees
+            const double directionX = dx / distance;
+            const double directionY = dy / distance;
+            turned = directionX * m_directionX + directionY * m_directionY < 0.85;
+            if (turned)
+            {
+                m_directionX = directionX;
+                m_directionY = directionY;
+            }
+            m_anchorX = x;
+            m_anchorY = y;
+        }
+    }
+
+    const int column = qFloor(x);
+    const int row = qFloor(y);
+    if (turned || column != m_prefetchColumn || row != m_prefetchRow)
+    {
+        m_prefetchColumn = column;
+        m_prefetchRow = row;
+        emit prefetchRequested(zoom, x, y, m_directionX, m_directionY);
+    }
+}
@@ -0,0 +1,291 @@
+#include "../include/tileserverworker.h"
+#include <QDebug>
+#include <QHostAddress>
+#include <QtMath>
+
+namespace
+{
+// Default size of the tile cache, a 256 px PNG tile is 10-40 KB
+constexpr qint64 DefaultCacheBytes = 64 * 1024 * 1024;
+
+// Tiles read ahead along the heading
+constexpr int PrefetchAhead = 4;
+
+// A request head larger than this is not a tile request
+constexpr qsizetype MaxRequestBytes = 8 * 1024;
+}
+
+TileServerWorker::TileServerWorker(QObject *parent)
+    : QObject(parent),
+    m_server(nullptr),
+    m_prefetchTimer(nullptr),
+    m_served(0),
+    m_hits(0)
+{
+    m_cache.setMaxCost(DefaultCacheBytes);
+}
+
+TileServerWorker::~TileServerWorker()
+{
+    close();
+}
+
+void TileServerWorker::initialize()
+{
+    // This slot is called when the worker's thread starts.
+    // Any thread-specific initialization should happen here.
+    if (!m_server)
+    {
+        m_server = new QTcpServer(this);
+        connect(m_server, &QTcpServer::newConnection, this, &TileServerWorker::acceptConnections);
+
+        m_prefetchTimer = new QTimer(this);
+        m_prefetchTimer->setSingleShot(true);
+        m_prefetchTimer->setInterval(0);
+        connect(m_prefetchTimer, &QTimer::timeout, this, &TileServerWorker::prefetchNext);
+    }
+}
+
+bool TileServerWorker::open(const QString &path, QString *url, QString *error)
+{
+    close();
+
+    if (!m_server)
+    {
+        *error = QStringLiteral("Tile server not initialized.");
+        return false;
+    }
+
+    if (!m_store.open(path, error))
+    {
+        return false;
+    }
+
+    // Loopback only, the map of this dashboard is the sole client
+    if (!m_server->listen(QHostAddress::LocalHost, 0))
+    {
+        *error = QStringLiteral("Cannot listen for tile requests: %1").arg(m_server->errorString());
+        m_store.close();
+        return false;
+    }
+
+    *url = QStringLiteral("http://127.0.0.1:%1/").arg(m_server->serverPort());
+    qDebug() << "TileServerWorker: Serving" << path << "at" << *url;
+    return true;
+}
+
+void TileServerWorker::close()
+{
+    if (m_server && m_server->isListening())
+    {
+        m_server->close();
+        qDebug() << "TileServerWorker: Stopped after" << m_served << "tiles," << m_hits << "from the cache";
+    }
+
+    for (auto it = m_requests.begin(); it != m_requests.end(); ++it)
+    {
+        it.key()->disconnectFromHost();
+    }
+
+    m_prefetchQueue.clear();
+    m_cache.clear();
+    m_store.close();
+    m_served = 0;
+    m_hits = 0;
+}
+
+void TileServerWorker::setCacheSize(qint64 bytes)
+{
+    m_cache.setMaxCost(qMax<qint64>(bytes, 1024 * 1024));
+}
+
+void TileServerWorker::prefetch(int zoom, double x, double y, double directionX, double directionY)
+{
+    if (!m_store.isOpen() || zoom < 0 || zoom > 24)
+    {
+        return;
+    }
+
+    const int tiles = 1 << zoom;
+    m_prefetchQueue.clear();
+
+    auto enqueue = [&](double tileX, double tileY)
+    {
+        const int column = qFloor(tileX);
+        const int row = qFloor(tileY);
+        if (row < 0 || row >= tiles)
+        {
+            return;
+        }
+
+        // Columns wrap at the antimeridian
+        const quint64 key = tileKey(zoom, ((column % tiles) + tiles) % tiles, row);
+        if (!m_cache.contains(key) && !m_prefetchQueue.contains(key))
+        {
+            m_prefetchQueue.append(key);
+        }
+    };
+
+    // The tiles around the car first, the map needs them whatever the heading
+    for (int dy = -1; dy <= 1; ++dy)
+    {
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+            enqueue(x + dx, y + dy);
+        }
+    }
+
+    // Then a corridor three tiles wide along the heading
+    for (int step = 2; step <= PrefetchAhead; ++step)
+    {
+        const double aheadX = x + directionX * step;
+        const double aheadY = y + directionY * step;
+        enqueue(aheadX, aheadY);
+        enqueue(aheadX - directionY, aheadY + directionX);
+        enqueue(aheadX + directionY, aheadY - directionX);
+    }
+
+    if (!m_prefetchQueue.isEmpty())
+    {
+        m_prefetchTimer->start();
+    }
+}
+
+void TileServerWorker::prefetchNext()
+{
+    if (m_prefetchQueue.isEmpty())
+    {
+        return;
+    }
+
+    const quint64 key = m_prefetchQueue.takeFirst();
+    cachedTile(int(key >> 48), int((key >> 24) & 0xFFFFFF), int(key & 0xFFFFFF));
+
+    if (!m_prefetchQueue.isEmpty())
+    {
+        // Back through the event loop, a tile request that arrived meanwhile is answered first
+        m_prefetchTimer->start();
+    }
+}
+
+const QByteArray *TileServerWorker::cachedTile(int zoom, int x, int y)
+{
+    const quint64 key = tileKey(zoom, x, y);
+    if (const QByteArray *tile = m_cache.object(key))
+    {
+        return tile;
+    }
+
+    QByteArray *tile = new QByteArray(m_store.tile(zoom, x, y));
+    const qsizetype cost = qMax<qsizetype>(tile->size(), 1);
+    if (!m_cache.insert(key, tile, cost))
+    {
+        // Larger than the whole cache, insert() already deleted it
+        return nullptr;
+    }
+    return m_cache.object(key);
+}
+
+void TileServerWorker::acceptConnections()
+{
+    while (m_server->hasPendingConnections())
+    {
+        QTcpSocket *socket = m_server->nextPendingConnection();
+        m_requests.insert(socket, QByteArray());
+        connect(socket, &QTcpSocket::readyRead, this, &TileServerWorker::readRequests);
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]()
+        {
+            m_requests.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void TileServerWorker::readRequests()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    if (!socket || !m_requests.contains(socket))
+    {
+        return;
+    }
+
+    QByteArray &buffer = m_requests[socket];
+    buffer.append(socket->readAll());
+
+    // Keep-alive connections may pipeline several requests
+    qsizetype headEnd;
+    while ((headEnd = buffer.indexOf("\r\n\r\n")) >= 0)
+    {
+        const QByteArray head = buffer.left(headEnd);
+        buffer.remove(0, headEnd + 4);
+
+        const qsizetype lineEnd = head.indexOf("\r\n");
+        const QList<QByteArray> requestLine = (lineEnd >= 0 ? head.left(lineEnd) : head).split(' ');
+        const bool keepAlive = !head.toLower().contains("connection: close");
+
+        if (requestLine.size() != 3 || requestLine.at(0) != "GET")
+        {
+            socket->write("HTTP/1.1 405 Method Not Allowed\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+            socket->disconnectFromHost();
+            return;
+        }
+
+        respond(socket, requestLine.at(1), keepAlive);
+        if (!keepAlive)
+        {
+            socket->disconnectFromHost();
+            return;
+        }
+    }
+
+    if (buffer.size() > MaxRequestBytes)
+    {
+        socket->disconnectFromHost();
+    }
+}
+
+void TileServerWorker::respond(QTcpSocket *socket, const QByteArray &target, bool keepAlive)
+{
+    // Only /{z}/{x}/{y}.{ext} is served, the extension is ignored and the store's format is sent
+    const QList<QByteArray> parts = target.mid(1).split('/');
+    const QByteArray *tile = nullptr;
+    if (parts.size() == 3)
+    {
+        bool zoomOk = false;
+        bool xOk = false;
+        bool yOk = false;
+        const qsizetype dot = parts.at(2).indexOf('.');
+        const int zoom = parts.at(0).toInt(&zoomOk);
+        const int x = parts.at(1).toInt(&xOk);
+        const int y = (dot >= 0 ? parts.at(2).left(dot) : parts.at(2)).toInt(&yOk);
+        if (zoomOk && xOk && yOk && zoom >= 0 && zoom <= 24 && x >= 0 && y >= 0 && x < (1 << zoom) && y < (1 << zoom))
+        {
+            const bool cached = m_cache.contains(tileKey(zoom, x, y));
+            tile = cachedTile(zoom, x, y);
+            m_served++;
+            m_hits += cached ? 1 : 0;
+        }
+    }
+
+    const QByteArray connection = keepAlive ? "keep-alive" : "close";
+    if (!tile || tile->isEmpty())
+    {
+        socket->write("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: " + connection + "\r\n\r\n");
+        return;
+    }
+
+    const QString format = m_store.format();
+    const QByteArray contentType = format == QStringLiteral("jpg") || format == QStringLiteral("jpeg") ? "image/jpeg"
+                                   : format == QStringLiteral("webp") ? "image/webp"
+                                                                      : "image/png";
+
+    socket->write("HTTP/1.1 200 OK\r\nContent-Type: " + contentType
+                  + "\r\nContent-Length: " + QByteArray::number(tile->size())
+                  + "\r\nConnection: " + connection + "\r\n\r\n");
+    socket->write(*tile);
+}
+
+quint64 TileServerWorker::tileKey(int zoom, int x, int y)
+{
+    return (quint64(zoom) << 48) | (quint64(x & 0xFFFFFF) << 24) | quint64(y & 0xFFFFFF);
+}
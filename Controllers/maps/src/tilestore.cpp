@@ -0,0 +1,152 @@
+#include "../include/tilestore.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSqlError>
+
+TileStore::TileStore()
+    : m_kind(Kind::None),
+    m_format(QStringLiteral("png")),
+    m_extensions({QStringLiteral("png"), QStringLiteral("jpg"), QStringLiteral("jpeg"), QStringLiteral("webp")})
+{
+}
+
+TileStore::~TileStore()
+{
+    close();
+}
+
+bool TileStore::open(const QString &path, QString *error)
+{
+    close();
+
+    const QFileInfo info(path);
+    if (info.isDir())
+    {
+        return openDirectory(info.absoluteFilePath(), error);
+    }
+    if (info.isFile())
+    {
+        return openMBTiles(info.absoluteFilePath(), error);
+    }
+
+    *error = QStringLiteral("Tile source not found: %1").arg(path);
+    return false;
+}
+
+void TileStore::close()
+{
+    if (m_kind == Kind::MBTiles)
+    {
+        m_tileQuery = QSqlQuery();
+        QSqlDatabase::database(m_connectionName, false).close();
+        QSqlDatabase::removeDatabase(m_connectionName);
+    }
+
+    m_kind = Kind::None;
+    m_path.clear();
+    m_format = QStringLiteral("png");
+}
+
+bool TileStore::openMBTiles(const QString &path, QString *error)
+{
+    // One connection per store, a connection must only be used from the thread that opened it
+    m_connectionName = QStringLiteral("tilestore-%1").arg(quintptr(this), 0, 16);
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), m_connectionName);
+        db.setDatabaseName(path);
+        db.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
+        if (!db.open())
+        {
+            *error = QStringLiteral("Cannot open MBTiles file %1: %2").arg(path, db.lastError().text());
+        }
+        else
+        {
+            QSqlQuery metadata(db);
+            if (metadata.exec(QStringLiteral("SELECT value FROM metadata WHERE name = 'format'")) && metadata.next())
+            {
+                m_format = metadata.value(0).toString().toLower();
+            }
+
+            m_tileQuery = QSqlQuery(db);
+            if (m_tileQuery.prepare(QStringLiteral("SELECT tile_data FROM tiles WHERE zoom_level = ? AND tile_column = ? AND tile_row = ?")))
+            {
+                m_kind = Kind::MBTiles;
+                m_path = path;
+                return true;
+            }
+            *error = QStringLiteral("Not an MBTiles file %1: %2").arg(path, m_tileQuery.lastError().text());
+            m_tileQuery = QSqlQuery();
+        }
+    }
+
+    QSqlDatabase::removeDatabase(m_connectionName);
+    return false;
+}
+
+bool TileStore::openDirectory(const QString &path, QString *error)
+{
+    if (!QDir(path).exists())
+    {
+        *error = QStringLiteral("Tile directory not found: %1").arg(path);
+        return false;
+    }
+
+    m_kind = Kind::Directory;
+    m_path = path;
+    return true;
+}
+
+QByteArray TileStore::tile(int zoom, int x, int y)
+{
+    if (zoom < 0 || zoom > 24 || x < 0 || y < 0 || x >= (1 << zoom) || y >= (1 << zoom))
+    {
+        return QByteArray();
+    }
+
+    if (m_kind == Kind::MBTiles)
+    {
+        // MBTiles counts rows from the south (TMS)
+        m_tileQuery.bindValue(0, zoom);
+        m_tileQuery.bindValue(1, x);
+        m_tileQuery.bindValue(2, (1 << zoom) - 1 - y);
+        if (!m_tileQuery.exec())
+        {
+            qDebug() << "TileStore: Tile query failed:" << m_tileQuery.lastError().text();
+            return QByteArray();
+        }
+
+        QByteArray data;
+        if (m_tileQuery.next())
+        {
+            data = m_tileQuery.value(0).toByteArray();
+        }
+        m_tileQuery.finish();
+        return data;
+    }
+
+    if (m_kind == Kind::Directory)
+    {
+        const QString base = QStringLiteral("%1/%2/%3/%4.").arg(m_path).arg(zoom).arg(x).arg(y);
+        for (qsizetype i = 0; i < m_extensions.size(); ++i)
+        {
+            QFile file(base + m_extensions.at(i));
+            if (!file.open(QIODevice::ReadOnly))
+            {
+                continue;
+            }
+
+            // Trees use a single format, so try the extension that matched last first next time
+            if (i != 0)
+            {
+                m_extensions.move(i, 0);
+            }
+            m_format = m_extensions.constFirst();
+            return file.readAll();
+        }
+    }
+
+    return QByteArray();
+}
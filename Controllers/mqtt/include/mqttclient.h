@@ -6,6 +6,8 @@
 #include <QThreadPool>
 #include <QAtomicInt>
 #include <atomic>
+#include "../../telemetry/include/telemetrystore.h"
+#include "../../telemetry/include/telemetrysourcestats.h"
 #include <QtMqtt/QMqttClient>
 
 // Forward declarations
@@ -21,21 +23,6 @@ class MqttParserWorker;
 class MqttClient : public QObject
 {
     Q_OBJECT
-    Q_PROPERTY(float speed READ speed NOTIFY speedChanged)
-    Q_PROPERTY(int rpm READ rpm NOTIFY rpmChanged)
-    Q_PROPERTY(int accPedal READ accPedal NOTIFY accPedalChanged)
-    Q_PROPERTY(int brakePedal READ brakePedal NOTIFY brakePedalChanged)
-    Q_PROPERTY(double encoderAngle READ encoderAngle NOTIFY encoderAngleChanged)
-    Q_PROPERTY(float temperature READ temperature NOTIFY temperatureChanged)
-    Q_PROPERTY(int batteryLevel READ batteryLevel NOTIFY batteryLevelChanged)
-    Q_PROPERTY(double gpsLongitude READ gpsLongitude NOTIFY gpsLongitudeChanged)
-    Q_PROPERTY(double gpsLatitude READ gpsLatitude NOTIFY gpsLatitudeChanged)
-    Q_PROPERTY(int speedFL READ speedFL NOTIFY speedFLChanged)
-    Q_PROPERTY(int speedFR READ speedFR NOTIFY speedFRChanged)
-    Q_PROPERTY(int speedBL READ speedBL NOTIFY speedBLChanged)
-    Q_PROPERTY(int speedBR READ speedBR NOTIFY speedBRChanged)
-    Q_PROPERTY(double lateralG READ lateralG NOTIFY lateralGChanged)
-    Q_PROPERTY(double longitudinalG READ longitudinalG NOTIFY longitudinalGChanged)
 
 public:
     explicit MqttClient(QObject *parent = nullptr); // Initialize the Client , its threads and workers.
@@ -72,40 +59,15 @@ public:
      */
     Q_INVOKABLE void setDebugMode(bool enabled);
 
-    // Property getters
-    float speed() const { return m_speed.load(); }
-    int rpm() const { return m_rpm.load(); }
-    int accPedal() const { return m_accPedal.load(); }
-    int brakePedal() const { return m_brakePedal.load(); }
-    double encoderAngle() const { return m_encoderAngle.load(); }
-    float temperature() const { return m_temperature.load(); }
-    int batteryLevel() const { return m_batteryLevel.load(); }
-    double gpsLongitude() const { return m_gpsLongitude.load(); }
-    double gpsLatitude() const { return m_gpsLatitude.load(); }
-    int speedFL() const { return m_speedFL.load(); }
-    int speedFR() const { return m_speedFR.load(); }
-    int speedBL() const { return m_speedBL.load(); }
-    int speedBR() const { return m_speedBR.load(); }
-    double lateralG() const { return m_lateralG.load(); }
-    double longitudinalG() const { return m_longitudinalG.load(); }
+    // Latest parsed frame, snapshots can be taken from any thread
+    const TelemetryStore &telemetryStore() const { return m_store; }
+
+    // Pipeline counters for the performance overlay, call from the GUI thread
+    TelemetrySourceStats stats();
 
 signals:
-    // Property change signals
-    void speedChanged(float newSpeed);
-    void rpmChanged(int newRpm);
-    void accPedalChanged(int newAccPedal);
-    void brakePedalChanged(int newBrakePedal);
-    void encoderAngleChanged(double newAngle);
-    void temperatureChanged(float newTemperature);
-    void batteryLevelChanged(int newBatteryLevel);
-    void gpsLongitudeChanged(double newLongitude);
-    void gpsLatitudeChanged(double newLatitude);
-    void speedFLChanged(int newSpeedFL);
-    void speedFRChanged(int newSpeedFR);
-    void speedBLChanged(int newSpeedBL);
-    void speedBRChanged(int newSpeedBR);
-    void lateralGChanged(double newLateralG);
-    void longitudinalGChanged(double newLongitudinalG);
+    // Emitted from the parser thread for every parsed frame, receivers must be thread-safe
+    void frameReceived(const TelemetryFrame &frame);
 
     // Error signal
     void errorOccurred(const QString &error);
@@ -115,11 +77,7 @@ signals:
     void stopReceiving();
 
 private slots:
-    void handleParsedData(float speed, int rpm, int accPedal, int brakePedal,
-                          double encoderAngle, float temperature, int batteryLevel,
-                          double gpsLongitude, double gpsLatitude,
-                          int speedFL, int speedFR, int speedBL, int speedBR,
-                          double lateralG, double longitudinalG);
+    void handleParsedData(const TelemetryFrame &frame); // Runs in the parser thread, stores the frame and forwards it.
 
     void handleError(const QString &error); // Handles error messages from workers.
 
@@ -139,25 +97,12 @@ private:
     bool m_debugMode;
 
     // Performance tracking
+    std::atomic<qint64> m_messagesReceived;
     std::atomic<qint64> m_messagesProcessed;
     std::atomic<qint64> m_messagesDropped;
 
-    // Data storage with atomic access
-    std::atomic<float> m_speed;
-    std::atomic<int> m_rpm;
-    std::atomic<int> m_accPedal;
-    std::atomic<int> m_brakePedal;
-    std::atomic<double> m_encoderAngle;
-    std::atomic<float> m_temperature;
-    std::atomic<int> m_batteryLevel;
-    std::atomic<double> m_gpsLongitude;
-    std::atomic<double> m_gpsLatitude;
-    std::atomic<int> m_speedFL;
-    std::atomic<int> m_speedFR;
-    std::atomic<int> m_speedBL;
-    std::atomic<int> m_speedBR;
-    std::atomic<double> m_lateralG;
-    std::atomic<double> m_longitudinalG;
+    // Latest frame, written by the parser threads without locks
+    TelemetryStore m_store;
 
     // Helper methods
     void initializeParsers();
@@ -8,6 +8,7 @@
 #include <QQueue>
 #include <QWaitCondition>
 #include <atomic>
+#include "../../telemetry/include/telemetryframe.h"
 
 /**
  * @brief The MqttParserWorker class parses MQTT messages in a thread pool
@@ -29,6 +30,9 @@ public:
      */
     void run() override;
 
+    qsizetype queueDepth(); // Messages waiting to be parsed.
+    quint64 messagesRejected() const { return m_messagesRejected.load(std::memory_order_relaxed); }
+
 public slots:
     /**
      * @brief Queue a message for parsing
@@ -44,12 +48,9 @@ public slots:
 signals:
     /**
      * @brief Signal emitted when a message is successfully parsed
+     * @param frame The decoded telemetry values
      */
-    void messageParsed(float speed, int rpm, int accPedal, int brakePedal,
-                       double encoderAngle, float temperature, int batteryLevel,
-                       double gpsLongitude, double gpsLatitude,
-                       int speedFL, int speedFR, int speedBL, int speedBR,
-                       double lateralG, double longitudinalG);
+    void messageParsed(const TelemetryFrame &frame);
 
     /**
      * @brief Signal emitted when an error occurs during parsing
@@ -61,12 +62,14 @@ private:
     /**
      * @brief Parse a single message
      * @param data The message data to parse
+     * @return True if the message produced a frame
      */
-    void parseMessage(const QByteArray &data);
+    bool parseMessage(const QByteArray &data);
 
     bool m_debugMode;
     std::atomic<bool> m_running;
     std::atomic<quint64> m_messagesParsed;
+    std::atomic<quint64> m_messagesRejected;
 
     // Thread-safe queue for messages
     QQueue<QByteArray> m_queue;
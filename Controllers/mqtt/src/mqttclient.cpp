@@ -10,23 +10,9 @@ MqttClient::MqttClient(QObject *parent)
     m_nextParserIndex(0),
     m_parserThreadCount(QThread::idealThreadCount()),
     m_debugMode(true),
+    m_messagesReceived(0),
     m_messagesProcessed(0),
-    m_messagesDropped(0),
-    m_speed(0.0f),
-    m_rpm(0),
-    m_accPedal(0),
-    m_brakePedal(0),
-    m_encoderAngle(0.0),
-    m_temperature(0.0f),
-    m_batteryLevel(0),
-    m_gpsLongitude(0.0),
-    m_gpsLatitude(0.0),
-    m_speedFL(0),
-    m_speedFR(0),
-    m_speedBL(0),
-    m_speedBR(0),
-    m_lateralG(0.0),
-    m_longitudinalG(0.0)
+    m_messagesDropped(0)
 {
     m_receiverWorker = new MqttReceiverWorker();
     m_receiverWorker->moveToThread(&m_receiverThread);
@@ -115,126 +101,42 @@ void MqttClient::setDebugMode(bool enabled)
 
 void MqttClient::handleMqttMessageReceived(const QByteArray &message)
 {
+    m_messagesReceived.fetch_add(1, std::memory_order_relaxed);
+
     if (!m_parsers.isEmpty())
     {
         MqttParserWorker *parser = m_parsers[m_nextParserIndex];
         parser->queueMessage(message);
         m_nextParserIndex = (m_nextParserIndex + 1) % m_parsers.size();
     }
+    else
+    {
+        m_messagesDropped.fetch_add(1, std::memory_order_relaxed);
+    }
 }
 
-void MqttClient::handleParsedData(float speed, int rpm, int accPedal, int brakePedal,
-                                  double encoderAngle, float temperature, int batteryLevel,
-                                  double gpsLongitude, double gpsLatitude,
-                                  int speedFL, int speedFR, int speedBL, int speedBR,
-                                  double lateralG, double longitudinalG)
+void MqttClient::handleParsedData(const TelemetryFrame &frame)
 {
     m_messagesProcessed.fetch_add(1);
 
-    float oldSpeed = m_speed.load(std::memory_order_relaxed);
-    if (!qFuzzyCompare(oldSpeed, speed))
-    {
-        m_speed.store(speed, std::memory_order_relaxed);
-        emit speedChanged(speed);
-    }
-
-    int oldRpm = m_rpm.load(std::memory_order_relaxed);
-    if (oldRpm != rpm)
-    {
-        m_rpm.store(rpm, std::memory_order_relaxed);
-        emit rpmChanged(rpm);
-    }
-
-    int oldAccPedal = m_accPedal.load(std::memory_order_relaxed);
-    if (oldAccPedal != accPedal)
-    {
-        m_accPedal.store(accPedal, std::memory_order_relaxed);
-        emit accPedalChanged(accPedal);
-    }
-
-    int oldBrakePedal = m_brakePedal.load(std::memory_order_relaxed);
-    if (oldBrakePedal != brakePedal)
-    {
-        m_brakePedal.store(brakePedal, std::memory_order_relaxed);
-        emit brakePedalChanged(brakePedal);
-    }
-
-    double oldEncoderAngle = m_encoderAngle.load(std::memory_order_relaxed);
-    if (!qFuzzyCompare(oldEncoderAngle, encoderAngle))
-    {
-        m_encoderAngle.store(encoderAngle, std::memory_order_relaxed);
-        emit encoderAngleChanged(encoderAngle);
-    }
-
-    float oldTemperature = m_temperature.load(std::memory_order_relaxed);
-    if (!qFuzzyCompare(oldTemperature, temperature))
-    {
-        m_temperature.store(temperature, std::memory_order_relaxed);
-        emit temperatureChanged(temperature);
-    }
-
-    int oldBatteryLevel = m_batteryLevel.load(std::memory_order_relaxed);
-    if (oldBatteryLevel != batteryLevel)
-    {
-        m_batteryLevel.store(batteryLevel, std::memory_order_relaxed);
-        emit batteryLevelChanged(batteryLevel);
-    }
+    // Publish the new frame, readers only need the latest state
+    m_store.write(frame);
 
-    double oldGpsLongitude = m_gpsLongitude.load(std::memory_order_relaxed);
-    if (!qFuzzyCompare(oldGpsLongitude, gpsLongitude))
-    {
-        m_gpsLongitude.store(gpsLongitude, std::memory_order_relaxed);
-        emit gpsLongitudeChanged(gpsLongitude);
-    }
-
-    double oldGpsLatitude = m_gpsLatitude.load(std::memory_order_relaxed);
-    if (!qFuzzyCompare(oldGpsLatitude, gpsLatitude))
-    {
-        m_gpsLatitude.store(gpsLatitude, std::memory_order_relaxed);
-        emit gpsLatitudeChanged(gpsLatitude);
-    }
-
-    int oldSpeedFL = m_speedFL.load(std::memory_order_relaxed);
-    if (oldSpeedFL != speedFL)
-    {
-        m_speedFL.store(speedFL, std::memory_order_relaxed);
-        emit speedFLChanged(speedFL);
-    }
-
-    int oldSpeedFR = m_speedFR.load(std::memory_order_relaxed);
-    if (oldSpeedFR != speedFR)
-    {
-        m_speedFR.store(speedFR, std::memory_order_relaxed);
-        emit speedFRChanged(speedFR);
-    }
-
-    int oldSpeedBL = m_speedBL.load(std::memory_order_relaxed);
-    if (oldSpeedBL != speedBL)
-    {
-        m_speedBL.store(speedBL, std::memory_order_relaxed);
-        emit speedBLChanged(speedBL);
-    }
-
-    int oldSpeedBR = m_speedBR.load(std::memory_order_relaxed);
-    if (oldSpeedBR != speedBR)
-    {
-        m_speedBR.store(speedBR, std::memory_order_relaxed);
-        emit speedBRChanged(speedBR);
-    }
-
-    double oldLateralG = m_lateralG.load(std::memory_order_relaxed);
-    if (!qFuzzyCompare(oldLateralG, lateralG))
-    {
-        m_lateralG.store(lateralG, std::memory_order_relaxed);
-        emit lateralGChanged(lateralG);
-    }
+    emit frameReceived(frame);
+}
 
-    double oldLongitudinalG = m_longitudinalG.load(std::memory_order_relaxed);
-    if (!qFuzzyCompare(oldLongitudinalG, longitudinalG))
+TelemetrySourceStats MqttClient::stats()
+{
+    TelemetrySourceStats stats;
+    stats.received = quint64(m_messagesReceived.load(std::memory_order_relaxed));
+    stats.parsed = quint64(m_messagesProcessed.load(std::memory_order_relaxed));
+    stats.dropped = quint64(m_messagesDropped.load(std::memory_order_relaxed));
+    for (auto *parser : m_parsers)
     {
-        m_longitudinalG.store(longitudinalG, std::memory_order_relaxed);
-        emit longitudinalGChanged(longitudinalG);
+        stats.dropped += parser->messagesRejected();
+        stats.queued += parser->queueDepth();
     }
+    return stats;
 }
 
 void MqttClient::handleError(const QString &error)
@@ -253,7 +155,7 @@ void MqttClient::initializeParsers()
     {
         MqttParserWorker *parser = new MqttParserWorker(m_debugMode);
 
-        connect(parser, &MqttParserWorker::messageParsed, this, &MqttClient::handleParsedData, Qt::QueuedConnection);
+        connect(parser, &MqttParserWorker::messageParsed, this, &MqttClient::handleParsedData, Qt::DirectConnection);
         connect(parser, &MqttParserWorker::errorOccurred, this, &MqttClient::handleError, Qt::QueuedConnection);
 
         m_parsers.append(parser);
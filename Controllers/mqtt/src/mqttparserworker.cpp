@@ -9,7 +9,8 @@ MqttParserWorker::MqttParserWorker(bool debugMode, QObject *parent)
     : QObject(parent),
     m_debugMode(debugMode),
     m_running(true),
-    m_messagesParsed(0)
+    m_messagesParsed(0),
+    m_messagesRejected(0)
 {
     setAutoDelete(true);
 }
@@ -62,7 +63,10 @@ void MqttParserWorker::run()
         }
 
         // Parse the message
-        parseMessage(message);
+        if (!parseMessage(message))
+        {
+            m_messagesRejected.fetch_add(1, std::memory_order_relaxed);
+        }
     }
 
     if (m_debugMode)
@@ -82,6 +86,12 @@ void MqttParserWorker::queueMessage(const QByteArray &data)
     m_queueCondition.wakeOne();
 }
 
+qsizetype MqttParserWorker::queueDepth()
+{
+    QMutexLocker locker(&m_queueMutex);
+    return m_queue.size();
+}
+
 void MqttParserWorker::stop()
 {
     m_running.store(false);
@@ -91,7 +101,7 @@ void MqttParserWorker::stop()
     m_queueCondition.wakeAll();
 }
 
-void MqttParserWorker::parseMessage(const QByteArray &message)
+bool MqttParserWorker::parseMessage(const QByteArray &message)
 {
     try
     {
@@ -109,21 +119,23 @@ void MqttParserWorker::parseMessage(const QByteArray &message)
             bool okLateralG = false, okLongitudinalG = false;
 
             // Parse values
-            float speed = parts[0].toFloat(&okSpeed);
-            int rpm = parts[1].toInt(&okRpm);
-            int accPedal = parts[2].toInt(&okAcc);
-            int brakePedal = parts[3].toInt(&okBrake);
-            double encoderAngle = parts[4].toDouble(&okAngle);
-            float temperature = parts[5].toFloat(&okTemp);
-            int batteryLevel = parts[6].toInt(&okBattery);
-            double gpsLongitude = parts[7].toDouble(&okGpsLon);
-            double gpsLatitude = parts[8].toDouble(&okGpsLat);
-            int speedFL = parts[9].toInt(&okWSFL);
-            int speedFR = parts[10].toInt(&okWSFR);
-            int speedBL = parts[11].toInt(&okWSBL);
-            int speedBR = parts[12].toInt(&okWSBR);
-            double lateralG = parts[13].toDouble(&okLateralG);
-            double longitudinalG = parts[14].toDouble(&okLongitudinalG);
+            TelemetryFrame frame;
+            frame.timestampUs = telemetryTimestampUs();
+            frame.speed = parts[0].toFloat(&okSpeed);
+            frame.rpm = parts[1].toInt(&okRpm);
+            frame.accPedal = parts[2].toInt(&okAcc);
+            frame.brakePedal = parts[3].toInt(&okBrake);
+            frame.encoderAngle = parts[4].toDouble(&okAngle);
+            frame.temperature = parts[5].toFloat(&okTemp);
+            frame.batteryLevel = parts[6].toInt(&okBattery);
+            frame.gpsLongitude = parts[7].toDouble(&okGpsLon);
+            frame.gpsLatitude = parts[8].toDouble(&okGpsLat);
+            frame.speedFL = parts[9].toInt(&okWSFL);
+            frame.speedFR = parts[10].toInt(&okWSFR);
+            frame.speedBL = parts[11].toInt(&okWSBL);
+            frame.speedBR = parts[12].toInt(&okWSBR);
+            frame.lateralG = parts[13].toDouble(&okLateralG);
+            frame.longitudinalG = parts[14].toDouble(&okLongitudinalG);
 
             // Check if all values were parsed successfully
             if (okSpeed && okRpm && okAcc && okBrake && okAngle && okTemp &&
@@ -132,18 +144,14 @@ void MqttParserWorker::parseMessage(const QByteArray &message)
                 okLateralG && okLongitudinalG)
             {
                 // Emit signal with parsed data
-                emit messageParsed(
-                    speed, rpm, accPedal, brakePedal,
-                    encoderAngle, temperature, batteryLevel,
-                    gpsLongitude, gpsLatitude,
-                    speedFL, speedFR, speedBL, speedBR,
-                    lateralG, longitudinalG);
+                emit messageParsed(frame);
 
                 // Log debug info
                 if (m_debugMode)
                 {
-                    qDebug() << "MqttParserWorker: Parsed message - Speed:" << speed << "RPM:" << rpm;
+                    qDebug() << "MqttParserWorker: Parsed message - Speed:" << frame.speed << "RPM:" << frame.rpm;
                 }
+                return true;
             }
             else
             {
@@ -163,6 +171,7 @@ void MqttParserWorker::parseMessage(const QByteArray &message)
     {
         emit errorOccurred("MQTT: Unknown exception during parsing");
     }
+    return false;
 }
 
 
@@ -0,0 +1,197 @@
+#ifndef BLACKBOXRECORDER_H
+#define BLACKBOXRECORDER_H
+
+#include <QObject>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include "sessionlogformat.h"
+#include "sessionindex.h"
+#include "../../telemetry/include/telemetrychannels.h"
+
+// Forward declarations
+class QThread;
+class SessionLogWriter;
+
+/**
+ * @brief The BlackBoxRecorder class keeps the last minutes of raw frames in memory and saves them when triggered
+ *
+ * Frames go into a fixed ring of slots without a lock: a writer claims a slot with one fetch-add and
+ * publishes it through the slot's sequence number, so parser threads never wait for each other or for
+ * the black box thread. Readers copy a slot and check its sequence number afterwards, a slot the
+ * writers lapped meanwhile is counted as lost instead of being read torn.
+ *
+ * A trigger, either trigger() from the UI or a channel rule, saves the frames of the last
+ * preTriggerSeconds plus those of the next postTriggerSeconds to a session log in directory(). A
+ * trigger while a dump is running extends it. Rules are checked and dumps are written on the black
+ * box thread, which follows the ring a few times per second, so the ingest path only ever copies a
+ * frame into its slot.
+ */
+class BlackBoxRecorder : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool armed READ isArmed WRITE setArmed NOTIFY armedChanged)
+    Q_PROPERTY(bool dumping READ isDumping NOTIFY dumpingChanged)
+    Q_PROPERTY(QString lastDumpPath READ lastDumpPath NOTIFY dumpingChanged)
+    Q_PROPERTY(QString directory READ directory WRITE setDirectory NOTIFY directoryChanged)
+    Q_PROPERTY(int preTriggerSeconds READ preTriggerSeconds WRITE setPreTriggerSeconds NOTIFY windowChanged)
+    Q_PROPERTY(int postTriggerSeconds READ postTriggerSeconds WRITE setPostTriggerSeconds NOTIFY windowChanged)
+
+public:
+    static constexpr qsizetype DefaultCapacity = qsizetype(1) << 19; // ~8.7 min at 1 kHz, 48 MiB
+
+    /**
+     * @brief Create an armed black box
+     * @param capacity Frames kept, rounded up to a power of two
+     */
+    explicit BlackBoxRecorder(qsizetype capacity = DefaultCapacity, QObject *parent = nullptr);
+    ~BlackBoxRecorder();
+
+    /**
+     * @brief Put one frame into the ring, callable from any thread without blocking
+     */
+    void append(const TelemetryFrame &frame);
+
+    /**
+     * @brief Forget the frames in the ring, e.g. when the source changes; a running dump ends
+     */
+    void clear();
+
+    /**
+     * @brief Save the ring and the next postTriggerSeconds, or extend the dump that is running
+     * @param reason Kept as a marker in the log, up to 16 bytes of UTF-8
+     */
+    Q_INVOKABLE void trigger(const QString &reason = QString());
+
+    /**
+     * @brief Trigger a dump when a channel crosses a threshold
+     *
+     * A rule fires once when its condition becomes true and again only after it was false.
+     * @param channel The property name of the channel, e.g. "temperature"
+     * @param condition "above", "below", or "drop" for a fall by threshold within windowMs
+     * @param windowMs Only used by "drop"
+     * @return False if the channel or the condition is unknown
+     */
+    Q_INVOKABLE bool addTriggerRule(const QString &channel, const QString &condition, double threshold, int windowMs = 1000);
+    Q_INVOKABLE void clearTriggerRules();
+
+    qsizetype capacity() const { return m_capacity; }
+
+    bool isArmed() const { return m_armed.load(std::memory_order_relaxed); }
+    void setArmed(bool armed);
+
+    bool isDumping() const { return m_dumping.load(std::memory_order_relaxed); }
+    QString lastDumpPath() const;
+
+    QString directory() const { return m_directory; }
+    void setDirectory(const QString &directory);
+
+    int preTriggerSeconds() const { return m_preTriggerSeconds.load(std::memory_order_relaxed); }
+    void setPreTriggerSeconds(int seconds);
+    int postTriggerSeconds() const { return m_postTriggerSeconds.load(std::memory_order_relaxed); }
+    void setPostTriggerSeconds(int seconds);
+
+    /**
+     * @brief Source of the following frames, stored with every frame of a dump
+     */
+    void setTransport(SessionLog::Transport transport);
+
+signals:
+    void armedChanged();
+    void dumpingChanged();
+    void directoryChanged();
+    void windowChanged();
+    void triggered(const QString &reason);
+    void dumpFinished(const QString &filePath, qint64 frames, qint64 lostFrames);
+    void errorOccurred(const QString &error);
+
+private:
+    // Words are relaxed atomics, so a reader racing a writer is well-defined and caught by the sequence
+    static constexpr int WordCount = (sizeof(TelemetryFrame) + sizeof(quint64) - 1) / sizeof(quint64);
+
+    struct Slot
+    {
+        std::atomic<quint64> sequence; // 2 * index + 1 while frame index is written, 2 * index + 2 once it is complete
+        std::atomic<quint64> words[WordCount];
+    };
+
+    enum class SlotState { Ready, Pending, Lost };
+
+    struct Rule
+    {
+        enum class Condition { Above, Below, Drop };
+
+        TelemetryChannel channel = TelemetryChannel::Speed;
+        Condition condition = Condition::Above;
+        double threshold = 0.0;
+        qint64 windowUs = 0;
+        QString reason;
+
+        // Only used by the black box thread
+        bool active = false;
+        std::deque<std::pair<qint64, double>> maxima; // Falling maxima of the window, for Drop
+    };
+
+    struct Trigger
+    {
+        qint64 timeUs = 0;
+        QString reason;
+    };
+
+    struct Dump
+    {
+        std::unique_ptr<SessionLogWriter> writer;
+        QString filePath;
+        quint64 start = 0;     // m_start when the dump began, a clear() ends the dump
+        quint64 readIndex = 0;
+        qint64 fromUs = 0;
+        qint64 untilUs = 0;
+        qint64 wallOffsetUs = 0; // Added to the frame times, session logs are on the wall clock
+        qint64 lostFrames = 0;
+        bool opened = false;
+        bool failed = false;
+        QString error;
+        QList<SessionIndex::Marker> markers;
+        QList<TelemetryFrame> batch;
+    };
+
+    SlotState read(quint64 index, TelemetryFrame &frame) const;
+    quint64 oldestReadable() const; // Oldest index a reader can still get to before the writers do.
+    void run();                     // Runs on the black box thread until disarmed.
+    static bool checkRule(Rule &rule, const TelemetryFrame &frame); // True when the rule fires.
+    void startDump(Dump &dump, const Trigger &trigger, const QString &directory);
+    bool writeDump(Dump &dump);     // Returns true once the dump is complete.
+    void finishDump(Dump &dump);
+    void startThread();
+    void stopThread();
+
+    const qsizetype m_capacity;
+    const quint64 m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+    std::atomic<quint64> m_head;
+    std::atomic<quint64> m_start; // Index of the first frame after the last clear()
+
+    std::atomic<bool> m_armed;
+    std::atomic<bool> m_dumping;
+    std::atomic<quint8> m_transport;
+    std::atomic<int> m_preTriggerSeconds;
+    std::atomic<int> m_postTriggerSeconds;
+    QString m_directory; // Written under the mutex, read by the black box thread when a dump starts
+    QThread *m_thread;
+
+    // Shared between the callers and the black box thread
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;
+    QList<Trigger> m_pendingTriggers;
+    QList<Rule> m_rules;
+    bool m_rulesChanged;
+    QString m_lastDumpPath;
+    bool m_stopping;
+};
+
+#endif // BLACKBOXRECORDER_H
@@ -0,0 +1,138 @@
+#ifndef BLOCKWRITEQUEUE_H
+#define BLOCKWRITEQUEUE_H
+
+#include <QFile>
+#include <QList>
+#include <QString>
+
+/**
+ * @brief The BlockWriteQueue class writes whole buffers to positions of a file with a fixed number in flight
+ *
+ * The buffers are allocated by the queue, aligned for direct I/O, and filled in place by the caller.
+ * With the io_uring backend (Linux 5.1 and later) they are registered with the kernel once, so a write
+ * is a single submission queue entry without copying or pinning pages per call, and up to queueDepth
+ * writes proceed while the caller goes on. If the buffers cannot be registered, plain io_uring writes
+ * are used, which need Linux 5.6. Where io_uring is not compiled in, not allowed, e.g. by a container's
+ * seccomp profile, or cannot write without registered buffers, the queue falls back to one blocking
+ * pwrite per buffer. A failed submission ends the use of the ring, later writes fail.
+ *
+ * Direct I/O (O_DIRECT, Linux only) bypasses the page cache, so recording does not evict the pages of
+ * everything else. Offsets and sizes then have to be multiples of Alignment. If the file system
+ * refuses direct I/O the queue falls back to buffered writes. A short direct write is only continued
+ * if it ended on an aligned position, otherwise the write fails.
+ */
+class BlockWriteQueue
+{
+public:
+    enum class Backend { Pwrite, IoUring };
+
+    static constexpr int Alignment = 4096;
+
+    struct Completion
+    {
+        int buffer = 0;
+        bool ok = false;
+    };
+
+    BlockWriteQueue();
+    ~BlockWriteQueue();
+
+    BlockWriteQueue(const BlockWriteQueue &) = delete;
+    BlockWriteQueue &operator=(const BlockWriteQueue &) = delete;
+
+    /**
+     * @brief True if io_uring is compiled in and the kernel lets this process set up a ring
+     */
+    static bool ioUringSupported();
+
+    /**
+     * @brief Open an existing file for writing and allocate the buffers
+     * @param backend The preferred backend, Pwrite is used if it is not available
+     * @param direct Bypass the page cache if the file system allows it
+     * @param queueDepth Most writes in flight at once, 1 with the Pwrite backend
+     * @return False if the file cannot be opened or the buffers cannot be allocated
+     */
+    bool open(const QString &path, Backend backend, bool direct, int queueDepth, int bufferCount, qsizetype bufferBytes, QString *error = nullptr);
+
+    /**
+     * @brief Wait for the writes in flight and close the file
+     */
+    void close();
+
+    bool isOpen() const { return m_fd >= 0 || m_file.isOpen(); }
+    Backend backend() const { return m_backend; }
+    bool isDirect() const { return m_direct; }
+    int queueDepth() const { return m_queueDepth; }
+    int inFlight() const { return m_inFlight; }
+    QString errorString() const { return m_error; }
+    QString description() const; // E.g. "io_uring, O_DIRECT, depth 4".
+
+    uchar *buffer(int index) const { return m_buffers.at(index); }
+
+    /**
+     * @brief Start writing part of a buffer, the buffer must not change until its write completed
+     *
+     * Only call with fewer than queueDepth() writes in flight. The Pwrite backend writes right away.
+     * @param data Start of the bytes to write, inside buffer(index)
+     * @return False if the write could not be started
+     */
+    bool submit(int index, const uchar *data, qint64 size, qint64 offset);
+
+    /**
+     * @brief Collect the writes that completed since the last call, in any order
+     * @param wait Block until at least one completes if any is in flight
+     */
+    void complete(bool wait, QList<Completion> &completions);
+
+private:
+    struct Write
+    {
+        const uchar *data = nullptr;
+        qint64 size = 0;
+        qint64 offset = 0;
+    };
+
+    bool setupRing();
+    void closeRing();
+    bool submitWrite(int index); // Queues the rest of a write to the ring.
+
+    QFile m_file; // Only used by the Pwrite backend where there is no pwrite
+    int m_fd;
+    Backend m_backend;
+    bool m_direct;
+    int m_queueDepth;
+    int m_inFlight;
+    qsizetype m_bufferBytes;
+    QList<uchar *> m_buffers;
+    QList<Write> m_writes;
+    QList<Completion> m_finished; // Completions of the Pwrite backend, handed out by complete()
+    QString m_error;
+
+    // Positions of the ring fields in the mappings, as reported by the kernel
+    struct RingOffsets
+    {
+        quint32 submissionHead = 0;
+        quint32 submissionTail = 0;
+        quint32 submissionMask = 0;
+        quint32 submissionArray = 0;
+        quint32 submissionEntries = 0;
+        quint32 completionHead = 0;
+        quint32 completionTail = 0;
+        quint32 completionMask = 0;
+        quint32 completions = 0;
+    };
+
+    // io_uring state, unused unless the backend is IoUring
+    RingOffsets m_ring;
+    int m_ringFd;
+    bool m_registered;
+    void *m_submissionRing;
+    void *m_completionRing;
+    void *m_entries;
+    qsizetype m_submissionRingBytes;
+    qsizetype m_completionRingBytes;
+    qsizetype m_entriesBytes;
+    bool m_ringFailed; // A submission failed, the ring takes no more writes
+};
+
+#endif // BLOCKWRITEQUEUE_H
@@ -0,0 +1,104 @@
+#ifndef SESSIONINDEX_H
+#define SESSIONINDEX_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include "sessionlogformat.h"
+
+// Forward declarations
+class QFile;
+
+/**
+ * @brief The SessionIndex class is the sparse time index and marker list of a session log
+ *
+ * It lives in a sidecar next to the log (Test-20250101-120000.tlog -> Test-20250101-120000.idx) with
+ * one fixed-size entry per block and per lap or marker. The recorder appends an entry after every
+ * block it writes, so the index survives a crash as far as the log does. Finding a time or a lap is a
+ * binary search over the entries followed by a single positioned read of the block.
+ *
+ * Index file: magic "ASURTIDX", u16 version, u16 entry size, 20 reserved bytes, then 64-byte entries:
+ * u8 kind, 7 reserved bytes, i64 time (us), i64 last time (us), i64 offset, u32 frame count or lap
+ * number, u32 block size (0 in older indexes), u64 first sequence, 16 bytes of UTF-8 label, zero padded
+ */
+class SessionIndex
+{
+public:
+    static constexpr int HeaderSize = 32;
+    static constexpr int EntrySize = 64;
+
+    struct Block
+    {
+        qint64 firstTimeUs = 0;
+        qint64 lastTimeUs = 0;
+        qint64 offset = 0;
+        quint32 recordCount = 0;
+        quint64 firstSequence = 0;
+        quint32 blockBytes = 0; // Including padding, 0 if the index predates padded blocks
+
+        qint64 size() const { return blockBytes != 0 ? blockBytes : SessionLog::columnOffset(SessionLog::ColumnCount, recordCount); }
+    };
+
+    struct Marker
+    {
+        enum class Kind : quint8 { Lap = 2, Marker = 3 };
+
+        Kind kind = Kind::Marker;
+        qint64 timeUs = 0;
+        int lap = 0;   // Number of the lap that starts here, 0 for plain markers
+        QString label; // At most 16 bytes of UTF-8 are kept
+    };
+
+    /**
+     * @brief The sidecar path of a session log
+     */
+    static QString indexPath(const QString &logPath);
+
+    /**
+     * @brief Load the index of a session log, rebuilding what is missing
+     *
+     * Blocks after the last indexed one, or all of them if the sidecar is missing or unreadable, are
+     * taken from the block headers of the log and the sidecar is rewritten. The sidecar of a log
+     * that is still being recorded is left alone, its rebuilt index is only kept in memory. Markers
+     * are only ever stored in the sidecar.
+     * @return False if the log itself cannot be read
+     */
+    static bool open(const QString &logPath, SessionIndex &index, QString *error = nullptr);
+
+    bool load(const QString &indexPath);
+    bool save(const QString &indexPath) const;
+
+    const QList<Block> &blocks() const { return m_blocks; }
+    const QList<Marker> &markers() const { return m_markers; }
+    qint64 coveredBytes() const; // End of the last indexed block in the log.
+    int lapCount() const;
+
+    /**
+     * @brief Index of the first block that ends at or after a time, blocks().size() if none does
+     */
+    qsizetype blockAt(qint64 timeUs) const;
+
+    /**
+     * @brief Start time of a lap, -1 if the session has no such lap
+     */
+    qint64 lapStartUs(int lap) const;
+
+    /**
+     * @brief Read one indexed block of the log with a single positioned read
+     * @param log The session log, opened for reading
+     */
+    bool readBlock(QFile &log, qsizetype block, QByteArray &data, SessionLog::BlockHeader &header) const;
+
+    void appendBlock(const Block &block);
+    void appendMarker(const Marker &marker);
+
+    static QByteArray encodeHeader();
+    static QByteArray encode(const Block &block);
+    static QByteArray encode(const Marker &marker);
+
+private:
+    QList<Block> m_blocks;
+    QList<Marker> m_markers;
+};
+
+#endif // SESSIONINDEX_H
@@ -0,0 +1,193 @@
+#ifndef SESSIONLOGFORMAT_H
+#define SESSIONLOGFORMAT_H
+
+#include <QtGlobal>
+#include <array>
+#include "../../telemetry/include/telemetryframe.h"
+#include "../../telemetry/include/telemetrychannels.h"
+
+// Forward declarations
+class QFile;
+
+/**
+ * @brief Layout of the append-only session log (.tlog), all integers little-endian
+ *
+ * A file header is followed by blocks. Every block is one write of the recorder and stores its frames
+ * column by column, so a reader can take one channel of a whole session without touching the others.
+ * A block cut short by a crash is detected by its size and ignored by readers, a block torn by a power
+ * loss is detected by its checksum when the log is recovered, see SessionRecovery. A block may end in
+ * zero padding, which lets a recorder writing with direct I/O keep every block aligned.
+ *
+ * File header (64 bytes):   magic "ASURTLOG", u16 version, u16 flags, u16 channel count,
+ *                           u16 reserved, i64 wall clock at start (ms since epoch), i64 monotonic
+ *                           start (us), 32 reserved bytes
+ * Block header (40 bytes):  magic "TBLK", u32 frame count, u64 first sequence, i64 first and last
+ *                           receive time (us), u32 block size including all headers and padding,
+ *                           u32 CRC-32C of the whole block without this field
+ * Column directory:         per column u32 offset from the block start, u32 size, f64 minimum and
+ *                           maximum value
+ * Columns:                  i64 receive time (us), u64 sequence, u8 transport padded to 8 bytes,
+ *                           then one f64 column per channel in TelemetryChannel order
+ */
+namespace SessionLog
+{
+constexpr char FileMagic[8] = {'A', 'S', 'U', 'R', 'T', 'L', 'O', 'G'};
+constexpr char BlockMagic[4] = {'T', 'B', 'L', 'K'};
+constexpr quint16 Version = 4;
+
+// Version 2 logs have the same layout without checksums and flags, they are still read as they are
+constexpr quint16 MinimumVersion = 2;
+
+// Version 3 added block checksums and the header flags, version 4 allows padded blocks
+constexpr quint16 ChecksumVersion = 3;
+
+/**
+ * @brief Bits of the file header flags
+ */
+enum FileFlag : quint16
+{
+    ClosedFlag = 0x1 // Set once the recorder has written and synced its last block
+};
+
+/**
+ * @brief Columns of a block, the channels follow in TelemetryChannel order
+ */
+enum Column : int
+{
+    TimestampColumn,
+    SequenceColumn,
+    TransportColumn,
+    FirstChannelColumn
+};
+
+constexpr int ColumnCount = FirstChannelColumn + TelemetryChannelCount;
+
+constexpr int FileHeaderSize = 64;
+constexpr int ColumnEntrySize = 24;
+constexpr int BlockHeaderSize = 40 + ColumnCount * ColumnEntrySize;
+
+/**
+ * @brief The transport a frame was received on
+ */
+enum class Transport : quint8
+{
+    Unknown,
+    Serial,
+    Udp,
+    Mqtt,
+    Replay
+};
+
+struct FileHeader
+{
+    qint64 startedMsSinceEpoch = 0;
+    qint64 startTimeUs = 0;
+    quint16 version = Version;
+    quint16 flags = 0;
+    quint16 channelCount = TelemetryChannelCount;
+};
+
+struct ColumnInfo
+{
+    quint32 offset = 0;
+    quint32 bytes = 0;
+    double minimum = 0.0;
+    double maximum = 0.0;
+};
+
+struct BlockHeader
+{
+    quint32 recordCount = 0;
+    quint64 firstSequence = 0;
+    qint64 firstTimeUs = 0;
+    qint64 lastTimeUs = 0;
+    quint32 blockBytes = 0;
+    quint32 checksum = 0;
+    std::array<ColumnInfo, ColumnCount> columns;
+};
+
+struct Record
+{
+    quint64 sequence = 0;
+    Transport transport = Transport::Unknown;
+    TelemetryFrame frame; // Receive time in frame.timestampUs
+};
+
+constexpr int channelColumn(TelemetryChannel channel)
+{
+    return FirstChannelColumn + static_cast<int>(channel);
+}
+
+/**
+ * @brief Bytes of one column holding count frames, a multiple of 8 so every column stays aligned
+ */
+constexpr qsizetype columnBytes(int column, quint32 count)
+{
+    return column == TransportColumn ? (qsizetype(count) + 7) & ~qsizetype(7) : qsizetype(count) * 8;
+}
+
+/**
+ * @brief Offset of a column in a block holding count frames, columns are stored back to back
+ */
+constexpr qsizetype columnOffset(int column, quint32 count)
+{
+    return column <= TransportColumn
+               ? BlockHeaderSize + qsizetype(column) * count * 8
+               : BlockHeaderSize + qsizetype(column - 1) * count * 8 + columnBytes(TransportColumn, count);
+}
+
+/**
+ * @brief Most frames a block of the given size can hold
+ */
+constexpr quint32 blockCapacity(qsizetype blockBytes)
+{
+    return quint32((blockBytes - BlockHeaderSize - 7) / ((ColumnCount - 1) * 8 + 1));
+}
+
+void writeFileHeader(uchar *destination, const FileHeader &header);
+bool readFileHeader(const uchar *source, FileHeader &header); // False if the magic or the layout does not match.
+
+/**
+ * @brief Set the closed flag in the header of an open log, the file position is left at its end
+ */
+bool markClosed(QFile &log);
+
+/**
+ * @brief Flush a log or its index from the page cache to stable storage
+ */
+bool syncFile(QFile &file);
+
+/**
+ * @brief CRC-32C (Castagnoli) of a buffer, continuing from crc for data in several parts
+ */
+quint32 crc32c(const uchar *data, qsizetype size, quint32 crc = 0);
+
+/**
+ * @brief Store one frame in a block that is being filled with the layout for capacity frames
+ */
+void writeRecord(uchar *block, quint32 capacity, quint32 index, quint64 sequence, Transport transport, const TelemetryFrame &frame);
+
+/**
+ * @brief Close a block that was filled with the layout for capacity frames
+ *
+ * Moves the columns together behind the header, computes the column directory and writes the header
+ * with the checksum of the finished block.
+ * @param padding Zero bytes appended to the block, the buffer has to hold them
+ * @return The size of the finished block
+ */
+quint32 finishBlock(uchar *block, quint32 capacity, BlockHeader &header, quint32 padding = 0);
+
+/**
+ * @brief Read and check a block header, available bytes bounds the block
+ */
+bool readBlockHeader(const uchar *source, qint64 available, BlockHeader &header);
+
+/**
+ * @brief Check a block against the checksum in its header, the whole block has to be readable
+ */
+bool verifyBlock(const uchar *block, const BlockHeader &header);
+
+void readRecord(const uchar *block, const BlockHeader &header, quint32 index, Record &record);
+}
+
+#endif // SESSIONLOGFORMAT_H
@@ -0,0 +1,73 @@
+#ifndef SESSIONLOGWRITER_H
+#define SESSIONLOGWRITER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QSaveFile>
+#include <QString>
+#include "sessionindex.h"
+#include "sessionlogformat.h"
+#include "../../telemetry/include/telemetryframe.h"
+
+/**
+ * @brief The SessionLogWriter class writes a complete session log from frames that are already at hand
+ *
+ * Used by the importers, which unlike the recorder never wait for frames. Appended frames are buffered
+ * until a window of full blocks is ready, one block per worker of the global thread pool, and the
+ * blocks are then encoded in parallel and written in order. Memory therefore stays bounded however
+ * many frames are appended. The log is written through a QSaveFile and only replaces the target once
+ * commit() succeeds, closed and with its index.
+ */
+class SessionLogWriter
+{
+public:
+    SessionLogWriter();
+
+    SessionLogWriter(const SessionLogWriter &) = delete;
+    SessionLogWriter &operator=(const SessionLogWriter &) = delete;
+
+    /**
+     * @brief Start a log
+     * @param startedMsSinceEpoch Wall clock start of the session, frames keep their own timestamps
+     * @param transport Recorded as the source of every frame
+     */
+    bool open(const QString &logPath, qint64 startedMsSinceEpoch, SessionLog::Transport transport, QString *error = nullptr);
+
+    /**
+     * @brief Append frames in timestamp order
+     * @return False once a write failed, see errorString()
+     */
+    bool append(const TelemetryFrame *frames, qsizetype count);
+    bool append(const QList<TelemetryFrame> &frames) { return append(frames.constData(), frames.size()); }
+
+    /**
+     * @brief Add a lap or marker to the index, saved by commit()
+     */
+    void addMarker(const SessionIndex::Marker &marker) { m_index.appendMarker(marker); }
+
+    /**
+     * @brief Write the remaining frames, replace the target and save the index
+     */
+    bool commit(QString *error = nullptr);
+
+    qint64 frameCount() const { return qint64(m_sequence) + m_pending.size(); }
+    QString errorString() const { return m_error; }
+
+private:
+    bool writeBlocks(bool all);
+
+    QSaveFile m_file;
+    QString m_logPath;
+    QList<TelemetryFrame> m_pending;
+    QList<QByteArray> m_blocks;
+    QList<SessionLog::BlockHeader> m_headers;
+    SessionIndex m_index;
+    qint64 m_offset;
+    quint64 m_sequence;
+    qsizetype m_window;
+    SessionLog::Transport m_transport;
+    bool m_failed;
+    QString m_error;
+};
+
+#endif // SESSIONLOGWRITER_H
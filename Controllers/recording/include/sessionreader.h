@@ -0,0 +1,101 @@
+#ifndef SESSIONREADER_H
+#define SESSIONREADER_H
+
+#include <QFile>
+#include <QList>
+#include <QSpan>
+#include <QString>
+#include "sessionlogformat.h"
+#include "sessionindex.h"
+#include "../../telemetry/include/telemetryseries.h"
+
+/**
+ * @brief The SessionReader class reads a session log through a memory mapping
+ *
+ * Opening loads the SessionIndex, rebuilt if missing, and only reads the headers of the indexed
+ * blocks. Columns are returned as spans straight into the mapping, so reading one channel never
+ * touches the pages of the others, and blocks are independent of each other and copied out in
+ * parallel. The reader is not thread-safe for open() and close(), everything else may be called
+ * concurrently.
+ */
+class SessionReader
+{
+public:
+    struct Chunk
+    {
+        qint64 offset = 0; // Block start in the file
+        SessionLog::BlockHeader header;
+    };
+
+    SessionReader();
+    ~SessionReader();
+
+    SessionReader(const SessionReader &) = delete;
+    SessionReader &operator=(const SessionReader &) = delete;
+
+    /**
+     * @brief Map a session log and index its blocks
+     *
+     * A block cut short at the end of the file is left out, a missing or stale index is rebuilt.
+     * @param path The .tlog file
+     * @param error Set to a description if the file cannot be read
+     * @return True if the file is a session log of this version
+     */
+    bool open(const QString &path, QString *error = nullptr);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    QString filePath() const { return m_file.fileName(); }
+    const SessionLog::FileHeader &fileHeader() const { return m_fileHeader; }
+
+    qint64 frameCount() const { return m_frameCount; }
+    qint64 firstTimeUs() const; // Receive time of the first frame, 0 if empty.
+    qint64 lastTimeUs() const;
+    qint64 validBytes() const { return m_validBytes; } // End of the last complete block.
+
+    const QList<Chunk> &chunks() const { return m_chunks; }
+    const SessionIndex &index() const { return m_index; } // Blocks, laps and markers.
+
+    /**
+     * @brief Index of the first block that ends at or after a time, chunks().size() if none does
+     */
+    qsizetype chunkAt(qint64 timeUs) const;
+
+    QSpan<const qint64> timestamps(qsizetype chunk) const;
+    QSpan<const quint64> sequences(qsizetype chunk) const;
+    QSpan<const double> values(qsizetype chunk, TelemetryChannel channel) const;
+
+    /**
+     * @brief Decode one complete frame, e.g. for replay
+     */
+    void readRecord(qsizetype chunk, quint32 index, SessionLog::Record &record) const;
+
+    /**
+     * @brief Copy one channel over a time range out of the mapping, blocks in parallel
+     * @param fromUs First receive time to include
+     * @param toUs Last receive time to include
+     */
+    TelemetrySeries loadChannel(TelemetryChannel channel, qint64 fromUs, qint64 toUs) const;
+
+    /**
+     * @brief Minimum and maximum of a channel over a time range
+     *
+     * Blocks inside the range are answered from their directory without reading the column.
+     * @return False if the range holds no frame
+     */
+    bool channelBounds(TelemetryChannel channel, qint64 fromUs, qint64 toUs, double &minimum, double &maximum) const;
+
+private:
+    const uchar *column(qsizetype chunk, int column) const;
+    void rangeInChunk(qsizetype chunk, qint64 fromUs, qint64 toUs, qsizetype &begin, qsizetype &end) const;
+
+    QFile m_file;
+    uchar *m_data;
+    qint64 m_validBytes;
+    qint64 m_frameCount;
+    SessionLog::FileHeader m_fileHeader;
+    SessionIndex m_index;
+    QList<Chunk> m_chunks;
+};
+
+#endif // SESSIONREADER_H
@@ -0,0 +1,202 @@
+#ifndef SESSIONRECORDER_H
+#define SESSIONRECORDER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QTimer>
+#include <atomic>
+#include "blockwritequeue.h"
+#include "sessionlogformat.h"
+#include "sessionindex.h"
+
+// Forward declarations
+class QThread;
+
+/**
+ * @brief The SessionRecorder class appends every raw frame to a session log on disk
+ *
+ * Frames are encoded column by column into a ring of preallocated blocks under a short lock. A
+ * dedicated I/O thread hands a block to a BlockWriteQueue once it is full, or a partial one once the
+ * sync interval has passed, while the ingest path keeps filling the next block. With io_uring up to
+ * queueDepth blocks are written at once from buffers registered with the kernel, otherwise each block
+ * is one pwrite. The ingest path never waits on the disk: if every block is full or being written the
+ * frame is counted as dropped instead. With direct I/O the blocks are padded to whole 4 KiB pages and
+ * bypass the page cache.
+ *
+ * Durability follows a group-commit policy. The I/O thread syncs the log every syncIntervalMs or every
+ * syncBytes written, whichever comes first, and one sync covers every block written since the last
+ * one, so a power loss costs at most about one interval of frames without a sync per frame. Every
+ * block carries a checksum, and the closed flag of the log is set once the last block is synced. Logs
+ * left without it are repaired by recover(), see SessionRecovery.
+ *
+ * After each block the I/O thread appends its entry to the SessionIndex sidecar, together with the
+ * laps and markers set in the meantime.
+ */
+class SessionRecorder : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool recording READ isRecording NOTIFY recordingChanged)
+    Q_PROPERTY(QString filePath READ filePath NOTIFY recordingChanged)
+    Q_PROPERTY(QString directory READ directory WRITE setDirectory NOTIFY directoryChanged)
+    Q_PROPERTY(qint64 recordedFrames READ recordedFrames NOTIFY statsChanged)
+    Q_PROPERTY(qint64 droppedFrames READ droppedFrames NOTIFY statsChanged)
+    Q_PROPERTY(qint64 bytesWritten READ bytesWritten NOTIFY statsChanged)
+    Q_PROPERTY(qint64 syncedFrames READ syncedFrames NOTIFY statsChanged)
+    Q_PROPERTY(int syncIntervalMs READ syncIntervalMs WRITE setSyncIntervalMs NOTIFY syncPolicyChanged)
+    Q_PROPERTY(qint64 syncBytes READ syncBytes WRITE setSyncBytes NOTIFY syncPolicyChanged)
+    Q_PROPERTY(int lapCount READ lapCount NOTIFY lapCountChanged)
+    Q_PROPERTY(QString writeBackend READ writeBackend NOTIFY recordingChanged)
+
+public:
+    explicit SessionRecorder(QObject *parent = nullptr);
+    ~SessionRecorder();
+
+    /**
+     * @brief Open a new log and start recording
+     * @param sessionName Prefix of the file name, the start time is appended
+     * @return True if the log was created
+     */
+    Q_INVOKABLE bool start(const QString &sessionName = QString());
+
+    /**
+     * @brief Write the remaining frames and close the log
+     */
+    Q_INVOKABLE void stop();
+
+    /**
+     * @brief Mark the start of a new lap at the current time
+     */
+    Q_INVOKABLE void markLap();
+
+    /**
+     * @brief Put a named marker at the current time, e.g. "Brake fade"
+     * @param label Up to 16 bytes of UTF-8 are kept
+     */
+    Q_INVOKABLE void addMarker(const QString &label);
+
+    /**
+     * @brief Repair the logs of the directory that were not closed, e.g. after a power loss
+     *
+     * Runs on the calling thread and leaves the log being recorded alone. Emits sessionRecovered()
+     * for every repaired log.
+     * @return The number of repaired logs
+     */
+    Q_INVOKABLE int recover();
+
+    /**
+     * @brief Record one frame, safe to call from any thread
+     *
+     * Does nothing while not recording. Timestamps are clamped so that they never go backwards within
+     * a log, frames of parallel parsers may arrive slightly out of order.
+     */
+    void append(const TelemetryFrame &frame);
+
+    /**
+     * @brief The transport stored with the following frames
+     */
+    void setTransport(SessionLog::Transport transport);
+
+    bool isRecording() const { return m_recording.load(std::memory_order_relaxed); }
+    QString filePath() const { return m_filePath; }
+
+    QString directory() const { return m_directory; }
+    void setDirectory(const QString &directory);
+
+    qint64 recordedFrames() const { return qint64(m_recordedFrames.load(std::memory_order_relaxed)); }
+    qint64 droppedFrames() const { return qint64(m_droppedFrames.load(std::memory_order_relaxed)); }
+    qint64 bytesWritten() const { return qint64(m_bytesWritten.load(std::memory_order_relaxed)); }
+    qint64 syncedFrames() const { return qint64(m_syncedFrames.load(std::memory_order_relaxed)); } // Frames known to be on stable storage.
+    qint64 syncCount() const { return qint64(m_syncCount.load(std::memory_order_relaxed)); }
+
+    /**
+     * @brief Longest time a written frame waits for a sync, 0 syncs after every write, -1 never by time
+     */
+    int syncIntervalMs() const { return m_syncIntervalMs.load(std::memory_order_relaxed); }
+    void setSyncIntervalMs(int intervalMs);
+
+    /**
+     * @brief Most bytes written between two syncs, 0 or less for no limit by size
+     */
+    qint64 syncBytes() const { return m_syncBytes.load(std::memory_order_relaxed); }
+    void setSyncBytes(qint64 bytes);
+
+    int lapCount() const { return m_lapCount; }
+
+    /**
+     * @brief How the following recordings write their blocks, io_uring with 4 writes in flight by default
+     * @param direct Bypass the page cache, off by default
+     */
+    void setWriteOptions(BlockWriteQueue::Backend backend, bool direct, int queueDepth);
+
+    QString writeBackend() const { return m_writeBackend; } // What the current or last recording used, e.g. "io_uring, depth 4".
+
+signals:
+    void recordingChanged();
+    void directoryChanged();
+    void statsChanged();
+    void lapCountChanged();
+    void syncPolicyChanged();
+    void sessionRecovered(const QString &filePath, qint64 recoveredFrames, qint64 lostFrames);
+    void errorOccurred(const QString &error);
+
+private:
+    struct Block
+    {
+        uchar *data = nullptr; // A buffer of the write queue
+        qsizetype start = 0;   // Where the block starts in data, the first one of a direct log follows the file header
+        SessionLog::BlockHeader header;
+        bool full = false;     // Handed to the I/O thread, not filled until written
+
+        // Only used by the I/O thread
+        qint64 offset = 0;
+        bool submitted = false;
+        bool written = false;
+        bool failed = false;
+    };
+
+    void writeLoop();                                   // Runs on the I/O thread until stopped.
+    bool swapBlocks();                                  // Hands the active block to the I/O thread, the mutex must be held.
+    bool submitBlock(int index, qint64 &offset);        // Runs on the I/O thread without the mutex.
+    void retireBlock(Block &block);                     // Runs on the I/O thread without the mutex.
+    bool syncFiles();                                   // Runs on the I/O thread without the mutex.
+    void queueMarker(SessionIndex::Marker marker);
+
+    QString m_directory;
+    QString m_filePath;
+    QFile m_file;      // Only used by the I/O thread while recording
+    QFile m_indexFile; // Sidecar index, also only used by the I/O thread
+    BlockWriteQueue m_queue; // Writes the blocks, also only used by the I/O thread
+    QThread *m_ioThread;
+    BlockWriteQueue::Backend m_backend; // Write options, applied by the next start()
+    bool m_directIo;
+    int m_queueDepth;
+    QString m_writeBackend;
+    QTimer m_statsTimer;
+    int m_lapCount;
+
+    std::atomic<bool> m_recording;
+    std::atomic<quint8> m_transport;
+    std::atomic<quint64> m_recordedFrames;
+    std::atomic<quint64> m_droppedFrames;
+    std::atomic<quint64> m_bytesWritten;
+    std::atomic<quint64> m_syncedFrames;
+    std::atomic<quint64> m_syncCount;
+    std::atomic<int> m_syncIntervalMs;
+    std::atomic<qint64> m_syncBytes;
+
+    // Shared between the ingest threads and the I/O thread
+    QMutex m_mutex;
+    QWaitCondition m_blockFull;
+    QList<Block> m_blocks; // A ring, filled and written in order
+    QList<SessionIndex::Marker> m_pendingMarkers;
+    int m_active;
+    quint64 m_nextSequence;
+    qint64 m_lastTimeUs; // Newest recorded time, later frames are clamped to it
+    bool m_stopping;
+};
+
+#endif // SESSIONRECORDER_H
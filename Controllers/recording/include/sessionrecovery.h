@@ -0,0 +1,47 @@
+#ifndef SESSIONRECOVERY_H
+#define SESSIONRECOVERY_H
+
+#include <QList>
+#include <QString>
+
+/**
+ * @brief The SessionRecovery class repairs session logs left open by a crash or a power loss
+ *
+ * The recorder sets the closed flag of a log only once its last block is synced, so a log without it
+ * was cut short. Recovery walks the blocks of such a log from the start and checks their checksums,
+ * truncates the log after the last valid block and rebuilds the block entries of the index around the
+ * markers it already had. Blocks behind the first bad one are discarded too, since the log has to stay
+ * contiguous. Their frames are counted as lost as long as their headers are intact, frames that were
+ * still in memory when the power went leave no trace and are not counted.
+ */
+class SessionRecovery
+{
+public:
+    struct Result
+    {
+        QString filePath;
+        qint64 recoveredFrames = 0;
+        qint64 lostFrames = 0;
+        qint64 discardedBytes = 0;
+    };
+
+    /**
+     * @brief True for logs of this version whose closed flag is not set
+     */
+    static bool needsRecovery(const QString &logPath);
+
+    /**
+     * @brief Truncate a log to its last valid block, rebuild its index and mark it closed
+     * @param error Set to a description if the log cannot be read or written
+     * @return False if the log cannot be read or repaired
+     */
+    static bool recover(const QString &logPath, Result &result, QString *error = nullptr);
+
+    /**
+     * @brief Recover every log of a directory that needs it
+     * @param skipPath A log that is being recorded right now and must not be touched
+     */
+    static QList<Result> recoverDirectory(const QString &directory, const QString &skipPath = QString());
+};
+
+#endif // SESSIONRECOVERY_H
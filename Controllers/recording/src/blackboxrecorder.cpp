@@ -0,0 +1,533 @@
+#include "../include/blackboxrecorder.h"
+#include "../include/sessionlogwriter.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QStandardPaths>
+#include <QThread>
+#include <cstring>
+
+namespace
+{
+// Default window of a dump around the trigger
+constexpr int DefaultPreTriggerSeconds = 300;
+constexpr int DefaultPostTriggerSeconds = 30;
+
+// How often the black box thread checks the rules when there is nothing to write
+constexpr int MonitorIntervalMs = 50;
+
+// Frames copied out of the ring per pass, the rules are checked again between two passes
+constexpr qsizetype BatchFrames = 4096;
+
+// A dump also ends this long after its end if no later frame arrived, e.g. because the source stopped
+constexpr qint64 EndGraceUs = 1000000;
+
+qsizetype roundUpToPowerOfTwo(qsizetype value)
+{
+    qsizetype result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+}
+
+BlackBoxRecorder::BlackBoxRecorder(qsizetype capacity, QObject *parent)
+    : QObject(parent),
+    m_capacity(roundUpToPowerOfTwo(qMax<qsizetype>(capacity, 2))),
+    m_mask(quint64(m_capacity) - 1),
+    m_slots(new Slot[m_capacity]()),
+    m_head(0),
+    m_start(0),
+    m_armed(false),
+    m_dumping(false),
+    m_transport(quint8(SessionLog::Transport::Unknown)),
+    m_preTriggerSeconds(DefaultPreTriggerSeconds),
+    m_postTriggerSeconds(DefaultPostTriggerSeconds),
+    m_directory(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + QStringLiteral("/sessions")),
+    m_thread(nullptr),
+    m_rulesChanged(false),
+    m_stopping(false)
+{
+    setArmed(true);
+}
+
+BlackBoxRecorder::~BlackBoxRecorder()
+{
+    setArmed(false);
+}
+
+void BlackBoxRecorder::append(const TelemetryFrame &frame)
+{
+    if (!m_armed.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    quint64 words[WordCount] = {};
+    std::memcpy(words, &frame, sizeof(TelemetryFrame));
+
+    // Every writer gets its own slot, so parser threads never wait for each other
+    const quint64 index = m_head.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = m_slots[index & m_mask];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+
+    // Keep the data stores from being reordered before the odd sequence becomes visible
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int i = 0; i < WordCount; ++i)
+    {
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+
+    // Publishes the complete frame
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+void BlackBoxRecorder::clear()
+{
+    m_start.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+
+    // The rules start over as well, a drop must not be measured across two sources
+    QMutexLocker locker(&m_mutex);
+    m_rulesChanged = true;
+}
+
+void BlackBoxRecorder::trigger(const QString &reason)
+{
+    if (!isArmed())
+    {
+        qDebug() << "BlackBoxRecorder: Not armed, trigger ignored";
+        return;
+    }
+
+    Trigger trigger;
+    trigger.timeUs = telemetryTimestampUs();
+    trigger.reason = reason.isEmpty() ? QStringLiteral("Manual") : reason;
+
+    QMutexLocker locker(&m_mutex);
+    m_pendingTriggers.append(trigger);
+    m_wake.wakeOne();
+}
+
+bool BlackBoxRecorder::addTriggerRule(const QString &channel, const QString &condition, double threshold, int windowMs)
+{
+    const TelemetryChannelInfo *info = findTelemetryChannel(channel);
+    if (!info)
+    {
+        qDebug() << "BlackBoxRecorder: Unknown channel" << channel;
+        return false;
+    }
+
+    Rule rule;
+    rule.channel = info->channel;
+    rule.threshold = threshold;
+    rule.windowUs = qint64(qMax(1, windowMs)) * 1000;
+    if (condition == QLatin1String("above"))
+    {
+        rule.condition = Rule::Condition::Above;
+        rule.reason = QStringLiteral("%1 > %2").arg(channel).arg(threshold);
+    }
+    else if (condition == QLatin1String("below"))
+    {
+        rule.condition = Rule::Condition::Below;
+        rule.reason = QStringLiteral("%1 < %2").arg(channel).arg(threshold);
+    }
+    else if (condition == QLatin1String("drop"))
+    {
+        rule.condition = Rule::Condition::Drop;
+        rule.reason = QStringLiteral("%1 -%2").arg(channel).arg(threshold);
+    }
+    else
+    {
+        qDebug() << "BlackBoxRecorder: Unknown condition" << condition;
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_rules.append(rule);
+    m_rulesChanged = true;
+    return true;
+}
+
+void BlackBoxRecorder::clearTriggerRules()
+{
+    QMutexLocker locker(&m_mutex);
+    m_rules.clear();
+    m_rulesChanged = true;
+}
+
+void BlackBoxRecorder::setArmed(bool armed)
+{
+    if (m_armed.load(std::memory_order_relaxed) == armed)
+    {
+        return;
+    }
+
+    if (armed)
+    {
+        // Frames from before the black box was disarmed are stale
+        m_start.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+        m_armed.store(true, std::memory_order_relaxed);
+        startThread();
+    }
+    else
+    {
+        // A running dump saves what it has
+        m_armed.store(false, std::memory_order_relaxed);
+        stopThread();
+    }
+    emit armedChanged();
+}
+
+QString BlackBoxRecorder::lastDumpPath() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_lastDumpPath;
+}
+
+void BlackBoxRecorder::setDirectory(const QString &directory)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_directory != directory)
+    {
+        m_directory = directory;
+        locker.unlock();
+        emit directoryChanged();
+    }
+}
+
+void BlackBoxRecorder::setPreTriggerSeconds(int seconds)
+{
+    if (m_preTriggerSeconds.exchange(qMax(0, seconds)) != qMax(0, seconds))
+    {
+        emit windowChanged();
+    }
+}
+
+void BlackBoxRecorder::setPostTriggerSeconds(int seconds)
+{
+    if (m_postTriggerSeconds.exchange(qMax(0, seconds)) != qMax(0, seconds))
+    {
+        emit windowChanged();
+    }
+}
+
+void BlackBoxRecorder::setTransport(SessionLog::Transport transport)
+{
+    m_transport.store(quint8(transport), std::memory_order_relaxed);
+}
+
+BlackBoxRecorder::SlotState BlackBoxRecorder::read(quint64 index, TelemetryFrame &frame) const
+{
+    const Slot &slot = m_slots[index & m_mask];
+    const quint64 complete = 2 * index + 2;
+
+    // Lower means the frame is not written yet, higher that a writer lapped the ring
+    const quint64 before = slot.sequence.load(std::memory_order_acquire);
+    if (before != complete)
+    {
+        return before < complete ? SlotState::Pending : SlotState::Lost;
+    }
+
+    quint64 words[WordCount];
+    for (int i = 0; i < WordCount; ++i)
+    {
+        words[i] = slot.words[i].load(std::memory_order_relaxed);
+    }
+
+    // Keep the data loads from being reordered after the second sequence load
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != complete)
+    {
+        return SlotState::Lost;
+    }
+
+    std::memcpy(&frame, words, sizeof(TelemetryFrame));
+    return SlotState::Ready;
+}
+
+quint64 BlackBoxRecorder::oldestReadable() const
+{
+    // Readers stay a sixteenth of the ring behind the writers, so they are not lapped while they copy
+    const quint64 head = m_head.load(std::memory_order_acquire);
+    const quint64 reach = quint64(m_capacity - m_capacity / 16);
+    return qMax(head > reach ? head - reach : 0, m_start.load(std::memory_order_acquire));
+}
+
+void BlackBoxRecorder::run()
+{
+    QList<Rule> rules;
+    QList<Trigger> triggers;
+    QString directory;
+    Dump dump;
+    quint64 scanIndex = m_head.load(std::memory_order_acquire);
+
+    QMutexLocker locker(&m_mutex);
+
+    while (!m_stopping)
+    {
+        if (m_rulesChanged)
+        {
+            rules = m_rules;
+            m_rulesChanged = false;
+        }
+        triggers.append(m_pendingTriggers);
+        m_pendingTriggers.clear();
+        directory = m_directory;
+        locker.unlock();
+
+        // The rules see every frame once, in ring order
+        const quint64 head = m_head.load(std::memory_order_acquire);
+        scanIndex = rules.isEmpty() ? head : qMax(scanIndex, oldestReadable());
+        TelemetryFrame frame;
+        for (; scanIndex < head; ++scanIndex)
+        {
+            const SlotState state = read(scanIndex, frame);
+            if (state == SlotState::Pending)
+            {
+                break;
+            }
+            if (state == SlotState::Lost)
+            {
+                continue;
+            }
+            for (Rule &rule : rules)
+            {
+                if (checkRule(rule, frame))
+                {
+                    triggers.append(Trigger{frame.timestampUs, rule.reason});
+                }
+            }
+        }
+
+        for (const Trigger &trigger : std::as_const(triggers))
+        {
+            qDebug() << "BlackBoxRecorder: Triggered by" << trigger.reason;
+            emit triggered(trigger.reason);
+            if (dump.writer)
+            {
+                // A trigger during a dump extends it, so both are saved in one log
+                dump.untilUs = qMax(dump.untilUs, trigger.timeUs + qint64(postTriggerSeconds()) * 1000000);
+                dump.markers.append(SessionIndex::Marker{SessionIndex::Marker::Kind::Marker, trigger.timeUs + dump.wallOffsetUs, 0, trigger.reason});
+            }
+            else
+            {
+                startDump(dump, trigger, directory);
+            }
+        }
+        triggers.clear();
+
+        bool caughtUp = true;
+        if (dump.writer)
+        {
+            if (writeDump(dump))
+            {
+                finishDump(dump);
+            }
+            else
+            {
+                caughtUp = dump.readIndex >= m_head.load(std::memory_order_acquire);
+            }
+        }
+
+        locker.relock();
+        if (caughtUp && !m_stopping && m_pendingTriggers.isEmpty())
+        {
+            m_wake.wait(&m_mutex, QDeadlineTimer(MonitorIntervalMs));
+        }
+    }
+    locker.unlock();
+
+    if (dump.writer)
+    {
+        finishDump(dump);
+    }
+}
+
+bool BlackBoxRecorder::checkRule(Rule &rule, const TelemetryFrame &frame)
+{
+    const double value = telemetryChannel(rule.channel).read(frame);
+
+    bool met = false;
+    switch (rule.condition)
+    {
+    case Rule::Condition::Above:
+        met = value > rule.threshold;
+        break;
+    case Rule::Condition::Below:
+        met = value < rule.threshold;
+        break;
+    case Rule::Condition::Drop:
+        // The front is the largest value of the window, later ones that are not below a newer value are never needed
+        while (!rule.maxima.empty() && rule.maxima.front().first < frame.timestampUs - rule.windowUs)
+        {
+            rule.maxima.pop_front();
+        }
+        while (!rule.maxima.empty() && rule.maxima.back().second <= value)
+        {
+            rule.maxima.pop_back();
+        }
+        rule.maxima.emplace_back(frame.timestampUs, value);
+        met = rule.maxima.front().second - value >= rule.threshold;
+        break;
+    }
+
+    // Fires on the edge only, a channel that stays out of range does not trigger over and over
+    const bool fired = met && !rule.active;
+    rule.active = met;
+    return fired;
+}
+
+void BlackBoxRecorder::startDump(Dump &dump, const Trigger &trigger, const QString &directory)
+{
+    dump = Dump();
+    dump.writer = std::make_unique<SessionLogWriter>();
+    dump.start = m_start.load(std::memory_order_acquire);
+    dump.readIndex = oldestReadable();
+    dump.fromUs = trigger.timeUs - qint64(preTriggerSeconds()) * 1000000;
+    dump.untilUs = trigger.timeUs + qint64(postTriggerSeconds()) * 1000000;
+    dump.wallOffsetUs = QDateTime::currentMSecsSinceEpoch() * 1000 - telemetryTimestampUs();
+    dump.markers.append(SessionIndex::Marker{SessionIndex::Marker::Kind::Marker, trigger.timeUs + dump.wallOffsetUs, 0, trigger.reason});
+    dump.batch.reserve(BatchFrames);
+
+    const QDateTime triggeredAt = QDateTime::fromMSecsSinceEpoch((trigger.timeUs + dump.wallOffsetUs) / 1000);
+    dump.filePath = QDir(directory).filePath(QStringLiteral("blackbox") + triggeredAt.toString(QStringLiteral("-yyyyMMdd-hhmmss")) + QStringLiteral(".tlog"));
+    if (!QDir().mkpath(directory))
+    {
+        dump.failed = true;
+        dump.error = QStringLiteral("Cannot create directory %1").arg(directory);
+    }
+
+    m_dumping.store(true, std::memory_order_relaxed);
+    emit dumpingChanged();
+}
+
+bool BlackBoxRecorder::writeDump(Dump &dump)
+{
+    // After clear() the ring holds frames of another source
+    if (dump.failed || m_start.load(std::memory_order_acquire) != dump.start)
+    {
+        return true;
+    }
+
+    const quint64 oldest = oldestReadable();
+    if (dump.readIndex < oldest)
+    {
+        dump.lostFrames += qint64(oldest - dump.readIndex);
+        dump.readIndex = oldest;
+    }
+
+    const quint64 head = m_head.load(std::memory_order_acquire);
+    bool complete = false;
+    TelemetryFrame frame;
+    dump.batch.clear();
+    while (dump.readIndex < head && dump.batch.size() < BatchFrames)
+    {
+        const SlotState state = read(dump.readIndex, frame);
+        if (state == SlotState::Pending)
+        {
+            break;
+        }
+        ++dump.readIndex;
+        if (state == SlotState::Lost)
+        {
+            ++dump.lostFrames;
+            continue;
+        }
+        if (frame.timestampUs < dump.fromUs)
+        {
+            continue;
+        }
+        if (frame.timestampUs >= dump.untilUs)
+        {
+            complete = true;
+            break;
+        }
+        frame.timestampUs += dump.wallOffsetUs;
+        dump.batch.append(frame);
+    }
+
+    if (!dump.batch.isEmpty())
+    {
+        // Opened with the first frame, so the log starts where the ring did
+        if (!dump.opened)
+        {
+            const SessionLog::Transport transport = SessionLog::Transport(m_transport.load(std::memory_order_relaxed));
+            if (!dump.writer->open(dump.filePath, dump.batch.constFirst().timestampUs / 1000, transport, &dump.error))
+            {
+                dump.failed = true;
+                return true;
+            }
+            dump.opened = true;
+        }
+        dump.writer->append(dump.batch); // A failed write is reported by commit()
+    }
+
+    return complete || (dump.readIndex >= head && telemetryTimestampUs() >= dump.untilUs + EndGraceUs);
+}
+
+void BlackBoxRecorder::finishDump(Dump &dump)
+{
+    if (!dump.failed && !dump.opened)
+    {
+        dump.failed = true;
+        dump.error = QStringLiteral("No frames in the black box");
+    }
+
+    if (!dump.failed)
+    {
+        for (const SessionIndex::Marker &marker : std::as_const(dump.markers))
+        {
+            dump.writer->addMarker(marker);
+        }
+        dump.failed = !dump.writer->commit(&dump.error);
+    }
+
+    if (dump.failed)
+    {
+        qDebug() << "BlackBoxRecorder: Cannot save" << dump.filePath << dump.error;
+        emit errorOccurred(QStringLiteral("Cannot save black box %1: %2").arg(dump.filePath, dump.error));
+    }
+    else
+    {
+        qDebug() << "BlackBoxRecorder: Saved" << dump.writer->frameCount() << "frames to" << dump.filePath << "," << dump.lostFrames << "lost";
+        {
+            QMutexLocker locker(&m_mutex);
+            m_lastDumpPath = dump.filePath;
+        }
+        emit dumpFinished(dump.filePath, dump.writer->frameCount(), dump.lostFrames);
+    }
+
+    dump = Dump();
+    m_dumping.store(false, std::memory_order_relaxed);
+    emit dumpingChanged();
+}
+
+void BlackBoxRecorder::startThread()
+{
+    m_stopping = false;
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName(QStringLiteral("Black Box"));
+    m_thread->start();
+}
+
+void BlackBoxRecorder::stopThread()
+{
+    if (!m_thread)
+    {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeOne();
+    }
+
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
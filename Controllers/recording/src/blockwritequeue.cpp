@@ -0,0 +1,509 @@
+#include "../include/blockwritequeue.h"
+#include <QDebug>
+#include <cerrno>
+#include <cstring>
+
+#if defined(Q_OS_LINUX) && __has_include(<linux/io_uring.h>)
+#define BLOCKWRITEQUEUE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+#if !defined(Q_OS_WIN)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+QString systemError(int error)
+{
+    return QString::fromLocal8Bit(std::strerror(error));
+}
+
+#ifdef BLOCKWRITEQUEUE_IO_URING
+// The ring is shared with the kernel, the indices it writes are read with acquire and ours are published with release
+unsigned loadAcquire(const void *ring, quint32 offset)
+{
+    return __atomic_load_n(reinterpret_cast<const unsigned *>(static_cast<const char *>(ring) + offset), __ATOMIC_ACQUIRE);
+}
+
+void storeRelease(void *ring, quint32 offset, unsigned value)
+{
+    __atomic_store_n(reinterpret_cast<unsigned *>(static_cast<char *>(ring) + offset), value, __ATOMIC_RELEASE);
+}
+
+unsigned *ringField(void *ring, quint32 offset)
+{
+    return reinterpret_cast<unsigned *>(static_cast<char *>(ring) + offset);
+}
+
+int enterRing(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    int result;
+    do
+    {
+        result = int(::syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0));
+    } while (result < 0 && errno == EINTR);
+    return result;
+}
+
+bool writeSupported(int ringFd)
+{
+    // The probe came with Linux 5.6 like IORING_OP_WRITE itself, so older kernels fail it and get pwrite
+    constexpr unsigned ProbeOps = 256;
+    QByteArray storage(qsizetype(sizeof(io_uring_probe) + ProbeOps * sizeof(io_uring_probe_op)), '\0');
+    io_uring_probe *probe = reinterpret_cast<io_uring_probe *>(storage.data());
+    if (::syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_PROBE, probe, ProbeOps) != 0)
+    {
+        return false;
+    }
+    return IORING_OP_WRITE <= probe->last_op && (probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED);
+}
+#endif
+}
+
+BlockWriteQueue::BlockWriteQueue()
+    : m_fd(-1),
+    m_backend(Backend::Pwrite),
+    m_direct(false),
+    m_queueDepth(1),
+    m_inFlight(0),
+    m_bufferBytes(0),
+    m_ringFd(-1),
+    m_registered(false),
+    m_submissionRing(nullptr),
+    m_completionRing(nullptr),
+    m_entries(nullptr),
+    m_submissionRingBytes(0),
+    m_completionRingBytes(0),
+    m_entriesBytes(0),
+    m_ringFailed(false)
+{
+}
+
+BlockWriteQueue::~BlockWriteQueue()
+{
+    close();
+}
+
+bool BlockWriteQueue::ioUringSupported()
+{
+#ifdef BLOCKWRITEQUEUE_IO_URING
+    static const bool supported = []()
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        const int fd = int(::syscall(__NR_io_uring_setup, 1, &params));
+        if (fd < 0)
+        {
+            return false;
+        }
+        ::close(fd);
+        return true;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+bool BlockWriteQueue::open(const QString &path, Backend backend, bool direct, int queueDepth, int bufferCount, qsizetype bufferBytes, QString *error)
+{
+    auto fail = [this, error](const QString &message)
+    {
+        m_error = message;
+        close();
+        if (error)
+        {
+            *error = message;
+        }
+        return false;
+    };
+
+    close();
+    m_error.clear();
+    m_bufferBytes = (bufferBytes + Alignment - 1) / Alignment * Alignment;
+    for (int i = 0; i < bufferCount; ++i)
+    {
+        uchar *buffer = static_cast<uchar *>(qMallocAligned(size_t(m_bufferBytes), Alignment));
+        if (!buffer)
+        {
+            return fail(QStringLiteral("Cannot allocate %1 write buffers").arg(bufferCount));
+        }
+        std::memset(buffer, 0, size_t(m_bufferBytes));
+        m_buffers.append(buffer);
+    }
+    m_writes.resize(bufferCount);
+
+#if defined(Q_OS_WIN)
+    Q_UNUSED(direct);
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Unbuffered))
+    {
+        return fail(m_file.errorString());
+    }
+#else
+    const QByteArray nativePath = QFile::encodeName(path);
+#if defined(Q_OS_LINUX)
+    if (direct)
+    {
+        m_fd = ::open(nativePath.constData(), O_WRONLY | O_CLOEXEC | O_DIRECT);
+        if (m_fd >= 0)
+        {
+            m_direct = true;
+        }
+        else
+        {
+            // E.g. tmpfs, which has no direct I/O
+            qDebug() << "BlockWriteQueue: No direct I/O for" << path << systemError(errno) << ", writing through the page cache";
+        }
+    }
+#else
+    Q_UNUSED(direct);
+#endif
+    if (m_fd < 0)
+    {
+        m_fd = ::open(nativePath.constData(), O_WRONLY | O_CLOEXEC);
+    }
+    if (m_fd < 0)
+    {
+        return fail(systemError(errno));
+    }
+#endif
+
+    m_queueDepth = 1;
+    if (backend == Backend::IoUring)
+    {
+        m_queueDepth = qMax(1, queueDepth);
+        if (!setupRing())
+        {
+            m_queueDepth = 1;
+        }
+    }
+    return true;
+}
+
+void BlockWriteQueue::close()
+{
+    // The kernel may still read from the buffers of writes in flight
+    QList<Completion> completions;
+    while (m_inFlight > 0 && m_backend == Backend::IoUring)
+    {
+        const int inFlight = m_inFlight;
+        complete(true, completions);
+        if (m_inFlight == inFlight)
+        {
+            break;
+        }
+    }
+    closeRing();
+
+    if (m_fd >= 0)
+    {
+#if !defined(Q_OS_WIN)
+        ::close(m_fd);
+#endif
+        m_fd = -1;
+    }
+    m_file.close();
+
+    for (uchar *buffer : std::as_const(m_buffers))
+    {
+        qFreeAligned(buffer);
+    }
+    m_buffers.clear();
+    m_writes.clear();
+    m_finished.clear();
+    m_inFlight = 0;
+    m_direct = false;
+    m_backend = Backend::Pwrite;
+}
+
+QString BlockWriteQueue::description() const
+{
+    QString text = m_backend == Backend::IoUring ? QStringLiteral("io_uring") : QStringLiteral("pwrite");
+    if (m_direct)
+    {
+        text += QStringLiteral(", O_DIRECT");
+    }
+    return text + QStringLiteral(", depth %1").arg(m_queueDepth);
+}
+
+bool BlockWriteQueue::submit(int index, const uchar *data, qint64 size, qint64 offset)
+{
+    Write &write = m_writes[index];
+    write.data = data;
+    write.size = size;
+    write.offset = offset;
+
+    if (m_backend == Backend::IoUring)
+    {
+        if (!submitWrite(index))
+        {
+            return false;
+        }
+        ++m_inFlight;
+        return true;
+    }
+
+    // Blocking, the completion is handed out by the next complete()
+    Completion completion;
+    completion.buffer = index;
+    completion.ok = true;
+#if defined(Q_OS_WIN)
+    completion.ok = m_file.seek(offset) && m_file.write(reinterpret_cast<const char *>(data), size) == size;
+    if (!completion.ok)
+    {
+        m_error = m_file.errorString();
+    }
+#else
+    while (write.size > 0)
+    {
+        const ssize_t written = ::pwrite(m_fd, write.data, size_t(write.size), off_t(write.offset));
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            m_error = written < 0 ? systemError(errno) : QStringLiteral("No space left");
+            completion.ok = false;
+            break;
+        }
+        if (m_direct && written < write.size && written % Alignment != 0)
+        {
+            m_error = QStringLiteral("Short direct write of %1 bytes, the rest is not aligned").arg(written);
+            completion.ok = false;
+            break;
+        }
+        write.data += written;
+        write.size -= written;
+        write.offset += written;
+    }
+#endif
+    m_finished.append(completion);
+    ++m_inFlight;
+    return true;
+}
+
+void BlockWriteQueue::complete(bool wait, QList<Completion> &completions)
+{
+    completions.clear();
+    if (m_backend == Backend::Pwrite)
+    {
+        completions = m_finished;
+        m_finished.clear();
+        m_inFlight = 0;
+        return;
+    }
+
+#ifdef BLOCKWRITEQUEUE_IO_URING
+    unsigned head = *ringField(m_completionRing, m_ring.completionHead);
+    if (wait && m_inFlight > 0 && head == loadAcquire(m_completionRing, m_ring.completionTail)
+        && enterRing(m_ringFd, 0, 1, IORING_ENTER_GETEVENTS) < 0)
+    {
+        qDebug() << "BlockWriteQueue: Waiting for completions failed" << systemError(errno);
+    }
+
+    const unsigned mask = *ringField(m_completionRing, m_ring.completionMask);
+    const io_uring_cqe *entries = reinterpret_cast<const io_uring_cqe *>(static_cast<const char *>(m_completionRing) + m_ring.completions);
+    for (const unsigned tail = loadAcquire(m_completionRing, m_ring.completionTail); head != tail; ++head)
+    {
+        const io_uring_cqe &entry = entries[head & mask];
+        const int index = int(entry.user_data);
+        Write &write = m_writes[index];
+
+        Completion completion;
+        completion.buffer = index;
+        if (entry.res < 0)
+        {
+            m_error = systemError(-entry.res);
+        }
+        else if (entry.res == 0)
+        {
+            m_error = QStringLiteral("No space left");
+        }
+        else if (entry.res < write.size && m_direct && entry.res % Alignment != 0)
+        {
+            // Direct I/O cannot go on from an unaligned position, e.g. after the disk filled up
+            m_error = QStringLiteral("Short direct write of %1 bytes, the rest is not aligned").arg(entry.res);
+        }
+        else if (entry.res < write.size)
+        {
+            // A short write goes on with the rest in the same slot of the queue
+            write.data += entry.res;
+            write.size -= entry.res;
+            write.offset += entry.res;
+            if (submitWrite(index))
+            {
+                continue;
+            }
+        }
+        else
+        {
+            completion.ok = true;
+        }
+        --m_inFlight;
+        completions.append(completion);
+    }
+    storeRelease(m_completionRing, m_ring.completionHead, head);
+#else
+    Q_UNUSED(wait);
+#endif
+}
+
+bool BlockWriteQueue::setupRing()
+{
+#ifdef BLOCKWRITEQUEUE_IO_URING
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    m_ringFd = int(::syscall(__NR_io_uring_setup, unsigned(m_queueDepth), &params));
+    if (m_ringFd < 0)
+    {
+        qDebug() << "BlockWriteQueue: No io_uring" << systemError(errno) << ", using pwrite";
+        return false;
+    }
+
+    const io_sqring_offsets &sq = params.sq_off;
+    const io_cqring_offsets &cq = params.cq_off;
+    m_ring.submissionHead = sq.head;
+    m_ring.submissionTail = sq.tail;
+    m_ring.submissionMask = sq.ring_mask;
+    m_ring.submissionArray = sq.array;
+    m_ring.submissionEntries = params.sq_entries;
+    m_ring.completionHead = cq.head;
+    m_ring.completionTail = cq.tail;
+    m_ring.completionMask = cq.ring_mask;
+    m_ring.completions = cq.cqes;
+    m_submissionRingBytes = qsizetype(sq.array + params.sq_entries * sizeof(unsigned));
+    m_completionRingBytes = qsizetype(cq.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    m_entriesBytes = qsizetype(params.sq_entries * sizeof(io_uring_sqe));
+
+    // Kernels since 5.4 map both rings at once
+    const bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMap)
+    {
+        m_submissionRingBytes = m_completionRingBytes = qMax(m_submissionRingBytes, m_completionRingBytes);
+    }
+    m_submissionRing = ::mmap(nullptr, size_t(m_submissionRingBytes), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+    m_completionRing = singleMap ? m_submissionRing
+                                 : ::mmap(nullptr, size_t(m_completionRingBytes), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_CQ_RING);
+    m_entries = ::mmap(nullptr, size_t(m_entriesBytes), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+    if (m_submissionRing == MAP_FAILED || m_completionRing == MAP_FAILED || m_entries == MAP_FAILED)
+    {
+        qDebug() << "BlockWriteQueue: Cannot map the io_uring" << systemError(errno) << ", using pwrite";
+        closeRing();
+        return false;
+    }
+
+    // The submission array maps every slot to the entry of the same index once and for all
+    unsigned *array = ringField(m_submissionRing, m_ring.submissionArray);
+    for (unsigned i = 0; i < m_ring.submissionEntries; ++i)
+    {
+        array[i] = i;
+    }
+
+    // Registered buffers are pinned once instead of on every write, fixed writes then name them by index
+    QList<iovec> vectors;
+    for (uchar *buffer : std::as_const(m_buffers))
+    {
+        vectors.append(iovec{buffer, size_t(m_bufferBytes)});
+    }
+    m_registered = ::syscall(__NR_io_uring_register, m_ringFd, IORING_REGISTER_BUFFERS, vectors.constData(), unsigned(vectors.size())) == 0;
+    if (!m_registered)
+    {
+        // Usually RLIMIT_MEMLOCK on kernels before 5.12, plain writes still avoid the syscall per block
+        qDebug() << "BlockWriteQueue: Cannot register buffers" << systemError(errno);
+        if (!writeSupported(m_ringFd))
+        {
+            qDebug() << "BlockWriteQueue: The kernel has no io_uring write without registered buffers, using pwrite";
+            closeRing();
+            return false;
+        }
+    }
+    m_ringFailed = false;
+
+    m_backend = Backend::IoUring;
+    return true;
+#else
+    qDebug() << "BlockWriteQueue: Built without io_uring, using pwrite";
+    return false;
+#endif
+}
+
+void BlockWriteQueue::closeRing()
+{
+#ifdef BLOCKWRITEQUEUE_IO_URING
+    if (m_entries && m_entries != MAP_FAILED)
+    {
+        ::munmap(m_entries, size_t(m_entriesBytes));
+    }
+    if (m_completionRing && m_completionRing != MAP_FAILED && m_completionRing != m_submissionRing)
+    {
+        ::munmap(m_completionRing, size_t(m_completionRingBytes));
+    }
+    if (m_submissionRing && m_submissionRing != MAP_FAILED)
+    {
+        ::munmap(m_submissionRing, size_t(m_submissionRingBytes));
+    }
+    if (m_ringFd >= 0)
+    {
+        // Also unregisters the buffers
+        ::close(m_ringFd);
+    }
+#endif
+    m_ringFd = -1;
+    m_submissionRing = nullptr;
+    m_completionRing = nullptr;
+    m_entries = nullptr;
+    m_registered = false;
+}
+
+bool BlockWriteQueue::submitWrite(int index)
+{
+#ifdef BLOCKWRITEQUEUE_IO_URING
+    if (m_ringFailed)
+    {
+        m_error = QStringLiteral("The io_uring failed earlier");
+        return false;
+    }
+
+    const Write &write = m_writes.at(index);
+    const unsigned tail = *ringField(m_submissionRing, m_ring.submissionTail);
+    const unsigned slot = tail & *ringField(m_submissionRing, m_ring.submissionMask);
+
+    io_uring_sqe &entry = static_cast<io_uring_sqe *>(m_entries)[slot];
+    std::memset(&entry, 0, sizeof(entry));
+    entry.opcode = m_registered ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    entry.fd = m_fd;
+    entry.addr = quint64(quintptr(write.data));
+    entry.len = quint32(write.size);
+    entry.off = quint64(write.offset);
+    entry.buf_index = quint16(index);
+    entry.user_data = quint64(index);
+    storeRelease(m_submissionRing, m_ring.submissionTail, tail + 1);
+
+    if (enterRing(m_ringFd, 1, 0, 0) < 0)
+    {
+        m_error = systemError(errno);
+
+        // The kernel only reads the queue during io_uring_enter, so an entry it did not take can be
+        // withdrawn; it must not be submitted by a later call once the caller reused the buffer. The
+        // ring is not used for writes again either way.
+        if (loadAcquire(m_submissionRing, m_ring.submissionHead) == tail)
+        {
+            storeRelease(m_submissionRing, m_ring.submissionTail, tail);
+        }
+        m_ringFailed = true;
+        qDebug() << "BlockWriteQueue: Submitting to the io_uring failed" << m_error;
+        return false;
+    }
+    return true;
+#else
+    Q_UNUSED(index);
+    return false;
+#endif
+}
@@ -0,0 +1,287 @@
+#include "../include/sessionindex.h"
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+constexpr char IndexMagic[8] = {'A', 'S', 'U', 'R', 'T', 'I', 'D', 'X'};
+constexpr quint16 IndexVersion = 1;
+
+// Entry kind of a block, markers use their own kinds
+constexpr quint8 BlockKind = 1;
+
+// Label bytes kept per marker
+constexpr int LabelBytes = 16;
+}
+
+QString SessionIndex::indexPath(const QString &logPath)
+{
+    const QFileInfo info(logPath);
+    return QDir(info.path()).filePath(info.completeBaseName() + QStringLiteral(".idx"));
+}
+
+bool SessionIndex::open(const QString &logPath, SessionIndex &index, QString *error)
+{
+    QFile log(logPath);
+    if (!log.open(QIODevice::ReadOnly))
+    {
+        if (error)
+        {
+            *error = log.errorString();
+        }
+        return false;
+    }
+
+    SessionLog::FileHeader fileHeader;
+    const QByteArray headerBytes = log.read(SessionLog::FileHeaderSize);
+    if (headerBytes.size() != SessionLog::FileHeaderSize
+        || !SessionLog::readFileHeader(reinterpret_cast<const uchar *>(headerBytes.constData()), fileHeader))
+    {
+        if (error)
+        {
+            *error = QStringLiteral("Not a session log of version %1").arg(SessionLog::Version);
+        }
+        return false;
+    }
+
+    const QString path = indexPath(logPath);
+    const qint64 size = log.size();
+    bool changed = !index.load(path);
+    if (index.coveredBytes() > size)
+    {
+        // The index belongs to a different or truncated log, only the markers can be trusted
+        index.m_blocks.clear();
+        changed = true;
+    }
+
+    // Only the block headers after the indexed part are read, a crash leaves at most a few of them
+    qint64 offset = qMax<qint64>(index.coveredBytes(), SessionLog::FileHeaderSize);
+    QByteArray blockHeader;
+    while (offset + SessionLog::BlockHeaderSize <= size && log.seek(offset))
+    {
+        blockHeader = log.read(SessionLog::BlockHeaderSize);
+        SessionLog::BlockHeader header;
+        if (blockHeader.size() != SessionLog::BlockHeaderSize
+            || !SessionLog::readBlockHeader(reinterpret_cast<const uchar *>(blockHeader.constData()), size - offset, header))
+        {
+            break;
+        }
+
+        Block block;
+        block.firstTimeUs = header.firstTimeUs;
+        block.lastTimeUs = header.lastTimeUs;
+        block.offset = offset;
+        block.recordCount = header.recordCount;
+        block.firstSequence = header.firstSequence;
+        block.blockBytes = header.blockBytes;
+        index.appendBlock(block);
+        offset += header.blockBytes;
+        changed = true;
+    }
+
+    // A log still being recorded keeps its sidecar, the recorder appends to it through an open handle
+    // that a replaced file would leave writing to the old one
+    const bool recording = fileHeader.version >= SessionLog::ChecksumVersion && !(fileHeader.flags & SessionLog::ClosedFlag);
+    if (changed && recording)
+    {
+        qDebug() << "SessionIndex: Rebuilt" << path << "in memory, the log is still being recorded";
+    }
+    else if (changed)
+    {
+        qDebug() << "SessionIndex: Rebuilt" << path << "with" << index.blocks().size() << "blocks";
+        if (!index.save(path))
+        {
+            // Still usable from memory, the next open rebuilds it again
+            qDebug() << "SessionIndex: Cannot write" << path;
+        }
+    }
+    return true;
+}
+
+bool SessionIndex::load(const QString &indexPath)
+{
+    m_blocks.clear();
+    m_markers.clear();
+
+    QFile file(indexPath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    const QByteArray data = file.readAll();
+    const uchar *bytes = reinterpret_cast<const uchar *>(data.constData());
+    if (data.size() < HeaderSize || std::memcmp(bytes, IndexMagic, sizeof(IndexMagic)) != 0
+        || qFromLittleEndian<quint16>(bytes + 8) != IndexVersion || qFromLittleEndian<quint16>(bytes + 10) != EntrySize)
+    {
+        return false;
+    }
+
+    // A torn last entry is ignored, the blocks it would describe are rebuilt from the log
+    for (qsizetype position = HeaderSize; position + EntrySize <= data.size(); position += EntrySize)
+    {
+        const uchar *entry = bytes + position;
+        if (entry[0] == BlockKind)
+        {
+            Block block;
+            block.firstTimeUs = qFromLittleEndian<qint64>(entry + 8);
+            block.lastTimeUs = qFromLittleEndian<qint64>(entry + 16);
+            block.offset = qFromLittleEndian<qint64>(entry + 24);
+            block.recordCount = qFromLittleEndian<quint32>(entry + 32);
+            block.blockBytes = qFromLittleEndian<quint32>(entry + 36);
+            block.firstSequence = qFromLittleEndian<quint64>(entry + 40);
+            m_blocks.append(block);
+        }
+        else if (entry[0] == quint8(Marker::Kind::Lap) || entry[0] == quint8(Marker::Kind::Marker))
+        {
+            Marker marker;
+            marker.kind = Marker::Kind(entry[0]);
+            marker.timeUs = qFromLittleEndian<qint64>(entry + 8);
+            marker.lap = int(qFromLittleEndian<quint32>(entry + 32));
+            const char *label = reinterpret_cast<const char *>(entry + 48);
+            marker.label = QString::fromUtf8(label, qsizetype(strnlen(label, LabelBytes)));
+            appendMarker(marker);
+        }
+    }
+    return true;
+}
+
+bool SessionIndex::save(const QString &indexPath) const
+{
+    // Replaced in one step, a reader never sees a half-written index
+    QSaveFile file(indexPath);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    QByteArray data = encodeHeader();
+    data.reserve(HeaderSize + (m_blocks.size() + m_markers.size()) * EntrySize);
+    for (const Block &block : m_blocks)
+    {
+        data += encode(block);
+    }
+    for (const Marker &marker : m_markers)
+    {
+        data += encode(marker);
+    }
+    return file.write(data) == data.size() && file.commit();
+}
+
+qint64 SessionIndex::coveredBytes() const
+{
+    if (m_blocks.isEmpty())
+    {
+        return 0;
+    }
+    const Block &last = m_blocks.last();
+    return last.offset + last.size();
+}
+
+int SessionIndex::lapCount() const
+{
+    return int(std::count_if(m_markers.cbegin(), m_markers.cend(), [](const Marker &marker)
+    {
+        return marker.kind == Marker::Kind::Lap;
+    }));
+}
+
+qsizetype SessionIndex::blockAt(qint64 timeUs) const
+{
+    const auto it = std::partition_point(m_blocks.cbegin(), m_blocks.cend(), [timeUs](const Block &block)
+    {
+        return block.lastTimeUs < timeUs;
+    });
+    return it - m_blocks.cbegin();
+}
+
+qint64 SessionIndex::lapStartUs(int lap) const
+{
+    for (const Marker &marker : m_markers)
+    {
+        if (marker.kind == Marker::Kind::Lap && marker.lap == lap)
+        {
+            return marker.timeUs;
+        }
+    }
+    return -1;
+}
+
+bool SessionIndex::readBlock(QFile &log, qsizetype block, QByteArray &data, SessionLog::BlockHeader &header) const
+{
+    if (block < 0 || block >= m_blocks.size())
+    {
+        return false;
+    }
+
+    // The size is known from the entry, so the whole block comes in with one positioned read
+    const Block &entry = m_blocks.at(block);
+    const qint64 bytes = entry.size();
+    data.resize(bytes);
+    return log.seek(entry.offset) && log.read(data.data(), bytes) == bytes
+           && SessionLog::readBlockHeader(reinterpret_cast<const uchar *>(data.constData()), bytes, header);
+}
+
+void SessionIndex::appendBlock(const Block &block)
+{
+    m_blocks.append(block);
+}
+
+void SessionIndex::appendMarker(const Marker &marker)
+{
+    // Kept in time order, markers can come in while earlier blocks are still being written
+    const auto position = std::upper_bound(m_markers.begin(), m_markers.end(), marker.timeUs, [](qint64 timeUs, const Marker &other)
+    {
+        return timeUs < other.timeUs;
+    });
+    m_markers.insert(position - m_markers.begin(), marker);
+}
+
+QByteArray SessionIndex::encodeHeader()
+{
+    QByteArray data(HeaderSize, '\0');
+    uchar *bytes = reinterpret_cast<uchar *>(data.data());
+    std::memcpy(bytes, IndexMagic, sizeof(IndexMagic));
+    qToLittleEndian<quint16>(IndexVersion, bytes + 8);
+    qToLittleEndian<quint16>(EntrySize, bytes + 10);
+    return data;
+}
+
+QByteArray SessionIndex::encode(const Block &block)
+{
+    QByteArray data(EntrySize, '\0');
+    uchar *entry = reinterpret_cast<uchar *>(data.data());
+    entry[0] = BlockKind;
+    qToLittleEndian<qint64>(block.firstTimeUs, entry + 8);
+    qToLittleEndian<qint64>(block.lastTimeUs, entry + 16);
+    qToLittleEndian<qint64>(block.offset, entry + 24);
+    qToLittleEndian<quint32>(block.recordCount, entry + 32);
+    qToLittleEndian<quint32>(block.blockBytes, entry + 36);
+    qToLittleEndian<quint64>(block.firstSequence, entry + 40);
+    return data;
+}
+
+QByteArray SessionIndex::encode(const Marker &marker)
+{
+    QByteArray data(EntrySize, '\0');
+    uchar *entry = reinterpret_cast<uchar *>(data.data());
+    entry[0] = quint8(marker.kind);
+    qToLittleEndian<qint64>(marker.timeUs, entry + 8);
+    qToLittleEndian<quint32>(quint32(marker.lap), entry + 32);
+
+    // Cut at a character boundary, continuation bytes are 10xxxxxx
+    const QByteArray label = marker.label.toUtf8();
+    qsizetype length = qMin<qsizetype>(label.size(), LabelBytes);
+    while (length < label.size() && length > 0 && (uchar(label.at(length)) & 0xC0) == 0x80)
+    {
+        --length;
+    }
+    std::memcpy(entry + 48, label.constData(), length);
+    return data;
+}
@@ -0,0 +1,291 @@
+#include "../include/sessionlogformat.h"
+#include <QFile>
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+// Position of the flags in the file header
+constexpr qint64 FlagsOffset = 10;
+
+// Position of the checksum in the block header, the checksum covers everything around it
+constexpr int ChecksumOffset = 36;
+
+/**
+ * @brief Lookup tables of a slicing-by-8 CRC-32C, eight input bytes per step
+ */
+struct CrcTables
+{
+    quint32 entries[8][256] = {};
+};
+
+constexpr CrcTables makeCrcTables()
+{
+    // Reflected Castagnoli polynomial
+    constexpr quint32 Polynomial = 0x82F63B78;
+
+    CrcTables tables;
+    for (quint32 i = 0; i < 256; ++i)
+    {
+        quint32 crc = i;
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc >> 1) ^ ((crc & 1) ? Polynomial : 0);
+        }
+        tables.entries[0][i] = crc;
+    }
+    for (int table = 1; table < 8; ++table)
+    {
+        for (int i = 0; i < 256; ++i)
+        {
+            const quint32 previous = tables.entries[table - 1][i];
+            tables.entries[table][i] = (previous >> 8) ^ tables.entries[0][previous & 0xFF];
+        }
+    }
+    return tables;
+}
+
+constexpr CrcTables crcTables = makeCrcTables();
+
+quint32 blockChecksum(const uchar *block, quint32 blockBytes)
+{
+    const quint32 crc = SessionLog::crc32c(block, ChecksumOffset);
+    return SessionLog::crc32c(block + ChecksumOffset + 4, qsizetype(blockBytes) - ChecksumOffset - 4, crc);
+}
+}
+
+namespace SessionLog
+{
+void writeFileHeader(uchar *destination, const FileHeader &header)
+{
+    std::memset(destination, 0, FileHeaderSize);
+    std::memcpy(destination, FileMagic, sizeof(FileMagic));
+    qToLittleEndian<quint16>(header.version, destination + 8);
+    qToLittleEndian<quint16>(header.flags, destination + FlagsOffset);
+    qToLittleEndian<quint16>(header.channelCount, destination + 12);
+    qToLittleEndian<qint64>(header.startedMsSinceEpoch, destination + 16);
+    qToLittleEndian<qint64>(header.startTimeUs, destination + 24);
+}
+
+bool readFileHeader(const uchar *source, FileHeader &header)
+{
+    if (std::memcmp(source, FileMagic, sizeof(FileMagic)) != 0)
+    {
+        return false;
+    }
+
+    header.version = qFromLittleEndian<quint16>(source + 8);
+    header.flags = qFromLittleEndian<quint16>(source + FlagsOffset);
+    header.channelCount = qFromLittleEndian<quint16>(source + 12);
+    header.startedMsSinceEpoch = qFromLittleEndian<qint64>(source + 16);
+    header.startTimeUs = qFromLittleEndian<qint64>(source + 24);
+
+    // Blocks of other versions or channel sets cannot be decoded with this table
+    return header.version >= MinimumVersion && header.version <= Version && header.channelCount == TelemetryChannelCount;
+}
+
+bool markClosed(QFile &log)
+{
+    uchar flags[2];
+    qToLittleEndian<quint16>(ClosedFlag, flags);
+    const qint64 end = log.size();
+    return log.seek(FlagsOffset) && log.write(reinterpret_cast<const char *>(flags), sizeof(flags)) == qint64(sizeof(flags))
+           && log.seek(end);
+}
+
+bool syncFile(QFile &file)
+{
+    if (!file.flush())
+    {
+        return false;
+    }
+#if defined(Q_OS_WIN)
+    return FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()))) != 0;
+#elif defined(Q_OS_DARWIN)
+    // A plain fsync() leaves the data in the drive cache on Apple platforms
+    return ::fcntl(file.handle(), F_FULLFSYNC) == 0 || ::fsync(file.handle()) == 0;
+#else
+    // The size of a growing file is synced as well, only timestamps are skipped
+    return ::fdatasync(file.handle()) == 0;
+#endif
+}
+
+quint32 crc32c(const uchar *data, qsizetype size, quint32 crc)
+{
+    const auto &table = crcTables.entries;
+    crc = ~crc;
+    while (size >= 8)
+    {
+        const quint32 low = qFromLittleEndian<quint32>(data) ^ crc;
+        const quint32 high = qFromLittleEndian<quint32>(data + 4);
+        crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^ table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24]
+              ^ table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^ table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+        data += 8;
+        size -= 8;
+    }
+    while (size-- > 0)
+    {
+        crc = table[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void writeRecord(uchar *block, quint32 capacity, quint32 index, quint64 sequence, Transport transport, const TelemetryFrame &frame)
+{
+    qToLittleEndian<qint64>(frame.timestampUs, block + columnOffset(TimestampColumn, capacity) + qsizetype(index) * 8);
+    qToLittleEndian<quint64>(sequence, block + columnOffset(SequenceColumn, capacity) + qsizetype(index) * 8);
+    block[columnOffset(TransportColumn, capacity) + index] = static_cast<uchar>(transport);
+
+    uchar *value = block + columnOffset(FirstChannelColumn, capacity) + qsizetype(index) * 8;
+    const qsizetype stride = qsizetype(capacity) * 8;
+    for (const TelemetryChannelInfo &channel : telemetryChannels())
+    {
+        qToLittleEndian<double>(channel.read(frame), value);
+        value += stride;
+    }
+}
+
+quint32 finishBlock(uchar *block, quint32 capacity, BlockHeader &header, quint32 padding)
+{
+    const quint32 count = header.recordCount;
+
+    for (int column = 0; column < ColumnCount; ++column)
+    {
+        ColumnInfo &info = header.columns[column];
+        info.offset = quint32(columnOffset(column, count));
+        info.bytes = quint32(columnBytes(column, count));
+
+        // Columns only ever move towards the header, so moving them in order never overwrites one not yet moved
+        const qsizetype from = columnOffset(column, capacity);
+        if (from != info.offset)
+        {
+            std::memmove(block + info.offset, block + from, column == TransportColumn ? count : qsizetype(count) * 8);
+        }
+        if (column == TransportColumn)
+        {
+            std::memset(block + info.offset + count, 0, info.bytes - count);
+        }
+    }
+
+    // Minimum and maximum let readers skip whole blocks when searching for a value
+    for (int column = 0; column < ColumnCount; ++column)
+    {
+        ColumnInfo &info = header.columns[column];
+        double minimum = std::numeric_limits<double>::infinity();
+        double maximum = -std::numeric_limits<double>::infinity();
+        const uchar *data = block + info.offset;
+        for (quint32 i = 0; i < count; ++i)
+        {
+            double value;
+            if (column == TimestampColumn)
+            {
+                value = double(qFromLittleEndian<qint64>(data + qsizetype(i) * 8));
+            }
+            else if (column == SequenceColumn)
+            {
+                value = double(qFromLittleEndian<quint64>(data + qsizetype(i) * 8));
+            }
+            else if (column == TransportColumn)
+            {
+                value = double(data[i]);
+            }
+            else
+            {
+                value = qFromLittleEndian<double>(data + qsizetype(i) * 8);
+            }
+            minimum = value < minimum ? value : minimum;
+            maximum = value > maximum ? value : maximum;
+        }
+        info.minimum = count > 0 ? minimum : 0.0;
+        info.maximum = count > 0 ? maximum : 0.0;
+    }
+
+    header.blockBytes = quint32(columnOffset(ColumnCount, count)) + padding;
+    std::memset(block + header.blockBytes - padding, 0, padding);
+
+    std::memcpy(block, BlockMagic, sizeof(BlockMagic));
+    qToLittleEndian<quint32>(header.recordCount, block + 4);
+    qToLittleEndian<quint64>(header.firstSequence, block + 8);
+    qToLittleEndian<qint64>(header.firstTimeUs, block + 16);
+    qToLittleEndian<qint64>(header.lastTimeUs, block + 24);
+    qToLittleEndian<quint32>(header.blockBytes, block + 32);
+    qToLittleEndian<quint32>(0, block + ChecksumOffset);
+
+    uchar *entry = block + 40;
+    for (const ColumnInfo &info : header.columns)
+    {
+        qToLittleEndian<quint32>(info.offset, entry);
+        qToLittleEndian<quint32>(info.bytes, entry + 4);
+        qToLittleEndian<double>(info.minimum, entry + 8);
+        qToLittleEndian<double>(info.maximum, entry + 16);
+        entry += ColumnEntrySize;
+    }
+
+    header.checksum = blockChecksum(block, header.blockBytes);
+    qToLittleEndian<quint32>(header.checksum, block + ChecksumOffset);
+    return header.blockBytes;
+}
+
+bool readBlockHeader(const uchar *source, qint64 available, BlockHeader &header)
+{
+    if (available < BlockHeaderSize || std::memcmp(source, BlockMagic, sizeof(BlockMagic)) != 0)
+    {
+        return false;
+    }
+
+    header.recordCount = qFromLittleEndian<quint32>(source + 4);
+    header.firstSequence = qFromLittleEndian<quint64>(source + 8);
+    header.firstTimeUs = qFromLittleEndian<qint64>(source + 16);
+    header.lastTimeUs = qFromLittleEndian<qint64>(source + 24);
+    header.blockBytes = qFromLittleEndian<quint32>(source + 32);
+    header.checksum = qFromLittleEndian<quint32>(source + ChecksumOffset);
+    if (header.blockBytes < columnOffset(ColumnCount, header.recordCount) || header.blockBytes > available)
+    {
+        return false;
+    }
+
+    const uchar *entry = source + 40;
+    for (int column = 0; column < ColumnCount; ++column)
+    {
+        ColumnInfo &info = header.columns[column];
+        info.offset = qFromLittleEndian<quint32>(entry);
+        info.bytes = qFromLittleEndian<quint32>(entry + 4);
+        info.minimum = qFromLittleEndian<double>(entry + 8);
+        info.maximum = qFromLittleEndian<double>(entry + 16);
+        if (info.offset != columnOffset(column, header.recordCount) || info.bytes != columnBytes(column, header.recordCount))
+        {
+            return false;
+        }
+        entry += ColumnEntrySize;
+    }
+    return true;
+}
+
+bool verifyBlock(const uchar *block, const BlockHeader &header)
+{
+    return blockChecksum(block, header.blockBytes) == header.checksum;
+}
+
+void readRecord(const uchar *block, const BlockHeader &header, quint32 index, Record &record)
+{
+    const std::array<ColumnInfo, ColumnCount> &columns = header.columns;
+    record.frame.timestampUs = qFromLittleEndian<qint64>(block + columns[TimestampColumn].offset + qsizetype(index) * 8);
+    record.sequence = qFromLittleEndian<quint64>(block + columns[SequenceColumn].offset + qsizetype(index) * 8);
+    record.transport = static_cast<Transport>(block[columns[TransportColumn].offset + index]);
+
+    for (const TelemetryChannelInfo &channel : telemetryChannels())
+    {
+        const ColumnInfo &info = columns[channelColumn(channel.channel)];
+        channel.write(record.frame, qFromLittleEndian<double>(block + info.offset + qsizetype(index) * 8));
+    }
+}
+}
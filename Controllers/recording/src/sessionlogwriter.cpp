@@ -0,0 +1,186 @@
+#include "../include/sessionlogwriter.h"
+#include "../../telemetry/include/parallelfor.h"
+#include <QDebug>
+#include <QThreadPool>
+
+namespace
+{
+// Same block size as the recorder, so replay and export see the same kind of log
+constexpr int BlockBytes = 1 << 20;
+constexpr quint32 RecordsPerBlock = SessionLog::blockCapacity(BlockBytes);
+}
+
+SessionLogWriter::SessionLogWriter()
+    : m_offset(0),
+    m_sequence(0),
+    m_window(qMax(1, QThreadPool::globalInstance()->maxThreadCount())),
+    m_transport(SessionLog::Transport::Unknown),
+    m_failed(false)
+{
+}
+
+bool SessionLogWriter::open(const QString &logPath, qint64 startedMsSinceEpoch, SessionLog::Transport transport, QString *error)
+{
+    m_logPath = logPath;
+    m_transport = transport;
+    m_pending.clear();
+    m_index = SessionIndex();
+    m_sequence = 0;
+    m_failed = false;
+    m_error.clear();
+
+    m_file.setFileName(logPath);
+    if (!m_file.open(QIODevice::WriteOnly))
+    {
+        m_failed = true;
+        m_error = m_file.errorString();
+        if (error)
+        {
+            *error = m_error;
+        }
+        return false;
+    }
+
+    // Frame timestamps are kept as they are, on a clock that reads the wall clock time in microseconds
+    SessionLog::FileHeader fileHeader;
+    fileHeader.startedMsSinceEpoch = startedMsSinceEpoch;
+    fileHeader.startTimeUs = startedMsSinceEpoch * 1000;
+    fileHeader.flags = SessionLog::ClosedFlag;
+    uchar headerBytes[SessionLog::FileHeaderSize];
+    SessionLog::writeFileHeader(headerBytes, fileHeader);
+    if (m_file.write(reinterpret_cast<const char *>(headerBytes), SessionLog::FileHeaderSize) != SessionLog::FileHeaderSize)
+    {
+        m_failed = true;
+        m_error = m_file.errorString();
+        m_file.cancelWriting();
+        if (error)
+        {
+            *error = m_error;
+        }
+        return false;
+    }
+    m_offset = SessionLog::FileHeaderSize;
+    return true;
+}
+
+bool SessionLogWriter::append(const TelemetryFrame *frames, qsizetype count)
+{
+    if (m_failed)
+    {
+        return false;
+    }
+
+    // Taken a window at a time, so a large append is not copied as a whole
+    const qsizetype windowRecords = m_window * RecordsPerBlock;
+    while (count > 0)
+    {
+        const qsizetype take = qMin(count, windowRecords - m_pending.size());
+        for (qsizetype i = 0; i < take; ++i)
+        {
+            m_pending.append(frames[i]);
+        }
+        frames += take;
+        count -= take;
+
+        if (m_pending.size() == windowRecords && !writeBlocks(false))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SessionLogWriter::commit(QString *error)
+{
+    auto fail = [this, error]()
+    {
+        m_file.cancelWriting();
+        if (error)
+        {
+            *error = m_error;
+        }
+        return false;
+    };
+
+    if (m_failed || !writeBlocks(true))
+    {
+        return fail();
+    }
+    if (!m_file.commit())
+    {
+        m_failed = true;
+        m_error = m_file.errorString();
+        return fail();
+    }
+
+    if (!m_index.save(SessionIndex::indexPath(m_logPath)))
+    {
+        // Not fatal, readers rebuild a missing index from the log
+        qDebug() << "SessionLogWriter: Cannot write index" << SessionIndex::indexPath(m_logPath);
+    }
+    return true;
+}
+
+bool SessionLogWriter::writeBlocks(bool all)
+{
+    // Whole windows of full blocks while appending, everything including a partial block when committing
+    const qsizetype fullBlocks = m_pending.size() / RecordsPerBlock;
+    const qsizetype blockCount = all ? (m_pending.size() + RecordsPerBlock - 1) / RecordsPerBlock
+                                     : fullBlocks - fullBlocks % m_window;
+    m_blocks.resize(m_window);
+    m_headers.resize(m_window);
+
+    for (qsizetype first = 0; first < blockCount; first += m_window)
+    {
+        const qsizetype count = qMin(m_window, blockCount - first);
+        parallelFor(count, [&](qsizetype i)
+        {
+            const qsizetype begin = (first + i) * RecordsPerBlock;
+            const quint32 records = quint32(qMin<qsizetype>(RecordsPerBlock, m_pending.size() - begin));
+            QByteArray &data = m_blocks[i];
+            if (data.size() != BlockBytes)
+            {
+                data.resize(BlockBytes);
+            }
+            uchar *block = reinterpret_cast<uchar *>(data.data());
+
+            SessionLog::BlockHeader &header = m_headers[i];
+            header = SessionLog::BlockHeader();
+            header.recordCount = records;
+            header.firstSequence = m_sequence + quint64(begin);
+            header.firstTimeUs = m_pending.at(begin).timestampUs;
+            header.lastTimeUs = m_pending.at(begin + records - 1).timestampUs;
+            for (quint32 record = 0; record < records; ++record)
+            {
+                SessionLog::writeRecord(block, RecordsPerBlock, record, header.firstSequence + record, m_transport, m_pending.at(begin + record));
+            }
+            SessionLog::finishBlock(block, RecordsPerBlock, header);
+        });
+
+        for (qsizetype i = 0; i < count; ++i)
+        {
+            const SessionLog::BlockHeader &header = m_headers.at(i);
+            if (m_file.write(m_blocks.at(i).constData(), header.blockBytes) != qint64(header.blockBytes))
+            {
+                m_failed = true;
+                m_error = m_file.errorString();
+                return false;
+            }
+
+            SessionIndex::Block entry;
+            entry.firstTimeUs = header.firstTimeUs;
+            entry.lastTimeUs = header.lastTimeUs;
+            entry.offset = m_offset;
+            entry.recordCount = header.recordCount;
+            entry.firstSequence = header.firstSequence;
+            entry.blockBytes = header.blockBytes;
+            m_index.appendBlock(entry);
+            m_offset += header.blockBytes;
+        }
+    }
+
+    const qsizetype written = qMin(m_pending.size(), blockCount * RecordsPerBlock);
+    m_pending.remove(0, written);
+    m_sequence += quint64(written);
+    return true;
+}
@@ -0,0 +1,223 @@
+#include "../include/sessionreader.h"
+#include "../../telemetry/include/parallelfor.h"
+#include <QDebug>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+// Columns are handed out in place, the little-endian file layout has to be the native one
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "SessionReader maps columns directly and needs a little-endian host");
+
+SessionReader::SessionReader()
+    : m_data(nullptr),
+    m_validBytes(0),
+    m_frameCount(0)
+{
+}
+
+SessionReader::~SessionReader()
+{
+    close();
+}
+
+bool SessionReader::open(const QString &path, QString *error)
+{
+    close();
+
+    if (!SessionIndex::open(path, m_index, error))
+    {
+        return false;
+    }
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        if (error)
+        {
+            *error = m_file.errorString();
+        }
+        return false;
+    }
+
+    const qint64 size = m_file.size();
+    uchar *data = size >= SessionLog::FileHeaderSize ? m_file.map(0, size) : nullptr;
+    if (!data || !SessionLog::readFileHeader(data, m_fileHeader))
+    {
+        if (error)
+        {
+            *error = data ? QStringLiteral("Not a session log of version %1").arg(SessionLog::Version)
+                          : QStringLiteral("Cannot map %1").arg(path);
+        }
+        if (data)
+        {
+            m_file.unmap(data);
+        }
+        m_file.close();
+        return false;
+    }
+    m_data = data;
+
+    // The index knows where every block starts, only their directories are read from the mapping
+    m_chunks.reserve(m_index.blocks().size());
+    for (const SessionIndex::Block &block : m_index.blocks())
+    {
+        Chunk chunk;
+        chunk.offset = block.offset;
+        if (block.offset > size || !SessionLog::readBlockHeader(m_data + block.offset, size - block.offset, chunk.header))
+        {
+            qDebug() << "SessionReader: Index of" << path << "does not match the log at offset" << block.offset;
+            break;
+        }
+        if (chunk.header.recordCount > 0)
+        {
+            m_frameCount += chunk.header.recordCount;
+            m_chunks.append(chunk);
+        }
+        m_validBytes = block.offset + chunk.header.blockBytes;
+    }
+    if (m_validBytes < size)
+    {
+        qDebug() << "SessionReader: Ignoring" << size - qMax<qint64>(m_validBytes, SessionLog::FileHeaderSize) << "bytes after the last complete block of" << path;
+    }
+    return true;
+}
+
+void SessionReader::close()
+{
+    if (m_data)
+    {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+    m_file.close();
+    m_chunks.clear();
+    m_frameCount = 0;
+    m_validBytes = 0;
+    m_fileHeader = SessionLog::FileHeader();
+    m_index = SessionIndex();
+}
+
+qint64 SessionReader::firstTimeUs() const
+{
+    return m_chunks.isEmpty() ? 0 : m_chunks.first().header.firstTimeUs;
+}
+
+qint64 SessionReader::lastTimeUs() const
+{
+    return m_chunks.isEmpty() ? 0 : m_chunks.last().header.lastTimeUs;
+}
+
+qsizetype SessionReader::chunkAt(qint64 timeUs) const
+{
+    const auto it = std::partition_point(m_chunks.cbegin(), m_chunks.cend(), [timeUs](const Chunk &chunk)
+    {
+        return chunk.header.lastTimeUs < timeUs;
+    });
+    return it - m_chunks.cbegin();
+}
+
+const uchar *SessionReader::column(qsizetype chunk, int column) const
+{
+    const Chunk &entry = m_chunks.at(chunk);
+    return m_data + entry.offset + entry.header.columns[column].offset;
+}
+
+QSpan<const qint64> SessionReader::timestamps(qsizetype chunk) const
+{
+    return QSpan<const qint64>(reinterpret_cast<const qint64 *>(column(chunk, SessionLog::TimestampColumn)), m_chunks.at(chunk).header.recordCount);
+}
+
+QSpan<const quint64> SessionReader::sequences(qsizetype chunk) const
+{
+    return QSpan<const quint64>(reinterpret_cast<const quint64 *>(column(chunk, SessionLog::SequenceColumn)), m_chunks.at(chunk).header.recordCount);
+}
+
+QSpan<const double> SessionReader::values(qsizetype chunk, TelemetryChannel channel) const
+{
+    return QSpan<const double>(reinterpret_cast<const double *>(column(chunk, SessionLog::channelColumn(channel))), m_chunks.at(chunk).header.recordCount);
+}
+
+void SessionReader::readRecord(qsizetype chunk, quint32 index, SessionLog::Record &record) const
+{
+    const Chunk &entry = m_chunks.at(chunk);
+    SessionLog::readRecord(m_data + entry.offset, entry.header, index, record);
+}
+
+void SessionReader::rangeInChunk(qsizetype chunk, qint64 fromUs, qint64 toUs, qsizetype &begin, qsizetype &end) const
+{
+    const QSpan<const qint64> times = timestamps(chunk);
+    begin = std::lower_bound(times.begin(), times.end(), fromUs) - times.begin();
+    end = std::upper_bound(times.begin() + begin, times.end(), toUs) - times.begin();
+}
+
+TelemetrySeries SessionReader::loadChannel(TelemetryChannel channel, qint64 fromUs, qint64 toUs) const
+{
+    TelemetrySeries series;
+    const qsizetype first = chunkAt(fromUs);
+    qsizetype last = first;
+    while (last < m_chunks.size() && m_chunks.at(last).header.firstTimeUs <= toUs)
+    {
+        ++last;
+    }
+
+    // Output positions are known up front, so every block copies into its own slice
+    const qsizetype count = last - first;
+    QList<qsizetype> begins(count);
+    QList<qsizetype> outputs(count + 1, 0);
+    for (qsizetype i = 0; i < count; ++i)
+    {
+        qsizetype end = 0;
+        rangeInChunk(first + i, fromUs, toUs, begins[i], end);
+        outputs[i + 1] = outputs[i] + (end - begins[i]);
+    }
+
+    series.timestampsUs.resize(outputs.last());
+    series.values.resize(outputs.last());
+    qint64 *timesOut = series.timestampsUs.data();
+    double *valuesOut = series.values.data();
+
+    parallelFor(count, [&](qsizetype i)
+    {
+        const qsizetype length = outputs[i + 1] - outputs[i];
+        std::memcpy(timesOut + outputs[i], timestamps(first + i).data() + begins[i], length * sizeof(qint64));
+        std::memcpy(valuesOut + outputs[i], values(first + i, channel).data() + begins[i], length * sizeof(double));
+    });
+
+    return series;
+}
+
+bool SessionReader::channelBounds(TelemetryChannel channel, qint64 fromUs, qint64 toUs, double &minimum, double &maximum) const
+{
+    bool found = false;
+    for (qsizetype chunk = chunkAt(fromUs); chunk < m_chunks.size() && m_chunks.at(chunk).header.firstTimeUs <= toUs; ++chunk)
+    {
+        const SessionLog::BlockHeader &header = m_chunks.at(chunk).header;
+        double low;
+        double high;
+        if (header.firstTimeUs >= fromUs && header.lastTimeUs <= toUs)
+        {
+            const SessionLog::ColumnInfo &info = header.columns[SessionLog::channelColumn(channel)];
+            low = info.minimum;
+            high = info.maximum;
+        }
+        else
+        {
+            qsizetype begin = 0;
+            qsizetype end = 0;
+            rangeInChunk(chunk, fromUs, toUs, begin, end);
+            if (begin == end)
+            {
+                continue;
+            }
+            const QSpan<const double> column = values(chunk, channel).sliced(begin, end - begin);
+            const auto bounds = std::minmax_element(column.begin(), column.end());
+            low = *bounds.first;
+            high = *bounds.second;
+        }
+
+        minimum = found ? qMin(minimum, low) : low;
+        maximum = found ? qMax(maximum, high) : high;
+        found = true;
+    }
+    return found;
+}
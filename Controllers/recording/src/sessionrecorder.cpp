@@ -0,0 +1,576 @@
+#include "../include/sessionrecorder.h"
+#include "../include/sessionrecovery.h"
+#include <QDebug>
+#include <QDir>
+#include <QDateTime>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QThread>
+#include <cstring>
+
+namespace
+{
+// Size of each block, one write per block keeps the syscall rate far below the frame rate
+constexpr int BlockBytes = 1 << 20;
+
+// Frames that fit behind the block header and column directory
+constexpr quint32 RecordsPerBlock = SessionLog::blockCapacity(BlockBytes);
+
+// Default group-commit policy, a power loss costs at most about a second of frames
+constexpr int DefaultSyncIntervalMs = 1000;
+constexpr qint64 DefaultSyncBytes = qint64(8) << 20;
+
+// A partly filled block is written after this much time when syncing by time is off, bounds what a crash can lose
+constexpr int IdleFlushMs = 1000;
+
+// Interval at which the counters are published to QML
+constexpr int StatsIntervalMs = 1000;
+
+// Writes in flight with io_uring, the ring holds one more block that is being filled
+constexpr int DefaultQueueDepth = 4;
+}
+
+SessionRecorder::SessionRecorder(QObject *parent)
+    : QObject(parent),
+    m_directory(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + QStringLiteral("/sessions")),
+    m_ioThread(nullptr),
+    m_backend(BlockWriteQueue::Backend::IoUring),
+    m_directIo(false),
+    m_queueDepth(DefaultQueueDepth),
+    m_lapCount(0),
+    m_recording(false),
+    m_transport(quint8(SessionLog::Transport::Unknown)),
+    m_recordedFrames(0),
+    m_droppedFrames(0),
+    m_bytesWritten(0),
+    m_syncedFrames(0),
+    m_syncCount(0),
+    m_syncIntervalMs(DefaultSyncIntervalMs),
+    m_syncBytes(DefaultSyncBytes),
+    m_active(0),
+    m_nextSequence(0),
+    m_lastTimeUs(0),
+    m_stopping(false)
+{
+    m_statsTimer.setInterval(StatsIntervalMs);
+    connect(&m_statsTimer, &QTimer::timeout, this, &SessionRecorder::statsChanged);
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    stop();
+}
+
+bool SessionRecorder::start(const QString &sessionName)
+{
+    stop();
+
+    if (!QDir().mkpath(m_directory))
+    {
+        qDebug() << "SessionRecorder: Cannot create directory" << m_directory;
+        emit errorOccurred(QStringLiteral("Cannot create recording directory %1").arg(m_directory));
+        return false;
+    }
+
+    QString name = sessionName.trimmed();
+    name.replace(QRegularExpression(QStringLiteral("[^A-Za-z0-9_-]")), QStringLiteral("_"));
+    if (name.isEmpty())
+    {
+        name = QStringLiteral("session");
+    }
+
+    const QDateTime startedAt = QDateTime::currentDateTime();
+    m_filePath = QDir(m_directory).filePath(name + startedAt.toString(QStringLiteral("-yyyyMMdd-hhmmss")) + QStringLiteral(".tlog"));
+
+    // Unbuffered, every block goes to the kernel in one piece without another copy
+    m_file.setFileName(m_filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::NewOnly | QIODevice::Unbuffered))
+    {
+        qDebug() << "SessionRecorder: Cannot open" << m_filePath << m_file.errorString();
+        emit errorOccurred(QStringLiteral("Cannot open session log %1: %2").arg(m_filePath, m_file.errorString()));
+        return false;
+    }
+
+    // The index is appended along with the log, so it is as complete as the log after a crash
+    m_indexFile.setFileName(SessionIndex::indexPath(m_filePath));
+    if (!m_indexFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)
+        || m_indexFile.write(SessionIndex::encodeHeader()) != SessionIndex::HeaderSize)
+    {
+        // Not fatal, readers rebuild a missing index from the log
+        qDebug() << "SessionRecorder: Cannot write index" << m_indexFile.fileName() << m_indexFile.errorString();
+        m_indexFile.close();
+    }
+
+    SessionLog::FileHeader fileHeader;
+    fileHeader.startedMsSinceEpoch = startedAt.toMSecsSinceEpoch();
+    fileHeader.startTimeUs = telemetryTimestampUs();
+    uchar headerBytes[SessionLog::FileHeaderSize];
+    SessionLog::writeFileHeader(headerBytes, fileHeader);
+    if (m_file.write(reinterpret_cast<const char *>(headerBytes), SessionLog::FileHeaderSize) != SessionLog::FileHeaderSize)
+    {
+        qDebug() << "SessionRecorder: Cannot write" << m_filePath << m_file.errorString();
+        emit errorOccurred(QStringLiteral("Cannot write session log %1: %2").arg(m_filePath, m_file.errorString()));
+        m_file.close();
+        m_indexFile.close();
+        return false;
+    }
+
+    // Room for the file header in front of the first block and for the padding of direct I/O
+    QString error;
+    const int blockCount = m_queueDepth + 1;
+    if (!m_queue.open(m_filePath, m_backend, m_directIo, m_queueDepth, blockCount, BlockBytes + SessionLog::FileHeaderSize + BlockWriteQueue::Alignment, &error))
+    {
+        qDebug() << "SessionRecorder: Cannot open" << m_filePath << "for writing" << error;
+        emit errorOccurred(QStringLiteral("Cannot write session log %1: %2").arg(m_filePath, error));
+        m_file.close();
+        m_indexFile.close();
+        return false;
+    }
+    m_writeBackend = m_queue.description();
+
+    m_blocks.resize(blockCount);
+    for (int i = 0; i < blockCount; ++i)
+    {
+        m_blocks[i] = Block();
+        m_blocks[i].data = m_queue.buffer(i);
+    }
+    if (m_queue.isDirect())
+    {
+        // Direct writes start on a page boundary, so the first one writes the file header again
+        std::memcpy(m_blocks[0].data, headerBytes, SessionLog::FileHeaderSize);
+        m_blocks[0].start = SessionLog::FileHeaderSize;
+    }
+    m_active = 0;
+    m_nextSequence = 0;
+    m_lastTimeUs = 0;
+    m_stopping = false;
+    m_pendingMarkers.clear();
+    m_recordedFrames.store(0);
+    m_droppedFrames.store(0);
+    m_bytesWritten.store(SessionLog::FileHeaderSize);
+    m_syncedFrames.store(0);
+    m_syncCount.store(0);
+
+    m_ioThread = QThread::create([this]() { writeLoop(); });
+    m_ioThread->setObjectName(QStringLiteral("Session Recorder"));
+    m_ioThread->start();
+
+    m_recording.store(true);
+    m_statsTimer.start();
+    qDebug() << "SessionRecorder: Recording to" << m_filePath << "with" << m_writeBackend;
+
+    if (m_lapCount != 0)
+    {
+        m_lapCount = 0;
+        emit lapCountChanged();
+    }
+
+    emit recordingChanged();
+    emit statsChanged();
+    return true;
+}
+
+void SessionRecorder::stop()
+{
+    if (!m_recording.exchange(false))
+    {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_blockFull.wakeOne();
+    }
+
+    // The I/O thread writes and syncs what is left before it exits
+    m_ioThread->wait();
+    delete m_ioThread;
+    m_ioThread = nullptr;
+    m_queue.close();
+    m_file.close();
+    m_indexFile.close();
+    m_statsTimer.stop();
+
+    qDebug() << "SessionRecorder: Stopped," << recordedFrames() << "frames recorded," << droppedFrames() << "dropped";
+
+    emit statsChanged();
+    emit recordingChanged();
+}
+
+void SessionRecorder::markLap()
+{
+    if (!isRecording())
+    {
+        return;
+    }
+
+    SessionIndex::Marker marker;
+    marker.kind = SessionIndex::Marker::Kind::Lap;
+    marker.lap = ++m_lapCount;
+    marker.label = QStringLiteral("Lap %1").arg(marker.lap);
+    queueMarker(marker);
+    emit lapCountChanged();
+}
+
+void SessionRecorder::addMarker(const QString &label)
+{
+    if (!isRecording())
+    {
+        return;
+    }
+
+    SessionIndex::Marker marker;
+    marker.label = label;
+    queueMarker(marker);
+}
+
+void SessionRecorder::queueMarker(SessionIndex::Marker marker)
+{
+    // Same clock as the frame timestamps
+    marker.timeUs = telemetryTimestampUs();
+
+    QMutexLocker locker(&m_mutex);
+    m_pendingMarkers.append(marker);
+    m_blockFull.wakeOne();
+}
+
+int SessionRecorder::recover()
+{
+    const QList<SessionRecovery::Result> results = SessionRecovery::recoverDirectory(m_directory, isRecording() ? m_filePath : QString());
+    for (const SessionRecovery::Result &result : results)
+    {
+        emit sessionRecovered(result.filePath, result.recoveredFrames, result.lostFrames);
+    }
+    return int(results.size());
+}
+
+void SessionRecorder::setTransport(SessionLog::Transport transport)
+{
+    m_transport.store(quint8(transport), std::memory_order_relaxed);
+}
+
+void SessionRecorder::setWriteOptions(BlockWriteQueue::Backend backend, bool direct, int queueDepth)
+{
+    m_backend = backend;
+    m_directIo = direct;
+    m_queueDepth = qMax(1, queueDepth);
+}
+
+void SessionRecorder::setDirectory(const QString &directory)
+{
+    if (m_directory != directory)
+    {
+        m_directory = directory;
+        emit directoryChanged();
+    }
+}
+
+void SessionRecorder::setSyncIntervalMs(int intervalMs)
+{
+    if (m_syncIntervalMs.exchange(intervalMs) != intervalMs)
+    {
+        // A shorter interval may already be due
+        QMutexLocker locker(&m_mutex);
+        m_blockFull.wakeOne();
+        locker.unlock();
+        emit syncPolicyChanged();
+    }
+}
+
+void SessionRecorder::setSyncBytes(qint64 bytes)
+{
+    if (m_syncBytes.exchange(bytes) != bytes)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_blockFull.wakeOne();
+        locker.unlock();
+        emit syncPolicyChanged();
+    }
+}
+
+void SessionRecorder::append(const TelemetryFrame &frame)
+{
+    if (!m_recording.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    const SessionLog::Transport transport = SessionLog::Transport(m_transport.load(std::memory_order_relaxed));
+
+    QMutexLocker locker(&m_mutex);
+    if (m_stopping)
+    {
+        return;
+    }
+
+    Block *block = &m_blocks[m_active];
+    if (block->header.recordCount == RecordsPerBlock && !swapBlocks())
+    {
+        // Every block waits for the disk, the sequence gap marks the loss in the log
+        ++m_nextSequence;
+        m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    block = &m_blocks[m_active];
+
+    // Parser threads can take the lock out of stamp order, readers binary-search the times
+    TelemetryFrame record = frame;
+    m_lastTimeUs = qMax(m_lastTimeUs, frame.timestampUs);
+    record.timestampUs = m_lastTimeUs;
+
+    SessionLog::BlockHeader &header = block->header;
+    if (header.recordCount == 0)
+    {
+        header.firstSequence = m_nextSequence;
+        header.firstTimeUs = record.timestampUs;
+    }
+    header.lastTimeUs = record.timestampUs;
+
+    // Columns are laid out for a full block while filling, the I/O thread closes the gaps of a partial one
+    SessionLog::writeRecord(block->data + block->start, RecordsPerBlock, header.recordCount, m_nextSequence++, transport, record);
+    ++header.recordCount;
+    m_recordedFrames.fetch_add(1, std::memory_order_relaxed);
+
+    if (header.recordCount == RecordsPerBlock)
+    {
+        swapBlocks();
+    }
+}
+
+bool SessionRecorder::swapBlocks()
+{
+    const int next = (m_active + 1) % int(m_blocks.size());
+    if (m_blocks[next].full)
+    {
+        return false;
+    }
+
+    m_blocks[m_active].full = true;
+    m_active = next;
+    m_blockFull.wakeOne();
+    return true;
+}
+
+void SessionRecorder::writeLoop()
+{
+    bool failed = false;
+    quint64 syncedBytes = 0;
+    quint64 unsyncedFrames = 0;
+    qint64 writeOffset = SessionLog::FileHeaderSize;
+    int submitIndex = 0; // Next block to hand to the queue, blocks are filled and written in ring order
+    int retireIndex = 0; // Oldest block handed to the queue, released in ring order so the index stays sorted
+    QList<BlockWriteQueue::Completion> completions;
+    QElapsedTimer sinceWrite;
+    QElapsedTimer sinceSync;
+    sinceWrite.start();
+    sinceSync.start();
+
+    // Runs without the mutex, the blocks in flight are not touched by the ingest threads
+    auto collect = [&](bool wait)
+    {
+        m_queue.complete(wait, completions);
+        for (const BlockWriteQueue::Completion &completion : std::as_const(completions))
+        {
+            Block &block = m_blocks[completion.buffer];
+            block.written = true;
+            block.failed = !completion.ok;
+            if (!completion.ok && !failed)
+            {
+                qDebug() << "SessionRecorder: Write failed" << m_queue.errorString();
+                emit errorOccurred(QStringLiteral("Cannot write session log %1: %2").arg(m_filePath, m_queue.errorString()));
+                failed = true;
+            }
+        }
+    };
+
+    QMutexLocker locker(&m_mutex);
+
+    while (true)
+    {
+        if (!m_pendingMarkers.isEmpty())
+        {
+            const QList<SessionIndex::Marker> markers = m_pendingMarkers;
+            m_pendingMarkers.clear();
+            locker.unlock();
+            for (const SessionIndex::Marker &marker : markers)
+            {
+                if (m_indexFile.isOpen())
+                {
+                    m_indexFile.write(SessionIndex::encode(marker));
+                }
+            }
+            locker.relock();
+            continue;
+        }
+
+        // Full blocks go to the queue while it has room, the ingest threads keep filling the next ones
+        Block &next = m_blocks[submitIndex];
+        if (next.full && !next.submitted && m_queue.inFlight() < m_queue.queueDepth())
+        {
+            locker.unlock();
+            next.submitted = true;
+            if (failed || !submitBlock(submitIndex, writeOffset))
+            {
+                // Released as dropped like a block whose write failed
+                next.written = true;
+                next.failed = true;
+                if (!failed)
+                {
+                    qDebug() << "SessionRecorder: Write failed" << m_queue.errorString();
+                    emit errorOccurred(QStringLiteral("Cannot write session log %1: %2").arg(m_filePath, m_queue.errorString()));
+                }
+                failed = true;
+            }
+            submitIndex = (submitIndex + 1) % int(m_blocks.size());
+            sinceWrite.restart();
+            collect(false);
+            locker.relock();
+            continue;
+        }
+
+        Block &oldest = m_blocks[retireIndex];
+        if (oldest.full && oldest.written)
+        {
+            locker.unlock();
+            if (oldest.failed)
+            {
+                m_droppedFrames.fetch_add(oldest.header.recordCount, std::memory_order_relaxed);
+            }
+            else
+            {
+                retireBlock(oldest);
+                unsyncedFrames += oldest.header.recordCount;
+            }
+            locker.relock();
+
+            // The buffer belongs to the queue and stays with its slot
+            uchar *data = oldest.data;
+            oldest = Block();
+            oldest.data = data;
+            retireIndex = (retireIndex + 1) % int(m_blocks.size());
+            continue;
+        }
+
+        const int intervalMs = m_syncIntervalMs.load(std::memory_order_relaxed);
+        const qint64 syncBytes = m_syncBytes.load(std::memory_order_relaxed);
+        const int writeAfterMs = intervalMs >= 0 ? intervalMs : IdleFlushMs;
+        const bool hasFrames = m_blocks[m_active].header.recordCount > 0;
+        const bool canSwap = !m_blocks[(m_active + 1) % int(m_blocks.size())].full;
+        if (hasFrames && canSwap && (m_stopping || sinceWrite.elapsed() >= writeAfterMs))
+        {
+            // Write the partial block, so no frame waits in memory longer than the sync interval
+            swapBlocks();
+            continue;
+        }
+
+        // Group commit, one sync covers every block written since the last one
+        const bool drained = !hasFrames && !m_blocks[retireIndex].full;
+        const qint64 unsyncedBytes = qint64(m_bytesWritten.load(std::memory_order_relaxed) - syncedBytes);
+        if (!failed && unsyncedBytes > 0
+            && ((m_stopping && drained) || (intervalMs >= 0 && sinceSync.elapsed() >= intervalMs) || (syncBytes > 0 && unsyncedBytes >= syncBytes)))
+        {
+            locker.unlock();
+            if (syncFiles())
+            {
+                syncedBytes += quint64(unsyncedBytes);
+                m_syncedFrames.fetch_add(unsyncedFrames, std::memory_order_relaxed);
+                m_syncCount.fetch_add(1, std::memory_order_relaxed);
+                unsyncedFrames = 0;
+            }
+            else
+            {
+                // The kernel may already have dropped the pages that failed, a retry could succeed without them
+                qDebug() << "SessionRecorder: Sync failed" << m_file.errorString();
+                emit errorOccurred(QStringLiteral("Cannot sync session log %1: %2").arg(m_filePath, m_file.errorString()));
+                failed = true;
+            }
+            sinceSync.restart();
+            locker.relock();
+            continue;
+        }
+
+        if (m_stopping && drained)
+        {
+            break;
+        }
+
+        if (m_queue.inFlight() > 0)
+        {
+            // The blocks in flight are released first, a block filling up meanwhile waits for that
+            locker.unlock();
+            collect(true);
+            locker.relock();
+            continue;
+        }
+
+        // Sleep until a write or a sync is due or a block fills up, a frame arriving meanwhile waits at most writeAfterMs
+        qint64 waitMs = hasFrames ? writeAfterMs - sinceWrite.elapsed() : writeAfterMs;
+        if (unsyncedBytes > 0 && intervalMs >= 0)
+        {
+            waitMs = qMin(waitMs, intervalMs - sinceSync.elapsed());
+        }
+        m_blockFull.wait(&m_mutex, QDeadlineTimer(qMax<qint64>(waitMs, 1)));
+    }
+    locker.unlock();
+
+    // Set only once every block is synced, a log left without the flag is repaired by recover()
+    if (!failed && (!SessionLog::markClosed(m_file) || !SessionLog::syncFile(m_file)))
+    {
+        qDebug() << "SessionRecorder: Cannot mark" << m_filePath << "closed" << m_file.errorString();
+    }
+}
+
+bool SessionRecorder::submitBlock(int index, qint64 &offset)
+{
+    Block &block = m_blocks[index];
+    uchar *data = block.data + block.start;
+
+    // Direct writes start and end on a page boundary, the zero padding is part of the block
+    quint32 padding = 0;
+    if (m_queue.isDirect())
+    {
+        const qint64 end = offset + SessionLog::columnOffset(SessionLog::ColumnCount, block.header.recordCount);
+        padding = quint32((BlockWriteQueue::Alignment - end % BlockWriteQueue::Alignment) % BlockWriteQueue::Alignment);
+    }
+
+    const quint32 size = SessionLog::finishBlock(data, RecordsPerBlock, block.header, padding);
+    block.offset = offset;
+    offset += size;
+    return m_queue.submit(index, block.data, block.start + size, block.offset - block.start);
+}
+
+void SessionRecorder::retireBlock(Block &block)
+{
+    m_bytesWritten.fetch_add(block.header.blockBytes, std::memory_order_relaxed);
+
+    // Indexed only once the block is written, an entry never points past the end of the log
+    if (m_indexFile.isOpen())
+    {
+        SessionIndex::Block entry;
+        entry.firstTimeUs = block.header.firstTimeUs;
+        entry.lastTimeUs = block.header.lastTimeUs;
+        entry.offset = block.offset;
+        entry.recordCount = block.header.recordCount;
+        entry.firstSequence = block.header.firstSequence;
+        entry.blockBytes = block.header.blockBytes;
+        m_indexFile.write(SessionIndex::encode(entry));
+    }
+}
+
+bool SessionRecorder::syncFiles()
+{
+    if (!SessionLog::syncFile(m_file))
+    {
+        return false;
+    }
+
+    // Not fatal, recovery and readers rebuild the block entries of the index from the log
+    if (m_indexFile.isOpen() && !SessionLog::syncFile(m_indexFile))
+    {
+        qDebug() << "SessionRecorder: Cannot sync index" << m_indexFile.fileName() << m_indexFile.errorString();
+    }
+    return true;
+}
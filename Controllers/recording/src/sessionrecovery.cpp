@@ -0,0 +1,154 @@
+#include "../include/sessionrecovery.h"
+#include "../include/sessionindex.h"
+#include "../include/sessionlogformat.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <limits>
+
+bool SessionRecovery::needsRecovery(const QString &logPath)
+{
+    QFile log(logPath);
+    if (!log.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    const QByteArray headerBytes = log.read(SessionLog::FileHeaderSize);
+    SessionLog::FileHeader header;
+    return headerBytes.size() == SessionLog::FileHeaderSize
+           && SessionLog::readFileHeader(reinterpret_cast<const uchar *>(headerBytes.constData()), header)
+           && header.version >= SessionLog::ChecksumVersion && !(header.flags & SessionLog::ClosedFlag);
+}
+
+bool SessionRecovery::recover(const QString &logPath, Result &result, QString *error)
+{
+    auto fail = [error](const QString &message)
+    {
+        if (error)
+        {
+            *error = message;
+        }
+        return false;
+    };
+
+    result = Result();
+    result.filePath = logPath;
+
+    QFile log(logPath);
+    if (!log.open(QIODevice::ReadWrite))
+    {
+        return fail(log.errorString());
+    }
+
+    const qint64 size = log.size();
+    SessionLog::FileHeader fileHeader;
+    QByteArray data = log.read(SessionLog::FileHeaderSize);
+    if (data.size() != SessionLog::FileHeaderSize
+        || !SessionLog::readFileHeader(reinterpret_cast<const uchar *>(data.constData()), fileHeader)
+        || fileHeader.version < SessionLog::ChecksumVersion)
+    {
+        return fail(QStringLiteral("Not a session log of version %1 or later").arg(SessionLog::ChecksumVersion));
+    }
+
+    // Markers are only stored in the index, the blocks are taken from the log itself
+    const QString indexPath = SessionIndex::indexPath(logPath);
+    SessionIndex previous;
+    previous.load(indexPath);
+    SessionIndex index;
+    for (const SessionIndex::Marker &marker : previous.markers())
+    {
+        index.appendMarker(marker);
+    }
+
+    qint64 offset = SessionLog::FileHeaderSize;
+    qint64 validEnd = offset;
+    bool valid = true;
+    while (offset + SessionLog::BlockHeaderSize <= size && log.seek(offset))
+    {
+        // The header is checked without bounding it by the file size, so a torn block still counts its frames
+        data = log.read(SessionLog::BlockHeaderSize);
+        SessionLog::BlockHeader header;
+        if (data.size() != SessionLog::BlockHeaderSize
+            || !SessionLog::readBlockHeader(reinterpret_cast<const uchar *>(data.constData()), std::numeric_limits<qint64>::max(), header))
+        {
+            break;
+        }
+
+        if (valid)
+        {
+            valid = offset + header.blockBytes <= size && log.seek(offset);
+            if (valid)
+            {
+                data = log.read(header.blockBytes);
+                valid = data.size() == qsizetype(header.blockBytes) && SessionLog::verifyBlock(reinterpret_cast<const uchar *>(data.constData()), header);
+            }
+        }
+
+        if (valid)
+        {
+            SessionIndex::Block block;
+            block.firstTimeUs = header.firstTimeUs;
+            block.lastTimeUs = header.lastTimeUs;
+            block.offset = offset;
+            block.recordCount = header.recordCount;
+            block.firstSequence = header.firstSequence;
+            block.blockBytes = header.blockBytes;
+            index.appendBlock(block);
+            result.recoveredFrames += header.recordCount;
+            validEnd = offset + header.blockBytes;
+        }
+        else
+        {
+            result.lostFrames += header.recordCount;
+        }
+        offset += header.blockBytes;
+    }
+
+    // The log is repaired before it is marked closed, a crash in between only repeats the recovery
+    result.discardedBytes = size - validEnd;
+    if ((result.discardedBytes > 0 && !log.resize(validEnd)) || !SessionLog::syncFile(log))
+    {
+        return fail(log.errorString());
+    }
+    if (!index.save(indexPath))
+    {
+        // Not fatal, readers rebuild a missing index from the log
+        qDebug() << "SessionRecovery: Cannot write index" << indexPath;
+    }
+    if (!SessionLog::markClosed(log) || !SessionLog::syncFile(log))
+    {
+        return fail(log.errorString());
+    }
+
+    qDebug() << "SessionRecovery: Recovered" << result.recoveredFrames << "frames of" << logPath << ","
+             << result.lostFrames << "lost," << result.discardedBytes << "bytes discarded";
+    return true;
+}
+
+QList<SessionRecovery::Result> SessionRecovery::recoverDirectory(const QString &directory, const QString &skipPath)
+{
+    QList<Result> results;
+    const QDir dir(directory);
+    const QStringList names = dir.entryList({QStringLiteral("*.tlog")}, QDir::Files, QDir::Name);
+    for (const QString &name : names)
+    {
+        const QString path = dir.filePath(name);
+        if (path == skipPath || !needsRecovery(path))
+        {
+            continue;
+        }
+
+        Result result;
+        QString error;
+        if (recover(path, result, &error))
+        {
+            results.append(result);
+        }
+        else
+        {
+            qDebug() << "SessionRecovery: Cannot recover" << path << error;
+        }
+    }
+    return results;
+}
@@ -0,0 +1,141 @@
+#ifndef REPLAYCLIENT_H
+#define REPLAYCLIENT_H
+
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+#include <functional>
+#include "../../export/include/exportprogress.h"
+#include "../../telemetry/include/telemetrystore.h"
+#include "../../telemetry/include/telemetrysourcestats.h"
+
+// Forward declarations
+class ReplayWorker;
+
+/**
+ * @brief The ReplayClient class is a telemetry source that plays back a recorded session
+ *
+ * It publishes frames exactly like the protocol clients, through its store and frameReceived(), so a
+ * replay drives history, recorder, feeds and gauges the same way live data does. Playback runs in a
+ * worker thread at the recorded timing, scaled by speed, or as fast as possible at speed 0.
+ *
+ * A packet capture or a CSV log is imported into a session log in a background thread first, with
+ * its progress in importProgress, and playback starts once the import finished. Lines a CSV import
+ * rejected are reported in importWarning.
+ */
+class ReplayClient : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool running READ isRunning NOTIFY runningChanged)
+    Q_PROPERTY(QString filePath READ filePath NOTIFY runningChanged)
+    Q_PROPERTY(bool playing READ isPlaying NOTIFY stateChanged)
+    Q_PROPERTY(bool finished READ isFinished NOTIFY stateChanged)
+    Q_PROPERTY(double speed READ speed WRITE setSpeed NOTIFY speedChanged)
+    Q_PROPERTY(qint64 positionMs READ positionMs NOTIFY positionChanged)
+    Q_PROPERTY(qint64 durationMs READ durationMs NOTIFY runningChanged)
+    Q_PROPERTY(int lapCount READ lapCount NOTIFY runningChanged)
+    Q_PROPERTY(bool importing READ isImporting NOTIFY importingChanged)
+    Q_PROPERTY(double importProgress READ importProgress NOTIFY importProgressChanged)
+    Q_PROPERTY(QString importWarning READ importWarning NOTIFY importingChanged)
+
+public:
+    explicit ReplayClient(QObject *parent = nullptr);
+    ~ReplayClient();
+
+    /**
+     * @brief Open a session log, a packet capture or a CSV log and start playing it
+     *
+     * A capture or CSV log is imported in the background, playback starts when the import finished and a
+     * failed import is reported through errorOccurred().
+     * @param path The .tlog, .pcap, .pcapng or .csv file
+     * @param speed Factor on the recorded timing, 0 replays as fast as possible
+     * @param capturePort UDP port of the telemetry in a capture, 0 for the busiest port
+     * @return True if the file could be opened or its import started
+     */
+    Q_INVOKABLE bool start(const QString &path, double speed = 1.0, quint16 capturePort = 0);
+
+    /**
+     * @brief Stop playback, or cancel a running import
+     */
+    Q_INVOKABLE bool stop();
+
+    Q_INVOKABLE void pause();
+    Q_INVOKABLE void resume();
+    Q_INVOKABLE void step();
+    Q_INVOKABLE void seek(qint64 positionMs);
+    Q_INVOKABLE void seekToLap(int lap);
+
+    bool isRunning() const { return m_running; }
+    QString filePath() const { return m_filePath; }
+    bool isPlaying() const { return m_playing; }
+    bool isFinished() const { return m_finished; }
+    qint64 positionMs() const { return m_positionUs / 1000; }
+    qint64 durationMs() const { return m_durationUs / 1000; }
+    int lapCount() const { return m_lapCount; }
+    bool isImporting() const { return m_importThread != nullptr; }
+    double importProgress() const;
+    QString importWarning() const { return m_importWarning; } // Rejected lines of the last import, empty if there were none.
+
+    double speed() const { return m_speed; }
+    void setSpeed(double speed);
+
+    // Latest replayed frame, snapshots can be taken from any thread
+    const TelemetryStore &telemetryStore() const { return m_store; }
+
+    // Pipeline counters for the performance overlay, call from the GUI thread
+    TelemetrySourceStats stats();
+
+signals:
+    // Emitted from the worker thread for every replayed frame, receivers must be thread-safe
+    void frameReceived(const TelemetryFrame &frame);
+
+    void runningChanged();
+    void stateChanged();
+    void speedChanged();
+    void positionChanged();
+    void importingChanged();
+    void importProgressChanged();
+    void errorOccurred(const QString &error);
+
+private slots:
+    void handleFrame(const TelemetryFrame &frame); // Runs in the worker thread, stores the frame and forwards it.
+    void handleStateChanged(bool playing, bool finished);
+    void handlePositionChanged(qint64 positionUs);
+
+private:
+    using Import = std::function<QString(ExportProgress &progress, QString *warning, QString *error)>; // Returns the log to open.
+
+    bool open(const QString &path, const QString &logPath, double speed);
+    void startImport(const QString &path, double speed, const Import &import);
+    void handleImportFinished(quint64 generation, const QString &logPath, const QString &warning, const QString &error);
+    void cancelImport();
+
+    QThread m_workerThread;
+    ReplayWorker *m_worker;
+
+    bool m_running;
+    bool m_playing;
+    bool m_finished;
+    double m_speed;
+    qint64 m_positionUs;
+    qint64 m_durationUs;
+    int m_lapCount;
+    QString m_filePath;
+
+    // Import of the file to replay, m_importGeneration tells a finished import from one stopped meanwhile
+    QThread *m_importThread;
+    QTimer m_importTimer;
+    ExportProgress m_importProgress;
+    quint64 m_importGeneration;
+    QString m_importPath;
+    double m_importSpeed;
+    QString m_importWarning;
+
+    std::atomic<quint64> m_framesReplayed;
+    TelemetryStore m_store;
+};
+
+#endif // REPLAYCLIENT_H
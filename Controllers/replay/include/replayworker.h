@@ -0,0 +1,86 @@
+#ifndef REPLAYWORKER_H
+#define REPLAYWORKER_H
+
+#include <QObject>
+#include <QTimer>
+#include <atomic>
+#include "../../recording/include/sessionreader.h"
+
+/**
+ * @brief The ReplayWorker class plays a session log back in its own thread
+ *
+ * Frames are paced by their recorded receive times, scaled by the speed, against the telemetry clock.
+ * At speed 0 they are emitted as fast as the pipeline takes them, in batches that still let pause,
+ * step and seek through between two batches.
+ */
+class ReplayWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ReplayWorker(QObject *parent = nullptr);
+
+    /**
+     * @brief Open a session log, playback starts with play()
+     *
+     * Packet captures and CSV logs are imported into session logs by ReplayClient before they get here.
+     * @return False if the file is not a readable session log or holds no telemetry
+     */
+    bool open(const QString &path, QString *error);
+
+    qint64 durationUs() const { return m_durationUs; }
+    int lapCount() const { return m_reader.index().lapCount(); }
+    quint64 framesReplayed() const { return m_framesReplayed.load(std::memory_order_relaxed); }
+
+public slots:
+    void initialize();
+    void close();
+
+    void play();
+    void pause();
+    void step();                     // Emits the next frame, only while paused.
+    void seek(qint64 positionUs);    // Relative to the first frame of the session.
+    void seekToLap(int lap);         // Laps are numbered from 1 as marked while recording.
+    void setSpeed(double speed);     // Factor on the recorded timing, 0 replays as fast as possible.
+
+signals:
+    /**
+     * @brief Emitted on the worker thread for every replayed frame, stamped with the current time
+     */
+    void frameParsed(const TelemetryFrame &frame);
+
+    void positionChanged(qint64 positionUs);
+    void stateChanged(bool playing, bool finished);
+    void errorOccurred(const QString &error);
+
+private slots:
+    void tick();
+
+private:
+    bool atEnd() const { return m_chunk >= m_reader.chunks().size(); }
+    qint64 recordTimeUs() const; // Receive time of the next frame, atEnd() must be false.
+    void emitNext();
+    void anchor();
+    void schedule();
+    void reportPosition(bool force);
+
+    SessionReader m_reader;
+    QTimer *m_timer;
+
+    // Cursor on the next frame to emit
+    qsizetype m_chunk;
+    quint32 m_index;
+
+    bool m_playing;
+    double m_speed;
+    qint64 m_durationUs;
+
+    // A frame recorded at m_recordAnchorUs is due at m_clockAnchorUs, later frames follow at m_speed
+    qint64 m_clockAnchorUs;
+    qint64 m_recordAnchorUs;
+    qint64 m_lastReportUs;
+
+    std::atomic<quint64> m_framesReplayed;
+};
+
+#endif // REPLAYWORKER_H
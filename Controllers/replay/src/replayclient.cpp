@@ -0,0 +1,318 @@
+#include "../include/replayclient.h"
+#include "../include/replayworker.h"
+#include "../../capture/include/captureimporter.h"
+#include "../../capture/include/csvimporter.h"
+#include "../../capture/include/pcapreader.h"
+#include <QDebug>
+
+namespace
+{
+// Interval at which the import progress is published to QML
+constexpr int ImportProgressIntervalMs = 100;
+}
+
+ReplayClient::ReplayClient(QObject *parent)
+    : QObject(parent),
+    m_running(false),
+    m_playing(false),
+    m_finished(false),
+    m_speed(1.0),
+    m_positionUs(0),
+    m_durationUs(0),
+    m_lapCount(0),
+    m_importThread(nullptr),
+    m_importGeneration(0),
+    m_importSpeed(1.0),
+    m_framesReplayed(0)
+{
+    m_importTimer.setInterval(ImportProgressIntervalMs);
+    connect(&m_importTimer, &QTimer::timeout, this, &ReplayClient::importProgressChanged);
+
+    // Create and configure the worker
+    m_worker = new ReplayWorker();
+    m_worker->moveToThread(&m_workerThread);
+
+    connect(m_worker, &ReplayWorker::frameParsed, this, &ReplayClient::handleFrame, Qt::DirectConnection);
+    connect(m_worker, &ReplayWorker::stateChanged, this, &ReplayClient::handleStateChanged, Qt::QueuedConnection);
+    connect(m_worker, &ReplayWorker::positionChanged, this, &ReplayClient::handlePositionChanged, Qt::QueuedConnection);
+    connect(m_worker, &ReplayWorker::errorOccurred, this, &ReplayClient::errorOccurred, Qt::QueuedConnection);
+
+    // Connect thread start/stop signals
+    connect(&m_workerThread, &QThread::started, m_worker, &ReplayWorker::initialize);
+    connect(&m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
+
+    m_workerThread.setObjectName("Replay Thread");
+    m_workerThread.start();
+}
+
+ReplayClient::~ReplayClient()
+{
+    stop();
+
+    m_workerThread.quit();
+    m_workerThread.wait();
+}
+
+bool ReplayClient::start(const QString &path, double speed, quint16 capturePort)
+{
+    stop();
+    if (!m_importWarning.isEmpty())
+    {
+        m_importWarning.clear();
+        emit importingChanged();
+    }
+
+    if (PcapReader::isCapture(path))
+    {
+        startImport(path, speed, [path, capturePort](ExportProgress &progress, QString *, QString *error)
+        {
+            return CaptureImporter::cachedImport(path, capturePort, error, &progress);
+        });
+        return true;
+    }
+    if (path.endsWith(QStringLiteral(".csv"), Qt::CaseInsensitive))
+    {
+        startImport(path, speed, [path](ExportProgress &progress, QString *warning, QString *error)
+        {
+            CsvImporter::Result result;
+            const QString logPath = CsvImporter::cachedImport(path, error, &result, &progress);
+            for (const CsvImporter::Chunk &chunk : std::as_const(result.chunks))
+            {
+                if (chunk.rejected > 0)
+                {
+                    *warning = QStringLiteral("%1 of %2 lines rejected, first at line %3: %4")
+                                   .arg(result.rejected).arg(result.lines).arg(chunk.firstBadLine).arg(chunk.firstError);
+                    break;
+                }
+            }
+            return logPath;
+        });
+        return true;
+    }
+    return open(path, path, speed);
+}
+
+bool ReplayClient::stop()
+{
+    if (m_importThread)
+    {
+        cancelImport();
+        return true;
+    }
+    if (!m_running)
+    {
+        return false;
+    }
+
+    // Blocking, no frame is emitted once this returns
+    QMetaObject::invokeMethod(m_worker, &ReplayWorker::close, Qt::BlockingQueuedConnection);
+
+    m_running = false;
+    m_playing = false;
+    m_finished = false;
+    m_filePath.clear();
+    m_durationUs = 0;
+    m_lapCount = 0;
+    m_positionUs = 0;
+    emit stateChanged();
+    emit positionChanged();
+    emit runningChanged();
+    return true;
+}
+
+bool ReplayClient::open(const QString &path, const QString &logPath, double speed)
+{
+    // Opening an indexed log only maps it, so the GUI thread can wait for it
+    bool opened = false;
+    QString error;
+    qint64 durationUs = 0;
+    int lapCount = 0;
+    QMetaObject::invokeMethod(m_worker, [&]()
+    {
+        opened = m_worker->open(logPath, &error);
+        durationUs = m_worker->durationUs();
+        lapCount = m_worker->lapCount();
+    }, Qt::BlockingQueuedConnection);
+
+    if (!opened)
+    {
+        qDebug() << "ReplayClient: Cannot replay" << path << error;
+        emit errorOccurred(QStringLiteral("Cannot replay %1: %2").arg(path, error));
+        return false;
+    }
+
+    m_running = true;
+    m_finished = false;
+    m_filePath = path;
+    m_durationUs = durationUs;
+    m_lapCount = lapCount;
+    m_positionUs = 0;
+    m_framesReplayed.store(0);
+    emit runningChanged();
+    emit positionChanged();
+
+    setSpeed(speed);
+    resume();
+    return true;
+}
+
+void ReplayClient::startImport(const QString &path, double speed, const Import &import)
+{
+    m_importProgress.total.store(0);
+    m_importProgress.done.store(0);
+    m_importProgress.cancelled.store(false);
+    m_importPath = path;
+    m_importSpeed = speed;
+
+    const quint64 generation = ++m_importGeneration;
+    m_importThread = QThread::create([this, import, generation]()
+    {
+        QString warning;
+        QString error;
+        const QString logPath = import(m_importProgress, &warning, &error);
+        QMetaObject::invokeMethod(this, [this, generation, logPath, warning, error]()
+        {
+            handleImportFinished(generation, logPath, warning, error);
+        }, Qt::QueuedConnection);
+    });
+    m_importThread->setObjectName(QStringLiteral("Replay Import"));
+    m_importThread->start();
+    m_importTimer.start();
+
+    qDebug() << "ReplayClient: Importing" << path;
+    emit importingChanged();
+    emit importProgressChanged();
+}
+
+void ReplayClient::handleImportFinished(quint64 generation, const QString &logPath, const QString &warning, const QString &error)
+{
+    // The import was cancelled by stop() in the meantime
+    if (!m_importThread || generation != m_importGeneration)
+    {
+        return;
+    }
+
+    m_importThread->wait();
+    delete m_importThread;
+    m_importThread = nullptr;
+    m_importTimer.stop();
+    m_importWarning = warning;
+    emit importProgressChanged();
+    emit importingChanged();
+
+    if (!warning.isEmpty())
+    {
+        qDebug() << "ReplayClient: Import of" << m_importPath << ":" << warning;
+    }
+    if (logPath.isEmpty())
+    {
+        qDebug() << "ReplayClient: Cannot import" << m_importPath << error;
+        emit errorOccurred(QStringLiteral("Cannot replay %1: %2").arg(m_importPath, error));
+        return;
+    }
+    open(m_importPath, logPath, m_importSpeed);
+}
+
+void ReplayClient::cancelImport()
+{
+    // The importers check between two batches, so this only waits for the batches in progress
+    m_importProgress.cancelled.store(true);
+    m_importThread->wait();
+    delete m_importThread;
+    m_importThread = nullptr;
+    m_importTimer.stop();
+    qDebug() << "ReplayClient: Import of" << m_importPath << "cancelled";
+    emit importProgressChanged();
+    emit importingChanged();
+}
+
+double ReplayClient::importProgress() const
+{
+    const qint64 total = m_importProgress.total.load(std::memory_order_relaxed);
+    return total > 0 ? double(m_importProgress.done.load(std::memory_order_relaxed)) / double(total) : 0.0;
+}
+
+void ReplayClient::pause()
+{
+    QMetaObject::invokeMethod(m_worker, &ReplayWorker::pause, Qt::QueuedConnection);
+}
+
+void ReplayClient::resume()
+{
+    QMetaObject::invokeMethod(m_worker, &ReplayWorker::play, Qt::QueuedConnection);
+}
+
+void ReplayClient::step()
+{
+    QMetaObject::invokeMethod(m_worker, &ReplayWorker::step, Qt::QueuedConnection);
+}
+
+void ReplayClient::seek(qint64 positionMs)
+{
+    const qint64 positionUs = positionMs * 1000;
+    QMetaObject::invokeMethod(m_worker, [this, positionUs]() { m_worker->seek(positionUs); }, Qt::QueuedConnection);
+}
+
+void ReplayClient::seekToLap(int lap)
+{
+    QMetaObject::invokeMethod(m_worker, [this, lap]() { m_worker->seekToLap(lap); }, Qt::QueuedConnection);
+}
+
+void ReplayClient::setSpeed(double speed)
+{
+    speed = qMax(0.0, speed);
+    QMetaObject::invokeMethod(m_worker, [this, speed]() { m_worker->setSpeed(speed); }, Qt::QueuedConnection);
+
+    if (!qFuzzyCompare(m_speed + 1.0, speed + 1.0))
+    {
+        m_speed = speed;
+        emit speedChanged();
+    }
+}
+
+void ReplayClient::handleFrame(const TelemetryFrame &frame)
+{
+    m_framesReplayed.fetch_add(1, std::memory_order_relaxed);
+
+    // Publish the new frame, readers only need the latest state
+    m_store.write(frame);
+
+    // Forward the complete frame in one step
+    emit frameReceived(frame);
+}
+
+void ReplayClient::handleStateChanged(bool playing, bool finished)
+{
+    // Late updates of a replay that was stopped in the meantime
+    if (!m_running)
+    {
+        return;
+    }
+
+    if (m_playing != playing || m_finished != finished)
+    {
+        m_playing = playing;
+        m_finished = finished;
+        emit stateChanged();
+    }
+}
+
+void ReplayClient::handlePositionChanged(qint64 positionUs)
+{
+    if (!m_running || m_positionUs == positionUs)
+    {
+        return;
+    }
+
+    m_positionUs = positionUs;
+    emit positionChanged();
+}
+
+TelemetrySourceStats ReplayClient::stats()
+{
+    // Frames come out of the file already decoded, nothing is queued or rejected
+    TelemetrySourceStats stats;
+    stats.received = m_framesReplayed.load(std::memory_order_relaxed);
+    stats.parsed = stats.received;
+    return stats;
+}
@@ -0,0 +1,273 @@
+#include "../include/replayworker.h"
+#include <QDebug>
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+// Frames per pass at maximum speed, small enough that pause and seek are handled within a few milliseconds
+constexpr int MaxSpeedBatch = 4096;
+
+// Frames per pass when paced, bounds the burst after the event loop was held up
+constexpr int PacedBatch = 1024;
+
+// Interval at which the position is reported during playback
+constexpr qint64 ReportIntervalUs = 100000;
+}
+
+ReplayWorker::ReplayWorker(QObject *parent)
+    : QObject(parent),
+    m_timer(nullptr),
+    m_chunk(0),
+    m_index(0),
+    m_playing(false),
+    m_speed(1.0),
+    m_durationUs(0),
+    m_clockAnchorUs(0),
+    m_recordAnchorUs(0),
+    m_lastReportUs(0),
+    m_framesReplayed(0)
+{
+}
+
+void ReplayWorker::initialize()
+{
+    // Created here so the timer lives in the worker thread
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &ReplayWorker::tick);
+}
+
+bool ReplayWorker::open(const QString &path, QString *error)
+{
+    close();
+
+    if (!m_reader.open(path, error))
+    {
+        return false;
+    }
+    if (m_reader.frameCount() == 0)
+    {
+        m_reader.close();
+        if (error)
+        {
+            *error = QStringLiteral("%1 contains no frames").arg(path);
+        }
+        return false;
+    }
+
+    m_durationUs = m_reader.lastTimeUs() - m_reader.firstTimeUs();
+    m_framesReplayed.store(0);
+    qDebug() << "ReplayWorker: Opened" << path << "with" << m_reader.frameCount() << "frames";
+
+    emit stateChanged(false, false);
+    emit positionChanged(0);
+    return true;
+}
+
+void ReplayWorker::close()
+{
+    if (m_timer)
+    {
+        m_timer->stop();
+    }
+    m_reader.close();
+    m_chunk = 0;
+    m_index = 0;
+    m_playing = false;
+    m_durationUs = 0;
+}
+
+void ReplayWorker::play()
+{
+    if (m_playing || !m_reader.isOpen() || atEnd())
+    {
+        return;
+    }
+
+    m_playing = true;
+    anchor();
+    emit stateChanged(true, false);
+    schedule();
+}
+
+void ReplayWorker::pause()
+{
+    if (!m_playing)
+    {
+        return;
+    }
+
+    m_playing = false;
+    m_timer->stop();
+    reportPosition(true);
+    emit stateChanged(false, false);
+}
+
+void ReplayWorker::step()
+{
+    if (m_playing || !m_reader.isOpen() || atEnd())
+    {
+        return;
+    }
+
+    emitNext();
+    reportPosition(true);
+    if (atEnd())
+    {
+        emit stateChanged(false, true);
+    }
+}
+
+void ReplayWorker::seek(qint64 positionUs)
+{
+    if (!m_reader.isOpen())
+    {
+        return;
+    }
+
+    // Binary search over the block time ranges, then within the block
+    const qint64 target = m_reader.firstTimeUs() + qBound<qint64>(0, positionUs, m_durationUs);
+    m_chunk = m_reader.chunkAt(target);
+    m_index = 0;
+    if (!atEnd())
+    {
+        const QSpan<const qint64> times = m_reader.timestamps(m_chunk);
+        m_index = quint32(std::lower_bound(times.begin(), times.end(), target) - times.begin());
+        if (qsizetype(m_index) >= times.size())
+        {
+            ++m_chunk;
+            m_index = 0;
+        }
+    }
+
+    anchor();
+    reportPosition(true);
+    emit stateChanged(m_playing, false);
+    if (m_playing)
+    {
+        schedule();
+    }
+}
+
+void ReplayWorker::seekToLap(int lap)
+{
+    const qint64 startUs = m_reader.index().lapStartUs(lap);
+    if (startUs < 0)
+    {
+        emit errorOccurred(QStringLiteral("The session has no lap %1").arg(lap));
+        return;
+    }
+    seek(startUs - m_reader.firstTimeUs());
+}
+
+void ReplayWorker::setSpeed(double speed)
+{
+    m_speed = qMax(0.0, speed);
+    anchor();
+    if (m_playing)
+    {
+        schedule();
+    }
+}
+
+void ReplayWorker::tick()
+{
+    if (!m_playing)
+    {
+        return;
+    }
+
+    if (m_speed <= 0.0)
+    {
+        for (int i = 0; i < MaxSpeedBatch && !atEnd(); ++i)
+        {
+            emitNext();
+        }
+    }
+    else
+    {
+        const qint64 nowUs = telemetryTimestampUs();
+        for (int i = 0; i < PacedBatch && !atEnd(); ++i)
+        {
+            const qint64 dueUs = m_clockAnchorUs + qint64(double(recordTimeUs() - m_recordAnchorUs) / m_speed);
+            if (dueUs > nowUs)
+            {
+                break;
+            }
+            emitNext();
+        }
+    }
+
+    if (atEnd())
+    {
+        m_playing = false;
+        reportPosition(true);
+        qDebug() << "ReplayWorker: Finished after" << framesReplayed() << "frames";
+        emit stateChanged(false, true);
+        return;
+    }
+
+    reportPosition(false);
+    schedule();
+}
+
+qint64 ReplayWorker::recordTimeUs() const
+{
+    return m_reader.timestamps(m_chunk)[m_index];
+}
+
+void ReplayWorker::emitNext()
+{
+    SessionLog::Record record;
+    m_reader.readRecord(m_chunk, m_index, record);
+
+    // Stamped on the live clock like a parsed frame, so history and charts treat it as new data
+    record.frame.timestampUs = telemetryTimestampUs();
+    m_framesReplayed.fetch_add(1, std::memory_order_relaxed);
+    emit frameParsed(record.frame);
+
+    if (++m_index >= m_reader.chunks().at(m_chunk).header.recordCount)
+    {
+        ++m_chunk;
+        m_index = 0;
+    }
+}
+
+void ReplayWorker::anchor()
+{
+    m_clockAnchorUs = telemetryTimestampUs();
+    m_recordAnchorUs = atEnd() ? 0 : recordTimeUs();
+}
+
+void ReplayWorker::schedule()
+{
+    if (atEnd())
+    {
+        return;
+    }
+
+    if (m_speed <= 0.0)
+    {
+        m_timer->start(0);
+        return;
+    }
+
+    // Rounded up, waking early would only spin until the frame is due
+    const qint64 dueUs = m_clockAnchorUs + qint64(double(recordTimeUs() - m_recordAnchorUs) / m_speed);
+    const qint64 delayUs = qMax<qint64>(0, dueUs - telemetryTimestampUs());
+    m_timer->start(int(qMin<qint64>((delayUs + 999) / 1000, std::numeric_limits<int>::max())));
+}
+
+void ReplayWorker::reportPosition(bool force)
+{
+    const qint64 nowUs = telemetryTimestampUs();
+    if (!force && nowUs - m_lastReportUs < ReportIntervalUs)
+    {
+        return;
+    }
+
+    m_lastReportUs = nowUs;
+    emit positionChanged(atEnd() ? m_durationUs : recordTimeUs() - m_reader.firstTimeUs());
+}
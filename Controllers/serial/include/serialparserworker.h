@@ -3,10 +3,13 @@
 
 #include <QObject>
 #include <QByteArray>
+#include <QByteArrayView>
 #include <QQueue>
 #include <QMutex>
 #include <QWaitCondition>
 #include <QRunnable>
+#include <atomic>
+#include "../../telemetry/include/telemetryframe.h"
 
 /**
  * @brief The SerialParserWorker class parses raw serial data in a separate thread.
@@ -21,15 +24,24 @@ public:
     void queueData(const QByteArray &data);
     void stop();
 
+    qsizetype queueDepth(); // Chunks waiting to be parsed.
+    quint64 rejected() const { return m_rejected.load(std::memory_order_relaxed); } // Chunks that produced no frame.
+
+    /**
+     * @brief Decode one line of the 15-field MCU format, shared by the live source and the CSV importer
+     *
+     * The fields are parsed in place without allocating, so the function is safe and cheap to call from
+     * many threads at once. The timestamp of the frame is left to the caller.
+     * @param error Set to a description if the line is malformed
+     * @return False if the line does not hold 15 valid fields
+     */
+    static bool parseLine(QByteArrayView line, TelemetryFrame &frame, QString *error = nullptr);
+
 protected:
     void run() override;
 
 signals:
-    void dataParsed(float speed, int rpm, int accPedal, int brakePedal,
-                    double encoderAngle, float temperature, int batteryLevel,
-                    double gpsLongitude, double gpsLatitude,
-                    int speedFL, int speedFR, int speedBL, int speedBR,
-                    double lateralG, double longitudinalG);
+    void dataParsed(const TelemetryFrame &frame);
     void errorOccurred(const QString &error);
 
 private:
@@ -38,8 +50,9 @@ private:
     QWaitCondition m_waitCondition;
     bool m_running;
     bool m_debugMode;
+    std::atomic<quint64> m_rejected;
 
-    void parseData(const QByteArray &data);
+    bool parseData(const QByteArray &data); // Returns true if the data produced a frame.
 };
 
 #endif // SERIALPARSERWORKER_H
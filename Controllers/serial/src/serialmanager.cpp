@@ -10,23 +10,9 @@ SerialManager::SerialManager(QObject *parent)
     m_nextParserIndex(0),
     m_parserThreadCount(QThread::idealThreadCount()),
     m_debugMode(true),
+    m_datagramsReceived(0),
     m_datagramsProcessed(0),
-    m_datagramsDropped(0),
-    m_speed(0.0f),
-    m_rpm(0),
-    m_accPedal(0),
-    m_brakePedal(0),
-    m_encoderAngle(0.0),
-    m_temperature(0.0f),
-    m_batteryLevel(0),
-    m_gpsLongitude(0.0),
-    m_gpsLatitude(0.0),
-    m_speedFL(0),
-    m_speedFR(0),
-    m_speedBL(0),
-    m_speedBR(0),
-    m_lateralG(0.0),
-    m_longitudinalG(0.0)
+    m_datagramsDropped(0)
 {
     // Create and configure the receiver worker
     m_receiverWorker = new SerialReceiverWorker();
@@ -131,6 +117,8 @@ void SerialManager::setDebugMode(bool enabled)
 
 void SerialManager::handleSerialDataReceived(const QByteArray &data)
 {
+    m_datagramsReceived.fetch_add(1, std::memory_order_relaxed);
+
     // Distribute data among parsers in a round-robin fashion
     if (!m_parsers.isEmpty())
     {
@@ -143,136 +131,36 @@ void SerialManager::handleSerialDataReceived(const QByteArray &data)
         // Update the next parser index
         m_nextParserIndex = (m_nextParserIndex + 1) % m_parsers.size();
     }
+    else
+    {
+        m_datagramsDropped.fetch_add(1, std::memory_order_relaxed);
+    }
 }
 
-void SerialManager::handleParsedData(float speed, int rpm, int accPedal, int brakePedal,
-                                     double encoderAngle, float temperature, int batteryLevel,
-                                     double gpsLongitude, double gpsLatitude,
-                                     int speedFL, int speedFR, int speedBL, int speedBR,
-                                     double lateralG, double longitudinalG)
+void SerialManager::handleParsedData(const TelemetryFrame &frame)
 {
     // Increment processed count
     m_datagramsProcessed.fetch_add(1);
 
-    // Update speed if changed
-    float oldSpeed = m_speed.load(std::memory_order_relaxed);
-    if (!qFuzzyCompare(oldSpeed, speed))
-    {
-        m_speed.store(speed, std::memory_order_relaxed);
-        emit speedChanged(speed);
-    }
-
-    // Update rpm if changed
-    int oldRpm = m_rpm.load(std::memory_order_relaxed);
-    if (oldRpm != rpm)
-    {
-        m_rpm.store(rpm, std::memory_order_relaxed);
-        emit rpmChanged(rpm);
-    }
-
-    // Update accPedal if changed
-    int oldAccPedal = m_accPedal.load(std::memory_order_relaxed);
-    if (oldAccPedal != accPedal)
-    {
-        m_accPedal.store(accPedal, std::memory_order_relaxed);
-        emit accPedalChanged(accPedal);
-    }
-
-    // Update brakePedal if changed
-    int oldBrakePedal = m_brakePedal.load(std::memory_order_relaxed);
-    if (oldBrakePedal != brakePedal)
-    {
-        m_brakePedal.store(brakePedal, std::memory_order_relaxed);
-        emit brakePedalChanged(brakePedal);
-    }
-
-    // Update encoderAngle if changed
-    double oldEncoderAngle = m_encoderAngle.load(std::memory_order_relaxed);
-    if (!qFuzzyCompare(oldEncoderAngle, encoderAngle))
-    {
-        m_encoderAngle.store(encoderAngle, std::memory_order_relaxed);
-        emit encoderAngleChanged(encoderAngle);
-    }
-
-    // Update temperature if changed
-    float oldTemperature = m_temperature.load(std::memory_order_relaxed);
-    if (!qFuzzyCompare(oldTemperature, temperature))
-    {
-        m_temperature.store(temperature, std::memory_order_relaxed);
-        emit temperatureChanged(temperature);
-    }
-
-    // Update batteryLevel if changed
-    int oldBatteryLevel = m_batteryLevel.load(std::memory_order_relaxed);
-    if (oldBatteryLevel != batteryLevel)
-    {
-        m_batteryLevel.store(batteryLevel, std::memory_order_relaxed);
-        emit batteryLevelChanged(batteryLevel);
-    }
+    // Publish the new frame, readers only need the latest state
+    m_store.write(frame);
 
-    // Update gpsLongitude if changed
-    double oldGpsLongitude = m_gpsLongitude.load(std::memory_order_relaxed);
-    if (!qFuzzyCompare(oldGpsLongitude, gpsLongitude))
-    {
-        m_gpsLongitude.store(gpsLongitude, std::memory_order_relaxed);
-        emit gpsLongitudeChanged(gpsLongitude);
-    }
-
-    // Update gpsLatitude if changed
-    double oldGpsLatitude = m_gpsLatitude.load(std::memory_order_relaxed);
-    if (!qFuzzyCompare(oldGpsLatitude, gpsLatitude))
-    {
-        m_gpsLatitude.store(gpsLatitude, std::memory_order_relaxed);
-        emit gpsLatitudeChanged(gpsLatitude);
-    }
-
-    // Update speedFL if changed
-    int oldSpeedFL = m_speedFL.load(std::memory_order_relaxed);
-    if (oldSpeedFL != speedFL)
-    {
-        m_speedFL.store(speedFL, std::memory_order_relaxed);
-        emit speedFLChanged(speedFL);
-    }
-
-    // Update speedFR if changed
-    int oldSpeedFR = m_speedFR.load(std::memory_order_relaxed);
-    if (oldSpeedFR != speedFR)
-    {
-        m_speedFR.store(speedFR, std::memory_order_relaxed);
-        emit speedFRChanged(speedFR);
-    }
-
-    // Update speedBL if changed
-    int oldSpeedBL = m_speedBL.load(std::memory_order_relaxed);
-    if (oldSpeedBL != speedBL)
-    {
-        m_speedBL.store(speedBL, std::memory_order_relaxed);
-        emit speedBLChanged(speedBL);
-    }
-
-    // Update speedBR if changed
-    int oldSpeedBR = m_speedBR.load(std::memory_order_relaxed);
-    if (oldSpeedBR != speedBR)
-    {
-        m_speedBR.store(speedBR, std::memory_order_relaxed);
-        emit speedBRChanged(speedBR);
-    }
-
-    // Update lateralG if changed
-    double oldLateralG = m_lateralG.load(std::memory_order_relaxed);
-    if (!qFuzzyCompare(oldLateralG, lateralG))
-    {
-        m_lateralG.store(lateralG, std::memory_order_relaxed);
-        emit lateralGChanged(lateralG);
-    }
+    // Forward the complete frame in one step
+    emit frameReceived(frame);
+}
 
-    // Update longitudinalG if changed
-    double oldLongitudinalG = m_longitudinalG.load(std::memory_order_relaxed);
-    if (!qFuzzyCompare(oldLongitudinalG, longitudinalG))
+TelemetrySourceStats SerialManager::stats()
+{
+    TelemetrySourceStats stats;
+    stats.received = quint64(m_datagramsReceived.load(std::memory_order_relaxed));
+    stats.parsed = quint64(m_datagramsProcessed.load(std::memory_order_relaxed));
+    stats.dropped = quint64(m_datagramsDropped.load(std::memory_order_relaxed));
+    for (auto *parser : m_parsers)
     {
-        m_longitudinalG.store(longitudinalG, std::memory_order_relaxed);
-        emit longitudinalGChanged(longitudinalG);
+        stats.dropped += parser->rejected();
+        stats.queued += parser->queueDepth();
     }
+    return stats;
 }
 
 void SerialManager::handleError(const QString &error)
@@ -293,7 +181,7 @@ void SerialManager::initializeParsers()
         SerialParserWorker *parser = new SerialParserWorker(m_debugMode);
 
         // Connect signals for results
-        connect(parser, &SerialParserWorker::dataParsed, this, &SerialManager::handleParsedData, Qt::QueuedConnection);
+        connect(parser, &SerialParserWorker::dataParsed, this, &SerialManager::handleParsedData, Qt::DirectConnection);
         connect(parser, &SerialParserWorker::errorOccurred, this, &SerialManager::handleError, Qt::QueuedConnection);
 
         // Add to list
@@ -6,7 +6,8 @@
 SerialParserWorker::SerialParserWorker(bool debugMode, QObject *parent)
     : QObject(parent),
     m_running(true),
-    m_debugMode(debugMode)
+    m_debugMode(debugMode),
+    m_rejected(0)
 {
     setAutoDelete(true);
 
@@ -24,6 +25,12 @@ void SerialParserWorker::queueData(const QByteArray &data)
     m_waitCondition.wakeOne();
 }
 
+qsizetype SerialParserWorker::queueDepth()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_dataQueue.size();
+}
+
 void SerialParserWorker::stop()
 {
     QMutexLocker locker(&m_mutex);
@@ -52,9 +59,9 @@ void SerialParserWorker::run()
             }
         }
 
-        if (!data.isEmpty())
+        if (!data.isEmpty() && !parseData(data))
         {
-            parseData(data);
+            m_rejected.fetch_add(1, std::memory_order_relaxed);
         }
     }
     if (m_debugMode)
@@ -63,67 +70,98 @@ void SerialParserWorker::run()
     }
 }
 
-void SerialParserWorker::parseData(const QByteArray &data)
+bool SerialParserWorker::parseData(const QByteArray &data)
 {
-    QString dataString = QString::fromUtf8(data).trimmed();
-    QStringList fields = dataString.split(",");
-
-    // Expected number of fields based on the MCU format
-    const int expectedFields = 15;
-
-    if (fields.size() != expectedFields)
+    TelemetryFrame frame;
+    QString error;
+    if (!parseLine(data, frame, &error))
     {
         if (m_debugMode)
         {
-            qDebug() << "SerialParserWorker: Received incomplete or malformed data. Expected" << expectedFields << "fields, got" << fields.size() << ":" << dataString;
+            qDebug() << "SerialParserWorker:" << error << ":" << data.trimmed();
         }
         emit errorOccurred("Incomplete or malformed serial data received.");
-        return;
+        return false;
     }
 
+    frame.timestampUs = telemetryTimestampUs();
+    emit dataParsed(frame);
+    return true;
+}
+
+bool SerialParserWorker::parseLine(QByteArrayView line, TelemetryFrame &frame, QString *error)
+{
+    // Expected number of fields based on the MCU format
+    const int expectedFields = 15;
+
     // Parse data based on the MCU format:
     // speed, rpm, accPedal, brakePedal, encoderAngle,
     // temperature, batteryLevel, gpsLongitude, gpsLatitude,
     // frWheelSpeed, flWheelSpeed, brWheelSpeed, blWheelSpeed,
     // lateralG, longitudinalG
+    static const char *const names[expectedFields] = {
+        "speed", "rpm", "accPedal", "brakePedal", "encoderAngle",
+        "temperature", "batteryLevel", "gpsLongitude", "gpsLatitude",
+        "speedFR", "speedFL", "speedBR", "speedBL",
+        "lateralG", "longitudinalG"
+    };
+
+    line = line.trimmed();
+    QByteArrayView fields[expectedFields];
+    int fieldCount = 0;
+    qsizetype from = 0;
+    while (true)
+    {
+        const qsizetype comma = line.indexOf(',', from);
+        const qsizetype end = comma < 0 ? line.size() : comma;
+        if (fieldCount < expectedFields)
+        {
+            fields[fieldCount] = line.sliced(from, end - from).trimmed();
+        }
+        ++fieldCount;
+        if (comma < 0)
+        {
+            break;
+        }
+        from = comma + 1;
+    }
 
-    bool ok;
-    float speed = fields.at(0).toFloat(&ok);
-    if (!ok) { if (m_debugMode) qDebug() << "Failed to parse speed"; return; }
-    int rpm = fields.at(1).toInt(&ok);
-    if (!ok) { if (m_debugMode) qDebug() << "Failed to parse rpm"; return; }
-    int accPedal = fields.at(2).toInt(&ok);
-    if (!ok) { if (m_debugMode) qDebug() << "Failed to parse accPedal"; return; }
-    int brakePedal = fields.at(3).toInt(&ok);
-    if (!ok) { if (m_debugMode) qDebug() << "Failed to parse brakePedal"; return; }
-    double encoderAngle = fields.at(4).toDouble(&ok);
-    if (!ok) { if (m_debugMode) qDebug() << "Failed to parse encoderAngle"; return; }
-    float temperature = fields.at(5).toFloat(&ok);
-    if (!ok) { if (m_debugMode) qDebug() << "Failed to parse temperature"; return; }
-    int batteryLevel = fields.at(6).toInt(&ok);
-    if (!ok) { if (m_debugMode) qDebug() << "Failed to parse batteryLevel"; return; }
-    double gpsLongitude = fields.at(7).toDouble(&ok);
-    if (!ok) { if (m_debugMode) qDebug() << "Failed to parse gpsLongitude"; return; }
-    double gpsLatitude = fields.at(8).toDouble(&ok);
-    if (!ok) { if (m_debugMode) qDebug() << "Failed to parse gpsLatitude"; return; }
-    int speedFR = fields.at(9).toInt(&ok); // frWheelSpeed
-    if (!ok) { if (m_debugMode) qDebug() << "Failed to parse speedFR"; return; }
-    int speedFL = fields.at(10).toInt(&ok); // flWheelSpeed
-    if (!ok) { if (m_debugMode) qDebug() << "Failed to parse speedFL"; return; }
-    int speedBR = fields.at(11).toInt(&ok); // brWheelSpeed
-    if (!ok) { if (m_debugMode) qDebug() << "Failed to parse speedBR"; return; }
-    int speedBL = fields.at(12).toInt(&ok); // blWheelSpeed
-    if (!ok) { if (m_debugMode) qDebug() << "Failed to parse speedBL"; return; }
-    double lateralG = fields.at(13).toDouble(&ok);
-    if (!ok) { if (m_debugMode) qDebug() << "Failed to parse lateralG"; return; }
-    double longitudinalG = fields.at(14).toDouble(&ok);
-    if (!ok) { if (m_debugMode) qDebug() << "Failed to parse longitudinalG"; return; }
-
-    emit dataParsed(speed, rpm, accPedal, brakePedal, encoderAngle, temperature, batteryLevel,
-                    gpsLongitude, gpsLatitude, speedFL, speedFR, speedBL, speedBR,
-                    lateralG, longitudinalG);
-}
-
-
-
+    if (fieldCount != expectedFields)
+    {
+        if (error)
+        {
+            *error = QStringLiteral("Expected %1 fields, got %2").arg(expectedFields).arg(fieldCount);
+        }
+        return false;
+    }
 
+    bool ok[expectedFields];
+    frame.speed = fields[0].toFloat(&ok[0]);
+    frame.rpm = fields[1].toInt(&ok[1]);
+    frame.accPedal = fields[2].toInt(&ok[2]);
+    frame.brakePedal = fields[3].toInt(&ok[3]);
+    frame.encoderAngle = fields[4].toDouble(&ok[4]);
+    frame.temperature = fields[5].toFloat(&ok[5]);
+    frame.batteryLevel = fields[6].toInt(&ok[6]);
+    frame.gpsLongitude = fields[7].toDouble(&ok[7]);
+    frame.gpsLatitude = fields[8].toDouble(&ok[8]);
+    frame.speedFR = fields[9].toInt(&ok[9]); // frWheelSpeed
+    frame.speedFL = fields[10].toInt(&ok[10]); // flWheelSpeed
+    frame.speedBR = fields[11].toInt(&ok[11]); // brWheelSpeed
+    frame.speedBL = fields[12].toInt(&ok[12]); // blWheelSpeed
+    frame.lateralG = fields[13].toDouble(&ok[13]);
+    frame.longitudinalG = fields[14].toDouble(&ok[14]);
+
+    for (int i = 0; i < expectedFields; ++i)
+    {
+        if (!ok[i])
+        {
+            if (error)
+            {
+                *error = QStringLiteral("Failed to parse %1").arg(QLatin1String(names[i]));
+            }
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#ifndef GORILLACODEC_H
+#define GORILLACODEC_H
+
+#include <QByteArray>
+#include <QSpan>
+
+/**
+ * @brief Lossless block compression for telemetry columns, after Facebook's Gorilla
+ *
+ * Timestamps are stored as the delta of their deltas, which is zero or a few bits for a steady
+ * sample rate. Values are stored as the XOR with their predecessor, of which only the meaningful
+ * bits are written, reusing the previous window of leading and trailing zeros where it fits. Slowly
+ * changing channels cost one or a few bits per sample, and every double is restored bit for bit.
+ *
+ * A block does not store its length, the caller keeps the sample count next to it. Decoding first
+ * parses the bit stream into residuals and then restores the samples in a separate branch-free pass
+ * over the output, which keeps the branchy part short and lets the compiler unroll the rest.
+ */
+namespace Gorilla
+{
+QByteArray encodeTimes(QSpan<const qint64> times);
+QByteArray encodeValues(QSpan<const double> values);
+
+/**
+ * @brief Decode times.size() timestamps
+ * @return False if the block holds fewer samples
+ */
+bool decodeTimes(const QByteArray &block, QSpan<qint64> times);
+
+/**
+ * @brief Decode values.size() values
+ * @return False if the block holds fewer samples
+ */
+bool decodeValues(const QByteArray &block, QSpan<double> values);
+}
+
+#endif // GORILLACODEC_H
@@ -0,0 +1,48 @@
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <QThreadPool>
+#include <QSemaphore>
+#include <atomic>
+
+/**
+ * @brief Run function(i) for every i in [0, count) on the global thread pool and wait for all of them
+ *
+ * The calling thread works along, so a busy pool or a single item never adds a thread hand-over.
+ * Items are claimed one at a time, which balances items of uneven cost such as blocks of different size.
+ */
+template <typename Function>
+void parallelFor(qsizetype count, Function function)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    std::atomic<qsizetype> next(0);
+    auto work = [&next, count, &function]()
+    {
+        for (qsizetype i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+        {
+            function(i);
+        }
+    };
+
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const qsizetype helpers = qMin<qsizetype>(pool->maxThreadCount(), count) - 1;
+    QSemaphore finished;
+    int started = 0;
+    for (qsizetype i = 0; i < helpers; ++i)
+    {
+        if (!pool->tryStart([&work, &finished]() { work(); finished.release(); }))
+        {
+            break;
+        }
+        ++started;
+    }
+
+    work();
+    finished.acquire(started);
+}
+
+#endif // PARALLELFOR_H
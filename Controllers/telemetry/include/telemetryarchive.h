@@ -0,0 +1,92 @@
+#ifndef TELEMETRYARCHIVE_H
+#define TELEMETRYARCHIVE_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QList>
+#include <QReadWriteLock>
+#include <QSpan>
+#include <QString>
+#include <array>
+#include "telemetrychannels.h"
+#include "telemetryseries.h"
+
+/**
+ * @brief The TelemetryArchive class keeps telemetry in memory compressed with the Gorilla codec
+ *
+ * Samples are held in segments of a few thousand frames. Each segment stores its timestamps and every
+ * channel as a separate Gorilla block, so a query only decodes the channel it asks for, and the
+ * segments of a range are decoded in parallel. Typical telemetry shrinks 5-10x against the raw
+ * columns. The archive drops its oldest segments beyond a byte limit.
+ *
+ * An archive can be saved to and loaded from a .tlz file. The file is a header followed by
+ * self-contained segments, so it can also be written one segment at a time, see writeSegment().
+ * All methods are thread-safe.
+ */
+class TelemetryArchive
+{
+public:
+    static constexpr qint64 DefaultByteLimit = qint64(256) << 20;
+
+    struct Segment
+    {
+        qint64 firstTimeUs = 0;
+        qint64 lastTimeUs = 0;
+        qint32 count = 0;
+        QByteArray times;
+        std::array<QByteArray, TelemetryChannelCount> values;
+
+        qint64 bytes() const; // Compressed size of all blocks.
+    };
+
+    /**
+     * @brief Create an empty archive
+     * @param byteLimit Compressed bytes kept, the oldest segments are dropped beyond it
+     */
+    explicit TelemetryArchive(qint64 byteLimit = DefaultByteLimit);
+
+    /**
+     * @brief Compress one segment, callable from any thread without touching an archive
+     * @param times Non-decreasing receive times
+     * @param values One column per channel, as long as times
+     */
+    static Segment encode(QSpan<const qint64> times, const std::array<QSpan<const double>, TelemetryChannelCount> &values);
+
+    void append(Segment segment);
+    void clear();
+
+    qint64 sampleCount() const;
+    qint64 compressedBytes() const;
+    qint64 rawBytes() const; // Size of the same samples as plain timestamp and double columns.
+    qint64 firstTimeUs() const;
+    qint64 lastTimeUs() const;
+
+    /**
+     * @brief Decode one channel over a time range
+     * @param fromUs First receive time to include
+     * @param toUs Last receive time to include
+     */
+    TelemetrySeries load(TelemetryChannel channel, qint64 fromUs, qint64 toUs) const;
+
+    bool save(QIODevice &device) const;
+
+    /**
+     * @brief Replace the contents with a .tlz file
+     * @return False if the file is not an archive of this version or is truncated
+     */
+    bool load(QIODevice &device, QString *error = nullptr);
+
+    static bool writeHeader(QIODevice &device);
+    static bool writeSegment(QIODevice &device, const Segment &segment);
+
+private:
+    void dropOldest(); // Call with the write lock held.
+
+    qint64 m_byteLimit;
+    mutable QReadWriteLock m_lock;
+    QList<Segment> m_segments;
+    qint64 m_bytes;
+    qint64 m_samples;
+};
+
+#endif // TELEMETRYARCHIVE_H
@@ -0,0 +1,56 @@
+#ifndef TELEMETRYCHANGEFILTER_H
+#define TELEMETRYCHANGEFILTER_H
+
+#include <QtGlobal>
+#include <array>
+#include "telemetrychannels.h"
+
+/**
+ * @brief The TelemetryChangeFilter class decides which channel changes reach the UI
+ *
+ * Each channel has a deadband (changes smaller than it are ignored), a hysteresis (a reversal of
+ * direction needs the deadband plus this margin) and a minimum notify interval. Only the published
+ * frame is filtered; raw frames in the TelemetryStore keep their full resolution for recording and
+ * analytics.
+ */
+class TelemetryChangeFilter
+{
+public:
+    TelemetryChangeFilter(); // Starts with the default policy of every channel.
+
+    void setPolicy(TelemetryChannel channel, const TelemetryNotifyPolicy &policy);
+    TelemetryNotifyPolicy policy(TelemetryChannel channel) const;
+
+    /**
+     * @brief Copy the channels of a raw frame that pass their policy into the published frame
+     * @param raw The latest raw frame
+     * @param published The frame shown by the UI, updated in place
+     * @param nowMs Monotonic time in milliseconds
+     * @return True if at least one channel of the published frame changed
+     */
+    bool apply(const TelemetryFrame &raw, TelemetryFrame &published, qint64 nowMs);
+
+    /**
+     * @brief Whether a change is only held back by the minimum notify interval
+     *
+     * The caller should apply the raw frame again later, otherwise the last value of a channel that
+     * stopped changing would never be shown.
+     */
+    bool hasPending() const { return m_pendingCount > 0; }
+
+    void reset(); // Forget notify times and directions, e.g. when the source changes.
+
+private:
+    struct ChannelState
+    {
+        TelemetryNotifyPolicy policy;
+        qint64 lastNotifyMs = -1;
+        int direction = 0;
+        bool pending = false;
+    };
+
+    std::array<ChannelState, TelemetryChannelCount> m_channels;
+    int m_pendingCount;
+};
+
+#endif // TELEMETRYCHANGEFILTER_H
@@ -0,0 +1,85 @@
+#ifndef TELEMETRYCHANNELS_H
+#define TELEMETRYCHANNELS_H
+
+#include <QString>
+#include <array>
+#include "telemetryframe.h"
+
+/**
+ * @brief Index of every channel carried by a TelemetryFrame, in wire order
+ */
+enum class TelemetryChannel : int
+{
+    Speed,
+    Rpm,
+    AccPedal,
+    BrakePedal,
+    EncoderAngle,
+    Temperature,
+    BatteryLevel,
+    GpsLongitude,
+    GpsLatitude,
+    SpeedFL,
+    SpeedFR,
+    SpeedBL,
+    SpeedBR,
+    LateralG,
+    LongitudinalG,
+    Count
+};
+
+constexpr int TelemetryChannelCount = static_cast<int>(TelemetryChannel::Count);
+
+/**
+ * @brief When a change of a channel is worth a notification to the UI
+ */
+struct TelemetryNotifyPolicy
+{
+    double deadband = 0.0;   // Changes up to this size are ignored, 0 notifies every change
+    double hysteresis = 0.0; // Extra margin needed when the value reverses its direction
+    int minIntervalMs = 0;   // Minimum time between two notifications of this channel
+};
+
+/**
+ * @brief Describes how one channel is read from and written to a frame
+ *
+ * Values are exchanged as double, which holds every int and float channel exactly.
+ */
+struct TelemetryChannelInfo
+{
+    enum class Compare { Exact, Fuzzy };
+
+    TelemetryChannel channel;
+    const char *name;
+    const char *unit; // Display unit, also written to exported files
+    double (*read)(const TelemetryFrame &frame);
+    void (*write)(TelemetryFrame &frame, double value);
+    Compare compare;
+    TelemetryNotifyPolicy defaultPolicy;
+
+    /**
+     * @brief Whether two values of this channel are considered equal
+     */
+    bool equal(double a, double b) const;
+};
+
+/**
+ * @brief The routing table, one entry per channel in TelemetryChannel order
+ */
+const std::array<TelemetryChannelInfo, TelemetryChannelCount> &telemetryChannels();
+
+/**
+ * @brief Look up the descriptor of a single channel
+ */
+inline const TelemetryChannelInfo &telemetryChannel(TelemetryChannel channel)
+{
+    return telemetryChannels()[static_cast<int>(channel)];
+}
+
+/**
+ * @brief Look up a channel descriptor by its property name
+ * @return The descriptor, or nullptr if no channel has that name
+ */
+const TelemetryChannelInfo *findTelemetryChannel(const QString &name);
+
+#endif // TELEMETRYCHANNELS_H
@@ -0,0 +1,108 @@
+#ifndef TELEMETRYDECIMATOR_H
+#define TELEMETRYDECIMATOR_H
+
+#include <QList>
+#include "telemetryhistory.h"
+
+/**
+ * @brief One sample of a decimated series
+ */
+struct TelemetryPoint
+{
+    qint64 timeUs = 0;
+    double value = 0.0;
+};
+
+/**
+ * @brief The TelemetryDecimator class reduces one channel of the history to a plot-sized series
+ *
+ * The time window is split into one bucket per pixel column, aligned to absolute time so buckets stay
+ * put while the plot scrolls. Two reductions are available:
+ * - MinMax keeps the extremes of every column, so spikes are never lost (at most 2 points per pixel).
+ * - Lttb (Largest-Triangle-Three-Buckets) keeps the most visually significant sample of every column.
+ *
+ * The decimator is incremental: update() only consumes samples appended since the previous call.
+ * Complete buckets are reduced once, only the newest buckets are recomputed per frame.
+ * Not thread-safe, use one decimator per consumer thread.
+ */
+class TelemetryDecimator
+{
+public:
+    enum class Mode { MinMax, Lttb };
+
+    explicit TelemetryDecimator(TelemetryChannel channel, Mode mode = Mode::MinMax);
+
+    TelemetryChannel channel() const { return m_channel; }
+    Mode mode() const { return m_mode; }
+
+    void setMode(Mode mode);
+    void setWindow(qint64 windowUs); // Time span of the plot, default 10 s.
+    void setWidth(int pixels);       // Number of buckets, the output has at most twice as many points.
+
+    /**
+     * @brief Consume new samples from the history and refresh the output
+     * @param history The history of the active source
+     * @param nowUs The right edge of the plot, usually telemetryTimestampUs()
+     * @return True if points() changed
+     */
+    bool update(const TelemetryHistory &history, qint64 nowUs);
+
+    /**
+     * @brief The decimated series in time order
+     */
+    const QList<TelemetryPoint> &points() const { return m_points; }
+
+    /**
+     * @brief Number of leading points that are final, they only disappear by scrolling out of the window
+     *
+     * The points after them belong to the newest buckets and may change with the next update().
+     */
+    qsizetype stableCount() const { return m_stableCount; }
+
+    /**
+     * @brief Incremented whenever the output starts over, so consumers can drop what they derived from it
+     */
+    quint64 generation() const { return m_generation; }
+
+    void reset(); // Drop all buckets, the next update() starts over from the history.
+
+private:
+    struct Bucket
+    {
+        qint64 key = 0;     // Bucket number, time / bucket duration
+        quint64 begin = 0;  // History indices of the samples in this bucket
+        quint64 end = 0;
+        double sumTimeUs = 0.0; // Relative to the first sample, for the LTTB average
+        double sumValue = 0.0;
+        TelemetryPoint first;
+        TelemetryPoint last;
+        TelemetryPoint min;
+        TelemetryPoint max;
+        TelemetryPoint selected; // LTTB choice, valid once finalized
+        bool finalized = false;
+    };
+
+    void ingest(const TelemetryHistory &history, quint64 index, qint64 timeUs, double value);
+    bool finalize(const TelemetryHistory &history, int bucketIndex);
+    TelemetryPoint selectLttb(const TelemetryHistory &history, const Bucket &bucket, const TelemetryPoint &previous,
+                              double nextTimeUs, double nextValue, bool *valid) const;
+    void buildPoints(const TelemetryHistory &history);
+
+    static TelemetryPoint average(const Bucket &bucket);
+
+    TelemetryChannel m_channel;
+    Mode m_mode;
+    qint64 m_windowUs;
+    int m_width;
+    qint64 m_bucketUs;
+
+    QList<Bucket> m_buckets;
+    QList<TelemetryPoint> m_points;
+    qsizetype m_stableCount;
+    quint64 m_generation;
+    quint64 m_nextIndex;
+    quint64 m_historyStart;
+    bool m_primed;
+};
+
+#endif // TELEMETRYDECIMATOR_H
@@ -0,0 +1,47 @@
+#ifndef TELEMETRYFRAME_H
+#define TELEMETRYFRAME_H
+
+#include <QMetaType>
+#include <QtGlobal>
+#include <chrono>
+
+/**
+ * @brief The TelemetryFrame struct holds one fully parsed telemetry sample
+ *
+ * Every transport delivers the same fifteen values per message. Keeping them together in one
+ * value type lets the parsers hand over a complete frame in a single step instead of fifteen
+ * separate arguments, and lets consumers always work on a coherent set of values.
+ */
+struct TelemetryFrame
+{
+    float speed = 0.0f;
+    int rpm = 0;
+    int accPedal = 0;
+    int brakePedal = 0;
+    double encoderAngle = 0.0;
+    float temperature = 0.0f;
+    int batteryLevel = 0;
+    double gpsLongitude = 0.0;
+    double gpsLatitude = 0.0;
+    int speedFL = 0;
+    int speedFR = 0;
+    int speedBL = 0;
+    int speedBR = 0;
+    double lateralG = 0.0;
+    double longitudinalG = 0.0;
+
+    qint64 timestampUs = 0; // Monotonic time the frame was parsed, see telemetryTimestampUs()
+};
+
+/**
+ * @brief Monotonic clock shared by every telemetry timestamp, in microseconds
+ */
+inline qint64 telemetryTimestampUs()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+Q_DECLARE_METATYPE(TelemetryFrame)
+
+#endif // TELEMETRYFRAME_H
@@ -0,0 +1,153 @@
+#ifndef TELEMETRYHISTORY_H
+#define TELEMETRYHISTORY_H
+
+#include <QList>
+#include <QMutex>
+#include <QSpan>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+#include "telemetrychannels.h"
+#include "telemetryarchive.h"
+
+/**
+ * @brief Part of the history as at most two contiguous blocks, the second one is used when the range wraps
+ *
+ * The samples are relaxed atomics, at() loads one of them.
+ */
+template <typename T>
+struct TelemetryRingSpan
+{
+    QSpan<const std::atomic<T>> first;
+    QSpan<const std::atomic<T>> second;
+
+    qsizetype size() const { return first.size() + second.size(); }
+    bool isEmpty() const { return size() == 0; }
+    T at(qsizetype i) const { return (i < first.size() ? first[i] : second[i - first.size()]).load(std::memory_order_relaxed); }
+};
+
+/**
+ * @brief The TelemetryHistory class keeps a fixed-capacity, timestamped history of every channel
+ *
+ * Samples are stored column by column (one ring for the timestamps, one per channel), so a range of a
+ * single channel is contiguous in memory. The capacity is fixed at construction, appending never
+ * allocates.
+ *
+ * Appends from several parser threads are serialized by a mutex. Readers never lock: they take a
+ * view of absolute sample indices, read the spans in place, and call isValid() afterwards to learn
+ * whether the writer lapped the ring while they were reading. Keeping the queried window well below
+ * the capacity makes that practically impossible. The samples are stored as relaxed atomics, so a
+ * read racing the writer is well-defined and only its value is discarded.
+ *
+ * Every completed segment of samples is also compressed into a TelemetryArchive by a background
+ * task, which reads the ring like any other reader. The archive reaches back far beyond the ring at
+ * a fraction of its memory, for queries that look at more than the last few minutes.
+ */
+class TelemetryHistory
+{
+public:
+    static constexpr qsizetype DefaultCapacity = qsizetype(1) << 18; // ~4 min at 1 kHz
+
+    /**
+     * @brief Absolute sample indices [begin, end), stable while samples are appended
+     */
+    struct View
+    {
+        quint64 begin = 0;
+        quint64 end = 0;
+
+        qsizetype size() const { return qsizetype(end - begin); }
+        bool isEmpty() const { return begin == end; }
+    };
+
+    /**
+     * @brief Create a history
+     * @param capacity Samples kept per channel, rounded up to a power of two
+     */
+    explicit TelemetryHistory(qsizetype capacity = DefaultCapacity);
+    ~TelemetryHistory();
+
+    qsizetype capacity() const { return m_capacity; }
+
+    /**
+     * @brief Append one frame, callable from any thread
+     *
+     * Timestamps are clamped so that they never go backwards, frames of parallel parsers may arrive
+     * slightly out of order.
+     */
+    void append(const TelemetryFrame &frame);
+
+    /**
+     * @brief Drop all samples and the archive, e.g. when the source changes; ring memory is kept
+     */
+    void clear();
+
+    /**
+     * @brief Total number of samples appended so far, the end of the newest view
+     */
+    quint64 head() const { return m_head.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Index of the first sample after the last clear(), changes only when the history is cleared
+     */
+    quint64 start() const { return m_start.load(std::memory_order_acquire); }
+
+    View all() const;
+    View latest(qsizetype count) const;
+    View range(qint64 fromUs, qint64 toUs) const; // Samples with fromUs <= time < toUs.
+
+    TelemetryRingSpan<qint64> times(const View &view) const;
+    TelemetryRingSpan<double> values(TelemetryChannel channel, const View &view) const;
+
+    /**
+     * @brief The last sample at or before a time, as a frame
+     *
+     * A binary search over the timestamps, only the one sample is read from the ring.
+     * @return False if the history holds no sample that old, or the writer lapped it while it was read
+     */
+    bool frameAt(qint64 timeUs, TelemetryFrame &frame) const;
+
+    /**
+     * @brief Whether the samples of a view were still intact when this was called
+     *
+     * Call it after reading the spans of a view, a false result means the data must be discarded.
+     */
+    bool isValid(const View &view) const;
+
+    /**
+     * @brief Compressed copy of every sample since the last clear(), up to the last completed segment
+     */
+    const TelemetryArchive &archive() const { return m_archive; }
+
+private:
+    static_assert(std::atomic<double>::is_always_lock_free && sizeof(std::atomic<double>) == sizeof(double),
+                  "History columns are plain words");
+
+    template <typename T>
+    TelemetryRingSpan<T> spans(const std::atomic<T> *column, const View &view) const;
+
+    quint64 lowerBound(quint64 begin, quint64 end, qint64 timeUs) const;
+    void archiveSegments(); // Runs on m_archivePool.
+
+    const qsizetype m_capacity;
+    const quint64 m_mask;
+
+    std::unique_ptr<std::atomic<qint64>[]> m_times;
+    std::unique_ptr<std::atomic<double>[]> m_values; // Channel-major, m_capacity samples per channel
+
+    QMutex m_appendMutex;
+    qint64 m_lastTimeUs;
+    std::atomic<quint64> m_head;
+    std::atomic<quint64> m_start; // Index of the first sample after the last clear()
+
+    // Segments start at multiples of their size, so none of them wraps around the ring
+    const qsizetype m_segmentSamples;
+    TelemetryArchive m_archive;
+    QMutex m_archiveMutex;
+    quint64 m_archived; // End of the last archived segment
+    QList<qint64> m_segmentTimes;  // A segment copied out of the ring for encoding
+    QList<double> m_segmentValues; // Channel-major, m_segmentSamples per channel
+    QThreadPool m_archivePool;
+};
+
+#endif // TELEMETRYHISTORY_H
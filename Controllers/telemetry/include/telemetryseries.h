@@ -0,0 +1,16 @@
+#ifndef TELEMETRYSERIES_H
+#define TELEMETRYSERIES_H
+
+#include <QList>
+#include <QtGlobal>
+
+/**
+ * @brief One channel over a time range, in arrival order
+ */
+struct TelemetrySeries
+{
+    QList<qint64> timestampsUs;
+    QList<double> values;
+};
+
+#endif // TELEMETRYSERIES_H
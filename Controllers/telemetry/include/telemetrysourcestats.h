@@ -0,0 +1,19 @@
+#ifndef TELEMETRYSOURCESTATS_H
+#define TELEMETRYSOURCESTATS_H
+
+#include <QtGlobal>
+
+/**
+ * @brief The TelemetrySourceStats struct holds the pipeline counters of one telemetry source
+ *
+ * Counters run from the start of the process; rates are taken from the difference of two snapshots.
+ */
+struct TelemetrySourceStats
+{
+    quint64 received = 0; // Messages or serial chunks handed to the parsers
+    quint64 parsed = 0;   // Frames published to the store
+    quint64 dropped = 0;  // Messages that produced no frame, malformed or without a parser; parser rejections restart with the source
+    qsizetype queued = 0; // Messages waiting in the parser queues right now
+};
+
+#endif // TELEMETRYSOURCESTATS_H
@@ -0,0 +1,72 @@
+#ifndef TELEMETRYSTORE_H
+#define TELEMETRYSTORE_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <type_traits>
+#include "telemetryframe.h"
+
+/**
+ * @brief The TelemetryStore class holds the latest telemetry frame in a small ring of sequence-locked slots
+ *
+ * Writers publish a complete frame without taking a lock or waiting for each other, readers on any
+ * thread take consistent snapshots without blocking the writers. A reader never sees a frame that
+ * mixes values of two writes (e.g. a new latitude with an old longitude).
+ *
+ * Every write claims its own slot with one fetch-add, so concurrent writers (one per parser thread)
+ * never share a slot. A slot's sequence is odd while its frame is written and even once it is
+ * complete. Readers take the newest complete slot, skipping one a preempted writer is still filling,
+ * and retry only when the writers lapped the ring while they copied.
+ */
+class TelemetryStore
+{
+public:
+    TelemetryStore();
+
+    /**
+     * @brief Publish a new frame, callable from any thread without blocking
+     * @param frame The frame to publish
+     */
+    void write(const TelemetryFrame &frame);
+
+    /**
+     * @brief Take a consistent snapshot of the latest frame
+     * @return The latest published frame
+     */
+    TelemetryFrame read() const;
+
+    /**
+     * @brief Take a snapshot only if a write happened since the given version
+     * @param version The version seen by the caller, updated to the version of the returned frame
+     * @param frame Receives the snapshot
+     * @return True if the frame is newer than the version passed in
+     */
+    bool readIfNewer(quint64 &version, TelemetryFrame &frame) const;
+
+    /**
+     * @brief Number of started writes, increases monotonically
+     */
+    quint64 version() const { return m_head.load(std::memory_order_acquire); }
+
+private:
+    static_assert(std::is_trivially_copyable<TelemetryFrame>::value, "TelemetryFrame is copied word by word");
+
+    // The frame is kept as relaxed atomic words so concurrent reads and writes are well-defined
+    static constexpr int WordCount = (sizeof(TelemetryFrame) + sizeof(quint64) - 1) / sizeof(quint64);
+
+    // More slots than parser threads, a writer only reuses a slot after SlotCount later writes
+    static constexpr quint64 SlotCount = 16;
+
+    struct alignas(64) Slot
+    {
+        std::atomic<quint64> sequence; // 2 * index + 1 while write index fills it, 2 * index + 2 once it is complete
+        std::atomic<quint64> words[WordCount];
+    };
+
+    quint64 readSnapshot(TelemetryFrame &frame) const;
+
+    alignas(64) std::atomic<quint64> m_head;
+    Slot m_slots[SlotCount];
+};
+
+#endif // TELEMETRYSTORE_H
@@ -0,0 +1,375 @@
+#include "../include/gorillacodec.h"
+#include <QtAlgorithms>
+#include <QtEndian>
+#include <cstring>
+#include <iterator>
+
+namespace
+{
+/**
+ * @brief Delta-of-delta classes: a prefix of ones closed by a zero, then a zigzag value of that width
+ *
+ * Telemetry arrives at a steady rate with some scheduling jitter, so most samples land in the first
+ * three classes. The last one has no closing zero and stores the value in full.
+ */
+struct TimeClass
+{
+    int prefixBits;
+    int valueBits;
+};
+
+constexpr TimeClass timeClasses[] = {{1, 0}, {2, 7}, {3, 9}, {4, 12}, {5, 20}, {5, 64}};
+constexpr int TimeClassCount = int(std::size(timeClasses));
+
+// Width of the leading zero count and of the meaningful bit count of a new XOR window
+constexpr int WindowFieldBits = 6;
+
+quint64 zigzag(quint64 value)
+{
+    return (value << 1) ^ quint64(qint64(value) >> 63);
+}
+
+quint64 unzigzag(quint64 value)
+{
+    return (value >> 1) ^ (0 - (value & 1));
+}
+
+quint64 doubleBits(double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+void setDoubleBits(double &target, quint64 bits)
+{
+    std::memcpy(&target, &bits, sizeof(bits));
+}
+
+/**
+ * @brief Appends bits most significant first, whole 64-bit words at a time
+ */
+class BitWriter
+{
+public:
+    explicit BitWriter(qsizetype expectedBytes)
+        : m_word(0),
+        m_used(0)
+    {
+        m_data.reserve(expectedBytes);
+    }
+
+    // Writes the low count bits of value, count in [1, 64]
+    void write(quint64 value, int count)
+    {
+        if (count < 64)
+        {
+            value &= (quint64(1) << count) - 1;
+        }
+
+        const int free = 64 - m_used;
+        if (count < free)
+        {
+            m_word = (m_word << count) | value;
+            m_used += count;
+            return;
+        }
+
+        const int rest = count - free;
+        m_word = (free == 64 ? 0 : m_word << free) | (value >> rest);
+        flushWord();
+        m_word = rest > 0 ? value & ((quint64(1) << rest) - 1) : 0;
+        m_used = rest;
+    }
+
+    QByteArray finish()
+    {
+        if (m_used > 0)
+        {
+            const int bytes = (m_used + 7) / 8;
+            m_word <<= 64 - m_used;
+            char word[8];
+            qToBigEndian(m_word, word);
+            m_data.append(word, bytes);
+        }
+        return m_data;
+    }
+
+private:
+    void flushWord()
+    {
+        char word[8];
+        qToBigEndian(m_word, word);
+        m_data.append(word, 8);
+    }
+
+    QByteArray m_data;
+    quint64 m_word;
+    int m_used;
+};
+
+/**
+ * @brief Reads what BitWriter wrote, with an unaligned 64-bit load per call
+ */
+class BitReader
+{
+public:
+    explicit BitReader(const QByteArray &data)
+        : m_data(reinterpret_cast<const uchar *>(data.constData())),
+        m_bits(quint64(data.size()) * 8),
+        m_position(0)
+    {
+    }
+
+    // Reads count bits, count in [1, 64]; false once the data is exhausted
+    bool read(int count, quint64 &value)
+    {
+        if (m_position + quint64(count) > m_bits)
+        {
+            return false;
+        }
+
+        // A load holds at least 57 valid bits after the shift, longer fields take two
+        if (count > 56)
+        {
+            const quint64 high = load() >> 32;
+            m_position += 32;
+            value = (high << (count - 32)) | (load() >> (96 - count));
+            m_position += quint64(count - 32);
+            return true;
+        }
+
+        value = load() >> (64 - count);
+        m_position += quint64(count);
+        return true;
+    }
+
+private:
+    quint64 load() const
+    {
+        const quint64 byte = m_position / 8;
+        const quint64 available = m_bits / 8 - byte;
+        quint64 word;
+        if (available >= 8)
+        {
+            word = qFromBigEndian<quint64>(m_data + byte);
+        }
+        else
+        {
+            uchar tail[8] = {};
+            std::memcpy(tail, m_data + byte, available);
+            word = qFromBigEndian<quint64>(tail);
+        }
+        return word << (m_position % 8);
+    }
+
+    const uchar *m_data;
+    quint64 m_bits;
+    quint64 m_position;
+};
+}
+
+namespace Gorilla
+{
+QByteArray encodeTimes(QSpan<const qint64> times)
+{
+    if (times.isEmpty())
+    {
+        return QByteArray();
+    }
+
+    BitWriter writer(times.size() + 8);
+    writer.write(quint64(times[0]), 64);
+
+    // Unsigned arithmetic wraps instead of overflowing, which keeps any input lossless
+    quint64 previous = quint64(times[0]);
+    quint64 previousDelta = 0;
+    for (qsizetype i = 1; i < times.size(); ++i)
+    {
+        const quint64 delta = quint64(times[i]) - previous;
+        const quint64 encoded = zigzag(delta - previousDelta);
+        previous = quint64(times[i]);
+        previousDelta = delta;
+
+        int index = 0;
+        while (index < TimeClassCount - 1 && encoded >= (quint64(1) << timeClasses[index].valueBits))
+        {
+            ++index;
+        }
+
+        const TimeClass &timeClass = timeClasses[index];
+        const quint64 ones = (quint64(1) << index) - 1;
+        writer.write(index < TimeClassCount - 1 ? ones << 1 : ones, timeClass.prefixBits);
+        if (timeClass.valueBits > 0)
+        {
+            writer.write(encoded, timeClass.valueBits);
+        }
+    }
+    return writer.finish();
+}
+
+QByteArray encodeValues(QSpan<const double> values)
+{
+    if (values.isEmpty())
+    {
+        return QByteArray();
+    }
+
+    BitWriter writer(values.size() / 2 + 8);
+    quint64 previous = doubleBits(values[0]);
+    writer.write(previous, 64);
+
+    // No window yet, the first non-zero XOR always opens one
+    int windowLeading = 64;
+    int windowTrailing = 64;
+    for (qsizetype i = 1; i < values.size(); ++i)
+    {
+        const quint64 bits = doubleBits(values[i]);
+        const quint64 residual = bits ^ previous;
+        previous = bits;
+
+        if (residual == 0)
+        {
+            writer.write(0, 1);
+            continue;
+        }
+
+        const int leading = qCountLeadingZeroBits(residual);
+        const int trailing = qCountTrailingZeroBits(residual);
+        if (leading >= windowLeading && trailing >= windowTrailing)
+        {
+            writer.write(0b10, 2);
+            writer.write(residual >> windowTrailing, 64 - windowLeading - windowTrailing);
+        }
+        else
+        {
+            const int meaningful = 64 - leading - trailing;
+            writer.write(0b11, 2);
+            writer.write(quint64(leading), WindowFieldBits);
+            writer.write(quint64(meaningful - 1), WindowFieldBits);
+            writer.write(residual >> trailing, meaningful);
+            windowLeading = leading;
+            windowTrailing = trailing;
+        }
+    }
+    return writer.finish();
+}
+
+bool decodeTimes(const QByteArray &block, QSpan<qint64> times)
+{
+    if (times.isEmpty())
+    {
+        return true;
+    }
+
+    BitReader reader(block);
+    quint64 value = 0;
+    if (!reader.read(64, value))
+    {
+        return false;
+    }
+    times[0] = qint64(value);
+
+    // First pass: the deltas of the deltas
+    for (qsizetype i = 1; i < times.size(); ++i)
+    {
+        int index = 0;
+        quint64 bit = 1;
+        while (index < TimeClassCount - 1 && bit)
+        {
+            if (!reader.read(1, bit))
+            {
+                return false;
+            }
+            index += int(bit);
+        }
+
+        value = 0;
+        if (timeClasses[index].valueBits > 0 && !reader.read(timeClasses[index].valueBits, value))
+        {
+            return false;
+        }
+        times[i] = qint64(unzigzag(value));
+    }
+
+    // Second pass: two running sums restore the timestamps
+    quint64 time = quint64(times[0]);
+    quint64 delta = 0;
+    for (qsizetype i = 1; i < times.size(); ++i)
+    {
+        delta += quint64(times[i]);
+        time += delta;
+        times[i] = qint64(time);
+    }
+    return true;
+}
+
+bool decodeValues(const QByteArray &block, QSpan<double> values)
+{
+    if (values.isEmpty())
+    {
+        return true;
+    }
+
+    BitReader reader(block);
+    quint64 first = 0;
+    if (!reader.read(64, first))
+    {
+        return false;
+    }
+
+    // First pass: the XOR residuals, kept as bit patterns in the output
+    setDoubleBits(values[0], first);
+    int windowTrailing = 0;
+    int windowBits = 64;
+    for (qsizetype i = 1; i < values.size(); ++i)
+    {
+        quint64 control = 0;
+        if (!reader.read(1, control))
+        {
+            return false;
+        }
+        if (!control)
+        {
+            setDoubleBits(values[i], 0);
+            continue;
+        }
+
+        if (!reader.read(1, control))
+        {
+            return false;
+        }
+        if (control)
+        {
+            quint64 leading = 0;
+            quint64 meaningful = 0;
+            if (!reader.read(WindowFieldBits, leading) || !reader.read(WindowFieldBits, meaningful))
+            {
+                return false;
+            }
+            windowBits = int(meaningful) + 1;
+            windowTrailing = 64 - int(leading) - windowBits;
+            if (windowTrailing < 0)
+            {
+                return false;
+            }
+        }
+
+        quint64 residual = 0;
+        if (!reader.read(windowBits, residual))
+        {
+            return false;
+        }
+        setDoubleBits(values[i], residual << windowTrailing);
+    }
+
+    // Second pass: a running XOR restores the values
+    quint64 bits = first;
+    for (qsizetype i = 1; i < values.size(); ++i)
+    {
+        bits ^= doubleBits(values[i]);
+        setDoubleBits(values[i], bits);
+    }
+    return true;
+}
+}
@@ -0,0 +1,296 @@
+#include "../include/telemetryarchive.h"
+#include "../include/gorillacodec.h"
+#include "../include/parallelfor.h"
+#include <QDebug>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+constexpr char FileMagic[8] = {'A', 'S', 'U', 'R', 'T', 'T', 'L', 'Z'};
+constexpr char SegmentMagic[4] = {'T', 'S', 'E', 'G'};
+constexpr quint32 Version = 1;
+
+// Magic, version, channel count
+constexpr int FileHeaderSize = 16;
+
+// Magic, sample count, time range, then the size of the times block and of every channel block
+constexpr int BlockCount = 1 + TelemetryChannelCount;
+constexpr int SegmentHeaderSize = 24 + BlockCount * 4;
+
+const QByteArray &block(const TelemetryArchive::Segment &segment, int index)
+{
+    return index == 0 ? segment.times : segment.values[index - 1];
+}
+
+QByteArray &block(TelemetryArchive::Segment &segment, int index)
+{
+    return index == 0 ? segment.times : segment.values[index - 1];
+}
+}
+
+qint64 TelemetryArchive::Segment::bytes() const
+{
+    qint64 total = times.size();
+    for (const QByteArray &column : values)
+    {
+        total += column.size();
+    }
+    return total;
+}
+
+TelemetryArchive::TelemetryArchive(qint64 byteLimit)
+    : m_byteLimit(byteLimit),
+    m_bytes(0),
+    m_samples(0)
+{
+}
+
+TelemetryArchive::Segment TelemetryArchive::encode(QSpan<const qint64> times, const std::array<QSpan<const double>, TelemetryChannelCount> &values)
+{
+    Segment segment;
+    segment.count = qint32(times.size());
+    if (times.isEmpty())
+    {
+        return segment;
+    }
+
+    segment.firstTimeUs = times.front();
+    segment.lastTimeUs = times.back();
+    segment.times = Gorilla::encodeTimes(times);
+    for (int channel = 0; channel < TelemetryChannelCount; ++channel)
+    {
+        segment.values[channel] = Gorilla::encodeValues(values[channel]);
+    }
+    return segment;
+}
+
+void TelemetryArchive::append(Segment segment)
+{
+    if (segment.count == 0)
+    {
+        return;
+    }
+
+    QWriteLocker locker(&m_lock);
+    m_bytes += segment.bytes();
+    m_samples += segment.count;
+    m_segments.append(std::move(segment));
+    dropOldest();
+}
+
+void TelemetryArchive::clear()
+{
+    QWriteLocker locker(&m_lock);
+    m_segments.clear();
+    m_bytes = 0;
+    m_samples = 0;
+}
+
+void TelemetryArchive::dropOldest()
+{
+    // The newest segment always stays, even if it alone exceeds the limit
+    while (m_bytes > m_byteLimit && m_segments.size() > 1)
+    {
+        m_bytes -= m_segments.first().bytes();
+        m_samples -= m_segments.first().count;
+        m_segments.removeFirst();
+    }
+}
+
+qint64 TelemetryArchive::sampleCount() const
+{
+    QReadLocker locker(&m_lock);
+    return m_samples;
+}
+
+qint64 TelemetryArchive::compressedBytes() const
+{
+    QReadLocker locker(&m_lock);
+    return m_bytes;
+}
+
+qint64 TelemetryArchive::rawBytes() const
+{
+    return sampleCount() * BlockCount * qint64(sizeof(double));
+}
+
+qint64 TelemetryArchive::firstTimeUs() const
+{
+    QReadLocker locker(&m_lock);
+    return m_segments.isEmpty() ? 0 : m_segments.first().firstTimeUs;
+}
+
+qint64 TelemetryArchive::lastTimeUs() const
+{
+    QReadLocker locker(&m_lock);
+    return m_segments.isEmpty() ? 0 : m_segments.last().lastTimeUs;
+}
+
+TelemetrySeries TelemetryArchive::load(TelemetryChannel channel, qint64 fromUs, qint64 toUs) const
+{
+    // Blocks are implicitly shared, so the segments of the range are taken out cheaply and decoded
+    // without holding the lock
+    QList<Segment> segments;
+    {
+        QReadLocker locker(&m_lock);
+        auto it = std::partition_point(m_segments.cbegin(), m_segments.cend(), [fromUs](const Segment &segment)
+        {
+            return segment.lastTimeUs < fromUs;
+        });
+        for (; it != m_segments.cend() && it->firstTimeUs <= toUs; ++it)
+        {
+            Segment segment;
+            segment.firstTimeUs = it->firstTimeUs;
+            segment.lastTimeUs = it->lastTimeUs;
+            segment.count = it->count;
+            segment.times = it->times;
+            segment.values[static_cast<int>(channel)] = it->values[static_cast<int>(channel)];
+            segments.append(segment);
+        }
+    }
+
+    QList<TelemetrySeries> decoded(segments.size());
+    parallelFor(segments.size(), [&](qsizetype i)
+    {
+        const Segment &segment = segments.at(i);
+        TelemetrySeries &series = decoded[i];
+        series.timestampsUs.resize(segment.count);
+        series.values.resize(segment.count);
+        if (!Gorilla::decodeTimes(segment.times, QSpan<qint64>(series.timestampsUs.data(), segment.count))
+            || !Gorilla::decodeValues(segment.values[static_cast<int>(channel)], QSpan<double>(series.values.data(), segment.count)))
+        {
+            qDebug() << "TelemetryArchive: Skipping a corrupt segment at" << segment.firstTimeUs;
+            series = TelemetrySeries();
+        }
+    });
+
+    TelemetrySeries result;
+    for (const TelemetrySeries &series : std::as_const(decoded))
+    {
+        const auto begin = std::lower_bound(series.timestampsUs.cbegin(), series.timestampsUs.cend(), fromUs);
+        const auto end = std::upper_bound(begin, series.timestampsUs.cend(), toUs);
+        const qsizetype first = begin - series.timestampsUs.cbegin();
+        const qsizetype count = end - begin;
+        result.timestampsUs.append(series.timestampsUs.sliced(first, count));
+        result.values.append(series.values.sliced(first, count));
+    }
+    return result;
+}
+
+bool TelemetryArchive::writeHeader(QIODevice &device)
+{
+    char header[FileHeaderSize];
+    std::memcpy(header, FileMagic, sizeof(FileMagic));
+    qToLittleEndian<quint32>(Version, header + 8);
+    qToLittleEndian<quint32>(TelemetryChannelCount, header + 12);
+    return device.write(header, FileHeaderSize) == FileHeaderSize;
+}
+
+bool TelemetryArchive::writeSegment(QIODevice &device, const Segment &segment)
+{
+    char header[SegmentHeaderSize];
+    std::memcpy(header, SegmentMagic, sizeof(SegmentMagic));
+    qToLittleEndian<quint32>(quint32(segment.count), header + 4);
+    qToLittleEndian<qint64>(segment.firstTimeUs, header + 8);
+    qToLittleEndian<qint64>(segment.lastTimeUs, header + 16);
+    for (int i = 0; i < BlockCount; ++i)
+    {
+        qToLittleEndian<quint32>(quint32(block(segment, i).size()), header + 24 + i * 4);
+    }
+
+    if (device.write(header, SegmentHeaderSize) != SegmentHeaderSize)
+    {
+        return false;
+    }
+    for (int i = 0; i < BlockCount; ++i)
+    {
+        if (device.write(block(segment, i)) != block(segment, i).size())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TelemetryArchive::save(QIODevice &device) const
+{
+    QReadLocker locker(&m_lock);
+    if (!writeHeader(device))
+    {
+        return false;
+    }
+    for (const Segment &segment : m_segments)
+    {
+        if (!writeSegment(device, segment))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TelemetryArchive::load(QIODevice &device, QString *error)
+{
+    auto fail = [error](const QString &message)
+    {
+        if (error)
+        {
+            *error = message;
+        }
+        return false;
+    };
+
+    const QByteArray fileHeader = device.read(FileHeaderSize);
+    if (fileHeader.size() != FileHeaderSize || std::memcmp(fileHeader.constData(), FileMagic, sizeof(FileMagic)) != 0
+        || qFromLittleEndian<quint32>(fileHeader.constData() + 8) != Version
+        || qFromLittleEndian<quint32>(fileHeader.constData() + 12) != quint32(TelemetryChannelCount))
+    {
+        return fail(QStringLiteral("Not a telemetry archive of version %1").arg(Version));
+    }
+
+    QList<Segment> segments;
+    qint64 bytes = 0;
+    qint64 samples = 0;
+    while (!device.atEnd())
+    {
+        const QByteArray header = device.read(SegmentHeaderSize);
+        if (header.size() != SegmentHeaderSize || std::memcmp(header.constData(), SegmentMagic, sizeof(SegmentMagic)) != 0)
+        {
+            return fail(QStringLiteral("Corrupt segment header after %1 samples").arg(samples));
+        }
+
+        Segment segment;
+        segment.count = qint32(qFromLittleEndian<quint32>(header.constData() + 4));
+        segment.firstTimeUs = qFromLittleEndian<qint64>(header.constData() + 8);
+        segment.lastTimeUs = qFromLittleEndian<qint64>(header.constData() + 16);
+        for (int i = 0; i < BlockCount; ++i)
+        {
+            const qint64 size = qFromLittleEndian<quint32>(header.constData() + 24 + i * 4);
+            block(segment, i) = device.read(size);
+            if (block(segment, i).size() != size)
+            {
+                return fail(QStringLiteral("Truncated segment after %1 samples").arg(samples));
+            }
+        }
+
+        // Every timestamp takes at least one bit, a count the times block cannot hold is corrupt and
+        // must not reach the decode buffers
+        if (segment.count <= 0 || qint64(segment.count) > 8 * qint64(segment.times.size()))
+        {
+            return fail(QStringLiteral("Corrupt sample count after %1 samples").arg(samples));
+        }
+
+        bytes += segment.bytes();
+        samples += segment.count;
+        segments.append(std::move(segment));
+    }
+
+    QWriteLocker locker(&m_lock);
+    m_segments = std::move(segments);
+    m_bytes = bytes;
+    m_samples = samples;
+    dropOldest();
+    return true;
+}
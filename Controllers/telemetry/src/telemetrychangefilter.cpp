@@ -0,0 +1,78 @@
+#include "../include/telemetrychangefilter.h"
+
+TelemetryChangeFilter::TelemetryChangeFilter()
+    : m_pendingCount(0)
+{
+    for (const TelemetryChannelInfo &channel : telemetryChannels())
+    {
+        m_channels[static_cast<int>(channel.channel)].policy = channel.defaultPolicy;
+    }
+}
+
+void TelemetryChangeFilter::setPolicy(TelemetryChannel channel, const TelemetryNotifyPolicy &policy)
+{
+    m_channels[static_cast<int>(channel)].policy = policy;
+}
+
+TelemetryNotifyPolicy TelemetryChangeFilter::policy(TelemetryChannel channel) const
+{
+    return m_channels[static_cast<int>(channel)].policy;
+}
+
+bool TelemetryChangeFilter::apply(const TelemetryFrame &raw, TelemetryFrame &published, qint64 nowMs)
+{
+    bool changed = false;
+    m_pendingCount = 0;
+
+    for (const TelemetryChannelInfo &channel : telemetryChannels())
+    {
+        ChannelState &state = m_channels[static_cast<int>(channel.channel)];
+        state.pending = false;
+
+        const double value = channel.read(raw);
+        const double current = channel.read(published);
+        if (channel.equal(current, value))
+        {
+            continue;
+        }
+
+        // Inside the band: jitter around the shown value, a reversal needs the extra hysteresis margin
+        const double delta = value - current;
+        const int direction = delta > 0.0 ? 1 : -1;
+        double threshold = state.policy.deadband;
+        if (state.direction != 0 && direction != state.direction)
+        {
+            threshold += state.policy.hysteresis;
+        }
+        if (threshold > 0.0 && qAbs(delta) <= threshold)
+        {
+            continue;
+        }
+
+        // Real change, but too soon after the previous one, keep it for a later frame
+        if (state.lastNotifyMs >= 0 && nowMs - state.lastNotifyMs < state.policy.minIntervalMs)
+        {
+            state.pending = true;
+            ++m_pendingCount;
+            continue;
+        }
+
+        channel.write(published, value);
+        state.lastNotifyMs = nowMs;
+        state.direction = direction;
+        changed = true;
+    }
+
+    return changed;
+}
+
+void TelemetryChangeFilter::reset()
+{
+    for (ChannelState &state : m_channels)
+    {
+        state.lastNotifyMs = -1;
+        state.direction = 0;
+        state.pending = false;
+    }
+    m_pendingCount = 0;
+}
@@ -0,0 +1,77 @@
+#include "../include/telemetrychannels.h"
+#include <QtGlobal>
+#include <type_traits>
+
+namespace
+{
+template <auto Member>
+double readMember(const TelemetryFrame &frame)
+{
+    return static_cast<double>(frame.*Member);
+}
+
+template <auto Member>
+void writeMember(TelemetryFrame &frame, double value)
+{
+    using Type = std::remove_reference_t<decltype(frame.*Member)>;
+    frame.*Member = static_cast<Type>(value);
+}
+
+template <auto Member>
+constexpr TelemetryChannelInfo makeChannel(TelemetryChannel channel, const char *name, const char *unit, TelemetryChannelInfo::Compare compare,
+                                           double deadband = 0.0, double hysteresis = 0.0, int minIntervalMs = 0)
+{
+    return TelemetryChannelInfo{channel, name, unit, &readMember<Member>, &writeMember<Member>, compare,
+                                TelemetryNotifyPolicy{deadband, hysteresis, minIntervalMs}};
+}
+
+using Compare = TelemetryChannelInfo::Compare;
+
+// Default notify policies filter sensor noise in the last digit, pedals notify every step.
+// GPS uses ~0.1 m so the track stays smooth, the battery level reports at most once per second.
+const std::array<TelemetryChannelInfo, TelemetryChannelCount> channelTable = {{
+    makeChannel<&TelemetryFrame::speed>(TelemetryChannel::Speed, "speed", "km/h", Compare::Fuzzy, 0.1, 0.05),
+    makeChannel<&TelemetryFrame::rpm>(TelemetryChannel::Rpm, "rpm", "rpm", Compare::Exact, 10.0, 5.0),
+    makeChannel<&TelemetryFrame::accPedal>(TelemetryChannel::AccPedal, "accPedal", "%", Compare::Exact),
+    makeChannel<&TelemetryFrame::brakePedal>(TelemetryChannel::BrakePedal, "brakePedal", "%", Compare::Exact),
+    makeChannel<&TelemetryFrame::encoderAngle>(TelemetryChannel::EncoderAngle, "encoderAngle", "deg", Compare::Fuzzy, 0.1, 0.05),
+    makeChannel<&TelemetryFrame::temperature>(TelemetryChannel::Temperature, "temperature", "degC", Compare::Fuzzy, 0.1, 0.05, 250),
+    makeChannel<&TelemetryFrame::batteryLevel>(TelemetryChannel::BatteryLevel, "batteryLevel", "%", Compare::Exact, 0.0, 1.0, 1000),
+    makeChannel<&TelemetryFrame::gpsLongitude>(TelemetryChannel::GpsLongitude, "gpsLongitude", "deg", Compare::Exact, 1e-6),
+    makeChannel<&TelemetryFrame::gpsLatitude>(TelemetryChannel::GpsLatitude, "gpsLatitude", "deg", Compare::Exact, 1e-6),
+    makeChannel<&TelemetryFrame::speedFL>(TelemetryChannel::SpeedFL, "speedFL", "km/h", Compare::Exact, 1.0),
+    makeChannel<&TelemetryFrame::speedFR>(TelemetryChannel::SpeedFR, "speedFR", "km/h", Compare::Exact, 1.0),
+    makeChannel<&TelemetryFrame::speedBL>(TelemetryChannel::SpeedBL, "speedBL", "km/h", Compare::Exact, 1.0),
+    makeChannel<&TelemetryFrame::speedBR>(TelemetryChannel::SpeedBR, "speedBR", "km/h", Compare::Exact, 1.0),
+    makeChannel<&TelemetryFrame::lateralG>(TelemetryChannel::LateralG, "lateralG", "g", Compare::Fuzzy, 0.01, 0.005),
+    makeChannel<&TelemetryFrame::longitudinalG>(TelemetryChannel::LongitudinalG, "longitudinalG", "g", Compare::Fuzzy, 0.01, 0.005),
+}};
+}
+
+bool TelemetryChannelInfo::equal(double a, double b) const
+{
+    if (compare == Compare::Exact)
+    {
+        return a == b;
+    }
+
+    // qFuzzyCompare is relative and never matches zero against a non-zero value, so shift both by one
+    return qFuzzyCompare(1.0 + a, 1.0 + b);
+}
+
+const std::array<TelemetryChannelInfo, TelemetryChannelCount> &telemetryChannels()
+{
+    return channelTable;
+}
+
+const TelemetryChannelInfo *findTelemetryChannel(const QString &name)
+{
+    for (const TelemetryChannelInfo &channel : channelTable)
+    {
+        if (name == QLatin1String(channel.name))
+        {
+            return &channel;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,303 @@
+#include "../include/telemetrydecimator.h"
+#include <limits>
+
+namespace
+{
+// Bucket number of a time, rounding towards negative infinity
+qint64 bucketKey(qint64 timeUs, qint64 bucketUs)
+{
+    const qint64 key = timeUs / bucketUs;
+    return (timeUs % bucketUs < 0) ? key - 1 : key;
+}
+}
+
+TelemetryDecimator::TelemetryDecimator(TelemetryChannel channel, Mode mode)
+    : m_channel(channel),
+    m_mode(mode),
+    m_windowUs(10000000),
+    m_width(600),
+    m_bucketUs(m_windowUs / m_width),
+    m_stableCount(0),
+    m_generation(0),
+    m_nextIndex(0),
+    m_historyStart(0),
+    m_primed(false)
+{
+}
+
+void TelemetryDecimator::setMode(Mode mode)
+{
+    if (m_mode != mode)
+    {
+        m_mode = mode;
+        reset();
+    }
+}
+
+void TelemetryDecimator::setWindow(qint64 windowUs)
+{
+    windowUs = qMax<qint64>(windowUs, 1000);
+    if (m_windowUs != windowUs)
+    {
+        m_windowUs = windowUs;
+        m_bucketUs = qMax<qint64>(1, m_windowUs / m_width);
+        reset();
+    }
+}
+
+void TelemetryDecimator::setWidth(int pixels)
+{
+    pixels = qMax(pixels, 1);
+    if (m_width != pixels)
+    {
+        m_width = pixels;
+        m_bucketUs = qMax<qint64>(1, m_windowUs / m_width);
+        reset();
+    }
+}
+
+void TelemetryDecimator::reset()
+{
+    m_buckets.clear();
+    m_points.clear();
+    m_stableCount = 0;
+    m_primed = false;
+    ++m_generation;
+}
+
+bool TelemetryDecimator::update(const TelemetryHistory &history, qint64 nowUs)
+{
+    const qint64 fromUs = nowUs - m_windowUs;
+    const quint64 historyStart = history.start();
+    const TelemetryHistory::View available = history.all();
+
+    // Start over after a source change, after a reset, or if the ring overtook us
+    if (!m_primed || historyStart != m_historyStart || m_nextIndex < available.begin)
+    {
+        reset();
+        m_nextIndex = history.range(fromUs, std::numeric_limits<qint64>::max()).begin;
+        m_historyStart = historyStart;
+        m_primed = true;
+    }
+
+    bool changed = false;
+
+    if (available.end > m_nextIndex)
+    {
+        TelemetryHistory::View fresh;
+        fresh.begin = m_nextIndex;
+        fresh.end = available.end;
+
+        const TelemetryRingSpan<qint64> times = history.times(fresh);
+        const TelemetryRingSpan<double> values = history.values(m_channel, fresh);
+        for (qsizetype i = 0; i < times.size(); ++i)
+        {
+            ingest(history, fresh.begin + quint64(i), times.at(i), values.at(i));
+        }
+
+        if (!history.isValid(fresh))
+        {
+            // Lapped while reading, the next update rebuilds from what is left
+            reset();
+            return true;
+        }
+
+        m_nextIndex = fresh.end;
+        changed = true;
+    }
+
+    // Drop the columns that scrolled out on the left
+    const qint64 firstKey = bucketKey(fromUs, m_bucketUs);
+    while (!m_buckets.isEmpty() && m_buckets.constFirst().key < firstKey)
+    {
+        m_buckets.removeFirst();
+        changed = true;
+    }
+
+    if (changed)
+    {
+        buildPoints(history);
+    }
+    return changed;
+}
+
+void TelemetryDecimator::ingest(const TelemetryHistory &history, quint64 index, qint64 timeUs, double value)
+{
+    const TelemetryPoint point{timeUs, value};
+    const qint64 key = bucketKey(timeUs, m_bucketUs);
+
+    if (m_buckets.isEmpty() || key > m_buckets.constLast().key)
+    {
+        Bucket bucket;
+        bucket.key = key;
+        bucket.begin = index;
+        bucket.end = index;
+        bucket.first = point;
+        bucket.min = point;
+        bucket.max = point;
+        m_buckets.append(bucket);
+
+        // The previous bucket is complete now, so the one before it has both neighbours and is final
+        if (m_mode == Mode::Lttb && m_buckets.size() >= 3)
+        {
+            finalize(history, int(m_buckets.size()) - 3);
+        }
+    }
+
+    Bucket &bucket = m_buckets.last();
+    bucket.end = index + 1;
+    bucket.sumTimeUs += double(timeUs - bucket.first.timeUs);
+    bucket.sumValue += value;
+    bucket.last = point;
+    if (value < bucket.min.value)
+    {
+        bucket.min = point;
+    }
+    if (value > bucket.max.value)
+    {
+        bucket.max = point;
+    }
+}
+
+bool TelemetryDecimator::finalize(const TelemetryHistory &history, int bucketIndex)
+{
+    Bucket &bucket = m_buckets[bucketIndex];
+    if (bucket.finalized)
+    {
+        return true;
+    }
+
+    if (bucketIndex == 0)
+    {
+        bucket.selected = bucket.first;
+        bucket.finalized = true;
+        return true;
+    }
+
+    const Bucket &previous = m_buckets.at(bucketIndex - 1);
+    const TelemetryPoint anchor = previous.finalized ? previous.selected : previous.first;
+    const TelemetryPoint next = average(m_buckets.at(bucketIndex + 1));
+
+    bool valid = false;
+    const TelemetryPoint selected = selectLttb(history, bucket, anchor, next.timeUs, next.value, &valid);
+
+    bucket.selected = valid ? selected : bucket.first;
+    bucket.finalized = true;
+    return valid;
+}
+
+TelemetryPoint TelemetryDecimator::selectLttb(const TelemetryHistory &history, const Bucket &bucket, const TelemetryPoint &previous,
+                                              double nextTimeUs, double nextValue, bool *valid) const
+{
+    TelemetryHistory::View view;
+    view.begin = bucket.begin;
+    view.end = bucket.end;
+
+    const TelemetryRingSpan<qint64> times = history.times(view);
+    const TelemetryRingSpan<double> values = history.values(m_channel, view);
+
+    // Times relative to the anchor keep the products well inside double precision
+    const double ax = 0.0;
+    const double ay = previous.value;
+    const double cx = nextTimeUs - double(previous.timeUs);
+    const double cy = nextValue;
+
+    TelemetryPoint best = bucket.first;
+    double bestArea = -1.0;
+    for (qsizetype i = 0; i < times.size(); ++i)
+    {
+        const double bx = double(times.at(i) - previous.timeUs);
+        const double by = values.at(i);
+        const double area = qAbs((ax - cx) * (by - ay) - (ax - bx) * (cy - ay));
+        if (area > bestArea)
+        {
+            bestArea = area;
+            best.timeUs = times.at(i);
+            best.value = by;
+        }
+    }
+
+    *valid = history.isValid(view);
+    return best;
+}
+
+void TelemetryDecimator::buildPoints(const TelemetryHistory &history)
+{
+    m_points.clear();
+    m_stableCount = 0;
+    const int count = int(m_buckets.size());
+    if (count == 0)
+    {
+        return;
+    }
+
+    if (m_mode == Mode::MinMax)
+    {
+        m_points.reserve(2 * count + 1);
+        for (int i = 0; i < count; ++i)
+        {
+            const Bucket &bucket = m_buckets.at(i);
+            if (i == count - 1)
+            {
+                // Everything before the open bucket is final
+                m_stableCount = m_points.size();
+            }
+
+            const bool minFirst = bucket.min.timeUs <= bucket.max.timeUs;
+            const TelemetryPoint &a = minFirst ? bucket.min : bucket.max;
+            const TelemetryPoint &b = minFirst ? bucket.max : bucket.min;
+            m_points.append(a);
+            if (b.timeUs != a.timeUs || b.value != a.value)
+            {
+                m_points.append(b);
+            }
+        }
+
+        // End the line at the newest sample, not at the last extreme
+        const TelemetryPoint &last = m_buckets.constLast().last;
+        if (last.timeUs != m_points.constLast().timeUs)
+        {
+            m_points.append(last);
+        }
+        return;
+    }
+
+    m_points.reserve(count + 1);
+    for (int i = 0; i < count; ++i)
+    {
+        const Bucket &bucket = m_buckets.at(i);
+        if (bucket.finalized)
+        {
+            m_points.append(bucket.selected);
+            if (m_stableCount == m_points.size() - 1)
+            {
+                m_stableCount = m_points.size();
+            }
+        }
+        else if (i == 0)
+        {
+            m_points.append(bucket.first);
+        }
+        else if (i < count - 1)
+        {
+            // Newest complete bucket, its right neighbour is still filling so it is recomputed every frame
+            const TelemetryPoint next = average(m_buckets.at(i + 1));
+            bool valid = false;
+            m_points.append(selectLttb(history, bucket, m_points.constLast(), next.timeUs, next.value, &valid));
+        }
+
+        if (i == count - 1 && bucket.last.timeUs != m_points.constLast().timeUs)
+        {
+            m_points.append(bucket.last);
+        }
+    }
+}
+
+TelemetryPoint TelemetryDecimator::average(const Bucket &bucket)
+{
+    const double count = double(qMax<quint64>(1, bucket.end - bucket.begin));
+    TelemetryPoint point;
+    point.timeUs = bucket.first.timeUs + qint64(bucket.sumTimeUs / count);
+    point.value = bucket.sumValue / count;
+    return point;
+}
@@ -0,0 +1,229 @@
+#include "../include/telemetryhistory.h"
+
+namespace
+{
+// Samples per archived segment, one Gorilla block per column
+constexpr qsizetype ArchiveSegmentSamples = 4096;
+
+qsizetype roundUpToPowerOfTwo(qsizetype value)
+{
+    qsizetype result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+}
+
+TelemetryHistory::TelemetryHistory(qsizetype capacity)
+    : m_capacity(roundUpToPowerOfTwo(qMax<qsizetype>(capacity, 2))),
+    m_mask(quint64(m_capacity) - 1),
+    m_times(new std::atomic<qint64>[m_capacity]()),
+    m_values(new std::atomic<double>[m_capacity * TelemetryChannelCount]()),
+    m_lastTimeUs(0),
+    m_head(0),
+    m_start(0),
+    m_segmentSamples(qMin(ArchiveSegmentSamples, m_capacity / 2)),
+    m_archived(0),
+    m_segmentTimes(m_segmentSamples),
+    m_segmentValues(m_segmentSamples * TelemetryChannelCount)
+{
+    // One thread archives the segments in order
+    m_archivePool.setMaxThreadCount(1);
+}
+
+TelemetryHistory::~TelemetryHistory()
+{
+    m_archivePool.waitForDone();
+}
+
+void TelemetryHistory::append(const TelemetryFrame &frame)
+{
+    QMutexLocker locker(&m_appendMutex);
+
+    const quint64 index = m_head.load(std::memory_order_relaxed);
+    const quint64 slot = index & m_mask;
+
+    m_lastTimeUs = qMax(m_lastTimeUs, frame.timestampUs);
+    m_times[slot].store(m_lastTimeUs, std::memory_order_relaxed);
+
+    std::atomic<double> *column = m_values.get();
+    for (const TelemetryChannelInfo &channel : telemetryChannels())
+    {
+        column[slot].store(channel.read(frame), std::memory_order_relaxed);
+        column += m_capacity;
+    }
+
+    // Publish the sample, readers only look at indices below the head
+    m_head.store(index + 1, std::memory_order_release);
+
+    if ((index + 1) % quint64(m_segmentSamples) == 0)
+    {
+        m_archivePool.start([this]() { archiveSegments(); });
+    }
+}
+
+void TelemetryHistory::clear()
+{
+    QMutexLocker locker(&m_appendMutex);
+    m_start.store(m_head.load(std::memory_order_relaxed), std::memory_order_release);
+
+    // A segment being archived right now is appended before this gets the lock, and dropped with the rest
+    QMutexLocker archiveLocker(&m_archiveMutex);
+    m_archive.clear();
+    m_archived = m_head.load(std::memory_order_relaxed);
+}
+
+TelemetryHistory::View TelemetryHistory::all() const
+{
+    const quint64 head = m_head.load(std::memory_order_acquire);
+    const quint64 start = m_start.load(std::memory_order_acquire);
+
+    View view;
+    view.end = head;
+    // Leave out the oldest slot, it is the next one the writer overwrites
+    view.begin = qMax(start, head >= quint64(m_capacity) ? head - quint64(m_capacity) + 1 : 0);
+    return view;
+}
+
+TelemetryHistory::View TelemetryHistory::latest(qsizetype count) const
+{
+    View view = all();
+    if (count >= 0 && view.size() > count)
+    {
+        view.begin = view.end - quint64(count);
+    }
+    return view;
+}
+
+TelemetryHistory::View TelemetryHistory::range(qint64 fromUs, qint64 toUs) const
+{
+    View view = all();
+    const quint64 begin = lowerBound(view.begin, view.end, fromUs);
+    const quint64 end = lowerBound(begin, view.end, toUs);
+    view.begin = begin;
+    view.end = end;
+    return view;
+}
+
+TelemetryRingSpan<qint64> TelemetryHistory::times(const View &view) const
+{
+    return spans(m_times.get(), view);
+}
+
+TelemetryRingSpan<double> TelemetryHistory::values(TelemetryChannel channel, const View &view) const
+{
+    return spans(m_values.get() + static_cast<int>(channel) * m_capacity, view);
+}
+
+bool TelemetryHistory::frameAt(qint64 timeUs, TelemetryFrame &frame) const
+{
+    const View view = all();
+    View sample;
+    sample.end = lowerBound(view.begin, view.end, timeUs + 1);
+    if (sample.end == view.begin)
+    {
+        return false;
+    }
+    sample.begin = sample.end - 1;
+
+    const quint64 slot = sample.begin & m_mask;
+    frame = TelemetryFrame();
+    frame.timestampUs = m_times[slot].load(std::memory_order_relaxed);
+    const std::atomic<double> *column = m_values.get();
+    for (const TelemetryChannelInfo &channel : telemetryChannels())
+    {
+        channel.write(frame, column[slot].load(std::memory_order_relaxed));
+        column += m_capacity;
+    }
+    return isValid(sample);
+}
+
+bool TelemetryHistory::isValid(const View &view) const
+{
+    // The slot of index i is reused by index i + capacity, which the writer may be filling right now
+    const quint64 head = m_head.load(std::memory_order_acquire);
+    return view.begin + quint64(m_capacity) > head;
+}
+
+template <typename T>
+TelemetryRingSpan<T> TelemetryHistory::spans(const std::atomic<T> *column, const View &view) const
+{
+    TelemetryRingSpan<T> result;
+    if (view.isEmpty())
+    {
+        return result;
+    }
+
+    const qsizetype first = qsizetype(view.begin & m_mask);
+    const qsizetype size = qMin(view.size(), m_capacity);
+    const qsizetype firstSize = qMin(size, m_capacity - first);
+
+    result.first = QSpan<const std::atomic<T>>(column + first, firstSize);
+    result.second = QSpan<const std::atomic<T>>(column, size - firstSize);
+    return result;
+}
+
+quint64 TelemetryHistory::lowerBound(quint64 begin, quint64 end, qint64 timeUs) const
+{
+    // Timestamps are non-decreasing in index order, so a plain binary search works across the wrap
+    while (begin < end)
+    {
+        const quint64 middle = begin + (end - begin) / 2;
+        if (m_times[middle & m_mask].load(std::memory_order_relaxed) < timeUs)
+        {
+            begin = middle + 1;
+        }
+        else
+        {
+            end = middle;
+        }
+    }
+    return begin;
+}
+
+void TelemetryHistory::archiveSegments()
+{
+    QMutexLocker locker(&m_archiveMutex);
+
+    const quint64 head = m_head.load(std::memory_order_acquire);
+    const quint64 size = quint64(m_segmentSamples);
+    m_archived = qMax(m_archived, m_start.load(std::memory_order_acquire));
+    for (;;)
+    {
+        View view;
+        view.begin = m_archived;
+        view.end = (m_archived / size + 1) * size;
+        if (view.end > head)
+        {
+            break;
+        }
+
+        // Copy the segment out first, the codec reads plain columns
+        const qsizetype count = view.size();
+        const TelemetryRingSpan<qint64> segmentTimes = times(view);
+        for (qsizetype i = 0; i < count; ++i)
+        {
+            m_segmentTimes[i] = segmentTimes.at(i);
+        }
+        std::array<QSpan<const double>, TelemetryChannelCount> columns;
+        for (int channel = 0; channel < TelemetryChannelCount; ++channel)
+        {
+            const TelemetryRingSpan<double> segmentValues = values(static_cast<TelemetryChannel>(channel), view);
+            double *column = m_segmentValues.data() + channel * m_segmentSamples;
+            for (qsizetype i = 0; i < count; ++i)
+            {
+                column[i] = segmentValues.at(i);
+            }
+            columns[channel] = QSpan<const double>(column, count);
+        }
+
+        // A segment the writer lapped while it was copied is lost, the archive just has a gap there
+        if (isValid(view))
+        {
+            m_archive.append(TelemetryArchive::encode(QSpan<const qint64>(m_segmentTimes.constData(), count), columns));
+        }
+        m_archived = view.end;
+    }
+}
@@ -0,0 +1,103 @@
+#include "../include/telemetrystore.h"
+#include <QThread>
+#include <cstring>
+
+TelemetryStore::TelemetryStore()
+    : m_head(0)
+{
+    for (Slot &slot : m_slots)
+    {
+        slot.sequence.store(0, std::memory_order_relaxed);
+        for (std::atomic<quint64> &word : slot.words)
+        {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void TelemetryStore::write(const TelemetryFrame &frame)
+{
+    quint64 words[WordCount] = {};
+    std::memcpy(words, &frame, sizeof(TelemetryFrame));
+
+    // Every writer gets its own slot, so parser threads never wait for each other
+    const quint64 index = m_head.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = m_slots[index % SlotCount];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+
+    // Keep the data stores from being reordered before the odd sequence becomes visible
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int i = 0; i < WordCount; ++i)
+    {
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+
+    // Publishes the complete frame
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+TelemetryFrame TelemetryStore::read() const
+{
+    TelemetryFrame frame;
+    readSnapshot(frame);
+    return frame;
+}
+
+bool TelemetryStore::readIfNewer(quint64 &version, TelemetryFrame &frame) const
+{
+    if (this->version() == version)
+    {
+        return false;
+    }
+
+    version = readSnapshot(frame);
+    return true;
+}
+
+quint64 TelemetryStore::readSnapshot(TelemetryFrame &frame) const
+{
+    quint64 words[WordCount];
+
+    for (;;)
+    {
+        const quint64 head = m_head.load(std::memory_order_acquire);
+        if (head == 0)
+        {
+            // Nothing written yet
+            frame = TelemetryFrame();
+            return 0;
+        }
+
+        // Newest slot first, one still being written is skipped in favour of the one before it
+        const quint64 oldest = head > SlotCount ? head - SlotCount : 0;
+        for (quint64 index = head; index-- > oldest;)
+        {
+            const Slot &slot = m_slots[index % SlotCount];
+            const quint64 complete = 2 * index + 2;
+            if (slot.sequence.load(std::memory_order_acquire) != complete)
+            {
+                continue;
+            }
+
+            for (int i = 0; i < WordCount; ++i)
+            {
+                words[i] = slot.words[i].load(std::memory_order_relaxed);
+            }
+
+            // Order the data loads before the second sequence load
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (slot.sequence.load(std::memory_order_relaxed) == complete)
+            {
+                std::memcpy(&frame, words, sizeof(TelemetryFrame));
+
+                // A skipped newer slot keeps the version behind the head, so it is read once it is complete
+                return index + 1;
+            }
+        }
+
+        // Every slot is being written or the writers lapped the ring, both only last a few nanoseconds
+        QThread::yieldCurrentThread();
+    }
+}
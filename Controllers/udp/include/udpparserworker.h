@@ -4,10 +4,12 @@
 #include <QObject>
 #include <QRunnable>
 #include <QByteArray>
+#include <QByteArrayView>
 #include <QMutex>
 #include <QQueue>
 #include <QWaitCondition>
 #include <atomic>
+#include "../../telemetry/include/telemetryframe.h"
 
 /**
  * @brief The UdpParserWorker class parses UDP datagrams in a thread pool
@@ -29,6 +31,20 @@ public:
      */
     void run() override;
 
+    qsizetype queueDepth(); // Datagrams waiting to be parsed.
+    quint64 datagramsRejected() const { return m_datagramsRejected.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Decode the payload of one telemetry datagram, safe to call from any thread
+     *
+     * The receive time is left to the caller, e.g. the capture time when importing a pcap file.
+     * @param data The datagram payload
+     * @param frame Receives the decoded values
+     * @param error Set to a description if the payload is malformed
+     * @return True if the payload produced a frame
+     */
+    static bool parsePayload(QByteArrayView data, TelemetryFrame &frame, QString *error = nullptr);
+
 public slots:
     /**
      * @brief Queue a datagram for parsing
@@ -44,12 +60,9 @@ public slots:
 signals:
     /**
      * @brief Signal emitted when a datagram is successfully parsed
+     * @param frame The decoded telemetry values
      */
-    void datagramParsed(float speed, int rpm, int accPedal, int brakePedal,
-                        double encoderAngle, float temperature, int batteryLevel,
-                        double gpsLongitude, double gpsLatitude,
-                        int speedFL, int speedFR, int speedBL, int speedBR,
-                        double lateralG, double longitudinalG);
+    void datagramParsed(const TelemetryFrame &frame);
 
     /**
      * @brief Signal emitted when an error occurs during parsing
@@ -61,12 +74,14 @@ private:
     /**
      * @brief Parse a single datagram
      * @param data The datagram data to parse
+     * @return True if the datagram produced a frame
      */
-    void parseDatagram(const QByteArray &data);
+    bool parseDatagram(const QByteArray &data);
 
     bool m_debugMode;
     std::atomic<bool> m_running;
     std::atomic<quint64> m_datagramsParsed;
+    std::atomic<quint64> m_datagramsRejected;
 
     // Thread-safe queue for datagrams
     QQueue<QByteArray> m_queue;
@@ -12,7 +12,8 @@ UdpParserWorker::UdpParserWorker(bool debugMode, QObject *parent)
     : QObject(parent),
     m_debugMode(debugMode),
     m_running(true),
-    m_datagramsParsed(0)
+    m_datagramsParsed(0),
+    m_datagramsRejected(0)
 {
     setAutoDelete(true);
 }
@@ -79,7 +80,10 @@ void UdpParserWorker::run()
         }
 
         // Parse the datagram
-        parseDatagram(datagram);
+        if (!parseDatagram(datagram))
+        {
+            m_datagramsRejected.fetch_add(1, std::memory_order_relaxed);
+        }
     }
 
     if (m_debugMode)
@@ -99,6 +103,12 @@ void UdpParserWorker::queueDatagram(const QByteArray &data)
     m_queueCondition.wakeOne();
 }
 
+qsizetype UdpParserWorker::queueDepth()
+{
+    QMutexLocker locker(&m_queueMutex);
+    return m_queue.size();
+}
+
 void UdpParserWorker::stop()
 {
     m_running.store(false);
@@ -108,8 +118,45 @@ void UdpParserWorker::stop()
     m_queueCondition.wakeAll(); // wake up any thread that might be blocked waiting on the condition variable
 }
 
-void UdpParserWorker::parseDatagram(const QByteArray &data)
+bool UdpParserWorker::parseDatagram(const QByteArray &data)
 {
+    const qint64 receivedUs = telemetryTimestampUs();
+
+    TelemetryFrame frame;
+    QString error;
+    if (!parsePayload(data, frame, &error))
+    {
+        emit errorOccurred(error);
+        return false;
+    }
+    frame.timestampUs = receivedUs;
+
+    // Increment counter
+    m_datagramsParsed++;
+
+    // Emit signal with parsed data
+    emit datagramParsed(frame);
+
+    // Log debug info occasionally
+    if (m_debugMode && m_datagramsParsed % 1000 == 0)
+    {
+        qDebug() << "Parser" << QThread::currentThreadId()
+        << "has processed" << m_datagramsParsed << "datagrams";
+    }
+    return true;
+}
+
+bool UdpParserWorker::parsePayload(QByteArrayView data, TelemetryFrame &frame, QString *error)
+{
+    auto fail = [error](const QString &message)
+    {
+        if (error)
+        {
+            *error = message;
+        }
+        return false;
+    };
+
     try
     {
         // Convert datagram data to string and split by comma
@@ -126,21 +173,21 @@ void UdpParserWorker::parseDatagram(const QByteArray &data)
             bool okLateralG = false, okLongitudinalG = false;
 
             // Parse values
-            float speed = parts[0].toFloat(&okSpeed);
-            int rpm = parts[1].toInt(&okRpm);
-            int accPedal = parts[2].toInt(&okAcc);
-            int brakePedal = parts[3].toInt(&okBrake);
-            double encoderAngle = parts[4].toDouble(&okAngle);
-            float temperature = parts[5].toFloat(&okTemp);
-            int batteryLevel = parts[6].toInt(&okBattery);
-            double gpsLongitude = parts[7].toDouble(&okGpsLon);
-            double gpsLatitude = parts[8].toDouble(&okGpsLat);
-            int speedFL = parts[9].toInt(&okWSFL);
-            int speedFR = parts[10].toInt(&okWSFR);
-            int speedBL = parts[11].toInt(&okWSBL);
-            int speedBR = parts[12].toInt(&okWSBR);
-            double lateralG = parts[13].toDouble(&okLateralG);
-            double longitudinalG = parts[14].toDouble(&okLongitudinalG);
+            frame.speed = parts[0].toFloat(&okSpeed);
+            frame.rpm = parts[1].toInt(&okRpm);
+            frame.accPedal = parts[2].toInt(&okAcc);
+            frame.brakePedal = parts[3].toInt(&okBrake);
+            frame.encoderAngle = parts[4].toDouble(&okAngle);
+            frame.temperature = parts[5].toFloat(&okTemp);
+            frame.batteryLevel = parts[6].toInt(&okBattery);
+            frame.gpsLongitude = parts[7].toDouble(&okGpsLon);
+            frame.gpsLatitude = parts[8].toDouble(&okGpsLat);
+            frame.speedFL = parts[9].toInt(&okWSFL);
+            frame.speedFR = parts[10].toInt(&okWSFR);
+            frame.speedBL = parts[11].toInt(&okWSBL);
+            frame.speedBR = parts[12].toInt(&okWSBR);
+            frame.lateralG = parts[13].toDouble(&okLateralG);
+            frame.longitudinalG = parts[14].toDouble(&okLongitudinalG);
 
             // Check if all values were parsed successfully
             if (okSpeed && okRpm && okAcc && okBrake && okAngle && okTemp &&
@@ -148,42 +195,24 @@ void UdpParserWorker::parseDatagram(const QByteArray &data)
                 okWSFL && okWSFR && okWSBL && okWSBR &&
                 okLateralG && okLongitudinalG)
             {
-
-                // Increment counter
-                m_datagramsParsed++;
-
-                // Emit signal with parsed data
-                emit datagramParsed(
-                    speed, rpm, accPedal, brakePedal,
-                    encoderAngle, temperature, batteryLevel,
-                    gpsLongitude, gpsLatitude,
-                    speedFL, speedFR, speedBL, speedBR,
-                    lateralG, longitudinalG);
-
-                // Log debug info occasionally
-                if (m_debugMode && m_datagramsParsed % 1000 == 0)
-                {
-                    qDebug() << "Parser" << QThread::currentThreadId()
-                    << "has processed" << m_datagramsParsed << "datagrams";
-                }
+                return true;
             }
             else
             {
-                emit errorOccurred("Failed to parse some values in datagram");
+                return fail("Failed to parse some values in datagram");
             }
         }
         else
         {
-            emit errorOccurred(QString("Datagram has incorrect format (expected 15+ parts, got %1)").arg(parts.size()));
+            return fail(QString("Datagram has incorrect format (expected 15+ parts, got %1)").arg(parts.size()));
         }
     }
     catch (const std::exception &e)
     {
-        emit errorOccurred(QString("Exception during parsing: %1").arg(e.what()));
+        return fail(QString("Exception during parsing: %1").arg(e.what()));
     }
     catch (...)
     {
-        emit errorOccurred("Unknown exception during parsing");
+        return fail("Unknown exception during parsing");
     }
 }
-
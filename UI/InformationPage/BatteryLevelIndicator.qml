@@ -1,4 +1,5 @@
 import QtQuick 2.15
+import GUI.Charts
 
 Item {
     id: root
@@ -20,7 +21,7 @@ Item {
         Text {
             id: batteryText
             text: root.batteryLevel + "%"
-            color: batteryIndicator.getColorForBattery(root.batteryLevel)
+            color: batteryBars.color
             font {
                 pixelSize: 20 * root.scaleFactor
                 bold: true
@@ -31,37 +32,17 @@ Item {
             id: batteryIndicator
             width: 200 * root.scaleFactor
             height: 100 * root.scaleFactor
-            function getColorForBattery(level) {
-                var r = Math.floor(255 * (1 - level / 100));
-                var g = Math.floor(255 * (level / 100));
-                var b = 0;
-                return "#" + ((1 << 24) + (r << 16) + (g << 8) + b).toString(16).slice(1).toUpperCase();
-            }
-            Canvas {
-                id: batteryCanvas
-                anchors.fill: parent
-                anchors.centerIn: parent
-                onPaint: {
-                    var ctx = getContext("2d");
-                    var width = batteryCanvas.width / 5;
-                    var height = batteryCanvas.height;
-                    var barHeight = (height / 10);
-                    var numberOfBars = 10;
-                    ctx.clearRect(0, 0, width, height);
-                    var barColor = batteryIndicator.getColorForBattery(root.batteryLevel);
-                    for (var i = 0; i < numberOfBars; i++) {
-                        var yPosition = i * barHeight;
-                        ctx.fillStyle = (i < Math.ceil((100 - root.batteryLevel) / 10)) ? "black" : barColor;
-                        ctx.fillRect(0, yPosition, width, barHeight - 2);
-                    }
-                }
-            }
-        }
-        Connections {
-            target: communicationManager
-            onBatteryLevelChanged: {
-                batteryLevel = communicationManager ? communicationManager.batteryLevel : 0;
-                batteryCanvas.requestPaint();
+            BarGauge {
+                id: batteryBars
+                width: parent.width / 5
+                height: parent.height
+                value: root.batteryLevel
+                maximumValue: 100
+                segments: 10
+                spacing: 2
+                inactiveColor: "black"
+                emptyColor: "#FF0000"
+                fullColor: "#00FF00"
             }
         }
     }
@@ -2,6 +2,8 @@ import QtQuick 2.15
 import QtQuick.Controls 2.15
 import QtLocation
 import QtPositioning
+import GUI.Charts
+import GUI.Telemetry
 
 Rectangle {
     id: gpsDisplay
@@ -14,10 +16,6 @@ Rectangle {
     property real currentLongitude: gpsLongitude
     property real currentLatitude: gpsLatitude
 
-    // Add a property list to store path coordinates
-    property var pathCoordinates: []
-    property bool firstCoordinateReceived: false
-
     // Add error handling for invalid coordinates
     function isValidCoordinate(lat, lon) {
         return !isNaN(lat) && !isNaN(lon) &&
@@ -25,21 +23,17 @@ Rectangle {
                lon >= -180 && lon <= 180;
     }
 
-    // Modified function to update path
-    function updatePath(lat, lon) {
-        var newCoord = QtPositioning.coordinate(lat, lon);
-
-        if (!firstCoordinateReceived) {
-            firstCoordinateReceived = true;
-            pathCoordinates = [newCoord];
-        } else {
-            // Create a new array with all existing coordinates plus the new one
-            var newPath = pathCoordinates.slice(); // Create a copy of the existing array
-            newPath.push(newCoord);
-            pathCoordinates = newPath; // Assign the new array to trigger update
-        }
-        // Force update of the polyline
-        pathLine.path = pathCoordinates;
+    // Simplified track of every fix in the history; the polyline is edited in place,
+    // only a thinned or cleared track is assigned as a whole
+    GpsTrack {
+        id: track
+        source: communicationManager
+        tolerance: 1.0
+        minDistance: 0.5
+        maxVertices: 5000
+        onVertexAppended: (coordinate) => pathLine.addCoordinate(coordinate)
+        onLastVertexMoved: (coordinate) => pathLine.replaceCoordinate(pathLine.pathLength() - 1, coordinate)
+        onPathReset: pathLine.path = track.path()
     }
 
     Map {
@@ -53,12 +47,28 @@ Rectangle {
                 name: "osm.useragent"
                 value: "MyGPSApp"
             }
+            // Offline tiles from the local tile server when one is running
             PluginParameter {
                 name: "osm.mapping.custom.host"
-                value: "https://tile.openstreetmap.org/"
+                value: tileServer.running ? tileServer.url : "https://tile.openstreetmap.org/"
+            }
+            PluginParameter {
+                name: "osm.mapping.providersrepository.disabled"
+                value: tileServer.running
             }
         }
 
+        // The custom host is only used by the custom map type
+        activeMapType: {
+            if (tileServer.running) {
+                for (var i = 0; i < supportedMapTypes.length; ++i) {
+                    if (supportedMapTypes[i].style === MapType.CustomMap)
+                        return supportedMapTypes[i];
+                }
+            }
+            return supportedMapTypes[0];
+        }
+
 
 
         // Modified MapPolyline for better visibility
@@ -66,7 +76,6 @@ Rectangle {
             id: pathLine
             line.width: 4
             line.color: "blue"
-            path: gpsDisplay.pathCoordinates
         }
 
         MapQuickItem {
@@ -106,43 +115,36 @@ Rectangle {
             text: "Clear"
             width: 50
             height: 20
-            onClicked: {
-                gpsDisplay.pathCoordinates = [];
-                gpsDisplay.firstCoordinateReceived = false;
-                pathLine.path = [];
-            }
+            onClicked: track.clear()
         }
     }
 
+    // Glide over one feed interval, so the marker moves smoothly between 5 Hz updates
     Behavior on currentLongitude {
-        NumberAnimation { duration: 25; easing.type: Easing.InOutQuad }
+        NumberAnimation { duration: 200; easing.type: Easing.Linear }
     }
     Behavior on currentLatitude {
-        NumberAnimation { duration: 25; easing.type: Easing.InOutQuad }
+        NumberAnimation { duration: 200; easing.type: Easing.Linear }
     }
 
-    Connections {
-        target: communicationManager
-        function onGpsLongitudeChanged() {
-            if (isValidCoordinate(communicationManager.gpsLatitude , communicationManager.gpsLongitude)) {
-                gpsDisplay.gpsLongitude = communicationManager.gpsLongitude;
-                currentLongitude = communicationManager.gpsLongitude;
-                currentLatitude = communicationManager.gpsLatitude;
-                var newCoord = QtPositioning.coordinate(communicationManager.gpsLatitude, communicationManager.gpsLongitude);
-                map.center = newCoord;
-                // Only update path when both coordinates have changed
-                updatePath(communicationManager.gpsLatitude, communicationManager.gpsLongitude);
-            }
-        }
-        function onGpsLatitudeChanged() {
-            if (isValidCoordinate(communicationManager.gpsLatitude , communicationManager.gpsLongitude)) {
-                gpsDisplay.gpsLatitude = communicationManager.gpsLatitude;
-                currentLongitude = communicationManager.gpsLongitude;
-                currentLatitude = communicationManager.gpsLatitude;
-                var newCoord = QtPositioning.coordinate(communicationManager.gpsLatitude, communicationManager.gpsLongitude);
-                map.center = newCoord;
-                // Only update path when both coordinates have changed
-                updatePath(communicationManager.gpsLatitude, communicationManager.gpsLongitude);
+    // Re-centering the map is expensive, a few times per second is enough to follow the car
+    TelemetryFeed {
+        id: gpsFeed
+        source: communicationManager
+        maxRate: 5
+        priority: TelemetryFeed.Low
+        onUpdated: {
+            var lat = gpsFeed.gpsLatitude;
+            var lon = gpsFeed.gpsLongitude;
+            if (lat === gpsDisplay.gpsLatitude && lon === gpsDisplay.gpsLongitude)
+                return;
+            if (isValidCoordinate(lat, lon)) {
+                gpsDisplay.gpsLongitude = lon;
+                gpsDisplay.gpsLatitude = lat;
+                currentLongitude = lon;
+                currentLatitude = lat;
+                map.center = QtPositioning.coordinate(lat, lon);
+                tileServer.updatePosition(lat, lon, Math.round(map.zoomLevel));
             }
         }
     }
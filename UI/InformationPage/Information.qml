@@ -1,5 +1,6 @@
 import QtQuick 2.15
-import QtQuick.Shapes
+import GUI.Charts
+import GUI.Telemetry
 import "../StatusBar"
 
 Rectangle {
@@ -14,14 +15,38 @@ Rectangle {
     property real maxLateralG: 3.5  // Maximum lateral G-force (cornering)
     property real maxLongitudinalG: 2.0  // Maximum longitudinal G-force (acceleration)
     property real maxBrakingG: 3.5  // Maximum braking G-force
-    property real xDiagram: (communicationManager.lateralG / maxLateralG) * (ggImage.width / 2 - 20)
-    property real yDiagram: (communicationManager.longitudinalG / maxLongitudinalG) * (ggImage.height / 2 - 20)
+    property real xDiagram: (imuFeed.lateralG / maxLateralG) * (ggImage.width / 2 - 20)
+    property real yDiagram: (imuFeed.longitudinalG / maxLongitudinalG) * (ggImage.height / 2 - 20)
 
     color: "#1A3438"
     radius: 40
     border.color: "#A6F1E0"
     border.width: 5
 
+    // Each group of widgets gets the telemetry at the rate it is worth redrawing at
+    TelemetryFeed {
+        id: gaugeFeed
+        source: communicationManager
+        priority: TelemetryFeed.High
+    }
+    TelemetryFeed {
+        id: imuFeed
+        source: communicationManager
+        maxRate: 20
+    }
+    TelemetryFeed {
+        id: wheelFeed
+        source: communicationManager
+        maxRate: 10
+        priority: TelemetryFeed.Low
+    }
+    TelemetryFeed {
+        id: statusFeed
+        source: communicationManager
+        maxRate: 10
+        priority: TelemetryFeed.Low
+    }
+
         /******* Status Bar *********/
 
     StatusBar {
@@ -69,7 +94,7 @@ Rectangle {
             }
             SteeringWheel {
                 id: steeringWheel
-                encoderAngle : communicationManager ? communicationManager.encoderAngle : 0
+                encoderAngle : gaugeFeed.encoderAngle
                 anchors.centerIn: parent
             }
         }
@@ -104,7 +129,7 @@ Rectangle {
                 id: fl
                 wheelPos: "FL"
                 scaleFactor : 1.1
-                currentSpeed: communicationManager ? communicationManager.speedFL : 0
+                currentSpeed: wheelFeed.speedFL
                 anchors {
                     top : car.top
                     left : proximityRect.left
@@ -116,7 +141,7 @@ Rectangle {
                 id: fr
                 wheelPos: "FR"
                 scaleFactor : 1.1
-                currentSpeed: communicationManager ? communicationManager.speedFR : 0
+                currentSpeed: wheelFeed.speedFR
                 anchors {
                     top : car.top
                     right : proximityRect.right
@@ -129,7 +154,7 @@ Rectangle {
                 id: bl
                 wheelPos: "BL"
                 scaleFactor : 1.1
-                currentSpeed: communicationManager ? communicationManager.speedBL : 0
+                currentSpeed: wheelFeed.speedBL
                 anchors {
                     bottom : car.bottom
                     left : proximityRect.left
@@ -142,7 +167,7 @@ Rectangle {
                 id: br
                 wheelPos: "BR"
                 scaleFactor : 1.1
-                currentSpeed: communicationManager ? communicationManager.speedBR : 0
+                currentSpeed: wheelFeed.speedBR
                 anchors {
                     bottom : car.bottom
                     right : proximityRect.right
@@ -180,7 +205,7 @@ Rectangle {
 
         Speedometer {
             id: speedometer
-            speed: communicationManager ? communicationManager.speed : 0
+            speed: gaugeFeed.speed
             anchors {
                 left: parent.left
                 leftMargin: -20
@@ -191,7 +216,7 @@ Rectangle {
 
         RpmMeter {
             id: rpmMeter
-            rpm: communicationManager ? communicationManager.rpm : 0
+            rpm: gaugeFeed.rpm
             anchors {
                 left: speedometer.right
                 right: parent.right
@@ -202,6 +227,37 @@ Rectangle {
     }
 
 
+    /******** Speed / RPM Trend *******/
+
+    Rectangle {
+        id: trendRect
+        height: 50
+        color: "#09122C"
+        border.color: "#D84040"
+        border.width: 2
+        radius: 10
+
+        anchors {
+            top: metersScreen.bottom
+            topMargin: 8
+            left: pedalTempRect.left
+            right: pedalTempRect.right
+        }
+
+        StripChart {
+            id: trendChart
+            anchors.fill: parent
+            anchors.margins: 4
+            source: communicationManager
+            windowSeconds: 30
+            series: [
+                { channel: "speed", color: "#4CAF50", minimum: 0, maximum: 240 },
+                { channel: "rpm", color: "#FFC107", minimum: 0, maximum: 8000 }
+            ]
+        }
+    }
+
+
     /******** Battery , Accelator , Braker Pedal Readings *************/
 
     Rectangle {
@@ -223,7 +279,7 @@ Rectangle {
 
         AcceleratorPedal {
             id: acceleratorPedal
-            pedalPosition:  communicationManager ? communicationManager.accPedal : 0
+            pedalPosition:  gaugeFeed.accPedal
             anchors {
                 bottom: parent.bottom
                 left: parent.left
@@ -233,7 +289,7 @@ Rectangle {
 
         BrakePadel {
             id: brakePedal
-            pedalPosition: communicationManager ? communicationManager.brakePedal : 0
+            pedalPosition: gaugeFeed.brakePedal
             anchors {
                 bottom: parent.bottom
                 left: acceleratorPedal.right
@@ -243,7 +299,7 @@ Rectangle {
 
         TemperatureIndicator {
             id: temperatureIndicator
-            temperature: communicationManager ? communicationManager.temperature : 0
+            temperature: statusFeed.temperature
             anchors {
                 top: parent.top
                 left: parent.left
@@ -255,7 +311,7 @@ Rectangle {
         BatteryLevelIndicator {
             id: batteryLevelIndicator
             scaleFactor: parent.height / 222.22
-            batteryLevel: communicationManager ? communicationManager.batteryLevel : 0
+            batteryLevel: statusFeed.batteryLevel
             anchors {
                 right: parent.right
                 top: parent.top
@@ -308,28 +364,20 @@ Rectangle {
 
 
 
-            Shape {
-                id: pathShape
+            // Density heatmap of the whole session with a fading trail of the last seconds,
+            // counter-rotated so lateral G runs left to right and longitudinal G upwards
+            GGDiagram {
+                id: ggDiagram
                 anchors.fill: parent
-                smooth: true
-                antialiasing: true
-
-                ShapePath {
-                    id: movementPath
-                    strokeWidth: 2
-                    strokeColor: "white"
-                    strokeStyle: ShapePath.SolidLine
-                    fillColor: "transparent"
-
-                    // Start at the center point
-                    startX: ggImage.centerX
-                    startY: ggImage.centerY
-
-                    // Create path segments using a dynamic PathPolyline
-                    PathPolyline {
-                        id: polyline
-                    }
-                }
+                rotation: 90
+                source: communicationManager
+                maxLateralG: root.maxLateralG
+                maxLongitudinalG: root.maxLongitudinalG
+                margin: 20
+                trailLength: 250
+                trailInterval: 20
+                trailColor: "white"
+                z: 1
             }
 
             // Add the point marker
@@ -365,28 +413,6 @@ Rectangle {
             }
         }
 
-        // Point tracking for line drawing
-        Timer {
-            id: pathTracker
-            interval: 100  // Update every 100ms
-            running: true
-            repeat: true
-
-            property var pathPoints: []
-
-            onTriggered: {
-                // Calculate the center point of the marker with limits
-                const pointX = Math.max(0, Math.min(ggImage.width, pointImage.x + pointImage.width/2));
-                const pointY = Math.max(0, Math.min(ggImage.height, pointImage.y + pointImage.height/2));
-
-                // Add point to the path
-                pathPoints.push(Qt.point(pointX, pointY));
-
-                // Update the polyline path
-                polyline.path = pathPoints;
-            }
-        }
-
         // Add acceleration text displays
         Row {
             anchors {
@@ -423,15 +449,12 @@ Rectangle {
                     hoverEnabled: true
                     onEntered: parent.color = "#808080"
                     onExited: parent.color = "#636363"
-                    onClicked: {
-                        pathTracker.pathPoints = []
-                        polyline.path = []
-                    }
+                    onClicked: ggDiagram.clear()
                 }
             }
 
             Text {
-                text: "Lateral G: " + communicationManager.lateralG.toFixed(2) + " G"
+                text: "Lateral G: " + imuFeed.lateralG.toFixed(2) + " G"
                 color: "white"
                 font {
                     family: "Arial"
@@ -441,7 +464,7 @@ Rectangle {
             }
 
             Text {
-                text: "Longitudinal G: " + communicationManager.longitudinalG.toFixed(2) + " G"
+                text: "Longitudinal G: " + imuFeed.longitudinalG.toFixed(2) + " G"
                 color: "white"
                 font {
                     family: "Arial"
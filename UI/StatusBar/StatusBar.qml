@@ -1,4 +1,5 @@
 import QtQuick
+import QtQuick.Controls
 
 Rectangle {
     id: root
@@ -12,6 +13,7 @@ Rectangle {
     radius: 9
     border.color: "#A6F1E0"
     border.width: 5
+    z: 10 // Keeps the performance overlay above the panels below the bar
     anchors {
         top : parent.top
         horizontalCenter : parent.horizontalCenter
@@ -27,6 +29,260 @@ Rectangle {
         font.family : "DS-Digital"
         font.bold : true
         anchors.centerIn : parent
+
+        // Double-click the clock (or press F3) for the performance overlay
+        MouseArea {
+            anchors.fill: parent
+            onDoubleClicked: performanceMonitor.enabled = !performanceMonitor.enabled
+        }
+    }
+
+    // Session recording, every raw frame of the active source goes to the session log
+    Rectangle {
+        id: recordButton
+        property var recorder: communicationManager.recorder
+        width: recordText.width + 16
+        height: 24
+        radius: 6
+        color: recorder.recording ? "#C62828" : "transparent"
+        border.color: recorder.recording ? "#FF6B6B" : "#A6F1E0"
+        border.width: 1
+        anchors {
+            verticalCenter: parent.verticalCenter
+            left: timeText.right
+            leftMargin: 20
+        }
+
+        Text {
+            id: recordText
+            text: recordButton.recorder.recording
+                  ? "REC " + recordButton.recorder.recordedFrames + (recordButton.recorder.droppedFrames > 0 ? " (" + recordButton.recorder.droppedFrames + " lost)" : "")
+                  : "REC"
+            color: "white"
+            font { family: "DS-Digital"; pixelSize: 16; bold: true }
+            anchors.centerIn: parent
+        }
+
+        MouseArea {
+            anchors.fill: parent
+            onClicked: {
+                if (recordButton.recorder.recording)
+                    recordButton.recorder.stop()
+                else
+                    recordButton.recorder.start(root.nameofsession)
+            }
+        }
+    }
+
+    // Black box, saves the last minutes of raw frames and the next few seconds without recording
+    Rectangle {
+        id: blackBoxButton
+        property var blackBox: communicationManager.blackBox
+        visible: blackBox.armed
+        width: blackBoxText.width + 16
+        height: 24
+        radius: 6
+        color: blackBox.dumping ? "#E65100" : "transparent"
+        border.color: blackBox.dumping ? "#FFB74D" : "#A6F1E0"
+        border.width: 1
+        anchors {
+            verticalCenter: parent.verticalCenter
+            right: timeText.left
+            rightMargin: 20
+        }
+
+        Text {
+            id: blackBoxText
+            text: blackBoxButton.blackBox.dumping ? "SAVING" : "BOX"
+            color: "white"
+            font { family: "DS-Digital"; pixelSize: 16; bold: true }
+            anchors.centerIn: parent
+        }
+
+        MouseArea {
+            anchors.fill: parent
+            onClicked: blackBoxButton.blackBox.trigger()
+        }
+    }
+
+    // Live rewind, the gauges show a moment of the history while ingest and recording go on
+    Rectangle {
+        id: rewindButton
+        width: rewindText.width + 16
+        height: 24
+        radius: 6
+        color: communicationManager.live ? "transparent" : "#1565C0"
+        border.color: "#A6F1E0"
+        border.width: 1
+        anchors {
+            verticalCenter: parent.verticalCenter
+            right: blackBoxButton.left
+            rightMargin: 10
+        }
+
+        Text {
+            id: rewindText
+            text: communicationManager.live ? "LIVE" : "-" + communicationManager.rewindSeconds.toFixed(1) + " s"
+            color: "white"
+            font { family: "DS-Digital"; pixelSize: 16; bold: true }
+            anchors.centerIn: parent
+        }
+
+        MouseArea {
+            anchors.fill: parent
+            // While live a click opens the rewind slider, while rewound it goes back to live
+            onClicked: {
+                if (communicationManager.live) {
+                    rewindBar.visible = !rewindBar.visible
+                } else {
+                    communicationManager.goLive()
+                    rewindSlider.value = 0
+                }
+            }
+        }
+    }
+
+    Rectangle {
+        id: rewindBar
+        visible: false
+        width: 420
+        height: 40
+        color: "#CC09122C"
+        radius: 9
+        border.color: "#A6F1E0"
+        border.width: 2
+        z: 100
+        anchors {
+            top: parent.bottom
+            topMargin: 4
+            left: parent.left
+            leftMargin: 10
+        }
+
+        // The range is the time the history covers when the slider is opened or grabbed
+        onVisibleChanged: if (visible) rewindSlider.from = -communicationManager.historySeconds()
+
+        Slider {
+            id: rewindSlider
+            from: -60
+            to: 0
+            value: 0
+            anchors {
+                left: parent.left
+                right: rewindLiveText.left
+                verticalCenter: parent.verticalCenter
+                leftMargin: 10
+                rightMargin: 10
+            }
+            onPressedChanged: if (pressed && value === 0) from = -communicationManager.historySeconds()
+            onMoved: value < 0 ? communicationManager.rewind(-value) : communicationManager.goLive()
+        }
+
+        Text {
+            id: rewindLiveText
+            text: "LIVE"
+            color: communicationManager.live ? "gray" : "turquoise"
+            font { family: "DS-Digital"; pixelSize: 16; bold: true }
+            anchors {
+                right: parent.right
+                verticalCenter: parent.verticalCenter
+                rightMargin: 10
+            }
+            MouseArea {
+                anchors.fill: parent
+                onClicked: {
+                    communicationManager.goLive()
+                    rewindSlider.value = 0
+                }
+            }
+        }
+    }
+
+    // Lap marker, written to the session index so a replay can jump straight to it
+    Rectangle {
+        id: lapButton
+        visible: recordButton.recorder.recording
+        width: lapText.width + 16
+        height: 24
+        radius: 6
+        color: "transparent"
+        border.color: "#A6F1E0"
+        border.width: 1
+        anchors {
+            verticalCenter: parent.verticalCenter
+            left: recordButton.right
+            leftMargin: 10
+        }
+
+        Text {
+            id: lapText
+            text: "LAP " + (recordButton.recorder.lapCount + 1)
+            color: "white"
+            font { family: "DS-Digital"; pixelSize: 16; bold: true }
+            anchors.centerIn: parent
+        }
+
+        MouseArea {
+            anchors.fill: parent
+            onClicked: recordButton.recorder.markLap()
+        }
+    }
+
+    Shortcut {
+        sequence: "F3"
+        context: Qt.ApplicationShortcut
+        onActivated: performanceMonitor.enabled = !performanceMonitor.enabled
+    }
+
+    // Render and pipeline figures, the monitor only measures while this is shown
+    Rectangle {
+        id: performanceOverlay
+        visible: performanceMonitor.enabled
+        width: performanceColumn.width + 20
+        height: performanceColumn.height + 16
+        color: "#CC09122C"
+        radius: 9
+        border.color: "#A6F1E0"
+        border.width: 2
+        z: 100
+        anchors {
+            top: parent.bottom
+            topMargin: 4
+            horizontalCenter: parent.horizontalCenter
+        }
+
+        Column {
+            id: performanceColumn
+            anchors.centerIn: parent
+            spacing: 2
+
+            Text {
+                text: "Render  " + performanceMonitor.fps.toFixed(0) + " fps   frame "
+                      + performanceMonitor.frameTimeMs.toFixed(1) + " ms (max "
+                      + performanceMonitor.frameTimeMaxMs.toFixed(1) + ")   sync "
+                      + performanceMonitor.syncTimeMs.toFixed(2) + " ms   render "
+                      + performanceMonitor.renderTimeMs.toFixed(2) + " ms"
+                color: "white"
+                font { family: "Monospace"; pixelSize: 13 }
+            }
+            Text {
+                text: "GUI     event loop latency " + performanceMonitor.eventLoopLatencyMs.toFixed(1) + " ms"
+                color: performanceMonitor.eventLoopLatencyMs > 16 ? "#FF6B6B" : "white"
+                font { family: "Monospace"; pixelSize: 13 }
+            }
+            Text {
+                text: "Input   received " + performanceMonitor.receivedRate.toFixed(0) + "/s   parsed "
+                      + performanceMonitor.parsedRate.toFixed(0) + "/s   delivered "
+                      + performanceMonitor.deliveredRate.toFixed(0) + "/s"
+                color: "white"
+                font { family: "Monospace"; pixelSize: 13 }
+            }
+            Text {
+                text: "Queues  depth " + performanceMonitor.queueDepth + "   dropped " + performanceMonitor.dropped
+                color: performanceMonitor.dropped > 0 ? "#FFC107" : "white"
+                font { family: "Monospace"; pixelSize: 13 }
+            }
+        }
     }
 
     Text {
@@ -59,6 +315,134 @@ Rectangle {
         }
     }
 
+    // Replay controls, shown while a recorded session drives the dashboard
+    Row {
+        id: replayControls
+        property var replay: communicationManager.replay
+        visible: replay.running
+        spacing: 12
+        anchors {
+            verticalCenter: parent.verticalCenter
+            right: portNumberText.left
+            rightMargin: 20
+        }
+
+        function formatTime(ms) {
+            var seconds = Math.floor(ms / 1000)
+            return Math.floor(seconds / 60) + ":" + ("0" + seconds % 60).slice(-2)
+        }
+
+        Text {
+            text: replayControls.replay.playing ? "PAUSE" : "PLAY"
+            color: "turquoise"
+            font { family: "DS-Digital"; pixelSize: 16; bold: true }
+            MouseArea {
+                anchors.fill: parent
+                onClicked: replayControls.replay.playing ? replayControls.replay.pause() : replayControls.replay.resume()
+            }
+        }
+        Text {
+            text: "STEP"
+            color: replayControls.replay.playing ? "gray" : "turquoise"
+            font { family: "DS-Digital"; pixelSize: 16; bold: true }
+            MouseArea {
+                anchors.fill: parent
+                onClicked: replayControls.replay.step()
+            }
+        }
+        Text {
+            property int lap: 0
+            visible: replayControls.replay.lapCount > 0
+            text: lap > 0 ? "LAP " + lap + "/" + replayControls.replay.lapCount : "LAPS"
+            color: "turquoise"
+            font { family: "DS-Digital"; pixelSize: 16; bold: true }
+            MouseArea {
+                anchors.fill: parent
+                // Each click jumps to the start of the next marked lap
+                onClicked: {
+                    parent.lap = parent.lap % replayControls.replay.lapCount + 1
+                    replayControls.replay.seekToLap(parent.lap)
+                }
+            }
+        }
+        // Export the replayed session, click again to cancel a running export
+        Text {
+            text: sessionExporter.running ? "EXPORT " + Math.round(sessionExporter.progress * 100) + "%" : "MF4"
+            color: "turquoise"
+            font { family: "DS-Digital"; pixelSize: 16; bold: true }
+            MouseArea {
+                anchors.fill: parent
+                onClicked: sessionExporter.running ? sessionExporter.cancel() : sessionExporter.start(replayControls.replay.filePath, "mdf4")
+            }
+        }
+        Text {
+            visible: !sessionExporter.running
+            text: "PARQUET"
+            color: "turquoise"
+            font { family: "DS-Digital"; pixelSize: 16; bold: true }
+            MouseArea {
+                anchors.fill: parent
+                onClicked: sessionExporter.start(replayControls.replay.filePath, "parquet")
+            }
+        }
+        Text {
+            visible: !sessionExporter.running
+            text: "TLZ"
+            color: "turquoise"
+            font { family: "DS-Digital"; pixelSize: 16; bold: true }
+            MouseArea {
+                anchors.fill: parent
+                onClicked: sessionExporter.start(replayControls.replay.filePath, "tlz")
+            }
+        }
+        // Lines the CSV import could not parse, the replay leaves gaps where they were
+        Text {
+            visible: replayControls.replay.importWarning !== ""
+            width: Math.min(implicitWidth, 360)
+            elide: Text.ElideRight
+            text: replayControls.replay.importWarning
+            color: "#FFC107"
+            font { family: "DS-Digital"; pixelSize: 16 }
+        }
+        Text {
+            text: replayControls.formatTime(replayControls.replay.positionMs) + " / " + replayControls.formatTime(replayControls.replay.durationMs)
+                  + "  " + (replayControls.replay.speed > 0 ? replayControls.replay.speed + "x" : "MAX")
+            color: "white"
+            font { family: "DS-Digital"; pixelSize: 16 }
+        }
+    }
+
+    // Progress of a capture or CSV log being imported before its replay starts, click to cancel
+    Text {
+        id: importStatus
+        visible: communicationManager.replay.importing
+        text: "IMPORT " + Math.round(communicationManager.replay.importProgress * 100) + "%"
+        color: "turquoise"
+        font { family: "DS-Digital"; pixelSize: 16; bold: true }
+        anchors {
+            verticalCenter: parent.verticalCenter
+            right: portNumberText.left
+            rightMargin: 20
+        }
+        MouseArea {
+            anchors.fill: parent
+            onClicked: communicationManager.replay.stop()
+        }
+    }
+
+    // Left and right arrows seek by ten seconds during a replay
+    Shortcut {
+        sequence: "Left"
+        enabled: replayControls.visible
+        onActivated: replayControls.replay.seek(Math.max(0, replayControls.replay.positionMs - 10000))
+    }
+
+    Shortcut {
+        sequence: "Right"
+        enabled: replayControls.visible
+        onActivated: replayControls.replay.seek(replayControls.replay.positionMs + 10000)
+    }
+
     Timer {
         interval: 1000 // Updates every second
         running: true
@@ -494,6 +494,110 @@ Rectangle {
 
 
 
+                /**** Fields to choose a recorded session and its replay speed ****/
+
+                Text {
+                    visible: replayradio.checked
+                    text: "Enter Session, Capture or CSV File (.tlog, .pcap, .pcapng, .csv):"
+                    font {
+                        bold: true
+                        pixelSize: 13 * root.scaleFactor
+                    }
+                    anchors {
+                        left: parent.left
+                    }
+                    color: "white"
+                }
+
+                TextField {
+                    id: replayFileField
+                    visible: replayradio.checked
+                    placeholderText: startButton.inValid_Port ? "Don't Leave This Empty!" : "Enter Path (e.g., sessions/Test.tlog)"
+                    placeholderTextColor: startButton.inValid_Port ? "darkRed" : "turquoise"
+                    width: 300 * root.scaleFactor
+                    height: 25 * root.scaleFactor
+
+                    font.pointSize: 12 * root.scaleFactor
+                    verticalAlignment: TextInput.AlignVCenter
+                    anchors.horizontalCenter: parent.horizontalCenter
+                    color: "white"
+
+                    background: Rectangle {
+                        color: "#636363"
+                        radius: 50
+                        border.color: parent.activeFocus ? "turquoise" : startButton.inValid_Port ? "darkRed" : "transparent"
+                        border.width: 4
+                    }
+                }
+
+                Text {
+                    visible: replayradio.checked
+                    text: "Replay Speed (0 = as fast as possible):"
+                    font {
+                        bold: true
+                        pixelSize: 13 * root.scaleFactor
+                    }
+                    anchors {
+                        left: parent.left
+                    }
+                    color: "white"
+                }
+
+                TextField {
+                    id: replaySpeedField
+                    visible: replayradio.checked
+                    placeholderText: "1"
+                    placeholderTextColor: "turquoise"
+                    width: 300 * root.scaleFactor
+                    height: 25 * root.scaleFactor
+
+                    font.pointSize: 12 * root.scaleFactor
+                    verticalAlignment: TextInput.AlignVCenter
+                    anchors.horizontalCenter: parent.horizontalCenter
+                    color: "white"
+
+                    background: Rectangle {
+                        color: "#636363"
+                        radius: 50
+                        border.color: parent.activeFocus ? "turquoise" : "transparent"
+                        border.width: 4
+                    }
+                }
+
+                Text {
+                    visible: replayradio.checked
+                    text: "Capture UDP Port (pcap only, empty = busiest):"
+                    font {
+                        bold: true
+                        pixelSize: 13 * root.scaleFactor
+                    }
+                    anchors {
+                        left: parent.left
+                    }
+                    color: "white"
+                }
+
+                TextField {
+                    id: capturePortField
+                    visible: replayradio.checked
+                    placeholderText: "e.g., 5000"
+                    placeholderTextColor: "turquoise"
+                    width: 300 * root.scaleFactor
+                    height: 25 * root.scaleFactor
+
+                    font.pointSize: 12 * root.scaleFactor
+                    verticalAlignment: TextInput.AlignVCenter
+                    anchors.horizontalCenter: parent.horizontalCenter
+                    color: "white"
+
+                    background: Rectangle {
+                        color: "#636363"
+                        radius: 50
+                        border.color: parent.activeFocus ? "turquoise" : "transparent"
+                        border.width: 4
+                    }
+                }
+
                 /**** Field to choose the Serial Port ****/
 
                 ComboBox {
@@ -726,6 +830,34 @@ Rectangle {
                             }
                         }
                     }
+
+                    else if (replayradio.checked) {
+                        inValid_Port = (replayFileField.text.trim() === "");
+                        if (!inValid_Name && !inValid_Port) {
+                            var speed = replaySpeedField.text.trim() === "" ? 1.0 : parseFloat(replaySpeedField.text.trim());
+                            if (isNaN(speed) || speed < 0) {
+                                replaySpeedField.text = "";
+                                return;
+                            }
+                            var capturePort = capturePortField.text.trim() === "" ? 0 : parseInt(capturePortField.text.trim());
+                            if (isNaN(capturePort) || capturePort < 0 || capturePort > 65535) {
+                                capturePortField.text = "";
+                                return;
+                            }
+                            var success = communicationManager.startReplay(replayFileField.text.trim(), speed, capturePort);
+                            if (success) {
+                                console.log("Replay started: " + replayFileField.text);
+                                stackView.push("WaitingScreen.qml", {
+                                    "sessionName": sessionNameField.text,
+                                    "portNumber": "Replay",
+                                    "isSerialSource": false
+                                });
+                            } else {
+                                console.error("Failed to replay: " + replayFileField.text);
+                                inValid_Port = true;
+                            }
+                        }
+                    }
                 }
             }
 
@@ -953,6 +1085,23 @@ Rectangle {
                         anchors.leftMargin: 5
                     }
                 }
+
+                RadioButton {
+                    id: replayradio
+                    Text {
+                        id: radio4text
+                        text: "Replay Recorded Session"
+                        font {
+                            bold: true
+                            family: "DS-Digital"
+                            pixelSize: 18 * root.scaleFactor
+                        }
+                        color: "white"
+
+                        anchors.left: parent.right
+                        anchors.leftMargin: 5
+                    }
+                }
             }
         }
     }
@@ -0,0 +1,33 @@
+#ifndef BENCHMARKFRAMES_H
+#define BENCHMARKFRAMES_H
+
+#include <cmath>
+#include "../Controllers/telemetry/include/telemetryframe.h"
+
+/**
+ * @brief Frame i of a synthetic drive, shared by the benchmarks
+ *
+ * Noisy but plausible values, so that most comparisons between two consecutive frames report a change.
+ */
+inline TelemetryFrame makeFrame(int i)
+{
+    TelemetryFrame frame;
+    frame.speed = 80.0f + std::sin(i * 0.01f) * 40.0f;
+    frame.rpm = 6000 + (i % 2000);
+    frame.accPedal = i % 100;
+    frame.brakePedal = (i / 3) % 100;
+    frame.encoderAngle = std::sin(i * 0.02) * 90.0;
+    frame.temperature = 60.0f + (i % 50) * 0.1f;
+    frame.batteryLevel = 100 - (i / 10000) % 100;
+    frame.gpsLongitude = 31.2 + i * 1e-7;
+    frame.gpsLatitude = 30.0 + i * 1e-7;
+    frame.speedFL = 80 + i % 7;
+    frame.speedFR = 80 + i % 5;
+    frame.speedBL = 80 + i % 3;
+    frame.speedBR = 80 + i % 11;
+    frame.lateralG = std::sin(i * 0.05) * 2.0;
+    frame.longitudinalG = std::cos(i * 0.05) * 1.5;
+    return frame;
+}
+
+#endif // BENCHMARKFRAMES_H
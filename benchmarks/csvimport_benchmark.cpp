@@ -0,0 +1,117 @@
+// Measures how fast CsvImporter turns a legacy CSV log into a session log, on one core and on all of them.
+//
+// A synthetic log in the 15-field MCU format is written first, with one malformed line in every
+// 100000 so the error path is part of the measurement. The same file is then imported with the
+// global thread pool limited to one thread and with its default size.
+//
+// Build with -DGUI_BUILD_BENCHMARKS=ON and run csvimport_benchmark [megabytes] [directory]. The file
+// is read from the page cache after it was written, so the numbers are CPU bound, not disk bound.
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThreadPool>
+#include <cmath>
+#include "../Controllers/capture/include/csvimporter.h"
+#include "../Controllers/recording/include/sessionindex.h"
+
+static QByteArray makeLine(qint64 i)
+{
+    if (i % 100000 == 99999)
+    {
+        return QByteArrayLiteral("garbled,line\n");
+    }
+
+    // The MCU prints its values with a few decimals, like these
+    QByteArray line;
+    line += QByteArray::number(80.0 + std::sin(i * 0.01) * 40.0, 'f', 2) + ',';
+    line += QByteArray::number(6000 + i % 2000) + ',';
+    line += QByteArray::number(i % 100) + ',';
+    line += QByteArray::number((i / 3) % 100) + ',';
+    line += QByteArray::number(std::sin(i * 0.02) * 90.0, 'f', 3) + ',';
+    line += QByteArray::number(60.0 + (i % 50) * 0.1, 'f', 1) + ',';
+    line += QByteArray::number(100 - (i / 10000) % 100) + ',';
+    line += QByteArray::number(31.2 + i * 1e-7, 'f', 7) + ',';
+    line += QByteArray::number(30.0 + i * 1e-7, 'f', 7) + ',';
+    line += QByteArray::number(80 + i % 5) + ',';
+    line += QByteArray::number(80 + i % 7) + ',';
+    line += QByteArray::number(80 + i % 11) + ',';
+    line += QByteArray::number(80 + i % 3) + ',';
+    line += QByteArray::number(std::sin(i * 0.05) * 2.0, 'f', 3) + ',';
+    line += QByteArray::number(std::cos(i * 0.05) * 1.5, 'f', 3) + '\n';
+    return line;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const QStringList args = app.arguments();
+    const qint64 megabytes = args.size() > 1 ? args.at(1).toLongLong() : 512;
+    QTemporaryDir temporary;
+    const QString directory = args.size() > 2 ? args.at(2) : temporary.path();
+    const QString csvPath = directory + QStringLiteral("/csvimport-benchmark.csv");
+    const QString logPath = directory + QStringLiteral("/csvimport-benchmark.tlog");
+
+    // Lines repeat every 4096, which keeps writing a large file quick
+    QList<QByteArray> lines;
+    for (qint64 i = 0; i < 4096; ++i)
+    {
+        lines.append(makeLine(i));
+    }
+    QFile csv(csvPath);
+    if (!csv.open(QIODevice::WriteOnly))
+    {
+        out << "cannot write " << csvPath << Qt::endl;
+        return 1;
+    }
+    QByteArray buffer;
+    for (qint64 i = 0; csv.size() + buffer.size() < megabytes * 1000000; ++i)
+    {
+        buffer += i % 100000 == 99999 ? makeLine(i) : lines.at(i % lines.size());
+        if (buffer.size() >= (1 << 20))
+        {
+            csv.write(buffer);
+            buffer.clear();
+        }
+    }
+    csv.write(buffer);
+    csv.close();
+
+    const int threads = QThreadPool::globalInstance()->maxThreadCount();
+    out << "importing " << megabytes << " MB from " << csvPath << Qt::endl;
+
+    for (int poolSize : {1, threads})
+    {
+        QThreadPool::globalInstance()->setMaxThreadCount(poolSize);
+        CsvImporter::Result result;
+        QString error;
+        QElapsedTimer timer;
+        timer.start();
+        if (!CsvImporter::import(csvPath, logPath, CsvImporter::DefaultIntervalUs, result, &error))
+        {
+            out << "import failed: " << error << Qt::endl;
+            return 1;
+        }
+        const double elapsed = timer.nsecsElapsed() / 1e9;
+
+        qint64 failedChunks = 0;
+        for (const CsvImporter::Chunk &chunk : result.chunks)
+        {
+            failedChunks += chunk.rejected > 0 ? 1 : 0;
+        }
+        out << poolSize << (poolSize == 1 ? " thread: " : " threads: ") << elapsed << " s, " << result.bytes / elapsed / 1e6 << " MB/s, "
+            << qint64(result.frames / elapsed) << " frames/s" << Qt::endl;
+        out << "    " << result.lines << " lines, " << result.rejected << " rejected in " << failedChunks << " of "
+            << result.chunks.size() << " chunks" << Qt::endl;
+    }
+    QThreadPool::globalInstance()->setMaxThreadCount(threads);
+
+    QFile::remove(csvPath);
+    QFile::remove(logPath);
+    QFile::remove(SessionIndex::indexPath(logPath));
+    return 0;
+}
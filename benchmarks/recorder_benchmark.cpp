@@ -0,0 +1,97 @@
+// Measures what the group-commit policy of SessionRecorder costs in recording throughput.
+//
+// A producer appends frames as fast as it can for a fixed time while the I/O thread writes and syncs
+// under each policy, from a sync after every write to no sync before the log is closed. Frames the
+// disk cannot keep up with are dropped by the recorder, so the recorded rate is the sustainable one.
+// The most frames the producer saw recorded but not yet synced is what a power loss would cost.
+//
+// Build with -DGUI_BUILD_BENCHMARKS=ON and run recorder_benchmark [seconds] [directory]. Point the
+// directory at the disk sessions are recorded to, the default is a temporary directory.
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include "../Controllers/recording/include/sessionrecorder.h"
+#include "benchmarkframes.h"
+
+struct Policy
+{
+    const char *name;
+    int intervalMs;
+    qint64 bytes;
+};
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const QStringList args = app.arguments();
+    const double seconds = args.size() > 1 ? args.at(1).toDouble() : 5.0;
+    QTemporaryDir temporary;
+    const QString directory = args.size() > 2 ? args.at(2) : temporary.path();
+
+    const Policy policies[] = {
+        {"sync after every write", 0, 0},
+        {"sync every 10 ms", 10, 0},
+        {"sync every 100 ms", 100, 0},
+        {"sync every 1000 ms or 8 MiB", 1000, qint64(8) << 20},
+        {"sync only when stopped", -1, 0},
+    };
+
+    QList<TelemetryFrame> input;
+    input.reserve(4096);
+    for (int i = 0; i < 4096; ++i)
+    {
+        input.append(makeFrame(i));
+    }
+
+    out << "recording to " << directory << " for " << seconds << " s per policy" << Qt::endl;
+
+    int run = 0;
+    for (const Policy &policy : policies)
+    {
+        SessionRecorder recorder;
+        recorder.setDirectory(directory);
+        recorder.setSyncIntervalMs(policy.intervalMs);
+        recorder.setSyncBytes(policy.bytes);
+        if (!recorder.start(QStringLiteral("benchmark-%1").arg(run++)))
+        {
+            out << "cannot record to " << directory << Qt::endl;
+            return 1;
+        }
+
+        qint64 appended = 0;
+        qint64 maxUnsynced = 0;
+        const qint64 durationNs = qint64(seconds * 1e9);
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.nsecsElapsed() < durationNs)
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                TelemetryFrame frame = input.at(appended % input.size());
+                frame.timestampUs = telemetryTimestampUs();
+                recorder.append(frame);
+                ++appended;
+            }
+            maxUnsynced = qMax(maxUnsynced, recorder.recordedFrames() - recorder.syncedFrames());
+        }
+        const double elapsed = timer.nsecsElapsed() / 1e9;
+        recorder.stop();
+
+        const double recordedRate = recorder.recordedFrames() / elapsed;
+        out << policy.name << ":" << Qt::endl;
+        out << "    recorded " << qint64(recordedRate) << " frames/s, " << recorder.bytesWritten() / elapsed / 1e6 << " MB/s, "
+            << 100.0 * recorder.droppedFrames() / qMax<qint64>(appended, 1) << " % dropped" << Qt::endl;
+        out << "    " << recorder.syncCount() << " syncs, at most " << maxUnsynced << " frames unsynced ("
+            << 1000.0 * maxUnsynced / qMax(recordedRate, 1.0) << " ms at the recorded rate)" << Qt::endl;
+
+        QFile::remove(recorder.filePath());
+        QFile::remove(SessionIndex::indexPath(recorder.filePath()));
+    }
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+// Compares the old per-field signal fan-out of CommunicationManager with the table-driven routing.
+//
+// Legacy: every parsed frame emits one signal per channel, and the manager has a slot per channel and
+// per source that checks the active source and compares against its stored copy.
+// Routed: the parser publishes the frame in a TelemetryStore, and the manager applies the routing
+// table once per rendered frame.
+//
+// Build with -DGUI_BUILD_BENCHMARKS=ON and run routing_benchmark [frames] [framesPerRender].
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTextStream>
+#include "../Controllers/telemetry/include/telemetrychannels.h"
+#include "../Controllers/telemetry/include/telemetrystore.h"
+#include "benchmarkframes.h"
+
+class LegacyClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    void publish(const TelemetryFrame &frame)
+    {
+        for (const TelemetryChannelInfo &channel : telemetryChannels())
+        {
+            emit valueChanged(static_cast<int>(channel.channel), channel.read(frame));
+        }
+    }
+
+signals:
+    void valueChanged(int channel, double value);
+};
+
+class LegacyManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    int activeSource = 0;
+    int notifications = 0;
+
+    // One slot per source, mirroring handleUdp*, handleSerial* and handleMqtt*
+    void handleSource0(int channel, double value) { handle(0, channel, value); }
+    void handleSource1(int channel, double value) { handle(1, channel, value); }
+    void handleSource2(int channel, double value) { handle(2, channel, value); }
+
+private:
+    void handle(int source, int channel, double value)
+    {
+        if (source != activeSource)
+        {
+            return;
+        }
+
+        const TelemetryChannelInfo &info = telemetryChannels()[channel];
+        if (!info.equal(info.read(m_frame), value))
+        {
+            info.write(m_frame, value);
+            ++notifications;
+        }
+    }
+
+    TelemetryFrame m_frame;
+};
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const QStringList args = app.arguments();
+    const int frames = args.size() > 1 ? args.at(1).toInt() : 1000000;
+    const int framesPerRender = args.size() > 2 ? args.at(2).toInt() : 16;
+
+    QList<TelemetryFrame> input;
+    input.reserve(frames);
+    for (int i = 0; i < frames; ++i)
+    {
+        input.append(makeFrame(i));
+    }
+
+    // Legacy fan-out, all three clients connected even though only one is active
+    LegacyClient legacyClients[3];
+    LegacyManager legacyManager;
+    QObject::connect(&legacyClients[0], &LegacyClient::valueChanged, &legacyManager, &LegacyManager::handleSource0);
+    QObject::connect(&legacyClients[1], &LegacyClient::valueChanged, &legacyManager, &LegacyManager::handleSource1);
+    QObject::connect(&legacyClients[2], &LegacyClient::valueChanged, &legacyManager, &LegacyManager::handleSource2);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (const TelemetryFrame &frame : std::as_const(input))
+    {
+        legacyClients[0].publish(frame);
+    }
+    const qint64 legacyNs = timer.nsecsElapsed();
+
+    // Routed, the parser side writes the store and the render side applies the table per frame
+    TelemetryStore store;
+    TelemetryFrame published;
+    quint64 version = 0;
+    int notifications = 0;
+
+    timer.restart();
+    for (int i = 0; i < frames; ++i)
+    {
+        store.write(input.at(i));
+
+        if ((i + 1) % framesPerRender == 0)
+        {
+            TelemetryFrame frame;
+            if (store.readIfNewer(version, frame))
+            {
+                bool changed = false;
+                for (const TelemetryChannelInfo &channel : telemetryChannels())
+                {
+                    const double value = channel.read(frame);
+                    if (!channel.equal(channel.read(published), value))
+                    {
+                        channel.write(published, value);
+                        changed = true;
+                    }
+                }
+                notifications += changed ? 1 : 0;
+            }
+        }
+    }
+    const qint64 routedNs = timer.nsecsElapsed();
+
+    out << "frames: " << frames << ", frames per render: " << framesPerRender << Qt::endl;
+    out << "legacy per-field slots: " << double(legacyNs) / frames << " ns/frame, "
+        << legacyManager.notifications << " notifications" << Qt::endl;
+    out << "table-driven routing:   " << double(routedNs) / frames << " ns/frame, "
+        << notifications << " notifications" << Qt::endl;
+
+    return 0;
+}
+
+#include "routing_benchmark.moc"
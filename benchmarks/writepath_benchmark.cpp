@@ -0,0 +1,127 @@
+// Compares the write paths of SessionRecorder: blocking pwrite, io_uring, and io_uring with O_DIRECT.
+//
+// Each path records twice, once paced at a peak ingest rate and once as fast as the producer can
+// append. Syncing is left to the end, so the numbers are those of the write path alone. The paced
+// run shows what recording costs the ingest threads, the append latency and the CPU time of the
+// whole process, the unpaced run the most the path sustains before frames are dropped.
+//
+// Build with -DGUI_BUILD_BENCHMARKS=ON and run writepath_benchmark [seconds] [frames/s] [directory].
+// Point the directory at the disk sessions are recorded to, O_DIRECT is not available on tmpfs.
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+#include <ctime>
+#include "../Controllers/recording/include/sessionrecorder.h"
+#include "benchmarkframes.h"
+
+struct WritePath
+{
+    BlockWriteQueue::Backend backend;
+    bool direct;
+};
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const QStringList args = app.arguments();
+    const double seconds = args.size() > 1 ? args.at(1).toDouble() : 5.0;
+    const qint64 peakRate = args.size() > 2 ? args.at(2).toLongLong() : 500000;
+    QTemporaryDir temporary;
+    const QString directory = args.size() > 3 ? args.at(3) : temporary.path();
+
+    const WritePath paths[] = {
+        {BlockWriteQueue::Backend::Pwrite, false},
+        {BlockWriteQueue::Backend::IoUring, false},
+        {BlockWriteQueue::Backend::IoUring, true},
+    };
+
+    QList<TelemetryFrame> input;
+    input.reserve(4096);
+    for (int i = 0; i < 4096; ++i)
+    {
+        input.append(makeFrame(i));
+    }
+
+    out << "recording to " << directory << " for " << seconds << " s per run, io_uring "
+        << (BlockWriteQueue::ioUringSupported() ? "available" : "not available") << Qt::endl;
+
+    int run = 0;
+    for (const WritePath &path : paths)
+    {
+        for (const qint64 rate : {peakRate, qint64(0)})
+        {
+            SessionRecorder recorder;
+            recorder.setDirectory(directory);
+            recorder.setSyncIntervalMs(-1);
+            recorder.setSyncBytes(0);
+            recorder.setWriteOptions(path.backend, path.direct, 4);
+            if (!recorder.start(QStringLiteral("writepath-%1").arg(run++)))
+            {
+                out << "cannot record to " << directory << Qt::endl;
+                return 1;
+            }
+
+            // Every 64th append is timed, timing each one would cost about as much as the append
+            QList<qint64> latenciesNs;
+            latenciesNs.reserve(qsizetype(seconds * 1e6 / 64) + 1);
+            qint64 appended = 0;
+            const qint64 durationNs = qint64(seconds * 1e9);
+            const std::clock_t cpuStart = std::clock();
+            QElapsedTimer timer;
+            timer.start();
+            QElapsedTimer appendTimer;
+            while (timer.nsecsElapsed() < durationNs)
+            {
+                if (rate > 0 && appended >= timer.nsecsElapsed() * rate / 1000000000)
+                {
+                    // Ahead of the rate, a sleeping producer keeps the CPU time to appending and writing
+                    QThread::usleep(50);
+                    continue;
+                }
+                for (int i = 0; i < 256; ++i)
+                {
+                    TelemetryFrame frame = input.at(appended % input.size());
+                    frame.timestampUs = telemetryTimestampUs();
+                    if (appended % 64 == 0)
+                    {
+                        appendTimer.start();
+                        recorder.append(frame);
+                        latenciesNs.append(appendTimer.nsecsElapsed());
+                    }
+                    else
+                    {
+                        recorder.append(frame);
+                    }
+                    ++appended;
+                }
+            }
+            const double elapsed = timer.nsecsElapsed() / 1e9;
+            recorder.stop();
+            const double cpuSeconds = double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+            std::sort(latenciesNs.begin(), latenciesNs.end());
+            auto percentile = [&latenciesNs](double p)
+            {
+                return latenciesNs.isEmpty() ? 0 : latenciesNs.at(qMin(latenciesNs.size() - 1, qsizetype(p * latenciesNs.size())));
+            };
+
+            out << recorder.writeBackend() << (rate > 0 ? QStringLiteral(", %1 frames/s:").arg(rate) : QStringLiteral(", unpaced:")) << Qt::endl;
+            out << "    recorded " << qint64(recorder.recordedFrames() / elapsed) << " frames/s, " << recorder.bytesWritten() / elapsed / 1e6
+                << " MB/s, " << 100.0 * recorder.droppedFrames() / qMax<qint64>(appended, 1) << " % dropped" << Qt::endl;
+            out << "    append p50 " << percentile(0.5) << " ns, p99 " << percentile(0.99) << " ns, max " << percentile(1.0) << " ns, "
+                << "CPU " << 100.0 * cpuSeconds / elapsed << " % of a core" << Qt::endl;
+
+            QFile::remove(recorder.filePath());
+            QFile::remove(SessionIndex::indexPath(recorder.filePath()));
+        }
+    }
+
+    return 0;
+}
@@ -3,25 +3,59 @@
 #include <Controllers/udp/include/udpclient.h>
 #include <Controllers/serial/include/serialmanager.h>
 #include <Controllers/communication_manager/include/communicationmanager.h>
+#include <Controllers/communication_manager/include/telemetryfeed.h>
 #include <Controllers/mqtt/include/mqttclient.h>
+#include <Controllers/charts/include/stripchart.h>
+#include <Controllers/charts/include/dialgauge.h>
+#include <Controllers/charts/include/bargauge.h>
+#include <Controllers/charts/include/ggdiagram.h>
+#include <Controllers/charts/include/gpstrack.h>
+#include <Controllers/maps/include/tileserver.h>
+#include <Controllers/diagnostics/include/performancemonitor.h>
+#include <Controllers/export/include/sessionexporter.h>
 #include <QQmlContext>
+#include <QQuickWindow>
 #include <QThread>
 
 int main(int argc, char *argv[])
 {
     QGuiApplication app(argc, argv);
 
+    qmlRegisterType<StripChart>("GUI.Charts", 1, 0, "StripChart");
+    qmlRegisterType<DialGauge>("GUI.Charts", 1, 0, "DialGauge");
+    qmlRegisterType<BarGauge>("GUI.Charts", 1, 0, "BarGauge");
+    qmlRegisterType<GGDiagram>("GUI.Charts", 1, 0, "GGDiagram");
+    qmlRegisterType<GpsTrack>("GUI.Charts", 1, 0, "GpsTrack");
+    qmlRegisterType<TelemetryFeed>("GUI.Telemetry", 1, 0, "TelemetryFeed");
+
     QQmlApplicationEngine engine;
     UdpClient udpClient;
     SerialManager serialManager;
     MqttClient mqttClient;
     CommunicationManager communicationManager;
+    TileServer tileServer;
+    PerformanceMonitor performanceMonitor;
+    SessionExporter sessionExporter;
+    performanceMonitor.setSource(&communicationManager);
+
+    // Offline map tiles, an .mbtiles file or a {z}/{x}/{y} directory; must be serving before the map plugin is created
+    const QString tilePath = qEnvironmentVariable("GUI_MAP_TILES");
+    if (!tilePath.isEmpty())
+    {
+        tileServer.start(tilePath);
+    }
+
+    // Logs left open by a crash or a power loss are repaired before anything new is recorded
+    communicationManager.recorder()->recover();
 
     engine.rootContext()->setContextProperty("communicationManager", &communicationManager);
 
     engine.rootContext()->setContextProperty("udpClient", &udpClient);
     engine.rootContext()->setContextProperty("serialManager", &serialManager);
     engine.rootContext()->setContextProperty("mqttClient", &mqttClient);
+    engine.rootContext()->setContextProperty("tileServer", &tileServer);
+    engine.rootContext()->setContextProperty("performanceMonitor", &performanceMonitor);
+    engine.rootContext()->setContextProperty("sessionExporter", &sessionExporter);
 
     QObject::connect(
         &engine,
@@ -31,6 +65,13 @@ int main(int argc, char *argv[])
         Qt::QueuedConnection);
     engine.loadFromModule("GUI", "Main");
 
+    // Deliver telemetry to QML once per rendered frame of the dashboard window
+    if (!engine.rootObjects().isEmpty())
+    {
+        communicationManager.attachWindow(qobject_cast<QQuickWindow *>(engine.rootObjects().constFirst()));
+        performanceMonitor.attachWindow(qobject_cast<QQuickWindow *>(engine.rootObjects().constFirst()));
+    }
+
     return app.exec();
 }
 